@@ -0,0 +1,2037 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+xformArrayBench
+    Times the Maya-free kernels behind the xformArrayNodes nodes on
+    synthetic arrays of 1, 1k, 100k and 1M elements. Maya is not needed to
+    build or run it.
+
+    Each case reports nanoseconds per element and memory throughput,
+    counting the bytes each element reads and writes. Results are printed
+    as a table, and can also be written as JSON so that runs from
+    different releases can be compared.
+
+    With --concurrent, every case is instead run from that many threads at
+    once, the way Maya's parallel evaluation runs many instances of a node.
+    Each thread fills and works on its own arrays, and must reproduce the 
+    checksum of a single-threaded run.
+
+    Quaternion cases ending in .float run the single-precision kernels on
+    the same values. With --precision, the bench instead reports how far
+    each single-precision kernel's results are from the double-precision
+    ones. With --encoding, it reports the size of each quatArray binary 
+    encoding, and the largest error of each round trip, on a few kinds of
+    arrays. With --sidecar, it times writing quaternion arrays to sidecar
+    files, opening them, and first reading the values, against reading the
+    same bytes from an ordinary file, in a temporary directory. With
+    --binary, it reports the throughput of writing and reading 1M angles
+    in the binary file format, one value per stream call against one 
+    block of values per call.
+
+    quatLayout cases run the same product, normalize and slerp on 
+    quaternions stored as an array of Quaternions (aos), as the nodes 
+    receive them, and as lanes (soa), as the quatArray kernels use them.
+
+    The angle nodes, and packEulerArray and unpackEulerArray, convert 
+    each MAngle through Maya, so their cases time the same arithmetic on 
+    plain values and units instead.
+
+    quatToEulerArray cases convert to each of the six rotation orders with
+    the kernel compiled for that order, as the Per Order conversion does, 
+    and cases ending in .reorder time the default Maya conversion: find
+    XYZ angles, as asEulerRotation() does, then rebuild the matrix and 
+    decompose it in the new order, as reorderIt() does. That is a stand-in
+    written for the bench, as Maya's own functions need Maya.
+
+    Before any case runs, the bench checks that SharedBuffer copies, which
+    back the plugin's array data types, are isolated from each other's 
+    writes, and that both ways of finding euler rotations agree.
+
+    Usage: xformArrayBench [--json <path>] [--filter <text>] [--min-time <seconds>] [--concurrent <threads>] [--precision] [--encoding] [--sidecar] [--binary]
+*/
+
+#include "../src/core/doubleText.h"
+#include "../src/core/eulerKernels.h"
+#include "../src/core/matrixCompose.h"
+#include "../src/core/matrixDecompose.h"
+#include "../src/core/arrayView.h"
+#include "../src/core/matrixKernels.h"
+#include "../src/core/packKernels.h"
+#include "../src/core/parallel.h"
+#include "../src/core/quatCodec.h"
+#include "../src/core/quatKernels.h"
+#include "../src/core/quatLanes.h"
+#include "../src/core/quatSlerp.h"
+#include "../src/core/contentHash.h"
+#include "../src/core/sharedBuffer.h"
+#include "../src/core/sidecarFile.h"
+#include "../src/core/simd.h"
+#include "../src/core/vectorKernels.h"
+#include "../src/core/xformTypes.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchCase
+{
+    std::string             name;
+    size_t                  bytesPerElement;
+    std::function<void(size_t)> setup;
+    std::function<double()> run;
+};
+
+struct BenchResult
+{
+    std::string name;
+    size_t      elements;
+    size_t      iterations;
+    double      nsPerElement;
+    double      gbPerSecond;
+    double      checksum;
+};
+
+/** Stands in for MAngle, which stores a value and its unit. */
+struct BenchAngle
+{
+    double value;
+    int    unit;
+};
+
+struct BenchOptions
+{
+    std::string jsonPath;
+    std::string filter;
+    double      minTime = 0.25;
+    unsigned    concurrent = 0;
+    bool        precision = false;
+    bool        encoding = false;
+    bool        sidecar = false;
+    bool        binary = false;
+};
+
+static const size_t ELEMENT_COUNTS[] = {1, 1000, 100000, 1000000};
+
+static const size_t BATCH_ELEMENTS = 100000;
+
+/** Larger arrays are skipped by --concurrent, as every thread holds its own copies. */
+static const size_t STRESS_ELEMENTS = 100000;
+
+static const double PI = 3.14159265358979323846;
+
+/** Each thread has its own generator, so concurrent setups fill identical arrays. */
+static thread_local uint64_t randomState = 1;
+
+
+static void seedRandom(uint64_t seed)
+{
+    randomState = seed;
+}
+
+
+/** Values are kept in a small range so that every kernel stays finite. */
+static double randomValue()
+{
+    randomState = randomState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double) (randomState >> 11) / (double) (1ULL << 53) * 2.0 - 1.0;
+}
+
+
+static void fillLanes(QuatLanes &q, size_t n)
+{
+    q.resize(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        q.x[i] = randomValue();
+        q.y[i] = randomValue();
+        q.z[i] = randomValue();
+        q.w[i] = randomValue();
+    }
+}
+
+
+static void fillLanes(QuatLanesF &q, size_t n)
+{
+    QuatLanes values;
+    fillLanes(values, n);
+    convertQuatLanes(values, q);
+}
+
+
+template <typename REAL>
+static double lanesChecksum(const BasicQuatLanes<REAL> &q)
+{
+    return q.empty() ? 0.0 : q.x[0] + q.y[q.size() / 2] + q.w[q.size() - 1];
+}
+
+
+/** Fills n affine matrices with random rotation, scale and shear. */
+static void fillMatrices(std::vector<double> &m, size_t n)
+{
+    m.resize(n * MATRIX_SIZE);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double translate[3] = {randomValue() * 10.0, randomValue() * 10.0, randomValue() * 10.0};
+        double scale[3]     = {1.5 + randomValue(), 1.5 + randomValue(), 1.5 + randomValue()};
+        double shear[3]     = {randomValue() * 0.1, randomValue() * 0.1, randomValue() * 0.1};
+        double rotate[3][3];
+
+        eulerToRotation(randomValue() * PI, randomValue() * PI, randomValue() * PI, ROTATE_ORDER_XYZ, rotate);
+        composeMatrix(translate, rotate, scale, shear, &m[i * MATRIX_SIZE]);
+    }
+}
+
+
+static double matricesChecksum(const std::vector<double> &m)
+{
+    return m.empty() ? 0.0 : m[0] + m[m.size() / 2] + m[m.size() - 1];
+}
+
+
+static void fillVectors(std::vector<Vector3> &v, size_t n)
+{
+    v.resize(n);
+
+    for (Vector3 &e : v)
+    {
+        e.x = randomValue();
+        e.y = randomValue();
+        e.z = randomValue();
+    }
+}
+
+
+static double vectorsChecksum(const std::vector<Vector3> &v)
+{
+    return v.empty() ? 0.0 : v[0].x + v[v.size() / 2].y + v[v.size() - 1].z;
+}
+
+
+/** Radians per MAngle::Unit: radians, degrees, arc minutes and arc seconds. */
+static const double ANGLE_UNIT_RADIANS[] = {1.0, PI / 180.0, PI / 10800.0, PI / 648000.0};
+
+/** The arithmetic of MAngle::as. */
+static inline double angleAs(const BenchAngle &angle, int unit)
+{
+    return angle.value * (ANGLE_UNIT_RADIANS[angle.unit] / ANGLE_UNIT_RADIANS[unit]);
+}
+
+
+/** Fills n angles in degrees, as AngleArrayData reads them with the default UI unit. */
+static void fillAngles(std::vector<BenchAngle> &a, size_t n)
+{
+    a.resize(n);
+
+    for (BenchAngle &e : a)
+    {
+        e.value = randomValue() * 180.0;
+        e.unit  = 1;
+    }
+}
+
+
+static void fillPoints(std::vector<Point4> &p, size_t n)
+{
+    p.resize(n);
+
+    for (Point4 &e : p)
+    {
+        e.x = randomValue() * 10.0;
+        e.y = randomValue() * 10.0;
+        e.z = randomValue() * 10.0;
+        e.w = 1.0;
+    }
+}
+
+
+/** Fills n unit quaternions. */
+static void fillQuaternions(std::vector<Quaternion> &q, size_t n)
+{
+    q.resize(n);
+
+    for (Quaternion &e : q)
+    {
+        e.x = randomValue();
+        e.y = randomValue();
+        e.z = randomValue();
+        e.w = randomValue();
+
+        double length = sqrt((e.x * e.x) + (e.y * e.y) + (e.z * e.z) + (e.w * e.w));
+
+        e.x /= length; e.y /= length; e.z /= length; e.w /= length;
+    }
+}
+
+
+static double eulersChecksum(const std::vector<EulerRotation> &e)
+{
+    return e.empty() ? 0.0 : e[0].x + e[e.size() / 2].y + e[e.size() - 1].z;
+}
+
+
+/** 
+    Stands in for the default conversion of quatToEulerArray, which is 
+    asEulerRotation() followed by reorderIt().
+    Those need Maya, so this does the same steps with the core functions,
+    and is only as fast or slow as this code, not as Maya's.
+*/
+static EulerRotation quatToEulerReordered(const Quaternion &q, int rotateOrder)
+{
+    double rotate[3][3];
+    quatToRotation(q.x, q.y, q.z, q.w, rotate);
+
+    EulerRotation e = rotationToEuler(rotate, ROTATE_ORDER_XYZ);
+
+    if (rotateOrder != ROTATE_ORDER_XYZ)
+    {
+        eulerToRotation(e.x, e.y, e.z, ROTATE_ORDER_XYZ, rotate);
+        e = rotationToEuler(rotate, rotateOrder);
+    }
+
+    return e;
+}
+
+
+/** 
+    A slow turn about one axis, each rotation held for HOLD_ELEMENTS elements, 
+    like the values of a baked rig whose joints only some frames change.
+*/
+static void fillBakedQuaternions(std::vector<Quaternion> &q, size_t n)
+{
+    const size_t HOLD_ELEMENTS = 4;
+    const double axis[3] = {0.2672612419124244, 0.5345224838248488, 0.8017837257372732};
+
+    q.resize(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double halfAngle = 0.0005 * (double) (i / HOLD_ELEMENTS);
+        double s = sin(halfAngle);
+
+        q[i].x = axis[0] * s;
+        q[i].y = axis[1] * s;
+        q[i].z = axis[2] * s;
+        q[i].w = cos(halfAngle);
+    }
+}
+
+
+/** Copies quaternions into lanes, so that both layouts hold the same values. */
+static void quaternionsToLanes(const std::vector<Quaternion> &q, QuatLanes &lanes)
+{
+    lanes.resize(q.size());
+
+    for (size_t i = 0; i < q.size(); i++)
+    {
+        lanes.x[i] = q[i].x;
+        lanes.y[i] = q[i].y;
+        lanes.z[i] = q[i].z;
+        lanes.w[i] = q[i].w;
+    }
+}
+
+
+/**
+    The slerp of quatSlerp, with spin 1, over lanes instead of Quaternions.
+    It is only here to compare the two layouts.
+*/
+static void lanesSlerp(const QuatLanes &q1, const QuatLanes &q2, double tween, QuatLanes &out)
+{
+    out.resize(q1.size());
+
+    const double *px = q1.x.data(), *py = q1.y.data(), *pz = q1.z.data(), *pw = q1.w.data();
+    const double *qx = q2.x.data(), *qy = q2.y.data(), *qz = q2.z.data(), *qw = q2.w.data();
+    double *ox = out.x.data(), *oy = out.y.data(), *oz = out.z.data(), *ow = out.w.data();
+
+    parallelForRange(0, q1.size(), DEFAULT_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            double cosTheta = (px[i] * qx[i]) + (py[i] * qy[i]) + (pz[i] * qz[i]) + (pw[i] * qw[i]);
+            double sign = cosTheta < 0.0 ? -1.0 : 1.0;
+            cosTheta *= sign;
+
+            double alpha = tween;
+            double beta  = 1.0 - tween;
+
+            if (1.0 - cosTheta >= 1.0e-6)
+            {
+                double theta = acos(cosTheta);
+                double phi = theta + PI;
+                double sinTheta = sin(theta);
+
+                beta  = sin(theta - (tween * phi)) / sinTheta;
+                alpha = sin(tween * phi) / sinTheta;
+            }
+
+            alpha *= sign;
+
+            ox[i] = (beta * px[i]) + (alpha * qx[i]);
+            oy[i] = (beta * py[i]) + (alpha * qy[i]);
+            oz[i] = (beta * pz[i]) + (alpha * qz[i]);
+            ow[i] = (beta * pw[i]) + (alpha * qw[i]);
+        }
+    });
+}
+
+
+/**
+    The arrays the cases work on, shared by every case on one thread; each
+    setup call replaces the previous contents. These are at namespace scope
+    so that every --concurrent thread constructs its own on first use, and
+    frees them when it exits.
+*/
+static thread_local QuatLanes q1, q2, qOut;
+static thread_local QuatLanesF f1, f2, fOut;
+static thread_local std::vector<double> m1, m2, mOut;
+static thread_local std::vector<double> components;
+static thread_local std::vector<size_t> singular;
+static thread_local std::vector<Vector3> v1, v2, vOut;
+static thread_local std::vector<Quaternion> p1, p2, pOut;
+static thread_local std::vector<QuatSlerpPair> pairs;
+static thread_local std::vector<EulerRotation> e1, eOut;
+static thread_local SharedBuffer<std::vector<Quaternion>> shared;
+static thread_local std::vector<uint8_t> encoded;
+static thread_local QuatEncoding encodedAs;
+static thread_local std::vector<char> text;
+static thread_local std::vector<size_t> textOffsets;
+static thread_local std::vector<BenchAngle> a1, a2, a3, aOut;
+static thread_local std::vector<Point4> points, pointsOut;
+static thread_local std::vector<double> dOut;
+
+
+static std::vector<BenchCase> benchCases()
+{
+    std::vector<BenchCase> cases;
+
+    typedef void (*QuatBinary)(const QuatLanes&, const QuatLanes&, QuatLanes&);
+    typedef void (*QuatUnary)(const QuatLanes&, QuatLanes&);
+    typedef void (*QuatBinaryF)(const QuatLanesF&, const QuatLanesF&, QuatLanesF&);
+    typedef void (*QuatUnaryF)(const QuatLanesF&, QuatLanesF&);
+
+    struct QuatBinaryOp { const char *name; QuatBinary F; QuatBinaryF floatF; };
+    struct QuatUnaryOp  { const char *name; QuatUnary F;  QuatUnaryF floatF; };
+
+    const QuatBinaryOp quatBinaryOps[] = {
+        {"quatArrayBinaryOp.add",      &quatArrayAdd,      &quatArrayAdd},
+        {"quatArrayBinaryOp.subtract", &quatArraySubtract, &quatArraySubtract},
+        {"quatArrayBinaryOp.product",  &quatArrayProduct,  &quatArrayProduct}
+    };
+
+    for (const QuatBinaryOp &op : quatBinaryOps)
+    {
+        QuatBinary F = op.F;
+        QuatBinaryF floatF = op.floatF;
+
+        cases.push_back({
+            op.name, 12 * sizeof(double),
+            [](size_t n) { fillLanes(q1, n); fillLanes(q2, n); },
+            [F]() { F(q1, q2, qOut); return lanesChecksum(qOut); }
+        });
+
+        cases.push_back({
+            std::string(op.name) + ".float", 12 * sizeof(float),
+            [](size_t n) { fillLanes(f1, n); fillLanes(f2, n); },
+            [floatF]() { floatF(f1, f2, fOut); return lanesChecksum(fOut); }
+        });
+    }
+
+    cases.push_back({
+        "quatArrayBinaryOp.product.broadcast", 8 * sizeof(double),
+        [](size_t n) { fillLanes(q1, n); fillLanes(q2, 1); },
+        []() { quatArrayProduct(q1, q2, qOut); return lanesChecksum(qOut); }
+    });
+
+    const QuatUnaryOp quatUnaryOps[] = {
+        {"quatArrayUnaryOp.conjugate", &quatArrayConjugate, &quatArrayConjugate},
+        {"quatArrayUnaryOp.inverse",   &quatArrayInverse,   &quatArrayInverse},
+        {"quatArrayUnaryOp.negate",    &quatArrayNegate,    &quatArrayNegate},
+        {"quatArrayUnaryOp.normalize", &quatArrayNormalize, &quatArrayNormalize}
+    };
+
+    for (const QuatUnaryOp &op : quatUnaryOps)
+    {
+        QuatUnary F = op.F;
+        QuatUnaryF floatF = op.floatF;
+
+        cases.push_back({
+            op.name, 8 * sizeof(double),
+            [](size_t n) { fillLanes(q1, n); },
+            [F]() { F(q1, qOut); return lanesChecksum(qOut); }
+        });
+
+        cases.push_back({
+            std::string(op.name) + ".float", 8 * sizeof(float),
+            [](size_t n) { fillLanes(f1, n); },
+            [floatF]() { floatF(f1, fOut); return lanesChecksum(fOut); }
+        });
+    }
+
+    cases.push_back({
+        "matrixArrayOp.multiply", 3 * MATRIX_SIZE * sizeof(double),
+        [](size_t n) { fillMatrices(m1, n); fillMatrices(m2, n); mOut.resize(n * MATRIX_SIZE); },
+        []() { matrixArrayMultiply(m1.data(), m2.data(), mOut.data(), m1.size() / MATRIX_SIZE); return matricesChecksum(mOut); }
+    });
+
+    cases.push_back({
+        "matrixArrayOp.transpose", 2 * MATRIX_SIZE * sizeof(double),
+        [](size_t n) { fillMatrices(m1, n); mOut.resize(n * MATRIX_SIZE); },
+        []() { matrixArrayTranspose(m1.data(), mOut.data(), m1.size() / MATRIX_SIZE); return matricesChecksum(mOut); }
+    });
+
+    cases.push_back({
+        "matrixArrayOp.fastInverse", 2 * MATRIX_SIZE * sizeof(double),
+        [](size_t n) { fillMatrices(m1, n); mOut.resize(n * MATRIX_SIZE); },
+        []()
+        {
+            singular.clear();
+            matrixArrayFastInverse(m1.data(), mOut.data(), m1.size() / MATRIX_SIZE, singular);
+            return matricesChecksum(mOut);
+        }
+    });
+
+    // translate, euler rotate, scale and shear in; one matrix out.
+    cases.push_back({
+        "composeMatrixArray.euler", (12 + MATRIX_SIZE) * sizeof(double),
+        [](size_t n)
+        {
+            components.resize(n * 12);
+            std::generate(components.begin(), components.end(), randomValue);
+            mOut.resize(n * MATRIX_SIZE);
+        },
+        []()
+        {
+            // The arrays are thread_local, so the workers are handed this thread's pointers.
+            const double *input = components.data();
+            double *output = mOut.data();
+
+            parallelFor(0, components.size() / 12, [&](size_t i)
+            {
+                const double *c = input + i * 12;
+                double rotate[3][3];
+
+                eulerToRotation(c[3], c[4], c[5], ROTATE_ORDER_XYZ, rotate);
+                composeMatrix(c, rotate, c + 6, c + 9, output + i * MATRIX_SIZE);
+            });
+
+            return matricesChecksum(mOut);
+        }
+    });
+
+    // translate, quaternion, scale and shear in; one matrix out.
+    cases.push_back({
+        "composeMatrixArray.quat", (13 + MATRIX_SIZE) * sizeof(double),
+        [](size_t n)
+        {
+            components.resize(n * 13);
+            std::generate(components.begin(), components.end(), randomValue);
+            mOut.resize(n * MATRIX_SIZE);
+        },
+        []()
+        {
+            const double *input = components.data();
+            double *output = mOut.data();
+
+            parallelFor(0, components.size() / 13, [&](size_t i)
+            {
+                const double *c = input + i * 13;
+                double rotate[3][3];
+
+                quatToRotation(c[3], c[4], c[5], c[6], rotate);
+                composeMatrix(c, rotate, c + 7, c + 10, output + i * MATRIX_SIZE);
+            });
+
+            return matricesChecksum(mOut);
+        }
+    });
+
+    cases.push_back({
+        "decomposeMatrixArray", MATRIX_SIZE * sizeof(double) + sizeof(MatrixComponents),
+        [](size_t n) { fillMatrices(m1, n); components.resize(n * 3); },
+        []()
+        {
+            const double *input = m1.data();
+            double *output = components.data();
+
+            parallelFor(0, m1.size() / MATRIX_SIZE, [&](size_t i)
+            {
+                MatrixComponents c;
+                decomposeMatrix(input + i * MATRIX_SIZE, c);
+
+                output[i * 3 + 0] = c.translate[0];
+                output[i * 3 + 1] = c.rotate[0][0];
+                output[i * 3 + 2] = c.scale[0] + c.shear[0];
+            });
+
+            return components.empty() ? 0.0 : components[0] + components[components.size() - 1];
+        }
+    });
+
+    cases.push_back({
+        "vectorArrayBinaryOp.cross", 9 * sizeof(double),
+        [](size_t n) { fillVectors(v1, n); fillVectors(v2, n); vOut.resize(n); },
+        []()
+        {
+            vectorArrayCross(BroadcastView<Vector3>(v1, Vector3()), BroadcastView<Vector3>(v2, Vector3()), vOut.data(), vOut.size());
+            return vectorsChecksum(vOut);
+        }
+    });
+
+    cases.push_back({
+        "vectorArrayMatrixOp.pointMatrixProduct", (6 + MATRIX_SIZE) * sizeof(double),
+        [](size_t n) { fillVectors(v1, n); fillMatrices(m1, n); vOut.resize(n); },
+        []()
+        {
+            ArrayView<Matrix4> matrices(reinterpret_cast<const Matrix4*>(m1.data()), m1.size() / MATRIX_SIZE);
+            Matrix4 identity = {{{1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 0.0, 0.0}, {0.0, 0.0, 1.0, 0.0}, {0.0, 0.0, 0.0, 1.0}}};
+
+            pointArrayMatrixProduct(BroadcastView<Vector3>(v1, Vector3()), BroadcastView<Matrix4>(matrices, identity), vOut.data(), vOut.size());
+            return vectorsChecksum(vOut);
+        }
+    });
+
+    cases.push_back({
+        "lerpVectorArray.slerp", 9 * sizeof(double),
+        [](size_t n) { fillVectors(v1, n); fillVectors(v2, n); vOut.resize(n); },
+        []()
+        {
+            vectorArraySlerp(BroadcastView<Vector3>(v1, Vector3()), BroadcastView<Vector3>(v2, Vector3()), 0.3, vOut.data(), vOut.size());
+            return vectorsChecksum(vOut);
+        }
+    });
+
+    cases.push_back({
+        "slerpQuatArray", 12 * sizeof(double),
+        [](size_t n) { fillQuaternions(p1, n); fillQuaternions(p2, n); pOut.resize(n); },
+        []()
+        {
+            Quaternion identity = {0.0, 0.0, 0.0, 1.0};
+
+            quatArraySlerp(BroadcastView<Quaternion>(p1, identity), BroadcastView<Quaternion>(p2, identity), 0.3, 1, pOut.data(), pOut.size());
+            return pOut.empty() ? 0.0 : pOut[0].x + pOut[pOut.size() - 1].w;
+        }
+    });
+
+    // Only tween changed since the last compute, so the pairs are already prepared.
+    cases.push_back({
+        "slerpQuatArray.tween", 16 * sizeof(double),
+        [](size_t n) 
+        { 
+            Quaternion identity = {0.0, 0.0, 0.0, 1.0};
+
+            fillQuaternions(p1, n); 
+            fillQuaternions(p2, n); 
+            pOut.resize(n); 
+            pairs.resize(n);
+
+            quatArraySlerpPrepare(BroadcastView<Quaternion>(p1, identity), BroadcastView<Quaternion>(p2, identity), 1, pairs.data(), n);
+        },
+        []()
+        {
+            Quaternion identity = {0.0, 0.0, 0.0, 1.0};
+
+            quatArraySlerpPrepared(BroadcastView<Quaternion>(p1, identity), BroadcastView<Quaternion>(p2, identity), pairs.data(), 0.3, pOut.data(), pOut.size());
+            return pOut.empty() ? 0.0 : pOut[0].x + pOut[pOut.size() - 1].w;
+        }
+    });
+
+    // The same operations on the same values, stored as Quaternions (aos) and as lanes (soa).
+    auto fillLayouts = [](size_t n) 
+    { 
+        fillQuaternions(p1, n); 
+        fillQuaternions(p2, n); 
+        pOut.resize(n);
+        quaternionsToLanes(p1, q1);
+        quaternionsToLanes(p2, q2);
+    };
+
+    cases.push_back({
+        "quatLayout.product.aos", 12 * sizeof(double), fillLayouts,
+        []()
+        {
+            const Quaternion *a = p1.data(), *b = p2.data();
+            Quaternion *out = pOut.data();
+
+            parallelForRange(0, pOut.size(), DEFAULT_GRAIN_SIZE, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    Quaternion r = {
+                        (b[i].w * a[i].x) + (b[i].x * a[i].w) + (b[i].y * a[i].z) - (b[i].z * a[i].y),
+                        (b[i].w * a[i].y) - (b[i].x * a[i].z) + (b[i].y * a[i].w) + (b[i].z * a[i].x),
+                        (b[i].w * a[i].z) + (b[i].x * a[i].y) - (b[i].y * a[i].x) + (b[i].z * a[i].w),
+                        (b[i].w * a[i].w) - (b[i].x * a[i].x) - (b[i].y * a[i].y) - (b[i].z * a[i].z)
+                    };
+                    out[i] = r;
+                }
+            });
+
+            return pOut.empty() ? 0.0 : pOut[0].x + pOut[pOut.size() - 1].w;
+        }
+    });
+
+    cases.push_back({
+        "quatLayout.product.soa", 12 * sizeof(double), fillLayouts,
+        []() { quatArrayProduct(q1, q2, qOut); return qOut.empty() ? 0.0 : qOut.x[0] + qOut.w[qOut.size() - 1]; }
+    });
+
+    cases.push_back({
+        "quatLayout.normalize.aos", 8 * sizeof(double), fillLayouts,
+        []()
+        {
+            const Quaternion *a = p1.data();
+            Quaternion *out = pOut.data();
+
+            parallelForRange(0, pOut.size(), DEFAULT_GRAIN_SIZE, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    double norm = (a[i].x * a[i].x) + (a[i].y * a[i].y) + (a[i].z * a[i].z) + (a[i].w * a[i].w);
+                    double s = norm > 0.0 ? 1.0 / sqrt(norm) : 1.0;
+
+                    Quaternion r = {a[i].x * s, a[i].y * s, a[i].z * s, a[i].w * s};
+                    out[i] = r;
+                }
+            });
+
+            return pOut.empty() ? 0.0 : pOut[0].x + pOut[pOut.size() - 1].w;
+        }
+    });
+
+    cases.push_back({
+        "quatLayout.normalize.soa", 8 * sizeof(double), fillLayouts,
+        []() { quatArrayNormalize(q1, qOut); return qOut.empty() ? 0.0 : qOut.x[0] + qOut.w[qOut.size() - 1]; }
+    });
+
+    cases.push_back({
+        "quatLayout.slerp.aos", 12 * sizeof(double), fillLayouts,
+        []()
+        {
+            Quaternion identity = {0.0, 0.0, 0.0, 1.0};
+
+            quatArraySlerp(BroadcastView<Quaternion>(p1, identity), BroadcastView<Quaternion>(p2, identity), 0.3, 1, pOut.data(), pOut.size());
+            return pOut.empty() ? 0.0 : pOut[0].x + pOut[pOut.size() - 1].w;
+        }
+    });
+
+    cases.push_back({
+        "quatLayout.slerp.soa", 12 * sizeof(double), fillLayouts,
+        []() { lanesSlerp(q1, q2, 0.3, qOut); return qOut.empty() ? 0.0 : qOut.x[0] + qOut.w[qOut.size() - 1]; }
+    });
+
+    // The cost of hashing a quaternion array for the compute cache.
+    cases.push_back({
+        "computeCache.hash", 4 * sizeof(double),
+        [](size_t n) { fillQuaternions(p1, n); },
+        []()
+        {
+            ContentHash hash;
+            hash.update(p1.data(), p1.size() * sizeof(Quaternion));
+            return (double) (hash.digest() & 0xFF);
+        }
+    });
+
+    // Bytes are counted for the doubles only, not the text.
+    auto fillText = [](size_t n)
+    {
+        m1.resize(n);
+        for (size_t i = 0; i < n; i++) { m1[i] = randomValue() * 1000.0; }
+
+        char buffer[DOUBLE_TEXT_BUFFER_SIZE];
+        text.clear();
+        textOffsets.clear();
+
+        for (size_t i = 0; i < n; i++)
+        {
+            textOffsets.push_back(text.size());
+            text.insert(text.end(), buffer, buffer + formatDouble(m1[i], buffer) + 1);
+        }
+    };
+
+    cases.push_back({
+        "doubleText.format", sizeof(double), fillText,
+        []()
+        {
+            char buffer[DOUBLE_TEXT_BUFFER_SIZE];
+            size_t length = 0;
+
+            for (double value : m1) { length += formatDouble(value, buffer); }
+            return (double) length;
+        }
+    });
+
+    // How the ASCII format wrote each value before: %g with 15, 16, then 17 digits until one round trips.
+    cases.push_back({
+        "doubleText.format.snprintf", sizeof(double), fillText,
+        []()
+        {
+            char buffer[DOUBLE_TEXT_BUFFER_SIZE];
+            size_t length = 0;
+
+            for (double value : m1)
+            {
+                for (int precision = 15; precision <= 17; precision++)
+                {
+                    int written = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+                    if (precision == 17 || strtod(buffer, NULL) == value) { length += written; break; }
+                }
+            }
+
+            return (double) length;
+        }
+    });
+
+    cases.push_back({
+        "doubleText.parse", sizeof(double), fillText,
+        []()
+        {
+            double sum = 0.0, value = 0.0;
+
+            for (size_t offset : textOffsets)
+            {
+                if (parseDouble(text.data() + offset, value)) { sum += value; }
+            }
+
+            return sum;
+        }
+    });
+
+    // What MPxData::copy cost when the array data types held plain vectors.
+    cases.push_back({
+        "sharedBuffer.deepCopy", 8 * sizeof(double),
+        [](size_t n) { fillQuaternions(p1, n); },
+        []()
+        {
+            std::vector<Quaternion> copy(p1);
+            return copy.back().w;
+        }
+    });
+
+    // What MPxData::copy costs now; bytes are counted as for a deep copy.
+    cases.push_back({
+        "sharedBuffer.copy", 8 * sizeof(double),
+        [](size_t n) { fillQuaternions(p1, n); shared.set(std::vector<Quaternion>(p1)); },
+        []()
+        {
+            SharedBuffer<std::vector<Quaternion>> copy(shared);
+            return copy.get().back().w;
+        }
+    });
+
+    // A write to a shared copy pays for the deep copy after all.
+    cases.push_back({
+        "sharedBuffer.copyThenEdit", 8 * sizeof(double),
+        [](size_t n) { fillQuaternions(p1, n); shared.set(std::vector<Quaternion>(p1)); },
+        []()
+        {
+            SharedBuffer<std::vector<Quaternion>> copy(shared);
+            copy.edit()[0].w = 0.5;
+            return copy.get().back().w;
+        }
+    });
+
+    const std::pair<const char*, QuatEncoding> quatEncodings[] = {
+        {"quatCodec.lossless",      QUAT_ENCODING_LOSSLESS},
+        {"quatCodec.smallestThree", QUAT_ENCODING_SMALLEST_THREE}
+    };
+
+    // Bytes are counted as the unencoded quaternions read or written.
+    for (const auto &e : quatEncodings)
+    {
+        QuatEncoding encoding = e.second;
+
+        cases.push_back({
+            std::string(e.first) + ".encode", sizeof(Quaternion),
+            [](size_t n) { fillBakedQuaternions(p1, n); },
+            [encoding]()
+            {
+                encoded.clear();
+                encodeQuaternions(p1.data(), p1.size(), encoding, QUAT_ENCODING_DEFAULT_BITS, encoded);
+                return (double) encoded.size();
+            }
+        });
+
+        cases.push_back({
+            std::string(e.first) + ".decode", sizeof(Quaternion),
+            [encoding](size_t n)
+            {
+                fillBakedQuaternions(p1, n);
+                encoded.clear();
+                encodedAs = encodeQuaternions(p1.data(), n, encoding, QUAT_ENCODING_DEFAULT_BITS, encoded);
+                pOut.resize(n);
+            },
+            []()
+            {
+                decodeQuaternions(encoded.data(), encoded.size(), encodedAs, QUAT_ENCODING_DEFAULT_BITS, pOut.data(), pOut.size());
+                return pOut.back().w;
+            }
+        });
+    }
+
+    const char *rotateOrderNames[] = {"xyz", "yzx", "zxy", "xzy", "yxz", "zyx"};
+
+    for (int rotateOrder = ROTATE_ORDER_XYZ; rotateOrder <= ROTATE_ORDER_ZYX; rotateOrder++)
+    {
+        std::string name = std::string("quatToEulerArray.") + rotateOrderNames[rotateOrder];
+
+        cases.push_back({
+            name, sizeof(Quaternion) + sizeof(EulerRotation),
+            [](size_t n) { fillQuaternions(p1, n); eOut.resize(n); },
+            [rotateOrder]()
+            {
+                quatArrayToEuler(p1.data(), p1.size(), rotateOrder, eOut.data());
+                return eulersChecksum(eOut);
+            }
+        });
+
+        cases.push_back({
+            name + ".reorder", sizeof(Quaternion) + sizeof(EulerRotation),
+            [](size_t n) { fillQuaternions(p1, n); eOut.resize(n); },
+            [rotateOrder]()
+            {
+                // The workers have thread_local arrays of their own.
+                const std::vector<Quaternion> &q = p1;
+                std::vector<EulerRotation> &e = eOut;
+
+                parallelFor(0, q.size(), [&](size_t i) { e[i] = quatToEulerReordered(q[i], rotateOrder); });
+                return eulersChecksum(e);
+            }
+        });
+
+        cases.push_back({
+            std::string("eulerToQuatArray.") + rotateOrderNames[rotateOrder], sizeof(EulerRotation) + sizeof(Quaternion),
+            [rotateOrder](size_t n)
+            {
+                fillQuaternions(p1, n);
+                e1.resize(n);
+                quatArrayToEuler(p1.data(), n, rotateOrder, e1.data());
+                pOut.resize(n);
+            },
+            []()
+            {
+                eulerArrayToQuat(e1.data(), e1.size(), pOut.data());
+                return pOut.back().w;
+            }
+        });
+    }
+
+    // MAngle is not laid out for the core kernels, so the angle nodes still
+    // convert each MAngle. These cases do the same arithmetic on stand-ins.
+    cases.push_back({
+        "angleToDoubleArray", sizeof(BenchAngle) + sizeof(double),
+        [](size_t n) { fillAngles(a1, n); dOut.resize(n); },
+        []()
+        {
+            const BenchAngle *input = a1.data();
+            double *output = dOut.data();
+
+            parallelFor(0, dOut.size(), [&](size_t i) { output[i] = angleAs(input[i], 0); });
+            return dOut.empty() ? 0.0 : dOut[0] + dOut[dOut.size() - 1];
+        }
+    });
+
+    cases.push_back({
+        "doubleToAngleArray", sizeof(double) + sizeof(BenchAngle),
+        [](size_t n) { fillAngles(a1, n); m1.resize(n); for (size_t i = 0; i < n; i++) { m1[i] = a1[i].value; } aOut.resize(n); },
+        []()
+        {
+            const double *input = m1.data();
+            BenchAngle *output = aOut.data();
+
+            parallelFor(0, aOut.size(), [&](size_t i) { output[i].value = input[i]; output[i].unit = 1; });
+            return aOut.empty() ? 0.0 : aOut[0].value + aOut[aOut.size() - 1].value;
+        }
+    });
+
+    typedef void (*VectorUnary)(ArrayView<Vector3>, Vector3*);
+    typedef void (*VectorScalar)(ArrayView<Vector3>, BroadcastView<double>, Vector3*);
+    typedef void (*VectorToDouble)(BroadcastView<Vector3>, BroadcastView<Vector3>, double*, size_t);
+
+    const std::pair<const char*, VectorUnary> vectorUnaryOps[] = {
+        {"vectorArrayUnaryOp.normalize", &vectorArrayNormalize},
+        {"vectorArrayUnaryOp.negate",    &vectorArrayNegate}
+    };
+
+    for (const std::pair<const char*, VectorUnary> &op : vectorUnaryOps)
+    {
+        VectorUnary F = op.second;
+
+        cases.push_back({
+            op.first, 6 * sizeof(double),
+            [](size_t n) { fillVectors(v1, n); vOut.resize(n); },
+            [F]() { F(v1, vOut.data()); return vectorsChecksum(vOut); }
+        });
+    }
+
+    const std::pair<const char*, VectorScalar> vectorScalarOps[] = {
+        {"vectorArrayScalarOp.multiply", &vectorArrayMultiply},
+        {"vectorArrayScalarOp.divide",   &vectorArrayDivide}
+    };
+
+    for (const std::pair<const char*, VectorScalar> &op : vectorScalarOps)
+    {
+        VectorScalar F = op.second;
+
+        cases.push_back({
+            op.first, 7 * sizeof(double),
+            [](size_t n) { fillVectors(v1, n); m1.resize(n); std::generate(m1.begin(), m1.end(), []() { return 1.5 + randomValue(); }); vOut.resize(n); },
+            [F]() { F(v1, BroadcastView<double>(m1, 1.0), vOut.data()); return vectorsChecksum(vOut); }
+        });
+    }
+
+    const std::pair<const char*, VectorToDouble> vectorToDoubleOps[] = {
+        {"vectorArrayToDoubleOp.distance", &vectorArrayDistance},
+        {"vectorArrayToDoubleOp.dot",      &vectorArrayDot}
+    };
+
+    for (const std::pair<const char*, VectorToDouble> &op : vectorToDoubleOps)
+    {
+        VectorToDouble F = op.second;
+
+        cases.push_back({
+            op.first, 7 * sizeof(double),
+            [](size_t n) { fillVectors(v1, n); fillVectors(v2, n); dOut.resize(n); },
+            [F]() 
+            { 
+                F(BroadcastView<Vector3>(v1, Vector3()), BroadcastView<Vector3>(v2, Vector3()), dOut.data(), dOut.size()); 
+                return dOut.empty() ? 0.0 : dOut[0] + dOut[dOut.size() - 1]; 
+            }
+        });
+    }
+
+    cases.push_back({
+        "vectorArrayToDoubleOp.length", 4 * sizeof(double),
+        [](size_t n) { fillVectors(v1, n); dOut.resize(n); },
+        []()
+        {
+            vectorArrayLength(BroadcastView<Vector3>(v1, Vector3()), dOut.data(), dOut.size());
+            return dOut.empty() ? 0.0 : dOut[0] + dOut[dOut.size() - 1];
+        }
+    });
+
+    cases.push_back({
+        "rotateVectorArray.euler", 6 * sizeof(double) + sizeof(EulerRotation),
+        [](size_t n) { fillVectors(v1, n); fillQuaternions(p1, n); e1.resize(n); quatArrayToEuler(p1.data(), n, ROTATE_ORDER_XYZ, e1.data()); vOut.resize(n); },
+        []() { vectorArrayRotateByEuler(v1, e1, vOut.data()); return vectorsChecksum(vOut); }
+    });
+
+    cases.push_back({
+        "rotateVectorArray.quat", 10 * sizeof(double),
+        [](size_t n) { fillVectors(v1, n); fillQuaternions(p1, n); vOut.resize(n); },
+        []() { vectorArrayRotateByQuat(v1, p1, vOut.data()); return vectorsChecksum(vOut); }
+    });
+
+    cases.push_back({
+        "pointToVectorArray", 7 * sizeof(double),
+        [](size_t n) { fillPoints(points, n); vOut.resize(n); },
+        []() { pointArrayToVector(points, vOut.data()); return vectorsChecksum(vOut); }
+    });
+
+    cases.push_back({
+        "vectorToPointArray", 7 * sizeof(double),
+        [](size_t n) { fillVectors(v1, n); pointsOut.resize(n); },
+        []() 
+        { 
+            vectorArrayToPoint(v1, pointsOut.data()); 
+            return pointsOut.empty() ? 0.0 : pointsOut[0].x + pointsOut[pointsOut.size() - 1].w; 
+        }
+    });
+
+    // x, y and z arrays in; one vector array out.
+    cases.push_back({
+        "packVectorArray", 6 * sizeof(double),
+        [](size_t n)
+        {
+            components.resize(n * 3);
+            std::generate(components.begin(), components.end(), randomValue);
+            vOut.resize(n);
+        },
+        []()
+        {
+            size_t n = vOut.size();
+            Vector3 fillValue = {0.0, 0.0, 0.0};
+
+            packVectorArray(
+                ArrayView<double>(components.data(), n),
+                ArrayView<double>(components.data() + n, n),
+                ArrayView<double>(components.data() + 2 * n, n),
+                fillValue,
+                vOut.data(),
+                n
+            );
+
+            return vectorsChecksum(vOut);
+        }
+    });
+
+    // x, y, z and w arrays in; one quaternion array out.
+    cases.push_back({
+        "packQuatArray", 8 * sizeof(double),
+        [](size_t n)
+        {
+            components.resize(n * 4);
+            std::generate(components.begin(), components.end(), randomValue);
+            pOut.resize(n);
+        },
+        []()
+        {
+            size_t n = pOut.size();
+            Quaternion fillValue = {0.0, 0.0, 0.0, 1.0};
+
+            packQuatArray(
+                ArrayView<double>(components.data(), n),
+                ArrayView<double>(components.data() + n, n),
+                ArrayView<double>(components.data() + 2 * n, n),
+                ArrayView<double>(components.data() + 3 * n, n),
+                fillValue,
+                pOut.data(),
+                n
+            );
+
+            return pOut.empty() ? 0.0 : pOut[0].x + pOut[n - 1].w;
+        }
+    });
+
+    // Four row arrays in; one matrix array out.
+    cases.push_back({
+        "packMatrixArray", 2 * 12 * sizeof(double) + 4 * sizeof(double),
+        [](size_t n) { fillVectors(v1, n * 4); mOut.resize(n * MATRIX_SIZE); },
+        []()
+        {
+            size_t n = mOut.size() / MATRIX_SIZE;
+            Matrix4 identity = {{{1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 0.0, 0.0}, {0.0, 0.0, 1.0, 0.0}, {0.0, 0.0, 0.0, 1.0}}};
+
+            packMatrixArray(
+                ArrayView<Vector3>(v1.data(), n),
+                ArrayView<Vector3>(v1.data() + n, n),
+                ArrayView<Vector3>(v1.data() + 2 * n, n),
+                ArrayView<Vector3>(v1.data() + 3 * n, n),
+                identity,
+                reinterpret_cast<Matrix4*>(mOut.data()),
+                n
+            );
+
+            return matricesChecksum(mOut);
+        }
+    });
+
+    cases.push_back({
+        "unpackVectorArray", 6 * sizeof(double),
+        [](size_t n) { fillVectors(v1, n); components.resize(n * 3); },
+        []()
+        {
+            size_t n = v1.size();
+            double *c = components.data();
+
+            unpackVectorArray(v1, c, c + n, c + 2 * n);
+            return components.empty() ? 0.0 : components[0] + components[components.size() - 1];
+        }
+    });
+
+    cases.push_back({
+        "unpackQuatArray", 8 * sizeof(double),
+        [](size_t n) { fillQuaternions(p1, n); components.resize(n * 4); },
+        []()
+        {
+            size_t n = p1.size();
+            double *c = components.data();
+
+            unpackQuatArray(p1, c, c + n, c + 2 * n, c + 3 * n);
+            return components.empty() ? 0.0 : components[0] + components[components.size() - 1];
+        }
+    });
+
+    cases.push_back({
+        "unpackMatrixArray", 2 * 12 * sizeof(double) + 4 * sizeof(double),
+        [](size_t n) { fillMatrices(m1, n); vOut.resize(n * 4); },
+        []()
+        {
+            size_t n = m1.size() / MATRIX_SIZE;
+            Vector3 *rows = vOut.data();
+
+            unpackMatrixArray(ArrayView<Matrix4>(reinterpret_cast<const Matrix4*>(m1.data()), n), rows, rows + n, rows + 2 * n, rows + 3 * n);
+            return vectorsChecksum(vOut);
+        }
+    });
+
+    // packEulerArray and unpackEulerArray convert MAngles, so these also use stand-ins.
+    cases.push_back({
+        "packEulerArray", 3 * sizeof(BenchAngle) + sizeof(EulerRotation),
+        [](size_t n) { fillAngles(a1, n); fillAngles(a2, n); fillAngles(a3, n); eOut.resize(n); },
+        []()
+        {
+            const BenchAngle *x = a1.data(), *y = a2.data(), *z = a3.data();
+            EulerRotation *output = eOut.data();
+
+            parallelFor(0, eOut.size(), [&](size_t i)
+            {
+                EulerRotation r = {angleAs(x[i], 0), angleAs(y[i], 0), angleAs(z[i], 0), ROTATE_ORDER_XYZ};
+                output[i] = r;
+            });
+
+            return eulersChecksum(eOut);
+        }
+    });
+
+    cases.push_back({
+        "unpackEulerArray", sizeof(EulerRotation) + 3 * sizeof(BenchAngle),
+        [](size_t n) 
+        { 
+            fillQuaternions(p1, n); 
+            e1.resize(n); 
+            quatArrayToEuler(p1.data(), n, ROTATE_ORDER_XYZ, e1.data()); 
+            a1.resize(n); 
+            a2.resize(n); 
+            a3.resize(n); 
+        },
+        []()
+        {
+            const EulerRotation *input = e1.data();
+            BenchAngle *x = a1.data(), *y = a2.data(), *z = a3.data();
+
+            parallelFor(0, e1.size(), [&](size_t i)
+            {
+                x[i].value = input[i].x; x[i].unit = 0;
+                y[i].value = input[i].y; y[i].unit = 0;
+                z[i].value = input[i].z; z[i].unit = 0;
+            });
+
+            return a1.empty() ? 0.0 : a1[0].value + a3[a3.size() - 1].value;
+        }
+    });
+
+    return cases;
+}
+
+
+static BenchResult runCase(const BenchCase &benchCase, size_t elements, double minTime)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    benchCase.setup(elements);
+
+    BenchResult result;
+    result.name       = benchCase.name;
+    result.elements   = elements;
+    result.iterations = 0;
+    result.checksum   = benchCase.run();
+
+    // Small arrays are timed in batches, as one run is below the clock's resolution.
+    size_t batchSize = std::max((size_t) 1, BATCH_ELEMENTS / elements);
+
+    double elapsed = 0.0;
+    double best    = HUGE_VAL;
+
+    while (elapsed < minTime || result.iterations < 3 * batchSize)
+    {
+        Clock::time_point start = Clock::now();
+
+        for (size_t i = 0; i < batchSize; i++)
+        {
+            result.checksum += benchCase.run();
+        }
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        best = std::min(best, seconds / batchSize);
+        elapsed += seconds;
+        result.iterations += batchSize;
+    }
+
+    result.nsPerElement = best * 1e9 / elements;
+    result.gbPerSecond  = (double) (benchCase.bytesPerElement * elements) / best / 1e9;
+
+    return result;
+}
+
+
+/** 
+    Runs a case on threadCount threads at once and compares every run 
+    with the checksum of a single-threaded run. Returns the number of 
+    runs that did not match.
+*/
+static size_t runConcurrentCase(const BenchCase &benchCase, size_t elements, unsigned threadCount)
+{
+    seedRandom(1);
+    benchCase.setup(elements);
+
+    double expected = benchCase.run();
+    size_t rounds = std::max((size_t) 4, 4 * STRESS_ELEMENTS / elements);
+
+    std::atomic<size_t> mismatches(0);
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < threadCount; t++)
+    {
+        threads.push_back(std::thread([&]()
+        {
+            seedRandom(1);
+            benchCase.setup(elements);
+
+            for (size_t i = 0; i < rounds; i++)
+            {
+                if (benchCase.run() != expected)
+                {
+                    mismatches++;
+                }
+            }
+        }));
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    return mismatches;
+}
+
+
+/** Returns false, after printing why, if a write to one SharedBuffer is seen by a copy of it. */
+static bool checkCopyOnWrite()
+{
+    typedef SharedBuffer<std::vector<double>> Buffer;
+
+    const char *failure = nullptr;
+
+    Buffer original;
+    original.set(std::vector<double>(1000, 1.0));
+
+    Buffer edited(original);
+    edited.edit()[0] = 2.0;
+
+    Buffer replaced(original);
+    replaced.set(std::vector<double>(10, 3.0));
+
+    Buffer assigned(original);
+    assigned.assign(std::vector<double>(10, 4.0));
+
+    Buffer empty;
+    Buffer otherEmpty;
+    empty.edit().push_back(5.0);
+
+    const double *before = &original.get()[0];
+
+    if (original.get().size() != 1000 || original.get()[0] != 1.0)
+    {
+        failure = "a write to a copy changed the original";
+    } else if (edited.get()[0] != 2.0 || replaced.get()[0] != 3.0 || assigned.get()[0] != 4.0) {
+        failure = "a write to a copy was lost";
+    } else if (!otherEmpty.get().empty()) {
+        failure = "a write to an empty buffer changed another empty buffer";
+    } else if (original.useCount() != 1 || &original.edit()[0] != before) {
+        failure = "a buffer held once was copied by edit()";
+    }
+
+    if (failure != nullptr)
+    {
+        fprintf(stderr, "copy-on-write check failed: %s\n", failure);
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+    Checks, for every rotation order, that the euler kernels find the same
+    rotations as reordering XYZ angles does, and that converting them back
+    gives the quaternions they came from. Only rotations are compared here;
+    xformArrayCoreTests checks the angles themselves.
+*/
+static bool checkEulerOrders()
+{
+    const size_t numberOfItems = 10000;
+    const double tolerance = 1.0e-9;
+
+    std::vector<Quaternion> q, back;
+    std::vector<EulerRotation> e(numberOfItems);
+    back.resize(numberOfItems);
+
+    fillQuaternions(q, numberOfItems);
+
+    for (int rotateOrder = ROTATE_ORDER_XYZ; rotateOrder <= ROTATE_ORDER_ZYX; rotateOrder++)
+    {
+        quatArrayToEuler(q.data(), numberOfItems, rotateOrder, e.data());
+        eulerArrayToQuat(e.data(), numberOfItems, back.data());
+
+        for (size_t i = 0; i < numberOfItems; i++)
+        {
+            EulerRotation expected = quatToEulerReordered(q[i], rotateOrder);
+
+            double a[3][3], b[3][3], c[3][3];
+            eulerToRotation(e[i].x, e[i].y, e[i].z, rotateOrder, a);
+            eulerToRotation(expected.x, expected.y, expected.z, rotateOrder, b);
+            quatToRotation(back[i].x, back[i].y, back[i].z, back[i].w, c);
+
+            double error = 0.0;
+
+            for (int j = 0; j < 3; j++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    error = std::max(error, std::max(fabs(a[j][k] - b[j][k]), fabs(a[j][k] - c[j][k])));
+                }
+            }
+
+            if (error > tolerance || e[i].order != rotateOrder)
+            {
+                fprintf(stderr, "euler order check failed: order %d, element %zu is off by %g\n", rotateOrder, i, error);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static const char* simdName()
+{
+    switch (simdISA())
+    {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE2: return "sse2";
+        default:        return "scalar";
+    }
+}
+
+
+/**
+    Prints the largest and RMS difference between double- and single-precision
+    results, absolute and relative to the length of each expected quaternion.
+*/
+template <typename REAL>
+static void printPrecisionError(const char *name, const QuatLanes &expected, const BasicQuatLanes<REAL> &actual)
+{
+    double maxError = 0.0;
+    double sumSquares = 0.0;
+    double maxRelative = 0.0;
+    double sumRelativeSquares = 0.0;
+
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        const double errors[4] = {
+            expected.x[i] - (double) actual.x[i],
+            expected.y[i] - (double) actual.y[i],
+            expected.z[i] - (double) actual.z[i],
+            expected.w[i] - (double) actual.w[i]
+        };
+
+        double length = sqrt(
+            expected.x[i] * expected.x[i] + 
+            expected.y[i] * expected.y[i] + 
+            expected.z[i] * expected.z[i] + 
+            expected.w[i] * expected.w[i]
+        );
+
+        for (double e : errors)
+        {
+            maxError = std::max(maxError, fabs(e));
+            sumSquares += e * e;
+
+            double relative = length > 0.0 ? e / length : 0.0;
+            maxRelative = std::max(maxRelative, fabs(relative));
+            sumRelativeSquares += relative * relative;
+        }
+    }
+
+    double count = (double) (expected.size() * 4);
+    double rms = expected.empty() ? 0.0 : sqrt(sumSquares / count);
+    double rmsRelative = expected.empty() ? 0.0 : sqrt(sumRelativeSquares / count);
+
+    printf("%-40s %12.3e %12.3e %12.3e %12.3e\n", name, maxError, rms, maxRelative, rmsRelative);
+}
+
+
+/**
+    Runs every quaternion kernel in both precisions and reports how far the
+    single-precision results are from the double-precision ones. The inputs
+    are doubles, rounded to floats once, as a quatArray set by a double-
+    precision node is when a single-precision node reads it. The first row
+    is the error of that rounding alone.
+*/
+static void reportPrecision(const BenchOptions &options)
+{
+    typedef void (*QuatBinary)(const QuatLanes&, const QuatLanes&, QuatLanes&);
+    typedef void (*QuatUnary)(const QuatLanes&, QuatLanes&);
+    typedef void (*QuatBinaryF)(const QuatLanesF&, const QuatLanesF&, QuatLanesF&);
+    typedef void (*QuatUnaryF)(const QuatLanesF&, QuatLanesF&);
+
+    struct QuatBinaryOp { const char *name; QuatBinary F; QuatBinaryF floatF; };
+    struct QuatUnaryOp  { const char *name; QuatUnary F;  QuatUnaryF floatF; };
+
+    const QuatBinaryOp binaryOps[] = {
+        {"quatArrayBinaryOp.add",      &quatArrayAdd,      &quatArrayAdd},
+        {"quatArrayBinaryOp.subtract", &quatArraySubtract, &quatArraySubtract},
+        {"quatArrayBinaryOp.product",  &quatArrayProduct,  &quatArrayProduct}
+    };
+
+    const QuatUnaryOp unaryOps[] = {
+        {"quatArrayUnaryOp.conjugate", &quatArrayConjugate, &quatArrayConjugate},
+        {"quatArrayUnaryOp.inverse",   &quatArrayInverse,   &quatArrayInverse},
+        {"quatArrayUnaryOp.negate",    &quatArrayNegate,    &quatArrayNegate},
+        {"quatArrayUnaryOp.normalize", &quatArrayNormalize, &quatArrayNormalize}
+    };
+
+    QuatLanesF f1, f2, fOut;
+    QuatLanes  q1, q2, qOut;
+
+    fillLanes(q1, BATCH_ELEMENTS);
+    fillLanes(q2, BATCH_ELEMENTS);
+    convertQuatLanes(q1, f1);
+    convertQuatLanes(q2, f2);
+
+    printf("simd: %s, elements: %zu\n\n", simdName(), BATCH_ELEMENTS);
+    printf("%-40s %12s %12s %12s %12s\n", "case", "max error", "rms error", "max relative", "rms relative");
+
+    printPrecisionError("input", q1, f1);
+
+    for (const QuatBinaryOp &op : binaryOps)
+    {
+        if (std::string(op.name).find(options.filter) != std::string::npos)
+        {
+            op.F(q1, q2, qOut);
+            op.floatF(f1, f2, fOut);
+            printPrecisionError(op.name, qOut, fOut);
+        }
+    }
+
+    for (const QuatUnaryOp &op : unaryOps)
+    {
+        if (std::string(op.name).find(options.filter) != std::string::npos)
+        {
+            op.F(q1, qOut);
+            op.floatF(f1, fOut);
+            printPrecisionError(op.name, qOut, fOut);
+        }
+    }
+
+    stopParallelWorkers();
+}
+
+
+/** 
+    Encodes and decodes a few kinds of quaternion arrays with each encoding,
+    and prints the bytes per quaternion and the largest error of the round 
+    trip. Returns false if a lossless round trip changed any value.
+*/
+static bool reportEncoding()
+{
+    struct Input { const char *name; void (*fill)(std::vector<Quaternion>&, size_t); };
+    struct Encoding { const char *name; QuatEncoding encoding; unsigned bits; };
+
+    const Input inputs[] = {
+        {"random", &fillQuaternions},
+        {"baked",  &fillBakedQuaternions},
+        {"scaled", [](std::vector<Quaternion> &q, size_t n) { fillBakedQuaternions(q, n); for (Quaternion &e : q) { e.w *= 2.0; } }}
+    };
+
+    const Encoding encodings[] = {
+        {"raw",             QUAT_ENCODING_RAW,            0},
+        {"lossless",        QUAT_ENCODING_LOSSLESS,       0},
+        {"smallestThree8",  QUAT_ENCODING_SMALLEST_THREE, 8},
+        {"smallestThree12", QUAT_ENCODING_SMALLEST_THREE, 12},
+        {"smallestThree16", QUAT_ENCODING_SMALLEST_THREE, 16},
+        {"smallestThree20", QUAT_ENCODING_SMALLEST_THREE, 20}
+    };
+
+    const char *encodingNames[] = {"raw", "lossless", "smallestThree"};
+
+    bool isLossless = true;
+    std::vector<Quaternion> values, decoded;
+    std::vector<uint8_t> bytes;
+
+    printf("elements: %zu\n\n", BATCH_ELEMENTS);
+    printf("%-8s %-16s %-14s %12s %10s %14s\n", "input", "encoding", "written as", "bytes/quat", "ratio", "max error");
+
+    for (const Input &input : inputs)
+    {
+        input.fill(values, BATCH_ELEMENTS);
+
+        for (const Encoding &e : encodings)
+        {
+            bytes.clear();
+            QuatEncoding writtenAs = encodeQuaternions(values.data(), values.size(), e.encoding, e.bits, bytes);
+
+            decoded.resize(values.size());
+            bool isDecoded = decodeQuaternions(bytes.data(), bytes.size(), writtenAs, e.bits, decoded.data(), decoded.size());
+
+            double maxError = 0.0;
+
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                maxError = std::max(maxError, fabs(values[i].x - decoded[i].x));
+                maxError = std::max(maxError, fabs(values[i].y - decoded[i].y));
+                maxError = std::max(maxError, fabs(values[i].z - decoded[i].z));
+                maxError = std::max(maxError, fabs(values[i].w - decoded[i].w));
+            }
+
+            if (!isDecoded || (writtenAs != QUAT_ENCODING_SMALLEST_THREE && memcmp(values.data(), decoded.data(), values.size() * sizeof(Quaternion)) != 0))
+            {
+                fprintf(stderr, "%s %s: the round trip changed the values\n", input.name, e.name);
+                isLossless = false;
+            }
+
+            double bytesPerQuat = (double) bytes.size() / (double) values.size();
+
+            printf(
+                "%-8s %-16s %-14s %12.2f %9.2fx %14.3e\n", 
+                input.name, e.name, encodingNames[writtenAs], 
+                bytesPerQuat, (double) sizeof(Quaternion) / bytesPerQuat, maxError
+            );
+        }
+    }
+
+    return isLossless;
+}
+
+
+static std::string temporaryDirectory()
+{
+#if defined(_WIN32)
+    const char *directory = getenv("TEMP");
+    return directory != NULL ? std::string(directory) : std::string(".");
+#else
+    const char *directory = getenv("TMPDIR");
+    return directory != NULL ? std::string(directory) : std::string("/tmp");
+#endif
+}
+
+
+/**
+    Writes quaternion arrays of increasing size to sidecar files and prints
+    the time to write, rewrite and open each file, and to copy the values
+    out of the mapping the first time they are used. Opening should take
+    the same time for any size. The inline column is the time to read the 
+    same values from an ordinary file, as a scene stores them without a 
+    sidecar. Returns false if a sidecar file did not hold the values.
+*/
+static bool reportSidecar()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const size_t sizes[] = {1000, 100000, 1000000, 10000000};
+
+    std::string directory = temporaryDirectory();
+    setSidecarDirectory(directory);
+
+    auto milliseconds = [](Clock::time_point start) { 
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); 
+    };
+
+    bool isValid = true;
+    std::vector<Quaternion> values, loaded;
+
+    printf("directory: %s\n\n", directory.c_str());
+    printf("%10s %12s %12s %12s %14s %12s\n", "elements", "write ms", "rewrite ms", "open ms", "first use ms", "inline ms");
+
+    for (size_t numberOfItems : sizes)
+    {
+        fillQuaternions(values, numberOfItems);
+        const double *data = &values[0].x;
+
+        Clock::time_point start = Clock::now();
+        std::shared_ptr<const SidecarFile> written = SidecarFile::write(data, 4, numberOfItems);
+        double writeTime = milliseconds(start);
+
+        if (!written)
+        {
+            fprintf(stderr, "could not write a sidecar file to %s\n", directory.c_str());
+            return false;
+        }
+
+        std::string path = written->path();
+
+        // The file for these values is already there, so it is hashed and compared but not written.
+        start = Clock::now();
+        written = SidecarFile::write(data, 4, numberOfItems);
+        double rewriteTime = milliseconds(start);
+        written.reset();
+
+        start = Clock::now();
+        std::shared_ptr<const SidecarFile> file = SidecarFile::open(path, 4, numberOfItems);
+        double openTime = milliseconds(start);
+
+        // Both reads fill a new vector, as reading a scene does.
+        std::vector<Quaternion>().swap(loaded);
+        start = Clock::now();
+
+        if (file)
+        {
+            const Quaternion *mapped = reinterpret_cast<const Quaternion*>(file->values());
+            loaded.assign(mapped, mapped + numberOfItems);
+        }
+
+        double firstUseTime = milliseconds(start);
+
+        if (!file || memcmp(loaded.data(), values.data(), numberOfItems * sizeof(Quaternion)) != 0)
+        {
+            fprintf(stderr, "%zu: the sidecar file did not hold the values\n", numberOfItems);
+            isValid = false;
+        }
+
+        file.reset();
+
+        std::string inlinePath = path + ".inline";
+
+        {
+            std::ofstream out(inlinePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write((const char*) data, numberOfItems * sizeof(Quaternion));
+        }
+
+        std::vector<Quaternion>().swap(loaded);
+        start = Clock::now();
+
+        {
+            std::ifstream in(inlinePath.c_str(), std::ios::in | std::ios::binary);
+            loaded.resize(numberOfItems);
+            in.read((char*) loaded.data(), numberOfItems * sizeof(Quaternion));
+        }
+
+        double inlineTime = milliseconds(start);
+
+        remove(inlinePath.c_str());
+        remove(path.c_str());
+
+        printf("%10zu %12.3f %12.3f %12.4f %14.3f %12.3f\n", numberOfItems, writeTime, rewriteTime, openTime, firstUseTime, inlineTime);
+    }
+
+    setSidecarDirectory(std::string());
+
+    return isValid;
+}
+
+
+/** The block size of the data types' binary read and write, from arrayData.h. */
+static const size_t BINARY_BLOCK_SIZE = 4096;
+
+/**
+    Writes and reads 1M angles the way angleArray's binary format does, 
+    through a string stream so that the disk is not timed, and prints the 
+    throughput of each. The per-value columns read and write one double 
+    per stream call, and go through an intermediate vector, as the data 
+    types did before; the block columns convert through a fixed buffer 
+    and make one stream call per BINARY_BLOCK_SIZE values, as they do now.
+    Returns false if either read did not give back the values written.
+*/
+static bool reportBinary()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const size_t numberOfItems = 1000000;
+    const double megabytes = (double) (numberOfItems * sizeof(double)) / 1.0e6;
+    const int repeats = 5;
+
+    std::vector<BenchAngle> angles(numberOfItems);
+
+    for (size_t i = 0; i < numberOfItems; i++)
+    {
+        angles[i].value = randomValue() * PI;
+        angles[i].unit = 1;
+    }
+
+    auto perValueWrite = [&](std::ostream &out) {
+        std::vector<double> values(numberOfItems);
+
+        for (size_t i = 0; i < numberOfItems; i++) { values[i] = angles[i].value; }
+
+        for (size_t i = 0; i < numberOfItems; i++)
+        {
+            out.write((const char*) &values[i], sizeof(double));
+            if (out.fail()) { break; }
+        }
+    };
+
+    auto blockWrite = [&](std::ostream &out) {
+        double buffer[BINARY_BLOCK_SIZE];
+
+        for (size_t i = 0; i < numberOfItems && !out.fail(); i += BINARY_BLOCK_SIZE)
+        {
+            size_t numberOfBlockItems = std::min(BINARY_BLOCK_SIZE, numberOfItems - i);
+
+            for (size_t j = 0; j < numberOfBlockItems; j++) { buffer[j] = angles[i+j].value; }
+
+            out.write((const char*) buffer, numberOfBlockItems * sizeof(double));
+        }
+    };
+
+    auto perValueRead = [&](std::istream &in, std::vector<BenchAngle> &result) {
+        std::vector<double> values(numberOfItems);
+
+        for (size_t i = 0; i < numberOfItems; i++)
+        {
+            in.read((char*) &values[i], sizeof(double));
+            if (in.fail()) { break; }
+        }
+
+        result.resize(numberOfItems);
+        for (size_t i = 0; i < numberOfItems; i++) { result[i].value = values[i]; result[i].unit = 1; }
+    };
+
+    auto blockRead = [&](std::istream &in, std::vector<BenchAngle> &result) {
+        double buffer[BINARY_BLOCK_SIZE];
+        result.resize(numberOfItems);
+
+        for (size_t i = 0; i < numberOfItems && !in.fail(); i += BINARY_BLOCK_SIZE)
+        {
+            size_t numberOfBlockItems = std::min(BINARY_BLOCK_SIZE, numberOfItems - i);
+            in.read((char*) buffer, numberOfBlockItems * sizeof(double));
+
+            for (size_t j = 0; j < numberOfBlockItems; j++) { result[i+j].value = buffer[j]; result[i+j].unit = 1; }
+        }
+    };
+
+    auto sameValues = [&](const std::vector<BenchAngle> &result) {
+        if (result.size() != numberOfItems) { return false; }
+
+        for (size_t i = 0; i < numberOfItems; i++)
+        {
+            if (result[i].value != angles[i].value) { return false; }
+        }
+
+        return true;
+    };
+
+    // Each column is the best of a few runs, so that one slow allocation does not decide it.
+    double bestTimes[4] = {1.0e30, 1.0e30, 1.0e30, 1.0e30};
+    bool isValid = true;
+
+    for (int r = 0; r < repeats; r++)
+    {
+        std::vector<BenchAngle> result;
+
+        for (int style = 0; style < 2; style++)
+        {
+            std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+
+            Clock::time_point start = Clock::now();
+            if (style == 0) { perValueWrite(stream); } else { blockWrite(stream); }
+            double writeTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::vector<BenchAngle>().swap(result);
+            stream.seekg(0);
+
+            start = Clock::now();
+            if (style == 0) { perValueRead(stream, result); } else { blockRead(stream, result); }
+            double readTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+            bestTimes[style * 2]     = std::min(bestTimes[style * 2], writeTime);
+            bestTimes[style * 2 + 1] = std::min(bestTimes[style * 2 + 1], readTime);
+
+            if (stream.fail() || !sameValues(result))
+            {
+                fprintf(stderr, "%s binary read did not give back the values written\n", style == 0 ? "per-value" : "block");
+                isValid = false;
+            }
+        }
+    }
+
+    printf("%10s %16s %16s %16s %16s\n", "elements", "write MB/s", "block write MB/s", "read MB/s", "block read MB/s");
+    printf("%10zu %16.1f %16.1f %16.1f %16.1f\n", numberOfItems, 
+        megabytes / bestTimes[0], megabytes / bestTimes[2], 
+        megabytes / bestTimes[1], megabytes / bestTimes[3]);
+
+    return isValid;
+}
+
+
+static bool writeJson(const std::string &path, const std::vector<BenchResult> &results)
+{
+    FILE *file = fopen(path.c_str(), "w");
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"benchmark\": \"xformArrayBench\",\n");
+    fprintf(file, "  \"simd\": \"%s\",\n", simdName());
+    fprintf(file, "  \"threads\": %u,\n", parallelThreadLimit());
+    fprintf(file, "  \"results\": [\n");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+
+        fprintf(
+            file,
+            "    {\"name\": \"%s\", \"elements\": %zu, \"iterations\": %zu, \"nsPerElement\": %.4f, \"gbPerSecond\": %.4f}%s\n",
+            r.name.c_str(), r.elements, r.iterations, r.nsPerElement, r.gbPerSecond,
+            i + 1 < results.size() ? "," : ""
+        );
+    }
+
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+
+    return true;
+}
+
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            options.jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            options.minTime = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--concurrent") == 0 && hasValue) {
+            options.concurrent = (unsigned) std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--precision") == 0) {
+            options.precision = true;
+        } else if (strcmp(argv[i], "--encoding") == 0) {
+            options.encoding = true;
+        } else if (strcmp(argv[i], "--sidecar") == 0) {
+            options.sidecar = true;
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            options.binary = true;
+        } else {
+            fprintf(stderr, "usage: %s [--json <path>] [--filter <text>] [--min-time <seconds>] [--concurrent <threads>] [--precision] [--encoding] [--sidecar] [--binary]\n", argv[0]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static int runConcurrent(const BenchOptions &options)
+{
+    size_t failures = 0;
+
+    printf("simd: %s, threads: %u, concurrent: %u\n\n", simdName(), parallelThreadLimit(), options.concurrent);
+    printf("%-40s %10s %12s\n", "case", "elements", "mismatches");
+
+    for (const BenchCase &benchCase : benchCases())
+    {
+        if (benchCase.name.find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        for (size_t elements : ELEMENT_COUNTS)
+        {
+            if (elements > STRESS_ELEMENTS)
+            {
+                continue;
+            }
+
+            size_t mismatches = runConcurrentCase(benchCase, elements, options.concurrent);
+            printf("%-40s %10zu %12zu\n", benchCase.name.c_str(), elements, mismatches);
+
+            failures += mismatches;
+        }
+    }
+
+    stopParallelWorkers();
+
+    printf("\n%s\n", failures == 0 ? "ok" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
+
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        return 2;
+    }
+
+    seedRandom(1);
+
+    if (!checkCopyOnWrite() || !checkEulerOrders())
+    {
+        return 1;
+    }
+
+    if (options.concurrent > 0)
+    {
+        return runConcurrent(options);
+    }
+
+    if (options.precision)
+    {
+        reportPrecision(options);
+        return 0;
+    }
+
+    if (options.encoding)
+    {
+        return reportEncoding() ? 0 : 1;
+    }
+
+    if (options.sidecar)
+    {
+        return reportSidecar() ? 0 : 1;
+    }
+
+    if (options.binary)
+    {
+        return reportBinary() ? 0 : 1;
+    }
+
+    std::vector<BenchResult> results;
+    double checksum = 0.0;
+
+    printf("simd: %s, threads: %u\n\n", simdName(), parallelThreadLimit());
+    printf("%-40s %10s %12s %10s\n", "case", "elements", "ns/element", "GB/s");
+
+    for (const BenchCase &benchCase : benchCases())
+    {
+        if (benchCase.name.find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        for (size_t elements : ELEMENT_COUNTS)
+        {
+            BenchResult result = runCase(benchCase, elements, options.minTime);
+            printf("%-40s %10zu %12.3f %10.3f\n", result.name.c_str(), result.elements, result.nsPerElement, result.gbPerSecond);
+
+            checksum += result.checksum;
+            results.push_back(result);
+        }
+    }
+
+    // Printing the checksum keeps the compiler from discarding any results.
+    printf("\nchecksum: %g\n", checksum);
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, results))
+    {
+        fprintf(stderr, "Could not write %s\n", options.jsonPath.c_str());
+        return 1;
+    }
+
+    stopParallelWorkers();
+
+    return 0;
+}
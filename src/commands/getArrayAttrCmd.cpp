@@ -6,6 +6,10 @@
 /**
 getArrayAttr command
 This command returns the values of attributes with non-numeric array data.
+
+With -footprint, it instead returns the number of bytes held by an angleArray,
+eulerArray or quatArray value. Buffers shared with other copies of the value
+are divided among the copies that share them.
  */
 
 #include "getArrayAttrCmd.h"
@@ -47,6 +51,9 @@ This command returns the values of attributes with non-numeric array data.
 #include <maya/MTypeId.h>
 #include <maya/MVector.h>
 
+const char* FOOTPRINT_FLAG      = "-fp";
+const char* FOOTPRINT_LONG_FLAG = "-footprint";
+
 GetArrayAttrCmd::GetArrayAttrCmd()  {}
 GetArrayAttrCmd::~GetArrayAttrCmd() {}
 
@@ -60,6 +67,7 @@ MSyntax GetArrayAttrCmd::getSyntax()
     MSyntax syntax;
 
     syntax.setObjectType(MSyntax::MObjectFormat::kStringObjects);
+    syntax.addFlag(FOOTPRINT_FLAG, FOOTPRINT_LONG_FLAG);
 
     return syntax;
 }
@@ -75,6 +83,8 @@ MStatus GetArrayAttrCmd::doIt(const MArgList& argList)
     status = argData.getObjects(objectNames);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    this->isFootprintRequested = argData.isFlagSet(FOOTPRINT_FLAG);
+
     unsigned numberOfObjects = objectNames.length();
 
     if (numberOfObjects == 1)
@@ -139,11 +149,16 @@ MStatus GetArrayAttrCmd::redoIt()
         MFnPluginData fnData(data);
         MPxData *pluginDataPtr = fnData.data();
 
+        if (this->isFootprintRequested)
+        {
+            return this->setFootprintResult(typeId, pluginDataPtr);
+        }
+
         if (typeId == AngleArrayData::TYPE_ID)
         {
             MAngle::Unit unit = MAngle::uiUnit();
             AngleArrayData* pluginData = (AngleArrayData*) pluginDataPtr;
-            std::vector<MAngle> values = (*pluginData).getArray();
+            const std::vector<MAngle> &values = pluginData->array();
             result.setLength((unsigned) values.size());
 
             for (unsigned i = 0; i < values.size(); i++)
@@ -153,24 +168,24 @@ MStatus GetArrayAttrCmd::redoIt()
         } else if (typeId == EulerArrayData::TYPE_ID) {
             MAngle::Unit unit = MAngle::uiUnit();
             EulerArrayData* pluginData = (EulerArrayData*) pluginDataPtr;
-            std::vector<MEulerRotation> values = (*pluginData).getArray();
+            const std::vector<MEulerRotation> &values = pluginData->array();
             result.setLength((unsigned) values.size() * 3);
 
             for (unsigned i = 0; i < values.size(); i++)
             {                   
-                MEulerRotation &r = values[i];
+                const MEulerRotation &r = values[i];
                 result[(i*3)+0] = MAngle(r.x).as(unit);
                 result[(i*3)+1] = MAngle(r.y).as(unit);
                 result[(i*3)+2] = MAngle(r.z).as(unit);
             }
         } else if (typeId == QuatArrayData::TYPE_ID) {
             QuatArrayData* pluginData = (QuatArrayData*) pluginDataPtr;
-            std::vector<MQuaternion> values = (*pluginData).getArray();
+            const std::vector<MQuaternion> &values = pluginData->array();
             result.setLength((unsigned) values.size() * 4);
 
             for (unsigned i = 0; i < values.size(); i++)
             {   
-                MQuaternion &q = values[i];
+                const MQuaternion &q = values[i];
                 result[(i*4)+0] = q.x;
                 result[(i*4)+1] = q.y;
                 result[(i*4)+2] = q.z;
@@ -179,6 +194,8 @@ MStatus GetArrayAttrCmd::redoIt()
         } else {
             status = MStatus::kUnknownParameter;
         }
+    } else if (this->isFootprintRequested) {
+        status = MStatus::kUnknownParameter;
     } else {        
         if (type == MFn::Type::kDoubleArrayData)
         {
@@ -264,3 +281,26 @@ void  GetArrayAttrCmd::warnEmptyArray()
     msg.format(msg, this->requestedAttribute.name());
     MGlobal::displayWarning(msg);
 }
+
+
+MStatus GetArrayAttrCmd::setFootprintResult(const MTypeId &typeId, MPxData *data)
+{
+    size_t footprint = 0;
+
+    if (typeId == AngleArrayData::TYPE_ID)
+    {
+        footprint = ((AngleArrayData*) data)->footprint();
+    } else if (typeId == EulerArrayData::TYPE_ID) {
+        footprint = ((EulerArrayData*) data)->footprint();
+    } else if (typeId == QuatArrayData::TYPE_ID) {
+        footprint = ((QuatArrayData*) data)->footprint();
+    } else {
+        MGlobal::displayError("The -footprint flag requires an angleArray, eulerArray or quatArray attribute.");
+        return MStatus::kFailure;
+    }
+
+    // Returned as a double, as footprints may not fit in an int.
+    this->setResult((double) footprint);
+
+    return MStatus::kSuccess;
+}
\ No newline at end of file
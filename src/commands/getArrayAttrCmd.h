@@ -8,10 +8,12 @@
 #include <maya/MArgList.h>
 #include <maya/MArgDatabase.h>
 #include <maya/MPlug.h>
+#include <maya/MPxData.h>
 #include <maya/MPxCommand.h>
 #include <maya/MString.h>
 #include <maya/MStatus.h>
 #include <maya/MSyntax.h>
+#include <maya/MTypeId.h>
 
 class GetArrayAttrCmd : public MPxCommand
 {
@@ -30,10 +32,12 @@ public:
     
 private:
     void                warnEmptyArray();
+    MStatus             setFootprintResult(const MTypeId &typeId, MPxData *data);
         
 public:
     static MString      COMMAND_NAME;
 
 private:
     MPlug               requestedAttribute;
+    bool                isFootprintRequested = false;
 };
\ No newline at end of file
@@ -0,0 +1,292 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+xformArrayOptions command
+This command sets or queries plugin-wide evaluation options. 
+
+    -threads (-t) int
+        Maximum number of threads used by a single node, including the 
+        thread that evaluates it. 0 uses every hardware thread, 1 disables
+        threading. Lower this when Maya's parallel evaluation is already
+        running many array nodes at once.
+
+    -serialCutoff (-sc) int
+        Arrays with fewer elements than this are computed on a single thread.
+
+    -computeCache (-cc) bool
+        When on, nodes hash their inputs and keep their last output if the
+        inputs are the same as last time. Off by default.
+
+    -cacheHits (-ch)
+        Query only. Number of computes skipped by the compute cache.
+
+    -cacheMisses (-cm)
+        Query only. Number of computes the compute cache could not skip.
+
+    -resetCacheCounters (-rcc)
+        Sets the hit and miss counts back to 0.
+
+    -quatEncoding (-qe) string
+        Encoding of quatArray values written to binary files: "raw", 
+        "lossless" or "smallestThree". Raw by default. Files written with 
+        any encoding can be read whatever this is set to.
+
+    -quatEncodingBits (-qeb) int
+        Bits per component used by the "smallestThree" encoding, from 4 to 
+        24. 16 by default.
+
+    -sidecarDirectory (-sd) string
+        Directory that large angleArray, eulerArray and quatArray values are
+        written to, instead of the scene file. An empty string, the default,
+        keeps all values in the scene.
+
+    -sidecarThreshold (-st) int
+        Arrays with at least this many elements are written to the sidecar
+        directory. 100000 by default.
+ */
+
+#include "xformArrayOptionsCmd.h"
+
+#include "../core/computeCache.h"
+#include "../core/parallel.h"
+#include "../core/quatCodec.h"
+#include "../core/sidecarFile.h"
+
+#include <maya/MArgList.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MGlobal.h>
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+const char* THREADS_FLAG            = "-t";
+const char* THREADS_LONG_FLAG       = "-threads";
+const char* SERIAL_CUTOFF_FLAG      = "-sc";
+const char* SERIAL_CUTOFF_LONG_FLAG = "-serialCutoff";
+const char* COMPUTE_CACHE_FLAG      = "-cc";
+const char* COMPUTE_CACHE_LONG_FLAG = "-computeCache";
+const char* CACHE_HITS_FLAG         = "-ch";
+const char* CACHE_HITS_LONG_FLAG    = "-cacheHits";
+const char* CACHE_MISSES_FLAG       = "-cm";
+const char* CACHE_MISSES_LONG_FLAG  = "-cacheMisses";
+const char* RESET_CACHE_FLAG        = "-rcc";
+const char* RESET_CACHE_LONG_FLAG   = "-resetCacheCounters";
+const char* QUAT_ENCODING_FLAG      = "-qe";
+const char* QUAT_ENCODING_LONG_FLAG = "-quatEncoding";
+const char* QUAT_BITS_FLAG          = "-qeb";
+const char* QUAT_BITS_LONG_FLAG     = "-quatEncodingBits";
+const char* SIDECAR_DIR_FLAG        = "-sd";
+const char* SIDECAR_DIR_LONG_FLAG   = "-sidecarDirectory";
+const char* SIDECAR_SIZE_FLAG       = "-st";
+const char* SIDECAR_SIZE_LONG_FLAG  = "-sidecarThreshold";
+
+const char* QUAT_ENCODING_NAMES[] = {"raw", "lossless", "smallestThree"};
+
+XformArrayOptionsCmd::XformArrayOptionsCmd()  {}
+XformArrayOptionsCmd::~XformArrayOptionsCmd() {}
+
+void* XformArrayOptionsCmd::creator()
+{
+    return new XformArrayOptionsCmd();
+}
+
+MSyntax XformArrayOptionsCmd::getSyntax()
+{
+    MSyntax syntax;
+
+    syntax.addFlag(THREADS_FLAG,       THREADS_LONG_FLAG,       MSyntax::kLong);
+    syntax.addFlag(SERIAL_CUTOFF_FLAG, SERIAL_CUTOFF_LONG_FLAG, MSyntax::kLong);
+    syntax.addFlag(COMPUTE_CACHE_FLAG, COMPUTE_CACHE_LONG_FLAG, MSyntax::kBoolean);
+    syntax.addFlag(CACHE_HITS_FLAG,    CACHE_HITS_LONG_FLAG);
+    syntax.addFlag(CACHE_MISSES_FLAG,  CACHE_MISSES_LONG_FLAG);
+    syntax.addFlag(RESET_CACHE_FLAG,   RESET_CACHE_LONG_FLAG);
+    syntax.addFlag(QUAT_ENCODING_FLAG, QUAT_ENCODING_LONG_FLAG, MSyntax::kString);
+    syntax.addFlag(QUAT_BITS_FLAG,     QUAT_BITS_LONG_FLAG,     MSyntax::kLong);
+    syntax.addFlag(SIDECAR_DIR_FLAG,   SIDECAR_DIR_LONG_FLAG,   MSyntax::kString);
+    syntax.addFlag(SIDECAR_SIZE_FLAG,  SIDECAR_SIZE_LONG_FLAG,  MSyntax::kLong);
+
+    syntax.enableQuery(true);
+
+    return syntax;
+}
+
+MStatus XformArrayOptionsCmd::doIt(const MArgList& argList)
+{
+    MStatus status;
+
+    MArgDatabase argData(this->syntax(), argList, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    bool isThreadsFlagSet      = argData.isFlagSet(THREADS_FLAG);
+    bool isSerialCutoffFlagSet = argData.isFlagSet(SERIAL_CUTOFF_FLAG);
+    bool isComputeCacheFlagSet = argData.isFlagSet(COMPUTE_CACHE_FLAG);
+    bool isCacheHitsFlagSet    = argData.isFlagSet(CACHE_HITS_FLAG);
+    bool isCacheMissesFlagSet  = argData.isFlagSet(CACHE_MISSES_FLAG);
+    bool isResetCacheFlagSet   = argData.isFlagSet(RESET_CACHE_FLAG);
+    bool isQuatEncodingFlagSet = argData.isFlagSet(QUAT_ENCODING_FLAG);
+    bool isQuatBitsFlagSet     = argData.isFlagSet(QUAT_BITS_FLAG);
+    bool isSidecarDirFlagSet   = argData.isFlagSet(SIDECAR_DIR_FLAG);
+    bool isSidecarSizeFlagSet  = argData.isFlagSet(SIDECAR_SIZE_FLAG);
+
+    if (argData.isQuery())
+    {
+        int numberOfQueryFlags = (
+            isThreadsFlagSet + 
+            isSerialCutoffFlagSet + 
+            isComputeCacheFlagSet + 
+            isCacheHitsFlagSet + 
+            isCacheMissesFlagSet +
+            isQuatEncodingFlagSet +
+            isQuatBitsFlagSet +
+            isSidecarDirFlagSet +
+            isSidecarSizeFlagSet
+        );
+
+        if (numberOfQueryFlags != 1 || isResetCacheFlagSet)
+        {
+            MGlobal::displayError("This command requires exactly one flag in query mode.");
+            return MStatus::kFailure;
+        }
+
+        if (isThreadsFlagSet)
+        {
+            this->setResult((int) parallelThreadLimit());
+        } else if (isSerialCutoffFlagSet) {
+            this->setResult((int) parallelSerialCutoff());
+        } else if (isComputeCacheFlagSet) {
+            this->setResult(computeCacheEnabled());
+        } else if (isQuatEncodingFlagSet) {
+            this->setResult(MString(QUAT_ENCODING_NAMES[quatEncoding()]));
+        } else if (isQuatBitsFlagSet) {
+            this->setResult((int) quatEncodingBits());
+        } else if (isSidecarDirFlagSet) {
+            this->setResult(MString(sidecarDirectory().c_str()));
+        } else if (isSidecarSizeFlagSet) {
+            this->setResult((int) sidecarThreshold());
+        } else if (isCacheHitsFlagSet) {
+            // The counts can pass the range of an int, which is all setResult takes.
+            this->setResult((double) computeCacheHits());
+        } else {
+            this->setResult((double) computeCacheMisses());
+        }
+
+        return MStatus::kSuccess;
+    }
+
+    if (isCacheHitsFlagSet || isCacheMissesFlagSet)
+    {
+        MGlobal::displayError("-cacheHits and -cacheMisses can only be queried.");
+        return MStatus::kInvalidParameter;
+    }
+
+    if (isThreadsFlagSet)
+    {
+        int threads = 0;
+        status = argData.getFlagArgument(THREADS_FLAG, 0, threads);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (threads < 0)
+        {
+            MGlobal::displayError("-threads must be 0 or greater.");
+            return MStatus::kInvalidParameter;
+        }
+
+        setParallelThreadLimit((unsigned) threads);
+    }
+
+    if (isSerialCutoffFlagSet)
+    {
+        int cutoff = 0;
+        status = argData.getFlagArgument(SERIAL_CUTOFF_FLAG, 0, cutoff);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (cutoff < 0)
+        {
+            MGlobal::displayError("-serialCutoff must be 0 or greater.");
+            return MStatus::kInvalidParameter;
+        }
+
+        setParallelSerialCutoff((size_t) cutoff);
+    }
+
+    if (isComputeCacheFlagSet)
+    {
+        bool enabled = false;
+        status = argData.getFlagArgument(COMPUTE_CACHE_FLAG, 0, enabled);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        setComputeCacheEnabled(enabled);
+    }
+
+    if (isQuatEncodingFlagSet)
+    {
+        MString name;
+        status = argData.getFlagArgument(QUAT_ENCODING_FLAG, 0, name);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        int encoding = -1;
+
+        for (int i = QUAT_ENCODING_RAW; i <= QUAT_ENCODING_SMALLEST_THREE; i++)
+        {
+            if (name == QUAT_ENCODING_NAMES[i]) { encoding = i; }
+        }
+
+        if (encoding < 0)
+        {
+            MGlobal::displayError("-quatEncoding must be \"raw\", \"lossless\" or \"smallestThree\".");
+            return MStatus::kInvalidParameter;
+        }
+
+        setQuatEncoding((QuatEncoding) encoding);
+    }
+
+    if (isQuatBitsFlagSet)
+    {
+        int bits = 0;
+        status = argData.getFlagArgument(QUAT_BITS_FLAG, 0, bits);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (bits < (int) QUAT_ENCODING_MIN_BITS || bits > (int) QUAT_ENCODING_MAX_BITS)
+        {
+            MGlobal::displayError("-quatEncodingBits must be from 4 to 24.");
+            return MStatus::kInvalidParameter;
+        }
+
+        setQuatEncodingBits((unsigned) bits);
+    }
+
+    if (isSidecarDirFlagSet)
+    {
+        MString directory;
+        status = argData.getFlagArgument(SIDECAR_DIR_FLAG, 0, directory);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        setSidecarDirectory(directory.asChar());
+    }
+
+    if (isSidecarSizeFlagSet)
+    {
+        int threshold = 0;
+        status = argData.getFlagArgument(SIDECAR_SIZE_FLAG, 0, threshold);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        if (threshold < 1)
+        {
+            MGlobal::displayError("-sidecarThreshold must be 1 or greater.");
+            return MStatus::kInvalidParameter;
+        }
+
+        setSidecarThreshold((size_t) threshold);
+    }
+
+    if (isResetCacheFlagSet)
+    {
+        resetComputeCacheCounters();
+    }
+
+    return MStatus::kSuccess;
+}
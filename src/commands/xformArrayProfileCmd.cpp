@@ -0,0 +1,221 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+xformArrayProfile command
+This command controls and reports the compute profiling of the nodes in this
+plugin. Profiling is off by default, and costs next to nothing while off.
+
+    -enable (-e) bool
+        Turns profiling on or off. Totals are kept while it is off.
+
+    -reset (-r)
+        Clears the totals and the trace.
+
+    -report (-rp)
+        Returns one string per profiled node, sorted by time, with these
+        tab-separated fields: node name, node type, compute count, seconds
+        spent in compute (not counting nested upstream computes), input 
+        elements, output elements and bytes allocated for array data.
+
+    -trace (-tr) string
+        Writes every compute since profiling was enabled to a Chrome trace
+        JSON file, which can be opened in chrome://tracing or Perfetto.
+
+Nodes that were deleted after computing are reported as "(deleted)".
+ */
+
+#include "xformArrayProfileCmd.h"
+
+#include "../core/nodeProfiler.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <maya/MArgList.h>
+#include <maya/MArgDatabase.h>
+#include <maya/MFn.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MGlobal.h>
+#include <maya/MItDependencyNodes.h>
+#include <maya/MPxCommand.h>
+#include <maya/MPxNode.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+#include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+const char* ENABLE_FLAG       = "-e";
+const char* ENABLE_LONG_FLAG  = "-enable";
+const char* RESET_FLAG        = "-r";
+const char* RESET_LONG_FLAG   = "-reset";
+const char* REPORT_FLAG       = "-rp";
+const char* REPORT_LONG_FLAG  = "-report";
+const char* TRACE_FLAG        = "-tr";
+const char* TRACE_LONG_FLAG   = "-trace";
+
+const char* DELETED_NODE_NAME = "(deleted)";
+
+typedef std::unordered_map<const void*, std::pair<std::string, std::string>> NodeNames;
+
+
+/** Maps every plugin node in the scene to its name and type. */
+static NodeNames pluginNodeNames()
+{
+    NodeNames names;
+
+    for (MItDependencyNodes it(MFn::kPluginDependNode); !it.isDone(); it.next())
+    {
+        MFnDependencyNode fnNode(it.thisNode());
+        MPxNode *userNode = fnNode.userNode();
+
+        if (userNode != nullptr)
+        {
+            names[userNode] = std::make_pair(
+                std::string(fnNode.name().asChar()), 
+                std::string(fnNode.typeName().asChar())
+            );
+        }
+    }
+
+    return names;
+}
+
+
+XformArrayProfileCmd::XformArrayProfileCmd()  {}
+XformArrayProfileCmd::~XformArrayProfileCmd() {}
+
+void* XformArrayProfileCmd::creator()
+{
+    return new XformArrayProfileCmd();
+}
+
+MSyntax XformArrayProfileCmd::getSyntax()
+{
+    MSyntax syntax;
+
+    syntax.addFlag(ENABLE_FLAG, ENABLE_LONG_FLAG, MSyntax::kBoolean);
+    syntax.addFlag(RESET_FLAG,  RESET_LONG_FLAG);
+    syntax.addFlag(REPORT_FLAG, REPORT_LONG_FLAG);
+    syntax.addFlag(TRACE_FLAG,  TRACE_LONG_FLAG,  MSyntax::kString);
+
+    syntax.enableQuery(true);
+
+    return syntax;
+}
+
+MStatus XformArrayProfileCmd::doIt(const MArgList& argList)
+{
+    MStatus status;
+
+    MArgDatabase argData(this->syntax(), argList, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    if (argData.isQuery())
+    {
+        if (!argData.isFlagSet(ENABLE_FLAG))
+        {
+            MGlobal::displayError("Only -enable can be queried.");
+            return MStatus::kFailure;
+        }
+
+        this->setResult(profilerEnabled());
+        return MStatus::kSuccess;
+    }
+
+    if (argData.isFlagSet(ENABLE_FLAG))
+    {
+        bool enabled = false;
+        status = argData.getFlagArgument(ENABLE_FLAG, 0, enabled);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        setProfilerEnabled(enabled);
+    }
+
+    if (argData.isFlagSet(TRACE_FLAG))
+    {
+        MString path;
+        status = argData.getFlagArgument(TRACE_FLAG, 0, path);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        NodeNames names = pluginNodeNames();
+
+        bool isWritten = writeProfilerTrace(
+            path.asChar(),
+            [&names](const void *node) 
+            { 
+                auto name = names.find(node);
+                return name == names.end() ? std::string(DELETED_NODE_NAME) : name->second.first; 
+            },
+            [&names](const void *node) 
+            { 
+                auto name = names.find(node);
+                return name == names.end() ? std::string(DELETED_NODE_NAME) : name->second.second; 
+            }
+        );
+
+        if (!isWritten)
+        {
+            MGlobal::displayError("Could not write the trace to \"" + path + "\".");
+            return MStatus::kFailure;
+        }
+    }
+
+    if (argData.isFlagSet(REPORT_FLAG))
+    {
+        NodeNames names = pluginNodeNames();
+
+        std::vector<std::pair<const void*, NodeProfile>> records = profilerRecords();
+
+        std::sort(
+            records.begin(), 
+            records.end(), 
+            [](const std::pair<const void*, NodeProfile> &a, const std::pair<const void*, NodeProfile> &b)
+            {
+                return a.second.seconds > b.second.seconds;
+            }
+        );
+
+        MStringArray result;
+
+        for (const auto &record : records)
+        {
+            auto name = names.find(record.first);
+
+            std::string nodeName = name == names.end() ? DELETED_NODE_NAME : name->second.first;
+            std::string nodeType = name == names.end() ? DELETED_NODE_NAME : name->second.second;
+
+            const NodeProfile &profile = record.second;
+
+            char fields[256];
+            snprintf(
+                fields, 
+                sizeof(fields), 
+                "\t%zu\t%.9f\t%zu\t%zu\t%zu",
+                profile.computeCount,
+                profile.seconds,
+                profile.inputElements,
+                profile.outputElements,
+                profile.bytesAllocated
+            );
+
+            result.append(MString((nodeName + "\t" + nodeType + fields).c_str()));
+        }
+
+        this->setResult(result);
+    }
+
+    if (argData.isFlagSet(RESET_FLAG))
+    {
+        resetProfiler();
+    }
+
+    return MStatus::kSuccess;
+}
@@ -0,0 +1,30 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#pragma once
+
+#include <maya/MArgList.h>
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MStatus.h>
+#include <maya/MSyntax.h>
+
+class XformArrayProfileCmd : public MPxCommand
+{
+public:
+                        XformArrayProfileCmd();
+    virtual             ~XformArrayProfileCmd();
+
+    static void*        creator();
+    static MSyntax      getSyntax();
+
+    virtual MStatus     doIt(const MArgList& argList);
+
+    virtual bool        isUndoable() const { return false; }
+    virtual bool        hasSyntax()  const { return true; }
+        
+public:
+    static MString      COMMAND_NAME;
+};
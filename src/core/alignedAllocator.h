@@ -0,0 +1,71 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+AlignedAllocator
+    Standard allocator that returns memory aligned to a fixed boundary, so 
+    that std::vector storage can be loaded with aligned SIMD instructions.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+template <class T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template <class U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+                        AlignedAllocator() {}
+    template <class U>  AlignedAllocator(const AlignedAllocator<U, Alignment> &other) {}
+
+    T* allocate(size_t n)
+    {
+        if (n == 0) { return NULL; }
+
+        void *ptr = NULL;
+
+#ifdef _WIN32
+        ptr = _aligned_malloc(n * sizeof(T), Alignment);
+#else
+        if (posix_memalign(&ptr, Alignment, n * sizeof(T)) != 0) { ptr = NULL; }
+#endif
+
+        if (ptr == NULL) { throw std::bad_alloc(); }
+
+        return (T*) ptr;
+    }
+
+    void deallocate(T *ptr, size_t /* n */)
+    {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+};
+
+template <class T, class U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return true; }
+
+template <class T, class U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return false; }
@@ -0,0 +1,95 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+ArrayView
+    Read-only view of a contiguous array owned by someone else, such as the
+    storage of a Maya array data object. A view is only valid for as long
+    as the storage it points to.
+
+BroadcastView
+    Read-only view of an array stretched to any length, used to combine 
+    arrays of different lengths. An array of one value is broadcast to 
+    every index. A longer array reads as fillValue past its end. Nothing 
+    is copied; a single value is read with a stride of 0.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+template<class T>
+class ArrayView
+{
+public:
+                ArrayView() : values(nullptr), length(0) {}
+                ArrayView(const T *values, size_t length) : values(values), length(length) {}
+                ArrayView(const std::vector<T> &values) : values(values.data()), length(values.size()) {}
+
+    const T&    operator[](size_t i) const  { return values[i]; }
+
+    const T*    data() const                { return values; }
+    size_t      size() const                { return length; }
+    bool        empty() const               { return length == 0; }
+
+    const T*    begin() const               { return values; }
+    const T*    end() const                 { return values + length; }
+
+private:
+    const T    *values;
+    size_t      length;
+};
+
+
+template<class T>
+class BroadcastView
+{
+public:
+                BroadcastView(ArrayView<T> values, const T &fillValue) :
+                    values(values.data()),
+                    length(values.size() == 1 ? SIZE_MAX : values.size()),
+                    stride(values.size() == 1 ? 0 : 1),
+                    fillValue(fillValue)
+                {}
+
+    const T&    operator[](size_t i) const  { return i < length ? values[i * stride] : fillValue; }
+
+    /** Returns the view that starts at element first of this one. */
+    BroadcastView<T> from(size_t first) const
+    {
+        BroadcastView<T> result(*this);
+
+        if (stride != 0)
+        {
+            first = first < length ? first : length;
+            result.values += first;
+            result.length -= first;
+        }
+
+        return result;
+    }
+
+    /** Copies n broadcast values into a vector, for kernels that need contiguous input. */
+    std::vector<T> copy(size_t n) const
+    {
+        std::vector<T> result(n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            result[i] = (*this)[i];
+        }
+
+        return result;
+    }
+
+private:
+    const T    *values;
+    size_t      length;
+    size_t      stride;
+    T           fillValue;
+};
@@ -0,0 +1,83 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "computeCache.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
+
+static bool defaultComputeCacheEnabled()
+{
+    const char *requested = getenv("XFORM_ARRAY_COMPUTE_CACHE");
+    return requested != NULL && atoi(requested) > 0;
+}
+
+
+std::atomic<bool> computeCacheEnabledFlag(defaultComputeCacheEnabled());
+
+static std::atomic<uint64_t> cacheHits(0);
+static std::atomic<uint64_t> cacheMisses(0);
+
+const uint64_t ComputeCache::NO_HASH;
+
+
+void setComputeCacheEnabled(bool enabled)
+{
+    computeCacheEnabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+
+uint64_t computeCacheHits()
+{
+    return cacheHits.load(std::memory_order_relaxed);
+}
+
+
+uint64_t computeCacheMisses()
+{
+    return cacheMisses.load(std::memory_order_relaxed);
+}
+
+
+void resetComputeCacheCounters()
+{
+    cacheHits.store(0, std::memory_order_relaxed);
+    cacheMisses.store(0, std::memory_order_relaxed);
+}
+
+
+bool ComputeCache::reuse(uint64_t hash)
+{
+    if (!computeCacheEnabled())
+    {
+        return false;
+    }
+
+    bool isHit = hash != NO_HASH && this->hash.load(std::memory_order_acquire) == hash;
+
+    // A compute that fails after a miss must not leave a hash for an output it did not finish.
+    if (!isHit) 
+    { 
+        this->invalidate(); 
+    }
+
+    (isHit ? cacheHits : cacheMisses).fetch_add(1, std::memory_order_relaxed);
+
+    return isHit;
+}
+
+
+void ComputeCache::store(uint64_t hash)
+{
+    this->hash.store(computeCacheEnabled() ? hash : NO_HASH, std::memory_order_release);
+}
+
+
+void ComputeCache::invalidate()
+{
+    this->hash.store(NO_HASH, std::memory_order_release);
+}
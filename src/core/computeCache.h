@@ -0,0 +1,63 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+computeCache
+    Opt-in reuse of a node's last output when its inputs have not changed.
+    These have no Maya dependency.
+
+    Maya dirties an output whenever an upstream node recomputes, even if 
+    the upstream node produced the same values as before. While the cache
+    is enabled, a node hashes its inputs with ContentHash before computing.
+    If the hash matches the one stored by its last compute, the node keeps
+    the output it already has.
+
+    Every lookup counts as a hit or a miss, so the counters show whether 
+    hashing the inputs costs less than the computes it saves. 
+
+    The cache is off by default. It can be turned on with the 
+    XFORM_ARRAY_COMPUTE_CACHE environment variable or the xformArrayOptions
+    command. 
+
+    The stored hash is a single atomic word, so a node evaluated from two
+    threads at once can only see a miss, never half of another compute's
+    hash.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+extern std::atomic<bool> computeCacheEnabledFlag;
+
+inline bool     computeCacheEnabled() { return computeCacheEnabledFlag.load(std::memory_order_relaxed); }
+
+void            setComputeCacheEnabled(bool enabled);
+
+uint64_t        computeCacheHits();
+uint64_t        computeCacheMisses();
+void            resetComputeCacheCounters();
+
+/** The hash of the inputs of one node's last compute. */
+class ComputeCache
+{
+public:
+    /** Returns true if the cache is enabled and hash matches the stored hash. */
+    bool            reuse(uint64_t hash);
+
+    /** Stores the hash of a finished compute. While the cache is disabled this forgets the stored hash. */
+    void            store(uint64_t hash);
+
+    /** Forgets the stored hash. */
+    void            invalidate();
+
+private:
+    /** The stored hash, or NO_HASH. A digest that equals NO_HASH is never stored. */
+    std::atomic<uint64_t>   hash{NO_HASH};
+
+    static const uint64_t   NO_HASH = 0;
+};
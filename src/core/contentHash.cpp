@@ -0,0 +1,162 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "contentHash.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+
+static inline uint64_t read64(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+static inline uint32_t read32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+static inline uint64_t hashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME_2;
+    acc  = rotl(acc, 31);
+    return acc * PRIME_1;
+}
+
+
+static inline uint64_t hashMergeRound(uint64_t acc, uint64_t lane)
+{
+    acc ^= hashRound(0, lane);
+    return acc * PRIME_1 + PRIME_4;
+}
+
+
+ContentHash::ContentHash(uint64_t seed) : seed(seed), totalSize(0), bufferSize(0)
+{
+    this->lanes[0] = seed + PRIME_1 + PRIME_2;
+    this->lanes[1] = seed + PRIME_2;
+    this->lanes[2] = seed;
+    this->lanes[3] = seed - PRIME_1;
+}
+
+
+void ContentHash::update(const void *data, size_t size)
+{
+    const unsigned char *p = (const unsigned char*) data;
+    const unsigned char *end = p + size;
+
+    this->totalSize += size;
+
+    if (this->bufferSize + size < 32)
+    {
+        memcpy(this->buffer + this->bufferSize, p, size);
+        this->bufferSize += size;
+        return;
+    }
+
+    if (this->bufferSize > 0)
+    {
+        size_t fill = 32 - this->bufferSize;
+        memcpy(this->buffer + this->bufferSize, p, fill);
+        p += fill;
+
+        for (int i = 0; i < 4; i++)
+        {
+            this->lanes[i] = hashRound(this->lanes[i], read64(this->buffer + i * 8));
+        }
+
+        this->bufferSize = 0;
+    }
+
+    uint64_t v0 = this->lanes[0];
+    uint64_t v1 = this->lanes[1];
+    uint64_t v2 = this->lanes[2];
+    uint64_t v3 = this->lanes[3];
+
+    for (; p + 32 <= end; p += 32)
+    {
+        v0 = hashRound(v0, read64(p +  0));
+        v1 = hashRound(v1, read64(p +  8));
+        v2 = hashRound(v2, read64(p + 16));
+        v3 = hashRound(v3, read64(p + 24));
+    }
+
+    this->lanes[0] = v0;
+    this->lanes[1] = v1;
+    this->lanes[2] = v2;
+    this->lanes[3] = v3;
+
+    this->bufferSize = (size_t) (end - p);
+    memcpy(this->buffer, p, this->bufferSize);
+}
+
+
+uint64_t ContentHash::digest() const
+{
+    uint64_t h;
+
+    if (this->totalSize >= 32)
+    {
+        h = rotl(this->lanes[0], 1) + rotl(this->lanes[1], 7) + rotl(this->lanes[2], 12) + rotl(this->lanes[3], 18);
+
+        for (int i = 0; i < 4; i++)
+        {
+            h = hashMergeRound(h, this->lanes[i]);
+        }
+    } else {
+        h = this->seed + PRIME_5;
+    }
+
+    h += this->totalSize;
+
+    const unsigned char *p = this->buffer;
+    const unsigned char *end = p + this->bufferSize;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        h ^= hashRound(0, read64(p));
+        h  = rotl(h, 27) * PRIME_1 + PRIME_4;
+    }
+
+    if (p + 4 <= end)
+    {
+        h ^= (uint64_t) read32(p) * PRIME_1;
+        h  = rotl(h, 23) * PRIME_2 + PRIME_3;
+        p += 4;
+    }
+
+    for (; p < end; p++)
+    {
+        h ^= (*p) * PRIME_5;
+        h  = rotl(h, 11) * PRIME_1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME_2;
+    h ^= h >> 29;
+    h *= PRIME_3;
+    h ^= h >> 32;
+
+    return h;
+}
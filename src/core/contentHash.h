@@ -0,0 +1,47 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+ContentHash
+    Streaming 64-bit hash of the bytes fed to it, using the XXH64 algorithm
+    (https://github.com/Cyan4973/xxHash). This has no Maya dependency. 
+
+    It is not a cryptographic hash. It is fast enough to run over every 
+    input array of a compute, and is used to tell whether the inputs of a 
+    compute are the same as last time.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+class ContentHash
+{
+public:
+    explicit        ContentHash(uint64_t seed=0);
+
+    void            update(const void *data, size_t size);
+
+    /** Hashes the bytes of a value. Only use this on types without padding. */
+    template<class T>
+    void            updateValue(const T &value) 
+    { 
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "ContentHash::updateValue takes arithmetic and enum values.");
+        this->update(&value, sizeof(T)); 
+    }
+
+    uint64_t        digest() const;
+
+private:
+    uint64_t        seed;
+    uint64_t        lanes[4];
+    uint64_t        totalSize;
+
+    unsigned char   buffer[32];
+    size_t          bufferSize;
+};
@@ -0,0 +1,67 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+DirtyRange
+    Half-open range of array indices whose values changed. This has no Maya
+    dependency.
+
+    An array that carries a dirty range holds the same values as the array 
+    it was derived from everywhere outside the range, so elementwise nodes 
+    only need to recompute the elements inside it.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+struct DirtyRange
+{
+    size_t      begin;
+    size_t      end;
+
+    static DirtyRange all()     { DirtyRange r = {0, SIZE_MAX}; return r; }
+    static DirtyRange none()    { DirtyRange r = {0, 0}; return r; }
+
+    bool        empty() const   { return begin >= end; }
+    size_t      size() const    { return empty() ? 0 : end - begin; }
+
+    /** Returns the part of this range inside an array of n elements. */
+    DirtyRange  clamp(size_t n) const
+    {
+        DirtyRange r = {std::min(begin, n), std::min(end, n)};
+        return r.empty() ? none() : r;
+    }
+
+    /** Returns the smallest range that covers both ranges. */
+    DirtyRange  merge(const DirtyRange &other) const
+    {
+        if (empty())       { return other; }
+        if (other.empty()) { return *this; }
+
+        DirtyRange r = {std::min(begin, other.begin), std::max(end, other.end)};
+        return r;
+    }
+};
+
+
+/**
+    Returns the smallest range inside [begin, end) that holds every index i 
+    for which isSame(i) is false. The range is searched from both ends, so 
+    an array that changed at its first and last elements is not read any 
+    further.
+*/
+template<class F>
+DirtyRange findChangedRange(size_t begin, size_t end, F isSame)
+{
+    while (begin < end && isSame(begin))   { begin++; }
+    while (end > begin && isSame(end - 1)) { end--; }
+
+    DirtyRange r = {begin, end};
+    return r.empty() ? DirtyRange::none() : r;
+}
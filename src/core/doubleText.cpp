@@ -0,0 +1,138 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "doubleText.h"
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmath>
+
+#if defined(__has_include)
+#if __has_include(<charconv>) && __cplusplus >= 201703L
+#include <charconv>
+#endif
+#endif
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define XFORM_ARRAY_TO_CHARS 1
+#else
+#define XFORM_ARRAY_TO_CHARS 0
+#endif
+
+
+/**
+    Returns true if str only holds the characters of a decimal number, which
+    keeps out the hexadecimal, nan and inf forms strtod and from_chars take.
+    A leading '+', which from_chars does not take, is skipped.
+*/
+static bool isDecimalText(const char *&str)
+{
+    if (*str == '+') { str++; }
+
+    bool hasDigit = false;
+
+    for (const char *c = str; *c != '\0'; c++)
+    {
+        if (*c >= '0' && *c <= '9')
+        {
+            hasDigit = true;
+        } else if (*c == 'x' || *c == 'X' || strchr("+-.eE", *c) == NULL) {
+            return false;
+        }
+    }
+
+    return hasDigit;
+}
+
+
+#if XFORM_ARRAY_TO_CHARS
+
+int formatDouble(double value, char *buffer)
+{
+    std::to_chars_result result = std::to_chars(buffer, buffer + DOUBLE_TEXT_BUFFER_SIZE - 1, value);
+    *result.ptr = '\0';
+
+    return (int) (result.ptr - buffer);
+}
+
+
+bool parseDouble(const char *str, double &value)
+{
+    if (!isDecimalText(str)) { return false; }
+
+    const char *end = str + strlen(str);
+    std::from_chars_result result = std::from_chars(str, end, value);
+
+    return result.ec == std::errc() && result.ptr == end && std::isfinite(value);
+}
+
+#else
+
+/** Returns the decimal point character of the current C locale. */
+static char localeDecimalPoint()
+{
+    const char *decimalPoint = localeconv()->decimal_point;
+    return (decimalPoint != NULL && decimalPoint[0] != '\0') ? decimalPoint[0] : '.';
+}
+
+
+/** Tries 15, 16, then 17 significant digits, the first of which to round trip is the shortest %g gives. */
+int formatDouble(double value, char *buffer)
+{
+    int length = 0;
+
+    for (int precision = 15; precision <= 17; precision++)
+    {
+        length = snprintf(buffer, DOUBLE_TEXT_BUFFER_SIZE, "%.*g", precision, value);
+
+        if (precision == 17 || strtod(buffer, NULL) == value) { break; }
+    }
+
+    char decimalPoint = localeDecimalPoint();
+
+    if (decimalPoint != '.')
+    {
+        char *c = strchr(buffer, decimalPoint);
+        if (c != NULL) { *c = '.'; }
+    }
+
+    return length;
+}
+
+
+bool parseDouble(const char *str, double &value)
+{
+    if (!isDecimalText(str)) { return false; }
+
+    char buffer[DOUBLE_TEXT_BUFFER_SIZE * 2];
+    char decimalPoint = localeDecimalPoint();
+
+    if (decimalPoint != '.')
+    {
+        size_t length = strlen(str);
+
+        if (length >= sizeof(buffer)) { return false; }
+
+        memcpy(buffer, str, length + 1);
+
+        char *c = strchr(buffer, '.');
+        if (c != NULL) { *c = decimalPoint; }
+
+        str = buffer;
+    }
+
+    char *end = NULL;
+    double parsed = strtod(str, &end);
+
+    if (end == str || *end != '\0' || !std::isfinite(parsed)) { return false; }
+
+    value = parsed;
+    return true;
+}
+
+#endif
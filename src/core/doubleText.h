@@ -0,0 +1,36 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+doubleText
+    Conversions between doubles and the text of the ASCII file format. These
+    have no Maya dependency, and do not depend on the C locale: the decimal
+    point is always '.'.
+
+    Where the standard library has std::to_chars and std::from_chars for 
+    doubles, they are used directly. Otherwise the C library is used, with
+    the locale's decimal point swapped in and out.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+/** Large enough for the longest shortest representation of a double, and its terminator. */
+const size_t DOUBLE_TEXT_BUFFER_SIZE = 32;
+
+/**
+    Writes the shortest text that parses back to exactly value, and returns 
+    its length. The text is null-terminated. buffer must hold at least 
+    DOUBLE_TEXT_BUFFER_SIZE characters.
+*/
+int             formatDouble(double value, char *buffer);
+
+/**
+    Parses a whole null-terminated string as a finite decimal double. Text 
+    with anything after the number, hexadecimal floats, nan, inf and values
+    too large for a double are rejected.
+*/
+bool            parseDouble(const char *str, double &value);
@@ -0,0 +1,175 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "eulerKernels.h"
+#include "matrixCompose.h"
+#include "parallel.h"
+#include "xformTypes.h"
+
+#include <math.h>
+#include <stddef.h>
+
+/** Below this cosine of the middle angle, the rotation is treated as being at a pole. */
+static const double POLE_EPSILON = 1.0e-9;
+
+/** Returns 1 if the axes I, J, K are a cyclic permutation of X, Y, Z, and -1 otherwise. */
+template <int I, int J>
+static inline double orderParity()
+{
+    return (J - I + 3) % 3 == 1 ? 1.0 : -1.0;
+}
+
+
+/** Angles of the rotation matrix r, whose axes are applied in the order I, J, K. */
+template <int I, int J, int K>
+static inline EulerRotation matrixToEuler(const double r[3][3], int rotateOrder)
+{
+    const double parity = orderParity<I, J>();
+
+    double angles[3];
+    double cosJ = sqrt((r[I][I] * r[I][I]) + (r[I][J] * r[I][J]));
+
+    angles[J] = atan2(-parity * r[I][K], cosJ);
+
+    if (cosJ > POLE_EPSILON)
+    {
+        angles[I] = atan2(parity * r[J][K], r[K][K]);
+        angles[K] = atan2(parity * r[I][J], r[I][I]);
+    } else {
+        angles[I] = atan2(-parity * r[K][J], r[J][J]);
+        angles[K] = 0.0;
+    }
+
+    EulerRotation e = {angles[0], angles[1], angles[2], rotateOrder};
+    return e;
+}
+
+
+template <int I, int J, int K>
+static void quatToEulerOrder(const Quaternion *q, size_t begin, size_t end, int rotateOrder, EulerRotation *out)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        double x = q[i].x, y = q[i].y, z = q[i].z, w = q[i].w;
+
+        double norm = x * x + y * y + z * z + w * w;
+        double s = norm > 0.0 ? 2.0 / norm : 0.0;
+
+        double xs = x * s,  ys = y * s,  zs = z * s;
+        double wx = w * xs, wy = w * ys, wz = w * zs;
+        double xx = x * xs, xy = x * ys, xz = x * zs;
+        double yy = y * ys, yz = y * zs, zz = z * zs;
+
+        // As quatToRotation; the elements this order does not use are optimized away.
+        const double r[3][3] = {
+            {1.0 - (yy + zz), xy + wz,         xz - wy},
+            {xy - wz,         1.0 - (xx + zz), yz + wx},
+            {xz + wy,         yz - wx,         1.0 - (xx + yy)}
+        };
+
+        out[i] = matrixToEuler<I, J, K>(r, rotateOrder);
+    }
+}
+
+
+/**
+    The rotations about I, then J, then K, make the quaternion qK * qJ * qI.
+    This is that product, expanded for quaternions about single axes.
+*/
+template <int I, int J, int K>
+static void eulerToQuatOrder(const EulerRotation *e, size_t begin, size_t end, Quaternion *out)
+{
+    const double parity = orderParity<I, J>();
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const double angles[3] = {e[i].x * 0.5, e[i].y * 0.5, e[i].z * 0.5};
+
+        double cI = cos(angles[I]), sI = sin(angles[I]);
+        double cJ = cos(angles[J]), sJ = sin(angles[J]);
+        double cK = cos(angles[K]), sK = sin(angles[K]);
+
+        double v[3];
+        v[I] = (cK * cJ * sI) - (parity * sK * sJ * cI);
+        v[J] = (cK * sJ * cI) + (parity * sK * cJ * sI);
+        v[K] = (sK * cJ * cI) - (parity * cK * sJ * sI);
+
+        Quaternion r = {v[0], v[1], v[2], (cK * cJ * cI) + (parity * sK * sJ * sI)};
+        out[i] = r;
+    }
+}
+
+
+typedef void (*QuatToEulerFn)(const Quaternion*, size_t, size_t, int, EulerRotation*);
+typedef void (*EulerToQuatFn)(const EulerRotation*, size_t, size_t, Quaternion*);
+
+static const QuatToEulerFn QUAT_TO_EULER[6] = {
+    &quatToEulerOrder<0, 1, 2>,
+    &quatToEulerOrder<1, 2, 0>,
+    &quatToEulerOrder<2, 0, 1>,
+    &quatToEulerOrder<0, 2, 1>,
+    &quatToEulerOrder<1, 0, 2>,
+    &quatToEulerOrder<2, 1, 0>
+};
+
+static const EulerToQuatFn EULER_TO_QUAT[6] = {
+    &eulerToQuatOrder<0, 1, 2>,
+    &eulerToQuatOrder<1, 2, 0>,
+    &eulerToQuatOrder<2, 0, 1>,
+    &eulerToQuatOrder<0, 2, 1>,
+    &eulerToQuatOrder<1, 0, 2>,
+    &eulerToQuatOrder<2, 1, 0>
+};
+
+/** Orders outside the enum are treated as XYZ, as eulerToRotation does. */
+static inline int validOrder(int rotateOrder)
+{
+    return rotateOrder >= ROTATE_ORDER_XYZ && rotateOrder <= ROTATE_ORDER_ZYX ? rotateOrder : ROTATE_ORDER_XYZ;
+}
+
+
+void quatArrayToEuler(const Quaternion *q, size_t n, int rotateOrder, EulerRotation *out)
+{
+    rotateOrder = validOrder(rotateOrder);
+    QuatToEulerFn kernel = QUAT_TO_EULER[rotateOrder];
+
+    parallelForRange(0, n, DEFAULT_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        kernel(q, begin, end, rotateOrder, out);
+    });
+}
+
+
+void eulerArrayToQuat(const EulerRotation *e, size_t n, Quaternion *out)
+{
+    parallelForRange(0, n, DEFAULT_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        // Arrays almost always share one order, which makes this a single run.
+        for (size_t runBegin = begin; runBegin < end; )
+        {
+            int rotateOrder = e[runBegin].order;
+            size_t runEnd = runBegin + 1;
+
+            while (runEnd < end && e[runEnd].order == rotateOrder) { runEnd++; }
+
+            EULER_TO_QUAT[validOrder(rotateOrder)](e, runBegin, runEnd, out);
+            runBegin = runEnd;
+        }
+    });
+}
+
+
+EulerRotation rotationToEuler(const double rotate[3][3], int rotateOrder)
+{
+    switch (validOrder(rotateOrder))
+    {
+        case ROTATE_ORDER_YZX: return matrixToEuler<1, 2, 0>(rotate, rotateOrder);
+        case ROTATE_ORDER_ZXY: return matrixToEuler<2, 0, 1>(rotate, rotateOrder);
+        case ROTATE_ORDER_XZY: return matrixToEuler<0, 2, 1>(rotate, rotateOrder);
+        case ROTATE_ORDER_YXZ: return matrixToEuler<1, 0, 2>(rotate, rotateOrder);
+        case ROTATE_ORDER_ZYX: return matrixToEuler<2, 1, 0>(rotate, rotateOrder);
+        default:               return matrixToEuler<0, 1, 2>(rotate, ROTATE_ORDER_XYZ);
+    }
+}
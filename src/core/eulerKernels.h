@@ -0,0 +1,46 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+eulerKernels
+    Conversions between quaternions and euler rotations. These have no Maya
+    dependency.
+
+    Each conversion is compiled once per rotation order, so the order is
+    looked up once per array, or once per run of elements that share an
+    order, instead of once per element. Rotations follow the conventions of
+    matrixCompose: the first axis of the order is applied first.
+
+    Euler rotations are found from the rotation matrix of the quaternion,
+    with the angle of the middle axis in [-pi/2, pi/2] and the others in
+    [-pi, pi]. At the poles, where only the sum or difference of the other
+    two angles is defined, the last angle is 0 and the first holds the 
+    whole turn. 
+    
+    asEulerRotation() and reorderIt() describe the same rotations, but may
+    choose other angles for them, and their choice has not been recorded
+    to compare with. quatToEulerArray therefore only uses these kernels 
+    when its conversion attribute asks for them, and keeps Maya's angles
+    by default.
+*/
+
+#pragma once
+
+#include "matrixCompose.h"
+#include "xformTypes.h"
+
+#include <stddef.h>
+
+/** Writes the rotations of q[0, n) in rotateOrder to out. */
+void            quatArrayToEuler(const Quaternion *q, size_t n, int rotateOrder, EulerRotation *out);
+
+/** Writes the quaternions of e[0, n), each in its own order, to out. */
+void            eulerArrayToQuat(const EulerRotation *e, size_t n, Quaternion *out);
+
+/**
+    Returns the angles in rotateOrder of a rotation matrix, such as one
+    built by eulerToRotation. This looks the order up on every call.
+*/
+EulerRotation   rotationToEuler(const double rotate[3][3], int rotateOrder);
@@ -0,0 +1,114 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "matrixCompose.h"
+
+#include <math.h>
+#include <string.h>
+
+static void multiply3x3(const double a[3][3], const double b[3][3], double out[3][3])
+{
+    double result[3][3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            result[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+        }
+    }
+
+    memcpy(out, result, sizeof(result));
+}
+
+
+void eulerToRotation(double x, double y, double z, int rotateOrder, double rotate[3][3])
+{
+    double cx = cos(x), sx = sin(x);
+    double cy = cos(y), sy = sin(y);
+    double cz = cos(z), sz = sin(z);
+
+    const double rx[3][3] = {
+        {1.0, 0.0, 0.0},
+        {0.0,  cx,  sx},
+        {0.0, -sx,  cx}
+    };
+
+    const double ry[3][3] = {
+        { cy, 0.0, -sy},
+        {0.0, 1.0, 0.0},
+        { sy, 0.0,  cy}
+    };
+
+    const double rz[3][3] = {
+        { cz,  sz, 0.0},
+        {-sz,  cz, 0.0},
+        {0.0, 0.0, 1.0}
+    };
+
+    const double (*first)[3]  = rx;
+    const double (*second)[3] = ry;
+    const double (*third)[3]  = rz;
+
+    switch (rotateOrder)
+    {
+        case ROTATE_ORDER_YZX: first = ry; second = rz; third = rx; break;
+        case ROTATE_ORDER_ZXY: first = rz; second = rx; third = ry; break;
+        case ROTATE_ORDER_XZY: first = rx; second = rz; third = ry; break;
+        case ROTATE_ORDER_YXZ: first = ry; second = rx; third = rz; break;
+        case ROTATE_ORDER_ZYX: first = rz; second = ry; third = rx; break;
+        default: break;
+    }
+
+    multiply3x3(first, second, rotate);
+    multiply3x3(rotate, third, rotate);
+}
+
+
+void quatToRotation(double x, double y, double z, double w, double rotate[3][3])
+{
+    double norm = x * x + y * y + z * z + w * w;
+    double s = norm > 0.0 ? 2.0 / norm : 0.0;
+
+    double xs = x * s,  ys = y * s,  zs = z * s;
+    double wx = w * xs, wy = w * ys, wz = w * zs;
+    double xx = x * xs, xy = x * ys, xz = x * zs;
+    double yy = y * ys, yz = y * zs, zz = z * zs;
+
+    rotate[0][0] = 1.0 - (yy + zz); rotate[0][1] = xy + wz;         rotate[0][2] = xz - wy;
+    rotate[1][0] = xy - wz;         rotate[1][1] = 1.0 - (xx + zz); rotate[1][2] = yz + wx;
+    rotate[2][0] = xz + wy;         rotate[2][1] = yz - wx;         rotate[2][2] = 1.0 - (xx + yy);
+}
+
+
+void composeMatrix(
+    const double translate[3], 
+    const double rotate[3][3], 
+    const double scale[3], 
+    const double shear[3], 
+    double *out
+) {
+    const double *r0 = rotate[0];
+    const double *r1 = rotate[1];
+    const double *r2 = rotate[2];
+
+    double xy = shear[0], xz = shear[1], yz = shear[2];
+
+    for (int j = 0; j < 3; j++)
+    {
+        out[0 + j] = scale[0] * r0[j];
+        out[4 + j] = scale[1] * (xy * r0[j] + r1[j]);
+        out[8 + j] = scale[2] * (xz * r0[j] + yz * r1[j] + r2[j]);
+    }
+
+    out[3]  = 0.0;
+    out[7]  = 0.0;
+    out[11] = 0.0;
+
+    out[12] = translate[0];
+    out[13] = translate[1];
+    out[14] = translate[2];
+    out[15] = 1.0;
+}
@@ -0,0 +1,42 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+matrixCompose
+    Builds 4x4 matrices from transform components without going through
+    MTransformationMatrix. This has no Maya dependency.
+
+    Matrices are 16 doubles in row-major order, laid out like MMatrix::matrix,
+    and are composed in Maya's order: scale * shear * rotate * translate. 
+    Rotation matrices are 3x3 and use row vectors, like Maya's.
+*/
+
+#pragma once
+
+/** Matches the values of MEulerRotation::RotationOrder. */
+enum RotateOrder
+{
+    ROTATE_ORDER_XYZ = 0,
+    ROTATE_ORDER_YZX = 1,
+    ROTATE_ORDER_ZXY = 2,
+    ROTATE_ORDER_XZY = 3,
+    ROTATE_ORDER_YXZ = 4,
+    ROTATE_ORDER_ZYX = 5
+};
+
+/** Angles are in radians. The first axis of the order is applied first. */
+void            eulerToRotation(double x, double y, double z, int rotateOrder, double rotate[3][3]);
+
+/** The quaternion does not need to be normalized. A zero quaternion gives the identity. */
+void            quatToRotation(double x, double y, double z, double w, double rotate[3][3]);
+
+/** shear is (xy, xz, yz). */
+void            composeMatrix(
+                    const double translate[3], 
+                    const double rotate[3][3], 
+                    const double scale[3], 
+                    const double shear[3], 
+                    double *out
+                );
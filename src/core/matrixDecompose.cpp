@@ -0,0 +1,71 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "matrixDecompose.h"
+
+#include <math.h>
+
+static inline double dot(const double *a, const double *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+
+bool decomposeMatrix(const double *m, MatrixComponents &components)
+{
+    const double *row0 = m;
+    const double *row1 = m + 4;
+    const double *row2 = m + 8;
+
+    double det = row0[0] * (row1[1] * row2[2] - row1[2] * row2[1])
+               - row0[1] * (row1[0] * row2[2] - row1[2] * row2[0])
+               + row0[2] * (row1[0] * row2[1] - row1[1] * row2[0]);
+
+    if (!(det > 0.0)) 
+    { 
+        return false; 
+    }
+
+    double x[3] = {row0[0], row0[1], row0[2]};
+    double y[3] = {row1[0], row1[1], row1[2]};
+    double z[3] = {row2[0], row2[1], row2[2]};
+
+    double sx = sqrt(dot(x, x));
+    for (int i = 0; i < 3; i++) { x[i] /= sx; }
+
+    double xy = dot(y, x);
+    for (int i = 0; i < 3; i++) { y[i] -= xy * x[i]; }
+
+    double sy = sqrt(dot(y, y));
+    for (int i = 0; i < 3; i++) { y[i] /= sy; }
+
+    double xz = dot(z, x);
+    double yz = dot(z, y);
+    for (int i = 0; i < 3; i++) { z[i] -= xz * x[i] + yz * y[i]; }
+
+    double sz = sqrt(dot(z, z));
+    for (int i = 0; i < 3; i++) { z[i] /= sz; }
+
+    components.translate[0] = m[12];
+    components.translate[1] = m[13];
+    components.translate[2] = m[14];
+
+    double (&r)[4][4] = components.rotate;
+
+    r[0][0] = x[0]; r[0][1] = x[1]; r[0][2] = x[2]; r[0][3] = 0.0;
+    r[1][0] = y[0]; r[1][1] = y[1]; r[1][2] = y[2]; r[1][3] = 0.0;
+    r[2][0] = z[0]; r[2][1] = z[1]; r[2][2] = z[2]; r[2][3] = 0.0;
+    r[3][0] = 0.0;  r[3][1] = 0.0;  r[3][2] = 0.0;  r[3][3] = 1.0;
+
+    components.scale[0] = sx;
+    components.scale[1] = sy;
+    components.scale[2] = sz;
+
+    components.shear[0] = xy / sy;
+    components.shear[1] = xz / sz;
+    components.shear[2] = yz / sz;
+
+    return true;
+}
@@ -0,0 +1,37 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+matrixDecompose
+    Single pass decomposition of a 4x4 matrix into translate, rotate, scale 
+    and shear. This has no Maya dependency. 
+    
+    The matrix is 16 doubles in row-major order, laid out like 
+    MMatrix::matrix, and is assumed to be composed in Maya's order: 
+    scale * shear * rotate * translate, where shear is 
+
+        | 1   0   0 |
+        | xy  1   0 |
+        | xz  yz  1 |
+
+    The rotation is found by Gram-Schmidt orthogonalization of the rows of 
+    the upper 3x3, which yields scale and shear as a by-product. 
+*/
+
+#pragma once
+
+struct MatrixComponents
+{
+    double translate[3];
+    double rotate[4][4];
+    double scale[3];
+    double shear[3];
+};
+
+/**
+    Returns false if the matrix is mirrored or degenerate (its upper 3x3 has
+    a determinant <= 0), in which case the components are not valid. 
+*/
+bool            decomposeMatrix(const double *m, MatrixComponents &components);
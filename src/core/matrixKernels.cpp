@@ -0,0 +1,185 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "matrixKernels.h"
+#include "matrixKernelsImpl.h"
+#include "parallel.h"
+#include "simd.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+static const size_t MATRIX_KERNEL_GRAIN_SIZE = 1024;
+
+static const MatrixKernelTable* selectMatrixKernelTable()
+{
+    switch (simdISA())
+    {
+#if XFORM_ARRAY_X86
+        case SIMD_AVX2: return &AVX2_MATRIX_KERNELS;
+        case SIMD_SSE2: return &SSE2_MATRIX_KERNELS;
+#endif
+        default:        return &SCALAR_MATRIX_KERNELS;
+    }
+}
+
+
+static const MatrixKernelTable& matrixKernelTable()
+{
+    static const MatrixKernelTable *table = selectMatrixKernelTable();
+    return *table;
+}
+
+
+static bool isAffine(const double *m)
+{
+    return m[3] == 0.0 && m[7] == 0.0 && m[11] == 0.0 && m[15] == 1.0;
+}
+
+
+/** Inverts the upper 3x3 and transforms the negated translation by it. */
+static bool affineInverse(const double *m, double *out)
+{
+    double a = m[0], b = m[1], c = m[2];
+    double d = m[4], e = m[5], f = m[6];
+    double g = m[8], h = m[9], i = m[10];
+
+    double c00 = e * i - f * h;
+    double c10 = f * g - d * i;
+    double c20 = d * h - e * g;
+
+    double det = a * c00 + b * c10 + c * c20;
+
+    if (det == 0.0) { return false; }
+
+    double s = 1.0 / det;
+
+    double r00 = c00 * s, r01 = (c * h - b * i) * s, r02 = (b * f - c * e) * s;
+    double r10 = c10 * s, r11 = (a * i - c * g) * s, r12 = (c * d - a * f) * s;
+    double r20 = c20 * s, r21 = (b * g - a * h) * s, r22 = (a * e - b * d) * s;
+
+    double tx = m[12], ty = m[13], tz = m[14];
+
+    out[0]  = r00; out[1]  = r01; out[2]  = r02; out[3]  = 0.0;
+    out[4]  = r10; out[5]  = r11; out[6]  = r12; out[7]  = 0.0;
+    out[8]  = r20; out[9]  = r21; out[10] = r22; out[11] = 0.0;
+
+    out[12] = -(tx * r00 + ty * r10 + tz * r20);
+    out[13] = -(tx * r01 + ty * r11 + tz * r21);
+    out[14] = -(tx * r02 + ty * r12 + tz * r22);
+    out[15] = 1.0;
+
+    return true;
+}
+
+
+/** Expands the cofactors from the 2x2 minors of the top and bottom row pairs. */
+static bool generalInverse(const double *m, double *out)
+{
+    double a00 = m[0],  a01 = m[1],  a02 = m[2],  a03 = m[3];
+    double a10 = m[4],  a11 = m[5],  a12 = m[6],  a13 = m[7];
+    double a20 = m[8],  a21 = m[9],  a22 = m[10], a23 = m[11];
+    double a30 = m[12], a31 = m[13], a32 = m[14], a33 = m[15];
+
+    double s0 = a00 * a11 - a10 * a01;
+    double s1 = a00 * a12 - a10 * a02;
+    double s2 = a00 * a13 - a10 * a03;
+    double s3 = a01 * a12 - a11 * a02;
+    double s4 = a01 * a13 - a11 * a03;
+    double s5 = a02 * a13 - a12 * a03;
+
+    double c5 = a22 * a33 - a32 * a23;
+    double c4 = a21 * a33 - a31 * a23;
+    double c3 = a21 * a32 - a31 * a22;
+    double c2 = a20 * a33 - a30 * a23;
+    double c1 = a20 * a32 - a30 * a22;
+    double c0 = a20 * a31 - a30 * a21;
+
+    double det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+    if (det == 0.0) { return false; }
+
+    double s = 1.0 / det;
+
+    out[0]  = ( a11 * c5 - a12 * c4 + a13 * c3) * s;
+    out[1]  = (-a01 * c5 + a02 * c4 - a03 * c3) * s;
+    out[2]  = ( a31 * s5 - a32 * s4 + a33 * s3) * s;
+    out[3]  = (-a21 * s5 + a22 * s4 - a23 * s3) * s;
+
+    out[4]  = (-a10 * c5 + a12 * c2 - a13 * c1) * s;
+    out[5]  = ( a00 * c5 - a02 * c2 + a03 * c1) * s;
+    out[6]  = (-a30 * s5 + a32 * s2 - a33 * s1) * s;
+    out[7]  = ( a20 * s5 - a22 * s2 + a23 * s1) * s;
+
+    out[8]  = ( a10 * c4 - a11 * c2 + a13 * c0) * s;
+    out[9]  = (-a00 * c4 + a01 * c2 - a03 * c0) * s;
+    out[10] = ( a30 * s4 - a31 * s2 + a33 * s0) * s;
+    out[11] = (-a20 * s4 + a21 * s2 - a23 * s0) * s;
+
+    out[12] = (-a10 * c3 + a11 * c1 - a12 * c0) * s;
+    out[13] = ( a00 * c3 - a01 * c1 + a02 * c0) * s;
+    out[14] = (-a30 * s3 + a31 * s1 - a32 * s0) * s;
+    out[15] = ( a20 * s3 - a21 * s1 + a22 * s0) * s;
+
+    return true;
+}
+
+
+void matrixArrayMultiply(const double *m1, const double *m2, double *out, size_t numberOfMatrices)
+{
+    MatrixBinaryKernel kernel = matrixKernelTable().multiply;
+
+    parallelForRange(0, numberOfMatrices, MATRIX_KERNEL_GRAIN_SIZE, [=](size_t begin, size_t end)
+    {
+        kernel(m1, m2, out, begin, end);
+    });
+}
+
+
+void matrixArrayTranspose(const double *m, double *out, size_t numberOfMatrices)
+{
+    MatrixUnaryKernel kernel = matrixKernelTable().transpose;
+
+    parallelForRange(0, numberOfMatrices, MATRIX_KERNEL_GRAIN_SIZE, [=](size_t begin, size_t end)
+    {
+        kernel(m, out, begin, end);
+    });
+}
+
+
+void matrixArrayFastInverse(const double *m, double *out, size_t numberOfMatrices, std::vector<size_t> &singular)
+{
+    std::mutex singularMutex;
+    size_t firstSingular = singular.size();
+
+    parallelForRange(0, numberOfMatrices, MATRIX_KERNEL_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        std::vector<size_t> chunkSingular;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            const double *a = m   + i * MATRIX_SIZE;
+            double       *r = out + i * MATRIX_SIZE;
+
+            bool inverted = isAffine(a) ? affineInverse(a, r) : generalInverse(a, r);
+
+            if (!inverted)
+            {
+                chunkSingular.push_back(i);
+            }
+        }
+
+        if (!chunkSingular.empty())
+        {
+            std::lock_guard<std::mutex> lock(singularMutex);
+            singular.insert(singular.end(), chunkSingular.begin(), chunkSingular.end());
+        }
+    });
+
+    std::sort(singular.begin() + firstSingular, singular.end());
+}
@@ -0,0 +1,36 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+matrixKernels
+    Batched 4x4 matrix operations. These have no Maya dependency. Each 
+    matrix is 16 contiguous doubles in row-major order, laid out like 
+    MMatrix::matrix, so a std::vector<MMatrix> can be passed directly.
+    
+    Multiply and transpose have scalar, SSE2 and AVX2 implementations; 
+    the one matching simdISA() is chosen the first time a kernel is called.
+
+    The output may be one of the inputs.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+const size_t MATRIX_SIZE = 16;
+
+void            matrixArrayMultiply(const double *m1, const double *m2, double *out, size_t numberOfMatrices);
+void            matrixArrayTranspose(const double *m, double *out, size_t numberOfMatrices);
+
+/** 
+    Inverts the matrices using cofactors instead of Gaussian elimination. 
+    Affine matrices (last column 0, 0, 0, 1) only invert their upper 3x3. 
+    
+    The indices of singular matrices are appended to singular, and their 
+    output is left untouched so that the caller can decide what to do with 
+    them.
+*/
+void            matrixArrayFastInverse(const double *m, double *out, size_t numberOfMatrices, std::vector<size_t> &singular);
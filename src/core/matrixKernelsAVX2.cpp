@@ -0,0 +1,72 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+    AVX2 matrixKernels. This file must be compiled with AVX2 code generation enabled
+    (-mavx2 on GCC/Clang), and is only called after a CPUID check. Each row 
+    is held in one register.
+*/
+
+#include "matrixKernelsImpl.h"
+
+#if XFORM_ARRAY_X86
+
+#include <immintrin.h>
+
+static void avx2MatrixMultiply(const double *m1, const double *m2, double *out, size_t begin, size_t end)
+{
+    for (size_t n = begin; n < end; n++)
+    {
+        const double *a = m1  + n * 16;
+        const double *b = m2  + n * 16;
+        double       *r = out + n * 16;
+
+        __m256d b0 = _mm256_loadu_pd(b +  0);
+        __m256d b1 = _mm256_loadu_pd(b +  4);
+        __m256d b2 = _mm256_loadu_pd(b +  8);
+        __m256d b3 = _mm256_loadu_pd(b + 12);
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            __m256d row = _mm256_mul_pd(_mm256_set1_pd(a[i * 4 + 0]), b0);
+            row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[i * 4 + 1]), b1));
+            row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[i * 4 + 2]), b2));
+            row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[i * 4 + 3]), b3));
+
+            _mm256_storeu_pd(r + i * 4, row);
+        }
+    }
+}
+
+static void avx2MatrixTranspose(const double *m, double *out, size_t begin, size_t end)
+{
+    for (size_t n = begin; n < end; n++)
+    {
+        const double *a = m   + n * 16;
+        double       *r = out + n * 16;
+
+        __m256d r0 = _mm256_loadu_pd(a +  0);
+        __m256d r1 = _mm256_loadu_pd(a +  4);
+        __m256d r2 = _mm256_loadu_pd(a +  8);
+        __m256d r3 = _mm256_loadu_pd(a + 12);
+
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+        _mm256_storeu_pd(r +  0, _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(r +  4, _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(r +  8, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(r + 12, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+}
+
+const MatrixKernelTable AVX2_MATRIX_KERNELS = {
+    &avx2MatrixMultiply,
+    &avx2MatrixTranspose
+};
+
+#endif
@@ -0,0 +1,92 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+    Internal declarations shared by the per-instruction-set matrixKernels 
+    translation units. 
+    
+    Everything defined here is static so that each translation unit keeps 
+    its own copy, compiled for its own instruction set. 
+*/
+
+#pragma once
+
+#include "simd.h"
+
+#include <stddef.h>
+
+typedef void (*MatrixBinaryKernel)(const double *m1, const double *m2, double *out, size_t begin, size_t end);
+typedef void (*MatrixUnaryKernel)(const double *m, double *out, size_t begin, size_t end);
+
+struct MatrixKernelTable
+{
+    MatrixBinaryKernel multiply;
+    MatrixUnaryKernel  transpose;
+};
+
+extern const MatrixKernelTable SCALAR_MATRIX_KERNELS;
+
+#if XFORM_ARRAY_X86
+extern const MatrixKernelTable SSE2_MATRIX_KERNELS;
+extern const MatrixKernelTable AVX2_MATRIX_KERNELS;
+#endif
+
+/** 
+    Row i of the product is the sum of the rows of b, weighted by row i of a.
+    The SIMD kernels add the terms in the same order, so all of them give 
+    the same result.
+*/
+static inline void scalarMatrixMultiply(const double *m1, const double *m2, double *out, size_t begin, size_t end)
+{
+    for (size_t n = begin; n < end; n++)
+    {
+        const double *a = m1  + n * 16;
+        const double *b = m2  + n * 16;
+        double       *r = out + n * 16;
+
+        double result[16];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            for (size_t j = 0; j < 4; j++)
+            {
+                double sum = a[i * 4 + 0] * b[0 * 4 + j];
+                sum = sum + a[i * 4 + 1] * b[1 * 4 + j];
+                sum = sum + a[i * 4 + 2] * b[2 * 4 + j];
+                sum = sum + a[i * 4 + 3] * b[3 * 4 + j];
+                result[i * 4 + j] = sum;
+            }
+        }
+
+        for (size_t i = 0; i < 16; i++)
+        {
+            r[i] = result[i];
+        }
+    }
+}
+
+static inline void scalarMatrixTranspose(const double *m, double *out, size_t begin, size_t end)
+{
+    for (size_t n = begin; n < end; n++)
+    {
+        const double *a = m   + n * 16;
+        double       *r = out + n * 16;
+
+        double result[16];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            for (size_t j = 0; j < 4; j++)
+            {
+                result[j * 4 + i] = a[i * 4 + j];
+            }
+        }
+
+        for (size_t i = 0; i < 16; i++)
+        {
+            r[i] = result[i];
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+    SSE2 matrixKernels. SSE2 is part of the x86-64 baseline, so this file 
+    needs no extra compiler flags. Each row is held in two registers.
+*/
+
+#include "matrixKernelsImpl.h"
+
+#if XFORM_ARRAY_X86
+
+#include <emmintrin.h>
+
+static void sse2MatrixMultiply(const double *m1, const double *m2, double *out, size_t begin, size_t end)
+{
+    for (size_t n = begin; n < end; n++)
+    {
+        const double *a = m1  + n * 16;
+        const double *b = m2  + n * 16;
+        double       *r = out + n * 16;
+
+        __m128d b0lo = _mm_loadu_pd(b +  0), b0hi = _mm_loadu_pd(b +  2);
+        __m128d b1lo = _mm_loadu_pd(b +  4), b1hi = _mm_loadu_pd(b +  6);
+        __m128d b2lo = _mm_loadu_pd(b +  8), b2hi = _mm_loadu_pd(b + 10);
+        __m128d b3lo = _mm_loadu_pd(b + 12), b3hi = _mm_loadu_pd(b + 14);
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            __m128d a0 = _mm_set1_pd(a[i * 4 + 0]);
+            __m128d a1 = _mm_set1_pd(a[i * 4 + 1]);
+            __m128d a2 = _mm_set1_pd(a[i * 4 + 2]);
+            __m128d a3 = _mm_set1_pd(a[i * 4 + 3]);
+
+            __m128d lo = _mm_mul_pd(a0, b0lo);
+            lo = _mm_add_pd(lo, _mm_mul_pd(a1, b1lo));
+            lo = _mm_add_pd(lo, _mm_mul_pd(a2, b2lo));
+            lo = _mm_add_pd(lo, _mm_mul_pd(a3, b3lo));
+
+            __m128d hi = _mm_mul_pd(a0, b0hi);
+            hi = _mm_add_pd(hi, _mm_mul_pd(a1, b1hi));
+            hi = _mm_add_pd(hi, _mm_mul_pd(a2, b2hi));
+            hi = _mm_add_pd(hi, _mm_mul_pd(a3, b3hi));
+
+            _mm_storeu_pd(r + i * 4 + 0, lo);
+            _mm_storeu_pd(r + i * 4 + 2, hi);
+        }
+    }
+}
+
+/** Transposes the four 2x2 blocks and swaps the two off-diagonal ones. */
+static void sse2MatrixTranspose(const double *m, double *out, size_t begin, size_t end)
+{
+    for (size_t n = begin; n < end; n++)
+    {
+        const double *a = m   + n * 16;
+        double       *r = out + n * 16;
+
+        __m128d r0lo = _mm_loadu_pd(a +  0), r0hi = _mm_loadu_pd(a +  2);
+        __m128d r1lo = _mm_loadu_pd(a +  4), r1hi = _mm_loadu_pd(a +  6);
+        __m128d r2lo = _mm_loadu_pd(a +  8), r2hi = _mm_loadu_pd(a + 10);
+        __m128d r3lo = _mm_loadu_pd(a + 12), r3hi = _mm_loadu_pd(a + 14);
+
+        _mm_storeu_pd(r +  0, _mm_unpacklo_pd(r0lo, r1lo));
+        _mm_storeu_pd(r +  2, _mm_unpacklo_pd(r2lo, r3lo));
+        _mm_storeu_pd(r +  4, _mm_unpackhi_pd(r0lo, r1lo));
+        _mm_storeu_pd(r +  6, _mm_unpackhi_pd(r2lo, r3lo));
+        _mm_storeu_pd(r +  8, _mm_unpacklo_pd(r0hi, r1hi));
+        _mm_storeu_pd(r + 10, _mm_unpacklo_pd(r2hi, r3hi));
+        _mm_storeu_pd(r + 12, _mm_unpackhi_pd(r0hi, r1hi));
+        _mm_storeu_pd(r + 14, _mm_unpackhi_pd(r2hi, r3hi));
+    }
+}
+
+const MatrixKernelTable SSE2_MATRIX_KERNELS = {
+    &sse2MatrixMultiply,
+    &sse2MatrixTranspose
+};
+
+#endif
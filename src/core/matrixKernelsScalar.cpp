@@ -0,0 +1,11 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "matrixKernelsImpl.h"
+
+const MatrixKernelTable SCALAR_MATRIX_KERNELS = {
+    &scalarMatrixMultiply,
+    &scalarMatrixTranspose
+};
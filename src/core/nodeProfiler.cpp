@@ -0,0 +1,232 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "nodeProfiler.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct TraceEvent
+{
+    const void*     node;
+    unsigned        threadIndex;
+    double          start;
+    double          duration;
+};
+
+
+std::atomic<bool> profilerEnabledFlag(false);
+
+static std::mutex                                       profilerMutex;
+static std::unordered_map<const void*, NodeProfile>     profilerTotals;
+static std::vector<TraceEvent>                          traceEvents;
+static std::chrono::steady_clock::time_point            traceStartTime = std::chrono::steady_clock::now();
+
+static std::atomic<unsigned>                            nextThreadIndex(0);
+
+static thread_local ComputeProfile*                     currentProfile = nullptr;
+
+
+/** Small, stable ids for the trace viewer's thread rows. */
+static unsigned threadIndex()
+{
+    static thread_local unsigned index = nextThreadIndex++;
+    return index;
+}
+
+
+static double secondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double>(end - start).count();
+}
+
+
+/** Escapes a string for a JSON string literal. */
+static std::string jsonString(const std::string &value)
+{
+    std::string result;
+    result.reserve(value.size() + 2);
+    result += '"';
+
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n";  break;
+            case '\t': result += "\\t";  break;
+            default:
+                if ((unsigned char) c < 0x20)
+                {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned) c);
+                    result += escaped;
+                } else {
+                    result += c;
+                }
+        }
+    }
+
+    result += '"';
+    return result;
+}
+
+
+void setProfilerEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+
+    if (enabled && !profilerEnabled())
+    {
+        traceEvents.clear();
+        traceStartTime = std::chrono::steady_clock::now();
+    }
+
+    profilerEnabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+
+void resetProfiler()
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+
+    profilerTotals.clear();
+    traceEvents.clear();
+    traceStartTime = std::chrono::steady_clock::now();
+}
+
+
+std::vector<std::pair<const void*, NodeProfile>> profilerRecords()
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+
+    return std::vector<std::pair<const void*, NodeProfile>>(profilerTotals.begin(), profilerTotals.end());
+}
+
+
+bool writeProfilerTrace(
+    const std::string &path, 
+    const std::function<std::string(const void*)> &nodeName,
+    const std::function<std::string(const void*)> &nodeType
+) {
+    std::vector<TraceEvent> events;
+
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        events = traceEvents;
+    }
+
+    FILE *file = fopen(path.c_str(), "w");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    // The name and category of each node instance, as JSON strings.
+    std::unordered_map<const void*, std::pair<std::string, std::string>> names;
+
+    fprintf(file, "{\"traceEvents\": [\n");
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const TraceEvent &event = events[i];
+
+        auto name = names.find(event.node);
+
+        if (name == names.end())
+        {
+            std::pair<std::string, std::string> value(jsonString(nodeName(event.node)), jsonString(nodeType(event.node)));
+            name = names.insert(std::make_pair(event.node, value)).first;
+        }
+
+        fprintf(
+            file,
+            "  {\"name\": %s, \"cat\": %s, \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 0, \"tid\": %u}%s\n",
+            name->second.first.c_str(),
+            name->second.second.c_str(),
+            event.start * 1e6,
+            event.duration * 1e6,
+            event.threadIndex,
+            i + 1 < events.size() ? "," : ""
+        );
+    }
+
+    fprintf(file, "], \"displayTimeUnit\": \"ms\"}\n");
+
+    return fclose(file) == 0;
+}
+
+
+void recordInputElements(size_t count)
+{
+    if (currentProfile != nullptr) { currentProfile->inputElements += count; }
+}
+
+
+void recordOutputElements(size_t count)
+{
+    if (currentProfile != nullptr) { currentProfile->outputElements += count; }
+}
+
+
+void recordAllocation(size_t bytes)
+{
+    if (currentProfile != nullptr) { currentProfile->bytesAllocated += bytes; }
+}
+
+
+void ComputeProfile::begin()
+{
+    isActive = true;
+    parent = currentProfile;
+    currentProfile = this;
+    startTime = std::chrono::steady_clock::now();
+}
+
+
+void ComputeProfile::end()
+{
+    std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+    double duration = secondsBetween(startTime, endTime);
+
+    currentProfile = parent;
+
+    if (parent != nullptr)
+    {
+        parent->nestedSeconds += duration;
+    }
+
+    std::lock_guard<std::mutex> lock(profilerMutex);
+
+    NodeProfile &total = profilerTotals[node];
+    total.computeCount   += 1;
+    total.seconds        += duration - nestedSeconds;
+    total.inputElements  += inputElements;
+    total.outputElements += outputElements;
+    total.bytesAllocated += bytesAllocated;
+
+    if (traceEvents.size() < MAX_TRACE_EVENTS)
+    {
+        TraceEvent event = {
+            node,
+            threadIndex(),
+            secondsBetween(traceStartTime, startTime),
+            duration
+        };
+
+        traceEvents.push_back(event);
+    }
+}
@@ -0,0 +1,109 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+nodeProfiler
+    Opt-in timing of node computes. These have no Maya dependency.
+
+    Each compute opens a ComputeProfile. While profiling is enabled it
+    records the wall time of the compute, and the array helpers in nodeData
+    add the elements read and written and the bytes allocated for array
+    data. Totals are kept per node instance, and each compute is also kept
+    as a trace event that can be written as Chrome trace JSON
+    (chrome://tracing, or https://ui.perfetto.dev).
+
+    Computes nest when Maya evaluates an upstream node from inside a
+    compute. The totals count the time of each compute without its nested
+    computes; trace events keep the full duration, so they nest in the
+    trace viewer.
+
+    When profiling is disabled, every entry point returns after a single
+    relaxed atomic load.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Trace events past this many are dropped, so a long session cannot exhaust memory. */
+const size_t MAX_TRACE_EVENTS = 1 << 20;
+
+struct NodeProfile
+{
+    size_t          computeCount   = 0;
+    double          seconds        = 0.0;
+    size_t          inputElements  = 0;
+    size_t          outputElements = 0;
+    size_t          bytesAllocated = 0;
+};
+
+extern std::atomic<bool> profilerEnabledFlag;
+
+inline bool     profilerEnabled() { return profilerEnabledFlag.load(std::memory_order_relaxed); }
+
+/** Enabling starts a new trace clock; recorded totals are kept until resetProfiler. */
+void            setProfilerEnabled(bool enabled);
+void            resetProfiler();
+
+/** Returns the totals of every node instance that has computed since the last reset. */
+std::vector<std::pair<const void*, NodeProfile>> profilerRecords();
+
+/**
+    Writes the trace events as Chrome trace JSON. nodeName and nodeType 
+    describe a node instance, and are called once per instance. Returns 
+    false if the file cannot be written.
+*/
+bool            writeProfilerTrace(
+                    const std::string &path, 
+                    const std::function<std::string(const void*)> &nodeName,
+                    const std::function<std::string(const void*)> &nodeType
+                );
+
+void            recordInputElements(size_t count);
+void            recordOutputElements(size_t count);
+void            recordAllocation(size_t bytes);
+
+/** Adds to the compute running on this thread. Does nothing outside a profiled compute. */
+inline void     profileInputElements(size_t count)  { if (profilerEnabled()) { recordInputElements(count); } }
+inline void     profileOutputElements(size_t count) { if (profilerEnabled()) { recordOutputElements(count); } }
+inline void     profileAllocation(size_t bytes)     { if (profilerEnabled()) { recordAllocation(bytes); } }
+
+/** Profiles a compute for as long as it is in scope. */
+class ComputeProfile
+{
+public:
+    explicit        ComputeProfile(const void *node) : node(node) { if (profilerEnabled()) { this->begin(); } }
+                    ~ComputeProfile() { if (isActive) { this->end(); } }
+
+                    ComputeProfile(const ComputeProfile&) = delete;
+    ComputeProfile& operator=(const ComputeProfile&) = delete;
+
+private:
+    void            begin();
+    void            end();
+
+private:
+    friend void     recordInputElements(size_t count);
+    friend void     recordOutputElements(size_t count);
+    friend void     recordAllocation(size_t bytes);
+
+    const void*     node;
+    bool            isActive = false;
+
+    ComputeProfile* parent = nullptr;
+
+    std::chrono::steady_clock::time_point startTime;
+    double          nestedSeconds  = 0.0;
+    size_t          inputElements  = 0;
+    size_t          outputElements = 0;
+    size_t          bytesAllocated = 0;
+};
@@ -0,0 +1,145 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "packKernels.h"
+#include "arrayView.h"
+#include "parallel.h"
+#include "xformTypes.h"
+
+#include <algorithm>
+
+static inline double component(ArrayView<double> values, size_t i, double fillValue)
+{
+    return i < values.size() ? values[i] : fillValue;
+}
+
+
+static inline Vector3 row(ArrayView<Vector3> values, size_t i, double x, double y, double z)
+{
+    Vector3 fillValue = { x, y, z };
+    return i < values.size() ? values[i] : fillValue;
+}
+
+
+void packVectorArray(
+    ArrayView<double> x, 
+    ArrayView<double> y, 
+    ArrayView<double> z, 
+    const Vector3 &fillValue, 
+    Vector3 *out, 
+    size_t n
+) {
+    parallelFor(0, n, [&](size_t i)
+    {
+        Vector3 v = {
+            component(x, i, fillValue.x),
+            component(y, i, fillValue.y),
+            component(z, i, fillValue.z)
+        };
+
+        out[i] = v;
+    });
+}
+
+
+void packQuatArray(
+    ArrayView<double> x, 
+    ArrayView<double> y, 
+    ArrayView<double> z, 
+    ArrayView<double> w, 
+    const Quaternion &fillValue, 
+    Quaternion *out, 
+    size_t n
+) {
+    parallelFor(0, n, [&](size_t i)
+    {
+        Quaternion q = {
+            component(x, i, fillValue.x),
+            component(y, i, fillValue.y),
+            component(z, i, fillValue.z),
+            component(w, i, fillValue.w)
+        };
+
+        out[i] = q;
+    });
+}
+
+
+void packMatrixArray(
+    ArrayView<Vector3> row0, 
+    ArrayView<Vector3> row1, 
+    ArrayView<Vector3> row2, 
+    ArrayView<Vector3> row3, 
+    const Matrix4 &fillValue, 
+    Matrix4 *out, 
+    size_t n
+) {
+    size_t numberOfInputs = std::max(std::max(row0.size(), row1.size()), std::max(row2.size(), row3.size()));
+
+    parallelFor(0, n, [&](size_t i)
+    {
+        if (i >= numberOfInputs)
+        {
+            out[i] = fillValue;
+            return;
+        }
+
+        Vector3 r0 = row(row0, i, 1.0, 0.0, 0.0);
+        Vector3 r1 = row(row1, i, 0.0, 1.0, 0.0);
+        Vector3 r2 = row(row2, i, 0.0, 0.0, 1.0);
+        Vector3 r3 = row(row3, i, 0.0, 0.0, 0.0);
+
+        Matrix4 m = {{
+            {r0.x, r0.y, r0.z, 0.0},
+            {r1.x, r1.y, r1.z, 0.0},
+            {r2.x, r2.y, r2.z, 0.0},
+            {r3.x, r3.y, r3.z, 1.0}
+        }};
+
+        out[i] = m;
+    });
+}
+
+
+void unpackVectorArray(ArrayView<Vector3> v, double *x, double *y, double *z)
+{
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        x[i] = v[i].x;
+        y[i] = v[i].y;
+        z[i] = v[i].z;
+    });
+}
+
+
+void unpackQuatArray(ArrayView<Quaternion> q, double *x, double *y, double *z, double *w)
+{
+    parallelFor(0, q.size(), [&](size_t i)
+    {
+        x[i] = q[i].x;
+        y[i] = q[i].y;
+        z[i] = q[i].z;
+        w[i] = q[i].w;
+    });
+}
+
+
+void unpackMatrixArray(ArrayView<Matrix4> m, Vector3 *row0, Vector3 *row1, Vector3 *row2, Vector3 *row3)
+{
+    parallelFor(0, m.size(), [&](size_t i)
+    {
+        const double (*r)[4] = m[i].m;
+
+        Vector3 r0 = { r[0][0], r[0][1], r[0][2] };
+        Vector3 r1 = { r[1][0], r[1][1], r[1][2] };
+        Vector3 r2 = { r[2][0], r[2][1], r[2][2] };
+        Vector3 r3 = { r[3][0], r[3][1], r[3][2] };
+
+        row0[i] = r0;
+        row1[i] = r1;
+        row2[i] = r2;
+        row3[i] = r3;
+    });
+}
@@ -0,0 +1,57 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+packKernels
+    Conversions between arrays of vectors, quaternions or matrices and 
+    arrays of their components, behind the pack and unpack nodes. These 
+    have no Maya dependency.
+
+    Pack kernels write n elements. Elements past the end of every input are
+    fillValue. Where only some inputs run out, vector and quaternion 
+    components come from fillValue, and matrix rows come from the identity 
+    (with a zero translation).
+*/
+
+#pragma once
+
+#include "arrayView.h"
+#include "xformTypes.h"
+
+#include <stddef.h>
+
+void            packVectorArray(
+                    ArrayView<double> x, 
+                    ArrayView<double> y, 
+                    ArrayView<double> z, 
+                    const Vector3 &fillValue, 
+                    Vector3 *out, 
+                    size_t n
+                );
+
+void            packQuatArray(
+                    ArrayView<double> x, 
+                    ArrayView<double> y, 
+                    ArrayView<double> z, 
+                    ArrayView<double> w, 
+                    const Quaternion &fillValue, 
+                    Quaternion *out, 
+                    size_t n
+                );
+
+void            packMatrixArray(
+                    ArrayView<Vector3> row0, 
+                    ArrayView<Vector3> row1, 
+                    ArrayView<Vector3> row2, 
+                    ArrayView<Vector3> row3, 
+                    const Matrix4 &fillValue, 
+                    Matrix4 *out, 
+                    size_t n
+                );
+
+/** Each output holds v.size() components. */
+void            unpackVectorArray(ArrayView<Vector3> v, double *x, double *y, double *z);
+void            unpackQuatArray(ArrayView<Quaternion> q, double *x, double *y, double *z, double *w);
+void            unpackMatrixArray(ArrayView<Matrix4> m, Vector3 *row0, Vector3 *row1, Vector3 *row2, Vector3 *row3);
@@ -0,0 +1,317 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "parallel.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ParallelJob
+{
+    const std::function<void(size_t, size_t)> *body;
+
+    size_t begin;
+    size_t end;
+    size_t grainSize;
+    size_t numberOfChunks;
+
+    std::atomic<size_t> nextChunk;
+    std::atomic<size_t> finishedChunks;
+
+    std::mutex doneMutex;
+    std::condition_variable done;
+
+    std::exception_ptr error;
+};
+
+
+class WorkerPool
+{
+public:
+                    ~WorkerPool();
+
+    void            run(const std::shared_ptr<ParallelJob> &job);
+    void            start(unsigned numberOfWorkers);
+    void            stop();
+
+private:
+    void            workerLoop();
+    void            removeJob(const std::shared_ptr<ParallelJob> &job);
+
+private:
+    std::mutex                              mutex;
+    std::condition_variable                 wake;
+    std::deque<std::shared_ptr<ParallelJob>> jobs;
+    std::vector<std::thread>                workers;
+    bool                                    stopping = false;
+
+    std::mutex                              resizeMutex;
+};
+
+
+static unsigned defaultThreadLimit()
+{
+    const char *requested = getenv("XFORM_ARRAY_THREADS");
+
+    if (requested != NULL)
+    {
+        int limit = atoi(requested);
+
+        if (limit > 0) 
+        { 
+            return (unsigned) limit; 
+        }
+    }
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+static std::atomic<unsigned>& threadLimit()
+{
+    static std::atomic<unsigned> limit(defaultThreadLimit());
+    return limit;
+}
+
+
+static std::atomic<size_t>& serialCutoff()
+{
+    static std::atomic<size_t> cutoff(DEFAULT_SERIAL_CUTOFF);
+    return cutoff;
+}
+
+
+static WorkerPool& workerPool()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+
+/** Runs chunks of the job until there are none left to claim. */
+static void runChunks(ParallelJob &job)
+{
+    size_t chunk;
+
+    while ((chunk = job.nextChunk.fetch_add(1)) < job.numberOfChunks)
+    {
+        size_t chunkBegin = job.begin + chunk * job.grainSize;
+        size_t chunkEnd   = std::min(job.end, chunkBegin + job.grainSize);
+
+        try
+        {
+            (*job.body)(chunkBegin, chunkEnd);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.doneMutex);
+            if (!job.error) { job.error = std::current_exception(); }
+        }
+
+        if (job.finishedChunks.fetch_add(1) + 1 == job.numberOfChunks)
+        {
+            std::lock_guard<std::mutex> lock(job.doneMutex);
+            job.done.notify_all();
+        }
+    }
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    this->stop();
+}
+
+
+void WorkerPool::run(const std::shared_ptr<ParallelJob> &job)
+{
+    unsigned numberOfWorkers = threadLimit() - 1;
+    bool isResizeRequired = false;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        isResizeRequired = this->workers.size() != numberOfWorkers;
+    }
+
+    if (isResizeRequired)
+    {
+        this->start(numberOfWorkers);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->jobs.push_back(job);
+        this->wake.notify_all();
+    }
+
+    runChunks(*job);
+
+    {
+        std::unique_lock<std::mutex> lock(job->doneMutex);
+        job->done.wait(lock, [&job]() { return job->finishedChunks == job->numberOfChunks; });
+    }
+
+    this->removeJob(job);
+
+    if (job->error)
+    {
+        std::rethrow_exception(job->error);
+    }
+}
+
+
+void WorkerPool::start(unsigned numberOfWorkers)
+{
+    std::lock_guard<std::mutex> resizeLock(this->resizeMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->workers.size() == numberOfWorkers) 
+        { 
+            return; 
+        }
+    }
+
+    this->stop();
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    
+    for (unsigned i = 0; i < numberOfWorkers; i++)
+    {
+        this->workers.push_back(std::thread(&WorkerPool::workerLoop, this));
+    }
+}
+
+
+void WorkerPool::stop()
+{
+    std::vector<std::thread> stoppedWorkers;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+        this->workers.swap(stoppedWorkers);
+        this->wake.notify_all();
+    }
+
+    for (std::thread &worker : stoppedWorkers)
+    {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = false;
+}
+
+
+void WorkerPool::workerLoop()
+{
+    while (true)
+    {
+        std::shared_ptr<ParallelJob> job;
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wake.wait(lock, [this]() { return this->stopping || !this->jobs.empty(); });
+
+            if (this->stopping) 
+            { 
+                return; 
+            }
+
+            job = this->jobs.front();
+        }
+
+        runChunks(*job);
+        this->removeJob(job);
+    }
+}
+
+
+void WorkerPool::removeJob(const std::shared_ptr<ParallelJob> &job)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    auto it = std::find(this->jobs.begin(), this->jobs.end(), job);
+
+    if (it != this->jobs.end())
+    {
+        this->jobs.erase(it);
+    }
+}
+
+
+unsigned parallelThreadLimit()
+{
+    return threadLimit();
+}
+
+
+void setParallelThreadLimit(unsigned limit)
+{
+    threadLimit() = limit == 0 ? std::max(1u, std::thread::hardware_concurrency()) : limit;
+}
+
+
+size_t parallelSerialCutoff()
+{
+    return serialCutoff();
+}
+
+
+void setParallelSerialCutoff(size_t cutoff)
+{
+    serialCutoff() = cutoff;
+}
+
+
+void stopParallelWorkers()
+{
+    workerPool().stop();
+}
+
+
+void parallelForRange(
+    size_t begin, 
+    size_t end, 
+    size_t grainSize, 
+    const std::function<void(size_t, size_t)> &body
+) {
+    if (end <= begin) 
+    { 
+        return; 
+    }
+
+    grainSize = std::max((size_t) 1, grainSize);
+
+    size_t count = end - begin;
+
+    if (count < serialCutoff() || count <= grainSize || threadLimit() <= 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    std::shared_ptr<ParallelJob> job = std::make_shared<ParallelJob>();
+    job->body           = &body;
+    job->begin          = begin;
+    job->end            = end;
+    job->grainSize      = grainSize;
+    job->numberOfChunks = (count + grainSize - 1) / grainSize;
+    job->nextChunk      = 0;
+    job->finishedChunks = 0;
+
+    workerPool().run(job);
+}
@@ -0,0 +1,65 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+parallel
+    Chunked parallel-for over an index range, backed by a pool of worker 
+    threads shared by every node in the plugin. These have no Maya 
+    dependency.
+
+    The range is split into chunks of grainSize indices. The calling thread
+    works on its own chunks too, so nested or concurrent calls (for example
+    from Maya's parallel evaluation) cannot deadlock.
+
+    Ranges shorter than the serial cutoff run inline on the calling thread.
+
+    The thread limit counts the calling thread. It defaults to the number of
+    hardware threads, and can be set with the XFORM_ARRAY_THREADS environment
+    variable or the xformArrayOptions command. A limit of 1 disables 
+    threading.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <functional>
+
+const size_t DEFAULT_GRAIN_SIZE    = 1024;
+const size_t DEFAULT_SERIAL_CUTOFF = 4096;
+
+unsigned        parallelThreadLimit();
+void            setParallelThreadLimit(unsigned limit);
+
+size_t          parallelSerialCutoff();
+void            setParallelSerialCutoff(size_t cutoff);
+
+/** Joins the worker threads. They are restarted by the next parallel call. */
+void            stopParallelWorkers();
+
+/** Calls body(chunkBegin, chunkEnd) for each chunk of [begin, end). */
+void            parallelForRange(
+                    size_t begin, 
+                    size_t end, 
+                    size_t grainSize, 
+                    const std::function<void(size_t, size_t)> &body
+                );
+
+/** Calls body(i) for each i in [begin, end). */
+template <typename FUNC>
+void parallelFor(size_t begin, size_t end, const FUNC &body, size_t grainSize=DEFAULT_GRAIN_SIZE)
+{
+    parallelForRange(
+        begin, 
+        end, 
+        grainSize, 
+        [&body](size_t chunkBegin, size_t chunkEnd)
+        {
+            for (size_t i = chunkBegin; i < chunkEnd; i++)
+            {
+                body(i);
+            }
+        }
+    );
+}
@@ -0,0 +1,522 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "quatCodec.h"
+#include "xformTypes.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/** Largest magnitude of any component other than the largest, in a unit quaternion. */
+static const double SMALLEST_THREE_RANGE = 0.70710678118654752440;
+
+static QuatEncoding defaultQuatEncoding()
+{
+    const char *requested = getenv("XFORM_ARRAY_QUAT_ENCODING");
+
+    if (requested != NULL)
+    {
+        if (strcmp(requested, "lossless") == 0)      { return QUAT_ENCODING_LOSSLESS; }
+        if (strcmp(requested, "smallestThree") == 0) { return QUAT_ENCODING_SMALLEST_THREE; }
+    }
+
+    return QUAT_ENCODING_RAW;
+}
+
+
+static unsigned clampQuatEncodingBits(unsigned bits)
+{
+    return std::min(std::max(bits, QUAT_ENCODING_MIN_BITS), QUAT_ENCODING_MAX_BITS);
+}
+
+
+static unsigned defaultQuatEncodingBits()
+{
+    const char *requested = getenv("XFORM_ARRAY_QUAT_BITS");
+    int bits = requested != NULL ? atoi(requested) : 0;
+
+    return bits > 0 ? clampQuatEncodingBits((unsigned) bits) : QUAT_ENCODING_DEFAULT_BITS;
+}
+
+
+static std::atomic<int>      quatEncodingValue((int) defaultQuatEncoding());
+static std::atomic<unsigned> quatEncodingBitsValue(defaultQuatEncodingBits());
+
+
+QuatEncoding quatEncoding()
+{
+    return (QuatEncoding) quatEncodingValue.load(std::memory_order_relaxed);
+}
+
+
+unsigned quatEncodingBits()
+{
+    return quatEncodingBitsValue.load(std::memory_order_relaxed);
+}
+
+
+void setQuatEncoding(QuatEncoding encoding)
+{
+    quatEncodingValue.store((int) encoding, std::memory_order_relaxed);
+}
+
+
+void setQuatEncodingBits(unsigned bits)
+{
+    quatEncodingBitsValue.store(clampQuatEncodingBits(bits), std::memory_order_relaxed);
+}
+
+
+/** 
+    Packs values of up to 32 bits into a fixed number of bytes, lowest bit
+    first. Writing past the end writes nothing, and failed() returns true
+    from then on.
+*/
+class BitWriter
+{
+public:
+    BitWriter(uint8_t *bytes, size_t numberOfBytes) :
+        begin(bytes),
+        next(bytes),
+        end(bytes + numberOfBytes),
+        buffer(0),
+        count(0),
+        isPastEnd(false)
+    {}
+
+    void write(uint64_t value, unsigned numberOfBits)
+    {
+        this->buffer |= (value & ((1ULL << numberOfBits) - 1)) << this->count;
+        this->count += numberOfBits;
+
+        if (this->count >= 32)
+        {
+            this->flushBytes(4);
+        }
+    }
+
+    /** Writes any bits still buffered, and returns the number of bytes written. */
+    size_t finish()
+    {
+        this->flushBytes((this->count + 7) / 8);
+        return (size_t) (this->next - this->begin);
+    }
+
+    bool failed() const { return this->isPastEnd; }
+
+private:
+    void flushBytes(unsigned numberOfBytes)
+    {
+        if ((size_t) (this->end - this->next) < numberOfBytes)
+        {
+            this->isPastEnd = true;
+            this->next = this->end;
+        } else {
+            for (unsigned i = 0; i < numberOfBytes; i++)
+            {
+                *this->next++ = (uint8_t) (this->buffer >> (8 * i));
+            }
+        }
+
+        this->buffer = numberOfBytes < 8 ? this->buffer >> (8 * numberOfBytes) : 0;
+        this->count = this->count > 8 * numberOfBytes ? this->count - 8 * numberOfBytes : 0;
+    }
+
+private:
+    uint8_t        *begin;
+    uint8_t        *next;
+    uint8_t        *end;
+    uint64_t        buffer;
+    unsigned        count;
+    bool            isPastEnd;
+};
+
+
+/** Reads values written by BitWriter. Reading past the end returns 0, and failed() returns true from then on. */
+class BitReader
+{
+public:
+    BitReader(const uint8_t *bytes, size_t numberOfBytes) :
+        next(bytes),
+        end(bytes + numberOfBytes),
+        buffer(0),
+        count(0),
+        isPastEnd(false)
+    {}
+
+    uint64_t read(unsigned numberOfBits)
+    {
+        if (this->count < numberOfBits && this->end - this->next >= 4)
+        {
+            uint64_t word = (
+                (uint64_t) this->next[0] | 
+                ((uint64_t) this->next[1] << 8) | 
+                ((uint64_t) this->next[2] << 16) | 
+                ((uint64_t) this->next[3] << 24)
+            );
+
+            this->buffer |= word << this->count;
+            this->count += 32;
+            this->next += 4;
+        }
+
+        while (this->count < numberOfBits)
+        {
+            if (this->next == this->end)
+            {
+                this->isPastEnd = true;
+                return 0;
+            }
+
+            this->buffer |= (uint64_t) *this->next++ << this->count;
+            this->count += 8;
+        }
+
+        uint64_t value = this->buffer & ((1ULL << numberOfBits) - 1);
+        this->buffer >>= numberOfBits;
+        this->count -= numberOfBits;
+
+        return value;
+    }
+
+    bool failed() const { return this->isPastEnd; }
+
+    /** Returns the number of bits not read yet. */
+    size_t remainingBits() const { return (size_t) (this->end - this->next) * 8 + this->count; }
+
+private:
+    const uint8_t  *next;
+    const uint8_t  *end;
+    uint64_t        buffer;
+    unsigned        count;
+    bool            isPastEnd;
+};
+
+
+static unsigned leadingZeros(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (unsigned) index;
+#else
+    return (unsigned) __builtin_clzll(value);
+#endif
+}
+
+
+static unsigned trailingZeros(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (unsigned) index;
+#else
+    return (unsigned) __builtin_ctzll(value);
+#endif
+}
+
+
+static uint64_t doubleBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+static double bitsDouble(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+/**
+    Each changed component is written as a 1, the number of leading zero
+    bits of its XOR with the previous value (6 bits), the number of bits
+    between the leading and trailing zeros less one (6 bits), and those
+    bits. An unchanged component is written as a 0.
+
+    Returns the number of bytes written, or 0 if they would not fit in
+    numberOfBytes.
+*/
+static size_t encodeLossless(const Quaternion *q, size_t n, uint8_t *bytes, size_t numberOfBytes)
+{
+    BitWriter writer(bytes, numberOfBytes);
+    uint64_t previous[4] = {0, 0, 0, 0};
+
+    for (size_t i = 0; i < n && !writer.failed(); i++)
+    {
+        const double *c = &q[i].x;
+
+        for (int j = 0; j < 4; j++)
+        {
+            uint64_t bits = doubleBits(c[j]);
+            uint64_t delta = bits ^ previous[j];
+            previous[j] = bits;
+
+            if (delta == 0)
+            {
+                writer.write(0, 1);
+                continue;
+            }
+
+            unsigned leading = leadingZeros(delta);
+            unsigned trailing = trailingZeros(delta);
+            unsigned meaningful = 64 - leading - trailing;
+            uint64_t value = delta >> trailing;
+
+            writer.write(1 | (leading << 1) | ((meaningful - 1) << 7), 13);
+
+            if (meaningful > 32)
+            {
+                writer.write(value, 32);
+                writer.write(value >> 32, meaningful - 32);
+            } else {
+                writer.write(value, meaningful);
+            }
+        }
+    }
+
+    size_t numberOfBytesWritten = writer.finish();
+
+    return writer.failed() ? 0 : numberOfBytesWritten;
+}
+
+
+static bool decodeLossless(const uint8_t *bytes, size_t numberOfBytes, Quaternion *q, size_t n)
+{
+    BitReader reader(bytes, numberOfBytes);
+    uint64_t previous[4] = {0, 0, 0, 0};
+
+    for (size_t i = 0; i < n && !reader.failed(); i++)
+    {
+        double *c = &q[i].x;
+
+        for (int j = 0; j < 4; j++)
+        {
+            if (reader.read(1) != 0)
+            {
+                unsigned leading = (unsigned) reader.read(6);
+                unsigned meaningful = (unsigned) reader.read(6) + 1;
+
+                if (leading + meaningful > 64)
+                {
+                    return false;
+                }
+
+                uint64_t value = 0;
+
+                if (meaningful > 32)
+                {
+                    value = reader.read(32);
+                    value |= reader.read(meaningful - 32) << 32;
+                } else {
+                    value = reader.read(meaningful);
+                }
+
+                previous[j] ^= value << (64 - leading - meaningful);
+            }
+
+            c[j] = bitsDouble(previous[j]);
+        }
+    }
+
+    // Only the padding of the last byte may be left over.
+    return !reader.failed() && reader.remainingBits() < 8;
+}
+
+
+static bool isUnitQuaternion(const Quaternion &q)
+{
+    double lengthSquared = (q.x * q.x) + (q.y * q.y) + (q.z * q.z) + (q.w * q.w);
+
+    // Written so that NaN fails the test.
+    return fabs(lengthSquared - 1.0) <= QUAT_UNIT_TOLERANCE;
+}
+
+
+/** Returns the number of bytes that smallest-three encodes n quaternions to. */
+static size_t smallestThreeBytes(size_t n, unsigned bits)
+{
+    return (n * (3 + 3 * bits) + 7) / 8;
+}
+
+
+static void encodeSmallestThree(const Quaternion *q, size_t n, unsigned bits, uint8_t *bytes)
+{
+    BitWriter writer(bytes, smallestThreeBytes(n, bits));
+
+    const double maxQuantized = (double) ((1ULL << bits) - 1);
+    const double scale = maxQuantized / (2.0 * SMALLEST_THREE_RANGE);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const double *c = &q[i].x;
+        int largest = 0;
+
+        for (int j = 1; j < 4; j++)
+        {
+            if (fabs(c[j]) > fabs(c[largest])) { largest = j; }
+        }
+
+        writer.write((uint64_t) largest | ((c[largest] < 0.0 ? 1ULL : 0ULL) << 2), 3);
+
+        for (int j = 0; j < 4; j++)
+        {
+            if (j == largest) { continue; }
+
+            double quantized = floor((c[j] + SMALLEST_THREE_RANGE) * scale + 0.5);
+            quantized = std::min(std::max(quantized, 0.0), maxQuantized);
+
+            writer.write((uint64_t) quantized, bits);
+        }
+    }
+
+    writer.finish();
+}
+
+
+static bool decodeSmallestThree(const uint8_t *bytes, size_t numberOfBytes, unsigned bits, Quaternion *q, size_t n)
+{
+    BitReader reader(bytes, numberOfBytes);
+
+    const double maxQuantized = (double) ((1ULL << bits) - 1);
+    const double step = (2.0 * SMALLEST_THREE_RANGE) / maxQuantized;
+
+    for (size_t i = 0; i < n && !reader.failed(); i++)
+    {
+        double *c = &q[i].x;
+
+        unsigned header = (unsigned) reader.read(3);
+        unsigned largest = header & 3;
+        bool isNegative = (header & 4) != 0;
+
+        double lengthSquared = 0.0;
+
+        for (unsigned j = 0; j < 4; j++)
+        {
+            if (j == largest) { continue; }
+
+            c[j] = (double) reader.read(bits) * step - SMALLEST_THREE_RANGE;
+            lengthSquared += c[j] * c[j];
+        }
+
+        double value = sqrt(std::max(0.0, 1.0 - lengthSquared));
+        c[largest] = isNegative ? -value : value;
+    }
+
+    return !reader.failed();
+}
+
+
+QuatEncoding encodeQuaternions(const Quaternion *q, size_t n, QuatEncoding encoding, unsigned bits, std::vector<uint8_t> &bytes)
+{
+    size_t rawBytes = n * sizeof(Quaternion);
+    size_t start = bytes.size();
+
+    if (n == 0)
+    {
+        return encoding;
+    }
+
+    if (encoding == QUAT_ENCODING_SMALLEST_THREE)
+    {
+        if (std::all_of(q, q + n, isUnitQuaternion))
+        {
+            bits = clampQuatEncodingBits(bits);
+
+            bytes.resize(start + smallestThreeBytes(n, bits));
+            encodeSmallestThree(q, n, bits, bytes.data() + start);
+
+            return QUAT_ENCODING_SMALLEST_THREE;
+        }
+
+        encoding = QUAT_ENCODING_LOSSLESS;
+    }
+
+    if (encoding == QUAT_ENCODING_LOSSLESS)
+    {
+        // Lossless output is only kept if it is smaller than the raw values.
+        bytes.resize(start + rawBytes);
+        size_t numberOfBytes = encodeLossless(q, n, bytes.data() + start, rawBytes - 1);
+
+        if (numberOfBytes > 0)
+        {
+            bytes.resize(start + numberOfBytes);
+            return QUAT_ENCODING_LOSSLESS;
+        }
+    }
+
+    bytes.resize(start + rawBytes);
+
+    memcpy(bytes.data() + start, q, rawBytes);
+
+    return QUAT_ENCODING_RAW;
+}
+
+
+bool decodeQuaternions(const uint8_t *bytes, size_t numberOfBytes, QuatEncoding encoding, unsigned bits, Quaternion *q, size_t n)
+{
+    switch (encoding)
+    {
+        case QUAT_ENCODING_RAW:
+            if (numberOfBytes != n * sizeof(Quaternion)) { return false; }
+            if (n > 0) { memcpy(q, bytes, numberOfBytes); }
+            return true;
+
+        case QUAT_ENCODING_LOSSLESS:
+            return decodeLossless(bytes, numberOfBytes, q, n);
+
+        case QUAT_ENCODING_SMALLEST_THREE:
+            if (bits < QUAT_ENCODING_MIN_BITS || bits > QUAT_ENCODING_MAX_BITS) { return false; }
+            if (numberOfBytes != smallestThreeBytes(n, bits)) { return false; }
+            return decodeSmallestThree(bytes, numberOfBytes, bits, q, n);
+    }
+
+    return false;
+}
+
+
+bool isValidQuatEncodingHeader(const QuatEncodingHeader &header, size_t numberOfBytesAvailable)
+{
+    size_t numberOfItems = (size_t) header.numberOfItems;
+    size_t numberOfBytes = (size_t) header.numberOfBytes;
+
+    if (numberOfBytes > numberOfBytesAvailable)
+    {
+        return false;
+    }
+
+    switch (header.encoding)
+    {
+        case QUAT_ENCODING_RAW:
+            return numberOfBytes == numberOfItems * sizeof(Quaternion);
+
+        case QUAT_ENCODING_LOSSLESS:
+            // Every quaternion takes at least four bits, one per unchanged component.
+            return numberOfItems <= numberOfBytes * 2;
+
+        case QUAT_ENCODING_SMALLEST_THREE:
+            return header.bits >= QUAT_ENCODING_MIN_BITS 
+                && header.bits <= QUAT_ENCODING_MAX_BITS
+                && numberOfBytes == smallestThreeBytes(numberOfItems, header.bits);
+    }
+
+    return false;
+}
@@ -0,0 +1,97 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+quatCodec
+    Compact binary encodings for arrays of quaternions. These have no Maya
+    dependency.
+
+    QUAT_ENCODING_RAW stores the four doubles of each quaternion as they
+    are, 32 bytes per quaternion.
+
+    QUAT_ENCODING_LOSSLESS XORs each component with the same component of
+    the previous quaternion and stores only the bits between the leading
+    and trailing zeros of the result. Repeated values cost one bit, and
+    every value is restored exactly.
+
+    QUAT_ENCODING_SMALLEST_THREE is lossy, and only for unit quaternions.
+    It stores the index and sign of the largest component, and the other
+    three quantized to the given number of bits each; the largest is
+    restored from the unit length. Each of the three is restored to within
+    1 / (sqrt(2) * (2^bits - 1)) of its value, and the largest to within a
+    few times that. Each quaternion takes 3 + 3 * bits bits.
+
+    An encoding that cannot hold the values falls back to the next simpler
+    one: an array with any quaternion further than QUAT_UNIT_TOLERANCE from
+    unit length is stored losslessly, and values that do not compress are
+    stored raw. The encoding used is returned, and must be passed back to
+    decode the bytes.
+
+    The encoding that QuatArrayData uses when Maya writes a binary file is
+    a plugin-wide option. It can be set with the XFORM_ARRAY_QUAT_ENCODING
+    ("raw", "lossless" or "smallestThree") and XFORM_ARRAY_QUAT_BITS
+    environment variables or the xformArrayOptions command, and is raw by
+    default.
+*/
+
+#pragma once
+
+#include "xformTypes.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+enum QuatEncoding
+{
+    QUAT_ENCODING_RAW            = 0,
+    QUAT_ENCODING_LOSSLESS       = 1,
+    QUAT_ENCODING_SMALLEST_THREE = 2
+};
+
+const unsigned  QUAT_ENCODING_MIN_BITS     = 4;
+const unsigned  QUAT_ENCODING_MAX_BITS     = 24;
+const unsigned  QUAT_ENCODING_DEFAULT_BITS = 16;
+
+/** Largest difference between the squared length of a quaternion and 1 that smallest-three accepts. */
+const double    QUAT_UNIT_TOLERANCE = 1e-6;
+
+QuatEncoding    quatEncoding();
+unsigned        quatEncodingBits();
+
+void            setQuatEncoding(QuatEncoding encoding);
+
+/** Sets the bits per component used by smallest-three, clamped to [QUAT_ENCODING_MIN_BITS, QUAT_ENCODING_MAX_BITS]. */
+void            setQuatEncodingBits(unsigned bits);
+
+/**
+    Appends q[0, n) to bytes and returns the encoding that was used, which
+    may be simpler than the one requested.
+*/
+QuatEncoding    encodeQuaternions(const Quaternion *q, size_t n, QuatEncoding encoding, unsigned bits, std::vector<uint8_t> &bytes);
+
+/** 
+    Decodes n quaternions to q. Returns false if the bytes end early, go on
+    past the n quaternions, or do not match the encoding.
+*/
+bool            decodeQuaternions(const uint8_t *bytes, size_t numberOfBytes, QuatEncoding encoding, unsigned bits, Quaternion *q, size_t n);
+
+/** The words written before encoded bytes in a file. */
+struct QuatEncodingHeader
+{
+    uint32_t    encoding;
+    uint32_t    bits;
+    uint32_t    numberOfItems;
+    uint32_t    numberOfBytes;
+};
+
+/**
+    Returns true if header describes bytes that fit in the
+    numberOfBytesAvailable that follow it, in a known encoding, and in a
+    number that could hold its items. This is checked before anything is
+    allocated for the items, so that a corrupt count is rejected instead.
+*/
+bool            isValidQuatEncodingHeader(const QuatEncodingHeader &header, size_t numberOfBytesAvailable);
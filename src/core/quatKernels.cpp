@@ -0,0 +1,393 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "quatKernels.h"
+#include "quatKernelsImpl.h"
+#include "dirtyRange.h"
+#include "quatLanes.h"
+#include "parallel.h"
+#include "simd.h"
+
+#include <algorithm>
+
+/** Chunks are kept large, as these kernels are limited by memory bandwidth. */
+static const size_t QUAT_KERNEL_GRAIN_SIZE = 4096;
+
+static const QuatKernelTable* selectQuatKernelTable()
+{
+    switch (simdISA())
+    {
+#if XFORM_ARRAY_X86
+        case SIMD_AVX2: return &AVX2_QUAT_KERNELS;
+        case SIMD_SSE2: return &SSE2_QUAT_KERNELS;
+#endif
+        default:        return &SCALAR_QUAT_KERNELS;
+    }
+}
+
+
+static const QuatKernelTableF* selectQuatKernelTableF()
+{
+    switch (simdISA())
+    {
+#if XFORM_ARRAY_X86
+        case SIMD_AVX2: return &AVX2_QUAT_KERNELS_F;
+        case SIMD_SSE2: return &SSE2_QUAT_KERNELS_F;
+#endif
+        default:        return &SCALAR_QUAT_KERNELS_F;
+    }
+}
+
+
+static const QuatKernelTable& quatKernelTable()
+{
+    static const QuatKernelTable *table = selectQuatKernelTable();
+    return *table;
+}
+
+
+static const QuatKernelTableF& quatKernelTableF()
+{
+    static const QuatKernelTableF *table = selectQuatKernelTableF();
+    return *table;
+}
+
+
+template <typename REAL>
+static BasicConstQuatLanePtr<REAL> constLanePtr(const BasicQuatLanes<REAL> &q)
+{
+    BasicConstQuatLanePtr<REAL> ptr = { q.x.data(), q.y.data(), q.z.data(), q.w.data() };
+    return ptr;
+}
+
+
+template <typename REAL>
+static BasicQuatLanePtr<REAL> lanePtr(BasicQuatLanes<REAL> &q)
+{
+    BasicQuatLanePtr<REAL> ptr = { q.x.data(), q.y.data(), q.z.data(), q.w.data() };
+    return ptr;
+}
+
+
+/** Elements per tile when an input is broadcast or padded. */
+static const size_t QUAT_TILE_SIZE = 256;
+
+template <typename REAL>
+struct QuatTile
+{
+    REAL x[QUAT_TILE_SIZE];
+    REAL y[QUAT_TILE_SIZE];
+    REAL z[QUAT_TILE_SIZE];
+    REAL w[QUAT_TILE_SIZE];
+};
+
+
+/**
+    Returns lanes holding elements [begin, end) of q, broadcast or padded to 
+    any length. Elements within q are read in place; otherwise they are 
+    written to tile, which holds at most QUAT_TILE_SIZE elements.
+*/
+template <typename REAL>
+static BasicConstQuatLanePtr<REAL> broadcastLanes(const BasicQuatLanes<REAL> &q, size_t begin, size_t end, QuatTile<REAL> &tile)
+{
+    size_t size = q.size();
+
+    if (size != 1 && end <= size)
+    {
+        BasicConstQuatLanePtr<REAL> ptr = { q.x.data() + begin, q.y.data() + begin, q.z.data() + begin, q.w.data() + begin };
+        return ptr;
+    }
+
+    for (size_t i = begin; i < end; i++)
+    {
+        size_t j = i - begin;
+        size_t k = size == 1 ? 0 : i;
+
+        bool isPadding = k >= size;
+
+        tile.x[j] = isPadding ? REAL(0) : q.x[k];
+        tile.y[j] = isPadding ? REAL(0) : q.y[k];
+        tile.z[j] = isPadding ? REAL(0) : q.z[k];
+        tile.w[j] = isPadding ? REAL(1) : q.w[k];
+    }
+
+    BasicConstQuatLanePtr<REAL> ptr = { tile.x, tile.y, tile.z, tile.w };
+    return ptr;
+}
+
+
+/** Runs a binary kernel on elements [first, last) of out, broadcasting or padding either input. */
+template <typename REAL>
+static void runBroadcastKernel(typename BasicQuatKernelTable<REAL>::Binary kernel, const BasicQuatLanes<REAL> &q1, const BasicQuatLanes<REAL> &q2, BasicQuatLanePtr<REAL> r, size_t first, size_t last)
+{
+    parallelForRange(first, last, QUAT_KERNEL_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        QuatTile<REAL> tile1;
+        QuatTile<REAL> tile2;
+
+        for (size_t tileBegin = begin; tileBegin < end; tileBegin += QUAT_TILE_SIZE)
+        {
+            size_t tileEnd = std::min(end, tileBegin + QUAT_TILE_SIZE);
+
+            BasicConstQuatLanePtr<REAL> a = broadcastLanes(q1, tileBegin, tileEnd, tile1);
+            BasicConstQuatLanePtr<REAL> b = broadcastLanes(q2, tileBegin, tileEnd, tile2);
+            BasicQuatLanePtr<REAL>      o = { r.x + tileBegin, r.y + tileBegin, r.z + tileBegin, r.w + tileBegin };
+
+            kernel(a, b, o, 0, tileEnd - tileBegin);
+        }
+    });
+}
+
+
+template <typename REAL>
+static void runBinaryKernel(typename BasicQuatKernelTable<REAL>::Binary kernel, const BasicQuatLanes<REAL> &q1, const BasicQuatLanes<REAL> &q2, BasicQuatLanes<REAL> &out)
+{
+    size_t n = q1.size();
+
+    if (q2.size() != n)
+    {
+        // The output is built apart, as resizing it could move an input it aliases.
+        BasicQuatLanes<REAL> result;
+        result.resize(std::max(n, q2.size()));
+
+        runBroadcastKernel(kernel, q1, q2, lanePtr(result), 0, result.size());
+
+        out.swap(result);
+        return;
+    }
+
+    if (&out != &q1 && &out != &q2) { out.resize(n); }
+
+    BasicConstQuatLanePtr<REAL> a = constLanePtr(q1);
+    BasicConstQuatLanePtr<REAL> b = constLanePtr(q2);
+    BasicQuatLanePtr<REAL>      r = lanePtr(out);
+
+    parallelForRange(0, n, QUAT_KERNEL_GRAIN_SIZE, [=](size_t begin, size_t end)
+    {
+        kernel(a, b, r, begin, end);
+    });
+}
+
+
+template <typename REAL>
+static void runBinaryKernel(typename BasicQuatKernelTable<REAL>::Binary kernel, const BasicQuatLanes<REAL> &q1, const BasicQuatLanes<REAL> &q2, BasicQuatLanes<REAL> &out, const DirtyRange &changed)
+{
+    DirtyRange range = changed.clamp(std::min(out.size(), std::max(q1.size(), q2.size())));
+
+    if (q1.size() != q2.size())
+    {
+        runBroadcastKernel(kernel, q1, q2, lanePtr(out), range.begin, range.end);
+        return;
+    }
+
+    BasicConstQuatLanePtr<REAL> a = constLanePtr(q1);
+    BasicConstQuatLanePtr<REAL> b = constLanePtr(q2);
+    BasicQuatLanePtr<REAL>      r = lanePtr(out);
+
+    parallelForRange(range.begin, range.end, QUAT_KERNEL_GRAIN_SIZE, [=](size_t begin, size_t end)
+    {
+        kernel(a, b, r, begin, end);
+    });
+}
+
+
+template <typename REAL>
+static void runUnaryKernel(typename BasicQuatKernelTable<REAL>::Unary kernel, const BasicQuatLanes<REAL> &q, BasicQuatLanes<REAL> &out)
+{
+    size_t n = q.size();
+
+    if (&out != &q) { out.resize(n); }
+
+    BasicConstQuatLanePtr<REAL> a = constLanePtr(q);
+    BasicQuatLanePtr<REAL>      r = lanePtr(out);
+
+    parallelForRange(0, n, QUAT_KERNEL_GRAIN_SIZE, [=](size_t begin, size_t end)
+    {
+        kernel(a, r, begin, end);
+    });
+}
+
+
+template <typename REAL>
+static void runUnaryKernel(typename BasicQuatKernelTable<REAL>::Unary kernel, const BasicQuatLanes<REAL> &q, BasicQuatLanes<REAL> &out, const DirtyRange &changed)
+{
+    DirtyRange range = changed.clamp(std::min(out.size(), q.size()));
+
+    BasicConstQuatLanePtr<REAL> a = constLanePtr(q);
+    BasicQuatLanePtr<REAL>      r = lanePtr(out);
+
+    parallelForRange(range.begin, range.end, QUAT_KERNEL_GRAIN_SIZE, [=](size_t begin, size_t end)
+    {
+        kernel(a, r, begin, end);
+    });
+}
+
+
+void quatArrayAdd(const QuatLanes &q1, const QuatLanes &q2, QuatLanes &out)
+{
+    runBinaryKernel(quatKernelTable().add, q1, q2, out);
+}
+
+
+void quatArraySubtract(const QuatLanes &q1, const QuatLanes &q2, QuatLanes &out)
+{
+    runBinaryKernel(quatKernelTable().subtract, q1, q2, out);
+}
+
+
+void quatArrayProduct(const QuatLanes &q1, const QuatLanes &q2, QuatLanes &out)
+{
+    runBinaryKernel(quatKernelTable().product, q1, q2, out);
+}
+
+
+void quatArrayConjugate(const QuatLanes &q, QuatLanes &out)
+{
+    runUnaryKernel(quatKernelTable().conjugate, q, out);
+}
+
+
+void quatArrayInverse(const QuatLanes &q, QuatLanes &out)
+{
+    runUnaryKernel(quatKernelTable().inverse, q, out);
+}
+
+
+void quatArrayNegate(const QuatLanes &q, QuatLanes &out)
+{
+    runUnaryKernel(quatKernelTable().negate, q, out);
+}
+
+
+void quatArrayNormalize(const QuatLanes &q, QuatLanes &out)
+{
+    runUnaryKernel(quatKernelTable().normalize, q, out);
+}
+
+
+void quatArrayAdd(const QuatLanesF &q1, const QuatLanesF &q2, QuatLanesF &out)
+{
+    runBinaryKernel(quatKernelTableF().add, q1, q2, out);
+}
+
+
+void quatArraySubtract(const QuatLanesF &q1, const QuatLanesF &q2, QuatLanesF &out)
+{
+    runBinaryKernel(quatKernelTableF().subtract, q1, q2, out);
+}
+
+
+void quatArrayProduct(const QuatLanesF &q1, const QuatLanesF &q2, QuatLanesF &out)
+{
+    runBinaryKernel(quatKernelTableF().product, q1, q2, out);
+}
+
+
+void quatArrayConjugate(const QuatLanesF &q, QuatLanesF &out)
+{
+    runUnaryKernel(quatKernelTableF().conjugate, q, out);
+}
+
+
+void quatArrayInverse(const QuatLanesF &q, QuatLanesF &out)
+{
+    runUnaryKernel(quatKernelTableF().inverse, q, out);
+}
+
+
+void quatArrayNegate(const QuatLanesF &q, QuatLanesF &out)
+{
+    runUnaryKernel(quatKernelTableF().negate, q, out);
+}
+
+
+void quatArrayNormalize(const QuatLanesF &q, QuatLanesF &out)
+{
+    runUnaryKernel(quatKernelTableF().normalize, q, out);
+}
+
+
+void quatArrayAdd(const QuatLanes &q1, const QuatLanes &q2, QuatLanes &out, const DirtyRange &changed)
+{
+    runBinaryKernel(quatKernelTable().add, q1, q2, out, changed);
+}
+
+
+void quatArraySubtract(const QuatLanes &q1, const QuatLanes &q2, QuatLanes &out, const DirtyRange &changed)
+{
+    runBinaryKernel(quatKernelTable().subtract, q1, q2, out, changed);
+}
+
+
+void quatArrayProduct(const QuatLanes &q1, const QuatLanes &q2, QuatLanes &out, const DirtyRange &changed)
+{
+    runBinaryKernel(quatKernelTable().product, q1, q2, out, changed);
+}
+
+
+void quatArrayConjugate(const QuatLanes &q, QuatLanes &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTable().conjugate, q, out, changed);
+}
+
+
+void quatArrayInverse(const QuatLanes &q, QuatLanes &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTable().inverse, q, out, changed);
+}
+
+
+void quatArrayNegate(const QuatLanes &q, QuatLanes &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTable().negate, q, out, changed);
+}
+
+
+void quatArrayNormalize(const QuatLanes &q, QuatLanes &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTable().normalize, q, out, changed);
+}
+
+
+void quatArrayAdd(const QuatLanesF &q1, const QuatLanesF &q2, QuatLanesF &out, const DirtyRange &changed)
+{
+    runBinaryKernel(quatKernelTableF().add, q1, q2, out, changed);
+}
+
+
+void quatArraySubtract(const QuatLanesF &q1, const QuatLanesF &q2, QuatLanesF &out, const DirtyRange &changed)
+{
+    runBinaryKernel(quatKernelTableF().subtract, q1, q2, out, changed);
+}
+
+
+void quatArrayProduct(const QuatLanesF &q1, const QuatLanesF &q2, QuatLanesF &out, const DirtyRange &changed)
+{
+    runBinaryKernel(quatKernelTableF().product, q1, q2, out, changed);
+}
+
+
+void quatArrayConjugate(const QuatLanesF &q, QuatLanesF &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTableF().conjugate, q, out, changed);
+}
+
+
+void quatArrayInverse(const QuatLanesF &q, QuatLanesF &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTableF().inverse, q, out, changed);
+}
+
+
+void quatArrayNegate(const QuatLanesF &q, QuatLanesF &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTableF().negate, q, out, changed);
+}
+
+
+void quatArrayNormalize(const QuatLanesF &q, QuatLanesF &out, const DirtyRange &changed)
+{
+    runUnaryKernel(quatKernelTableF().normalize, q, out, changed);
+}
@@ -0,0 +1,228 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+    AVX2 quatKernels. This file must be compiled with AVX2 code generation enabled
+    (-mavx2 on GCC/Clang), and is only called after a CPUID check.
+*/
+
+#include "quatKernelsImpl.h"
+
+#if XFORM_ARRAY_X86
+
+#include <immintrin.h>
+
+/** The intrinsics for each precision, so that each kernel is written once. */
+struct Avx2Double
+{
+    typedef double  Real;
+    typedef __m256d Vec;
+
+    static const size_t W = 4;
+
+    static inline Vec  load(const Real *p)     { return _mm256_loadu_pd(p); }
+    static inline void store(Real *p, Vec a)   { _mm256_storeu_pd(p, a); }
+    static inline Vec  set1(Real a)            { return _mm256_set1_pd(a); }
+    static inline Vec  add(Vec a, Vec b)       { return _mm256_add_pd(a, b); }
+    static inline Vec  sub(Vec a, Vec b)       { return _mm256_sub_pd(a, b); }
+    static inline Vec  mul(Vec a, Vec b)       { return _mm256_mul_pd(a, b); }
+    static inline Vec  div(Vec a, Vec b)       { return _mm256_div_pd(a, b); }
+    static inline Vec  sqrt(Vec a)             { return _mm256_sqrt_pd(a); }
+
+    /** Flips the sign bit, matching scalar unary minus (including for zero). */
+    static inline Vec  negate(Vec a)           { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+
+    /** Returns a where mask > 0, and b elsewhere. */
+    static inline Vec  selectPositive(Vec mask, Vec a, Vec b)
+    {
+        Vec positive = _mm256_cmp_pd(mask, _mm256_setzero_pd(), _CMP_GT_OQ);
+        return _mm256_blendv_pd(b, a, positive);
+    }
+};
+
+struct Avx2Float
+{
+    typedef float  Real;
+    typedef __m256 Vec;
+
+    static const size_t W = 8;
+
+    static inline Vec  load(const Real *p)     { return _mm256_loadu_ps(p); }
+    static inline void store(Real *p, Vec a)   { _mm256_storeu_ps(p, a); }
+    static inline Vec  set1(Real a)            { return _mm256_set1_ps(a); }
+    static inline Vec  add(Vec a, Vec b)       { return _mm256_add_ps(a, b); }
+    static inline Vec  sub(Vec a, Vec b)       { return _mm256_sub_ps(a, b); }
+    static inline Vec  mul(Vec a, Vec b)       { return _mm256_mul_ps(a, b); }
+    static inline Vec  div(Vec a, Vec b)       { return _mm256_div_ps(a, b); }
+    static inline Vec  sqrt(Vec a)             { return _mm256_sqrt_ps(a); }
+
+    /** Flips the sign bit, matching scalar unary minus (including for zero). */
+    static inline Vec  negate(Vec a)           { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+
+    /** Returns a where mask > 0, and b elsewhere. */
+    static inline Vec  selectPositive(Vec mask, Vec a, Vec b)
+    {
+        Vec positive = _mm256_cmp_ps(mask, _mm256_setzero_ps(), _CMP_GT_OQ);
+        return _mm256_blendv_ps(b, a, positive);
+    }
+};
+
+template <class V>
+static void avx2QuatAdd(BasicConstQuatLanePtr<typename V::Real> a, BasicConstQuatLanePtr<typename V::Real> b, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::add(V::load(a.x + i), V::load(b.x + i)));
+        V::store(out.y + i, V::add(V::load(a.y + i), V::load(b.y + i)));
+        V::store(out.z + i, V::add(V::load(a.z + i), V::load(b.z + i)));
+        V::store(out.w + i, V::add(V::load(a.w + i), V::load(b.w + i)));
+    }
+
+    scalarQuatAdd(a, b, out, i, end);
+}
+
+template <class V>
+static void avx2QuatSubtract(BasicConstQuatLanePtr<typename V::Real> a, BasicConstQuatLanePtr<typename V::Real> b, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::sub(V::load(a.x + i), V::load(b.x + i)));
+        V::store(out.y + i, V::sub(V::load(a.y + i), V::load(b.y + i)));
+        V::store(out.z + i, V::sub(V::load(a.z + i), V::load(b.z + i)));
+        V::store(out.w + i, V::sub(V::load(a.w + i), V::load(b.w + i)));
+    }
+
+    scalarQuatSubtract(a, b, out, i, end);
+}
+
+template <class V>
+static void avx2QuatProduct(BasicConstQuatLanePtr<typename V::Real> a, BasicConstQuatLanePtr<typename V::Real> b, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    typedef typename V::Vec Vec;
+
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        Vec ax = V::load(a.x + i), ay = V::load(a.y + i), az = V::load(a.z + i), aw = V::load(a.w + i);
+        Vec bx = V::load(b.x + i), by = V::load(b.y + i), bz = V::load(b.z + i), bw = V::load(b.w + i);
+
+        Vec x = V::sub(V::add(V::add(V::mul(bw, ax), V::mul(bx, aw)), V::mul(by, az)), V::mul(bz, ay));
+        Vec y = V::add(V::add(V::sub(V::mul(bw, ay), V::mul(bx, az)), V::mul(by, aw)), V::mul(bz, ax));
+        Vec z = V::add(V::sub(V::add(V::mul(bw, az), V::mul(bx, ay)), V::mul(by, ax)), V::mul(bz, aw));
+        Vec w = V::sub(V::sub(V::sub(V::mul(bw, aw), V::mul(bx, ax)), V::mul(by, ay)), V::mul(bz, az));
+
+        V::store(out.x + i, x);
+        V::store(out.y + i, y);
+        V::store(out.z + i, z);
+        V::store(out.w + i, w);
+    }
+
+    scalarQuatProduct(a, b, out, i, end);
+}
+
+template <class V>
+static void avx2QuatConjugate(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::negate(V::load(q.x + i)));
+        V::store(out.y + i, V::negate(V::load(q.y + i)));
+        V::store(out.z + i, V::negate(V::load(q.z + i)));
+        V::store(out.w + i, V::load(q.w + i));
+    }
+
+    scalarQuatConjugate(q, out, i, end);
+}
+
+template <class V>
+static void avx2QuatInverse(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    typedef typename V::Vec Vec;
+
+    const Vec one = V::set1(1);
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        Vec x = V::load(q.x + i), y = V::load(q.y + i), z = V::load(q.z + i), w = V::load(q.w + i);
+        Vec norm = V::add(V::add(V::mul(x, x), V::mul(y, y)), V::add(V::mul(z, z), V::mul(w, w)));
+        Vec s = V::selectPositive(norm, V::div(one, norm), one);
+
+        V::store(out.x + i, V::mul(V::negate(x), s));
+        V::store(out.y + i, V::mul(V::negate(y), s));
+        V::store(out.z + i, V::mul(V::negate(z), s));
+        V::store(out.w + i, V::mul(w, s));
+    }
+
+    scalarQuatInverse(q, out, i, end);
+}
+
+template <class V>
+static void avx2QuatNegate(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::negate(V::load(q.x + i)));
+        V::store(out.y + i, V::negate(V::load(q.y + i)));
+        V::store(out.z + i, V::negate(V::load(q.z + i)));
+        V::store(out.w + i, V::negate(V::load(q.w + i)));
+    }
+
+    scalarQuatNegate(q, out, i, end);
+}
+
+template <class V>
+static void avx2QuatNormalize(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    typedef typename V::Vec Vec;
+
+    const Vec one = V::set1(1);
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        Vec x = V::load(q.x + i), y = V::load(q.y + i), z = V::load(q.z + i), w = V::load(q.w + i);
+        Vec norm = V::add(V::add(V::mul(x, x), V::mul(y, y)), V::add(V::mul(z, z), V::mul(w, w)));
+        Vec s = V::selectPositive(norm, V::div(one, V::sqrt(norm)), one);
+
+        V::store(out.x + i, V::mul(x, s));
+        V::store(out.y + i, V::mul(y, s));
+        V::store(out.z + i, V::mul(z, s));
+        V::store(out.w + i, V::mul(w, s));
+    }
+
+    scalarQuatNormalize(q, out, i, end);
+}
+
+const QuatKernelTable  AVX2_QUAT_KERNELS = {
+    &avx2QuatAdd<Avx2Double>,
+    &avx2QuatSubtract<Avx2Double>,
+    &avx2QuatProduct<Avx2Double>,
+    &avx2QuatConjugate<Avx2Double>,
+    &avx2QuatInverse<Avx2Double>,
+    &avx2QuatNegate<Avx2Double>,
+    &avx2QuatNormalize<Avx2Double>
+};
+
+const QuatKernelTableF AVX2_QUAT_KERNELS_F = {
+    &avx2QuatAdd<Avx2Float>,
+    &avx2QuatSubtract<Avx2Float>,
+    &avx2QuatProduct<Avx2Float>,
+    &avx2QuatConjugate<Avx2Float>,
+    &avx2QuatInverse<Avx2Float>,
+    &avx2QuatNegate<Avx2Float>,
+    &avx2QuatNormalize<Avx2Float>
+};
+
+#endif
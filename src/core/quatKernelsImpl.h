@@ -0,0 +1,159 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+    Internal declarations shared by the per-instruction-set quatKernels 
+    translation units. 
+    
+    Everything defined here is static so that each translation unit keeps 
+    its own copy, compiled for its own instruction set. The scalar kernels
+    are templates, instantiated for double and float lanes.
+*/
+
+#pragma once
+
+#include "simd.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#include <cmath>
+
+template <typename REAL> struct BasicConstQuatLanePtr { const REAL *x, *y, *z, *w; };
+template <typename REAL> struct BasicQuatLanePtr      { REAL *x, *y, *z, *w; };
+
+template <typename REAL>
+struct BasicQuatKernelTable
+{
+    typedef void (*Binary)(BasicConstQuatLanePtr<REAL> q1, BasicConstQuatLanePtr<REAL> q2, BasicQuatLanePtr<REAL> out, size_t begin, size_t end);
+    typedef void (*Unary)(BasicConstQuatLanePtr<REAL> q, BasicQuatLanePtr<REAL> out, size_t begin, size_t end);
+
+    Binary add;
+    Binary subtract;
+    Binary product;
+
+    Unary  conjugate;
+    Unary  inverse;
+    Unary  negate;
+    Unary  normalize;
+};
+
+typedef BasicConstQuatLanePtr<double> ConstQuatLanePtr;
+typedef BasicQuatLanePtr<double>      QuatLanePtr;
+typedef BasicQuatKernelTable<double>  QuatKernelTable;
+typedef QuatKernelTable::Binary       QuatBinaryKernel;
+typedef QuatKernelTable::Unary        QuatUnaryKernel;
+
+typedef BasicConstQuatLanePtr<float>  ConstQuatLanePtrF;
+typedef BasicQuatLanePtr<float>       QuatLanePtrF;
+typedef BasicQuatKernelTable<float>   QuatKernelTableF;
+
+extern const QuatKernelTable  SCALAR_QUAT_KERNELS;
+extern const QuatKernelTableF SCALAR_QUAT_KERNELS_F;
+
+#if XFORM_ARRAY_X86
+extern const QuatKernelTable  SSE2_QUAT_KERNELS;
+extern const QuatKernelTable  AVX2_QUAT_KERNELS;
+extern const QuatKernelTableF SSE2_QUAT_KERNELS_F;
+extern const QuatKernelTableF AVX2_QUAT_KERNELS_F;
+#endif
+
+template <typename REAL>
+static inline void scalarQuatAdd(BasicConstQuatLanePtr<REAL> a, BasicConstQuatLanePtr<REAL> b, BasicQuatLanePtr<REAL> out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        out.x[i] = a.x[i] + b.x[i];
+        out.y[i] = a.y[i] + b.y[i];
+        out.z[i] = a.z[i] + b.z[i];
+        out.w[i] = a.w[i] + b.w[i];
+    }
+}
+
+template <typename REAL>
+static inline void scalarQuatSubtract(BasicConstQuatLanePtr<REAL> a, BasicConstQuatLanePtr<REAL> b, BasicQuatLanePtr<REAL> out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        out.x[i] = a.x[i] - b.x[i];
+        out.y[i] = a.y[i] - b.y[i];
+        out.z[i] = a.z[i] - b.z[i];
+        out.w[i] = a.w[i] - b.w[i];
+    }
+}
+
+/** a * b in MQuaternion order, which is the Hamilton product b a. */
+template <typename REAL>
+static inline void scalarQuatProduct(BasicConstQuatLanePtr<REAL> a, BasicConstQuatLanePtr<REAL> b, BasicQuatLanePtr<REAL> out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        REAL ax = a.x[i], ay = a.y[i], az = a.z[i], aw = a.w[i];
+        REAL bx = b.x[i], by = b.y[i], bz = b.z[i], bw = b.w[i];
+
+        out.x[i] = (bw * ax) + (bx * aw) + (by * az) - (bz * ay);
+        out.y[i] = (bw * ay) - (bx * az) + (by * aw) + (bz * ax);
+        out.z[i] = (bw * az) + (bx * ay) - (by * ax) + (bz * aw);
+        out.w[i] = (bw * aw) - (bx * ax) - (by * ay) - (bz * az);
+    }
+}
+
+template <typename REAL>
+static inline void scalarQuatConjugate(BasicConstQuatLanePtr<REAL> q, BasicQuatLanePtr<REAL> out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        out.x[i] = -q.x[i];
+        out.y[i] = -q.y[i];
+        out.z[i] = -q.z[i];
+        out.w[i] =  q.w[i];
+    }
+}
+
+/** Zero-length quaternions are passed through unchanged. */
+template <typename REAL>
+static inline void scalarQuatInverse(BasicConstQuatLanePtr<REAL> q, BasicQuatLanePtr<REAL> out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        REAL x = q.x[i], y = q.y[i], z = q.z[i], w = q.w[i];
+        REAL norm = ((x * x) + (y * y)) + ((z * z) + (w * w));
+        REAL s = norm > REAL(0) ? REAL(1) / norm : REAL(1);
+
+        out.x[i] = -x * s;
+        out.y[i] = -y * s;
+        out.z[i] = -z * s;
+        out.w[i] =  w * s;
+    }
+}
+
+template <typename REAL>
+static inline void scalarQuatNegate(BasicConstQuatLanePtr<REAL> q, BasicQuatLanePtr<REAL> out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        out.x[i] = -q.x[i];
+        out.y[i] = -q.y[i];
+        out.z[i] = -q.z[i];
+        out.w[i] = -q.w[i];
+    }
+}
+
+/** Zero-length quaternions are passed through unchanged. */
+template <typename REAL>
+static inline void scalarQuatNormalize(BasicConstQuatLanePtr<REAL> q, BasicQuatLanePtr<REAL> out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        REAL x = q.x[i], y = q.y[i], z = q.z[i], w = q.w[i];
+        REAL norm = ((x * x) + (y * y)) + ((z * z) + (w * w));
+        REAL s = norm > REAL(0) ? REAL(1) / std::sqrt(norm) : REAL(1);
+
+        out.x[i] = x * s;
+        out.y[i] = y * s;
+        out.z[i] = z * s;
+        out.w[i] = w * s;
+    }
+}
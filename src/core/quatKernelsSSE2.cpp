@@ -0,0 +1,228 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+    SSE2 quatKernels. SSE2 is part of the x86-64 baseline, so this file needs no extra
+    compiler flags.
+*/
+
+#include "quatKernelsImpl.h"
+
+#if XFORM_ARRAY_X86
+
+#include <emmintrin.h>
+
+/** The intrinsics for each precision, so that each kernel is written once. */
+struct Sse2Double
+{
+    typedef double  Real;
+    typedef __m128d Vec;
+
+    static const size_t W = 2;
+
+    static inline Vec  load(const Real *p)     { return _mm_loadu_pd(p); }
+    static inline void store(Real *p, Vec a)   { _mm_storeu_pd(p, a); }
+    static inline Vec  set1(Real a)            { return _mm_set1_pd(a); }
+    static inline Vec  add(Vec a, Vec b)       { return _mm_add_pd(a, b); }
+    static inline Vec  sub(Vec a, Vec b)       { return _mm_sub_pd(a, b); }
+    static inline Vec  mul(Vec a, Vec b)       { return _mm_mul_pd(a, b); }
+    static inline Vec  div(Vec a, Vec b)       { return _mm_div_pd(a, b); }
+    static inline Vec  sqrt(Vec a)             { return _mm_sqrt_pd(a); }
+
+    /** Flips the sign bit, matching scalar unary minus (including for zero). */
+    static inline Vec  negate(Vec a)           { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+
+    /** Returns a where mask > 0, and b elsewhere. */
+    static inline Vec  selectPositive(Vec mask, Vec a, Vec b)
+    {
+        Vec positive = _mm_cmpgt_pd(mask, _mm_setzero_pd());
+        return _mm_or_pd(_mm_and_pd(positive, a), _mm_andnot_pd(positive, b));
+    }
+};
+
+struct Sse2Float
+{
+    typedef float  Real;
+    typedef __m128 Vec;
+
+    static const size_t W = 4;
+
+    static inline Vec  load(const Real *p)     { return _mm_loadu_ps(p); }
+    static inline void store(Real *p, Vec a)   { _mm_storeu_ps(p, a); }
+    static inline Vec  set1(Real a)            { return _mm_set1_ps(a); }
+    static inline Vec  add(Vec a, Vec b)       { return _mm_add_ps(a, b); }
+    static inline Vec  sub(Vec a, Vec b)       { return _mm_sub_ps(a, b); }
+    static inline Vec  mul(Vec a, Vec b)       { return _mm_mul_ps(a, b); }
+    static inline Vec  div(Vec a, Vec b)       { return _mm_div_ps(a, b); }
+    static inline Vec  sqrt(Vec a)             { return _mm_sqrt_ps(a); }
+
+    /** Flips the sign bit, matching scalar unary minus (including for zero). */
+    static inline Vec  negate(Vec a)           { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+
+    /** Returns a where mask > 0, and b elsewhere. */
+    static inline Vec  selectPositive(Vec mask, Vec a, Vec b)
+    {
+        Vec positive = _mm_cmpgt_ps(mask, _mm_setzero_ps());
+        return _mm_or_ps(_mm_and_ps(positive, a), _mm_andnot_ps(positive, b));
+    }
+};
+
+template <class V>
+static void sse2QuatAdd(BasicConstQuatLanePtr<typename V::Real> a, BasicConstQuatLanePtr<typename V::Real> b, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::add(V::load(a.x + i), V::load(b.x + i)));
+        V::store(out.y + i, V::add(V::load(a.y + i), V::load(b.y + i)));
+        V::store(out.z + i, V::add(V::load(a.z + i), V::load(b.z + i)));
+        V::store(out.w + i, V::add(V::load(a.w + i), V::load(b.w + i)));
+    }
+
+    scalarQuatAdd(a, b, out, i, end);
+}
+
+template <class V>
+static void sse2QuatSubtract(BasicConstQuatLanePtr<typename V::Real> a, BasicConstQuatLanePtr<typename V::Real> b, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::sub(V::load(a.x + i), V::load(b.x + i)));
+        V::store(out.y + i, V::sub(V::load(a.y + i), V::load(b.y + i)));
+        V::store(out.z + i, V::sub(V::load(a.z + i), V::load(b.z + i)));
+        V::store(out.w + i, V::sub(V::load(a.w + i), V::load(b.w + i)));
+    }
+
+    scalarQuatSubtract(a, b, out, i, end);
+}
+
+template <class V>
+static void sse2QuatProduct(BasicConstQuatLanePtr<typename V::Real> a, BasicConstQuatLanePtr<typename V::Real> b, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    typedef typename V::Vec Vec;
+
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        Vec ax = V::load(a.x + i), ay = V::load(a.y + i), az = V::load(a.z + i), aw = V::load(a.w + i);
+        Vec bx = V::load(b.x + i), by = V::load(b.y + i), bz = V::load(b.z + i), bw = V::load(b.w + i);
+
+        Vec x = V::sub(V::add(V::add(V::mul(bw, ax), V::mul(bx, aw)), V::mul(by, az)), V::mul(bz, ay));
+        Vec y = V::add(V::add(V::sub(V::mul(bw, ay), V::mul(bx, az)), V::mul(by, aw)), V::mul(bz, ax));
+        Vec z = V::add(V::sub(V::add(V::mul(bw, az), V::mul(bx, ay)), V::mul(by, ax)), V::mul(bz, aw));
+        Vec w = V::sub(V::sub(V::sub(V::mul(bw, aw), V::mul(bx, ax)), V::mul(by, ay)), V::mul(bz, az));
+
+        V::store(out.x + i, x);
+        V::store(out.y + i, y);
+        V::store(out.z + i, z);
+        V::store(out.w + i, w);
+    }
+
+    scalarQuatProduct(a, b, out, i, end);
+}
+
+template <class V>
+static void sse2QuatConjugate(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::negate(V::load(q.x + i)));
+        V::store(out.y + i, V::negate(V::load(q.y + i)));
+        V::store(out.z + i, V::negate(V::load(q.z + i)));
+        V::store(out.w + i, V::load(q.w + i));
+    }
+
+    scalarQuatConjugate(q, out, i, end);
+}
+
+template <class V>
+static void sse2QuatInverse(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    typedef typename V::Vec Vec;
+
+    const Vec one = V::set1(1);
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        Vec x = V::load(q.x + i), y = V::load(q.y + i), z = V::load(q.z + i), w = V::load(q.w + i);
+        Vec norm = V::add(V::add(V::mul(x, x), V::mul(y, y)), V::add(V::mul(z, z), V::mul(w, w)));
+        Vec s = V::selectPositive(norm, V::div(one, norm), one);
+
+        V::store(out.x + i, V::mul(V::negate(x), s));
+        V::store(out.y + i, V::mul(V::negate(y), s));
+        V::store(out.z + i, V::mul(V::negate(z), s));
+        V::store(out.w + i, V::mul(w, s));
+    }
+
+    scalarQuatInverse(q, out, i, end);
+}
+
+template <class V>
+static void sse2QuatNegate(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        V::store(out.x + i, V::negate(V::load(q.x + i)));
+        V::store(out.y + i, V::negate(V::load(q.y + i)));
+        V::store(out.z + i, V::negate(V::load(q.z + i)));
+        V::store(out.w + i, V::negate(V::load(q.w + i)));
+    }
+
+    scalarQuatNegate(q, out, i, end);
+}
+
+template <class V>
+static void sse2QuatNormalize(BasicConstQuatLanePtr<typename V::Real> q, BasicQuatLanePtr<typename V::Real> out, size_t begin, size_t end)
+{
+    typedef typename V::Vec Vec;
+
+    const Vec one = V::set1(1);
+    size_t i = begin;
+
+    for (; i + V::W <= end; i += V::W)
+    {
+        Vec x = V::load(q.x + i), y = V::load(q.y + i), z = V::load(q.z + i), w = V::load(q.w + i);
+        Vec norm = V::add(V::add(V::mul(x, x), V::mul(y, y)), V::add(V::mul(z, z), V::mul(w, w)));
+        Vec s = V::selectPositive(norm, V::div(one, V::sqrt(norm)), one);
+
+        V::store(out.x + i, V::mul(x, s));
+        V::store(out.y + i, V::mul(y, s));
+        V::store(out.z + i, V::mul(z, s));
+        V::store(out.w + i, V::mul(w, s));
+    }
+
+    scalarQuatNormalize(q, out, i, end);
+}
+
+const QuatKernelTable  SSE2_QUAT_KERNELS = {
+    &sse2QuatAdd<Sse2Double>,
+    &sse2QuatSubtract<Sse2Double>,
+    &sse2QuatProduct<Sse2Double>,
+    &sse2QuatConjugate<Sse2Double>,
+    &sse2QuatInverse<Sse2Double>,
+    &sse2QuatNegate<Sse2Double>,
+    &sse2QuatNormalize<Sse2Double>
+};
+
+const QuatKernelTableF SSE2_QUAT_KERNELS_F = {
+    &sse2QuatAdd<Sse2Float>,
+    &sse2QuatSubtract<Sse2Float>,
+    &sse2QuatProduct<Sse2Float>,
+    &sse2QuatConjugate<Sse2Float>,
+    &sse2QuatInverse<Sse2Float>,
+    &sse2QuatNegate<Sse2Float>,
+    &sse2QuatNormalize<Sse2Float>
+};
+
+#endif
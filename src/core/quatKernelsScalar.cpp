@@ -0,0 +1,26 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "quatKernelsImpl.h"
+
+const QuatKernelTable SCALAR_QUAT_KERNELS = {
+    &scalarQuatAdd<double>,
+    &scalarQuatSubtract<double>,
+    &scalarQuatProduct<double>,
+    &scalarQuatConjugate<double>,
+    &scalarQuatInverse<double>,
+    &scalarQuatNegate<double>,
+    &scalarQuatNormalize<double>
+};
+
+const QuatKernelTableF SCALAR_QUAT_KERNELS_F = {
+    &scalarQuatAdd<float>,
+    &scalarQuatSubtract<float>,
+    &scalarQuatProduct<float>,
+    &scalarQuatConjugate<float>,
+    &scalarQuatInverse<float>,
+    &scalarQuatNegate<float>,
+    &scalarQuatNormalize<float>
+};
@@ -0,0 +1,79 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+QuatLanes
+    Structure-of-arrays storage for quaternions. Each component is held in 
+    its own 64-byte aligned lane, so that kernels can load several 
+    quaternions per instruction.
+
+    QuatLanesF holds single-precision components. It takes half the memory,
+    and its kernels process twice as many quaternions per instruction.
+*/
+
+#pragma once
+
+#include "alignedAllocator.h"
+
+#include <stddef.h>
+
+#include <vector>
+
+const size_t LANE_ALIGNMENT = 64;
+
+template <typename REAL>
+struct BasicQuatLanes
+{
+    typedef std::vector<REAL, AlignedAllocator<REAL, LANE_ALIGNMENT>> Lane;
+
+    Lane x;
+    Lane y;
+    Lane z;
+    Lane w;
+
+    size_t size() const { return w.size(); }
+    bool   empty() const { return w.empty(); }
+
+    /** Resizes every lane. New elements are the identity quaternion. */
+    void resize(size_t n)
+    {
+        x.resize(n, REAL(0));
+        y.resize(n, REAL(0));
+        z.resize(n, REAL(0));
+        w.resize(n, REAL(1));
+    }
+
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        w.clear();
+    }
+
+    void swap(BasicQuatLanes &other)
+    {
+        x.swap(other.x);
+        y.swap(other.y);
+        z.swap(other.z);
+        w.swap(other.w);
+    }
+};
+
+typedef BasicQuatLanes<double> QuatLanes;
+typedef BasicQuatLanes<float>  QuatLanesF;
+
+typedef QuatLanes::Lane        DoubleLane;
+typedef QuatLanesF::Lane       FloatLane;
+
+/** Converts between precisions. Single-precision values are rounded to nearest. */
+template <typename TO, typename FROM>
+void convertQuatLanes(const BasicQuatLanes<FROM> &from, BasicQuatLanes<TO> &to)
+{
+    to.x.assign(from.x.begin(), from.x.end());
+    to.y.assign(from.y.begin(), from.y.end());
+    to.z.assign(from.z.begin(), from.z.end());
+    to.w.assign(from.w.begin(), from.w.end());
+}
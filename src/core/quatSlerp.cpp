@@ -0,0 +1,92 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "quatSlerp.h"
+#include "arrayView.h"
+#include "parallel.h"
+#include "xformTypes.h"
+
+#include <math.h>
+
+static const double PI = 3.14159265358979323846;
+
+/** Below this, 1 - cos(theta) is too small for sin(theta) to be divided by. */
+static const double SLERP_EPSILON = 1.0e-6;
+
+static inline QuatSlerpPair slerpPrepare(const Quaternion &p, const Quaternion &q, int spin)
+{
+    double cosTheta = (p.x * q.x) + (p.y * q.y) + (p.z * q.z) + (p.w * q.w);
+
+    QuatSlerpPair pair = {0.0, 0.0, 0.0, 1.0};
+
+    if (cosTheta < 0.0) 
+    { 
+        cosTheta = -cosTheta; 
+        pair.sign = -1.0;
+    }
+
+    if (1.0 - cosTheta >= SLERP_EPSILON)
+    {
+        pair.theta    = acos(cosTheta);
+        pair.phi      = pair.theta + (spin * PI);
+        pair.sinTheta = sin(pair.theta);
+    }
+
+    return pair;
+}
+
+
+static inline Quaternion slerpApply(const Quaternion &p, const Quaternion &q, const QuatSlerpPair &pair, double tween)
+{
+    double alpha = tween;
+    double beta  = 1.0 - tween;
+
+    if (pair.sinTheta != 0.0)
+    {
+        beta  = sin(pair.theta - (tween * pair.phi)) / pair.sinTheta;
+        alpha = sin(tween * pair.phi) / pair.sinTheta;
+    }
+
+    alpha *= pair.sign;
+
+    Quaternion r = {
+        (beta * p.x) + (alpha * q.x),
+        (beta * p.y) + (alpha * q.y),
+        (beta * p.z) + (alpha * q.z),
+        (beta * p.w) + (alpha * q.w)
+    };
+
+    return r;
+}
+
+
+void quatArraySlerp(BroadcastView<Quaternion> q1, BroadcastView<Quaternion> q2, double tween, int spin, Quaternion *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        const Quaternion &p = q1[i];
+        const Quaternion &q = q2[i];
+
+        out[i] = slerpApply(p, q, slerpPrepare(p, q, spin), tween);
+    });
+}
+
+
+void quatArraySlerpPrepare(BroadcastView<Quaternion> q1, BroadcastView<Quaternion> q2, int spin, QuatSlerpPair *pairs, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        pairs[i] = slerpPrepare(q1[i], q2[i], spin);
+    });
+}
+
+
+void quatArraySlerpPrepared(BroadcastView<Quaternion> q1, BroadcastView<Quaternion> q2, const QuatSlerpPair *pairs, double tween, Quaternion *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        out[i] = slerpApply(q1[i], q2[i], pairs[i], tween);
+    });
+}
@@ -0,0 +1,66 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+quatSlerp
+    Spherical linear interpolation of pairs of quaternions. This has no Maya
+    dependency. 
+    
+    The interpolation takes the shorter path between each pair, plus spin 
+    extra full turns, as in the extra-spin slerp of Graphics Gems III. 
+    Pairs that are nearly equal are interpolated linearly.
+
+    Most of the work per pair does not depend on tween. quatArraySlerpPrepare
+    does that part once, so that a change to tween alone only costs 
+    quatArraySlerpPrepared, a weighted sum of each pair.
+*/
+
+#pragma once
+
+#include "arrayView.h"
+#include "xformTypes.h"
+
+#include <stddef.h>
+
+/** The part of the slerp of one pair of quaternions that does not depend on tween. */
+struct QuatSlerpPair
+{
+    double      theta;      /**< Angle between the pair, along the shorter path. */
+    double      phi;        /**< theta plus the extra spin. */
+    double      sinTheta;   /**< 0 when the pair is interpolated linearly. */
+    double      sign;       /**< -1 when the second quaternion is negated to take the shorter path. */
+};
+
+/** Writes n interpolated quaternions to out, which must not overlap the inputs. */
+void            quatArraySlerp(
+                    BroadcastView<Quaternion> q1, 
+                    BroadcastView<Quaternion> q2, 
+                    double tween, 
+                    int spin, 
+                    Quaternion *out, 
+                    size_t n
+                );
+
+/** Writes the tween-independent part of the slerp of n pairs to pairs. */
+void            quatArraySlerpPrepare(
+                    BroadcastView<Quaternion> q1, 
+                    BroadcastView<Quaternion> q2, 
+                    int spin, 
+                    QuatSlerpPair *pairs, 
+                    size_t n
+                );
+
+/** 
+    Writes n interpolated quaternions to out, from pairs prepared from the 
+    same q1, q2 and spin. The result is the same as quatArraySlerp.
+*/
+void            quatArraySlerpPrepared(
+                    BroadcastView<Quaternion> q1, 
+                    BroadcastView<Quaternion> q2, 
+                    const QuatSlerpPair *pairs,
+                    double tween, 
+                    Quaternion *out, 
+                    size_t n
+                );
@@ -0,0 +1,84 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+SharedBuffer
+    Reference-counted, copy-on-write container. This has no Maya dependency.
+
+    Copying a SharedBuffer shares the container rather than its elements,
+    so a copy costs the same for any number of elements. Writes are 
+    copy-on-write: setting new values replaces the container, and edit() 
+    copies it first if any other SharedBuffer holds it. Either way, other
+    copies keep the values they had. Copies may be made and read from
+    different threads, as parallel evaluation does.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+template <typename CONTAINER>
+class SharedBuffer
+{
+public:
+    SharedBuffer() : buffer(emptyBuffer()) {}
+
+    const CONTAINER&    get() const     { return *this->buffer; }
+
+    /** Replaces the container with values. */
+    void                set(CONTAINER &&values) { this->buffer = std::make_shared<CONTAINER>(std::move(values)); }
+
+    /** Copies values into the container, reusing its storage unless another SharedBuffer holds it. */
+    void                assign(const CONTAINER &values)
+    {
+        if (this->buffer.use_count() == 1)
+        {
+            *this->buffer = values;
+        } else {
+            this->buffer = std::make_shared<CONTAINER>(values);
+        }
+    }
+
+    /** 
+        Returns the container for writing. It is copied first unless this 
+        is the only SharedBuffer that holds it.
+    */
+    CONTAINER&          edit()
+    {
+        if (this->buffer.use_count() != 1)
+        {
+            this->buffer = std::make_shared<CONTAINER>(*this->buffer);
+        }
+
+        return *this->buffer;
+    }
+
+    /** Replaces the container with an empty one, without allocating. */
+    void                reset()         { this->buffer = emptyBuffer(); }
+
+    /** Returns the number of SharedBuffers that hold this container. */
+    long                useCount() const { return this->buffer.use_count(); }
+
+    /** 
+        Returns this SharedBuffer's share of bytes held by the container, so
+        that adding the shares of every holder counts the container once.
+    */
+    size_t              share(size_t bytes) const { return bytes / (size_t) std::max(1L, this->useCount()); }
+
+private:
+    /** Held here as well, so edit() never writes to it. */
+    static const std::shared_ptr<CONTAINER>& emptyBuffer()
+    {
+        static const std::shared_ptr<CONTAINER> empty = std::make_shared<CONTAINER>();
+        return empty;
+    }
+
+private:
+    std::shared_ptr<CONTAINER> buffer;
+};
@@ -0,0 +1,314 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "sidecarFile.h"
+#include "contentHash.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char     SIDECAR_MAGIC[8] = {'X', 'F', 'A', 'S', 'I', 'D', 'E', 'C'};
+static const uint32_t SIDECAR_VERSION  = 1;
+
+/** The first SIDECAR_HEADER_SIZE bytes of a sidecar file. */
+struct SidecarHeader
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    valuesPerItem;
+    uint64_t    numberOfItems;
+    uint64_t    hash;
+    uint8_t     valueUnit;
+    uint8_t     reserved[31];
+};
+
+static_assert(sizeof(SidecarHeader) == SIDECAR_HEADER_SIZE, "SidecarHeader must fill the header exactly.");
+
+static std::string defaultSidecarDirectory()
+{
+    const char *requested = getenv("XFORM_ARRAY_SIDECAR_DIR");
+    return requested != NULL ? std::string(requested) : std::string();
+}
+
+
+static size_t defaultSidecarThreshold()
+{
+    const char *requested = getenv("XFORM_ARRAY_SIDECAR_THRESHOLD");
+    long long threshold = requested != NULL ? atoll(requested) : 0;
+
+    return threshold > 0 ? (size_t) threshold : SIDECAR_DEFAULT_THRESHOLD;
+}
+
+
+static std::mutex          directoryMutex;
+static std::string         directoryValue(defaultSidecarDirectory());
+static std::atomic<size_t> thresholdValue(defaultSidecarThreshold());
+
+/** Keeps temporary files written at the same time from different threads apart. */
+static std::atomic<uint64_t> nextTemporaryId(1);
+
+
+std::string sidecarDirectory()
+{
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    return directoryValue;
+}
+
+
+size_t sidecarThreshold()
+{
+    return thresholdValue.load(std::memory_order_relaxed);
+}
+
+
+void setSidecarDirectory(const std::string &directory)
+{
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    directoryValue = directory;
+}
+
+
+void setSidecarThreshold(size_t numberOfItems)
+{
+    thresholdValue.store(numberOfItems, std::memory_order_relaxed);
+}
+
+
+bool useSidecar(size_t numberOfItems)
+{
+    return numberOfItems > 0 && numberOfItems >= sidecarThreshold() && !sidecarDirectory().empty();
+}
+
+
+static bool isPathSeparator(char c)
+{
+    return c == '/' || c == '\\';
+}
+
+
+static std::string joinPath(const std::string &directory, const std::string &name)
+{
+    if (directory.empty() || isPathSeparator(directory[directory.size() - 1]))
+    {
+        return directory + name;
+    }
+
+    return directory + "/" + name;
+}
+
+
+static std::string fileName(const std::string &path)
+{
+    size_t i = path.size();
+
+    while (i > 0 && !isPathSeparator(path[i - 1])) { i--; }
+
+    return path.substr(i);
+}
+
+
+SidecarFile::SidecarFile() :
+    mappedValues(NULL),
+    itemCount(0),
+    itemValues(0),
+    unit(0),
+    valuesHash(0),
+    mapping(NULL),
+    mappingSize(0),
+    mappingHandle(NULL)
+{}
+
+
+SidecarFile::~SidecarFile()
+{
+    if (this->mapping == NULL) { return; }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(this->mapping);
+    CloseHandle((HANDLE) this->mappingHandle);
+#else
+    munmap(this->mapping, this->mappingSize);
+#endif
+}
+
+
+std::shared_ptr<const SidecarFile> SidecarFile::map(const std::string &path, unsigned valuesPerItem, size_t numberOfItems)
+{
+    std::shared_ptr<SidecarFile> file(new SidecarFile());
+    size_t size = 0;
+
+#if defined(_WIN32)
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) { return nullptr; }
+
+    LARGE_INTEGER fileSize;
+    HANDLE mappingHandle = NULL;
+
+    if (GetFileSizeEx(handle, &fileSize) && fileSize.QuadPart >= (LONGLONG) SIDECAR_HEADER_SIZE)
+    {
+        size = (size_t) fileSize.QuadPart;
+        mappingHandle = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+
+    CloseHandle(handle);
+
+    if (mappingHandle == NULL) { return nullptr; }
+
+    file->mappingHandle = mappingHandle;
+    file->mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) { return nullptr; }
+
+    struct stat status;
+
+    if (fstat(descriptor, &status) == 0 && status.st_size >= (off_t) SIDECAR_HEADER_SIZE)
+    {
+        size = (size_t) status.st_size;
+
+        void *address = mmap(NULL, size, PROT_READ, MAP_SHARED, descriptor, 0);
+        file->mapping = address == MAP_FAILED ? NULL : address;
+    }
+
+    // The mapping keeps the file open.
+    close(descriptor);
+#endif
+
+    if (file->mapping == NULL) { return nullptr; }
+
+    file->mappingSize = size;
+
+    SidecarHeader header;
+    memcpy(&header, file->mapping, sizeof(header));
+
+    size_t valuesSize = numberOfItems * valuesPerItem * sizeof(double);
+
+    if (
+        memcmp(header.magic, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC)) != 0 ||
+        header.version != SIDECAR_VERSION ||
+        header.valuesPerItem != valuesPerItem ||
+        header.numberOfItems != (uint64_t) numberOfItems ||
+        size - SIDECAR_HEADER_SIZE != valuesSize
+    ) {
+        return nullptr;
+    }
+
+    file->filePath = path;
+    file->mappedValues = (const double*) ((const char*) file->mapping + SIDECAR_HEADER_SIZE);
+    file->itemCount = numberOfItems;
+    file->itemValues = valuesPerItem;
+    file->unit = header.valueUnit;
+    file->valuesHash = header.hash;
+
+    return file;
+}
+
+
+std::shared_ptr<const SidecarFile> SidecarFile::open(const std::string &path, unsigned valuesPerItem, size_t numberOfItems)
+{
+    std::shared_ptr<const SidecarFile> file = map(path, valuesPerItem, numberOfItems);
+
+    if (!file)
+    {
+        std::string directory = sidecarDirectory();
+
+        if (!directory.empty())
+        {
+            file = map(joinPath(directory, fileName(path)), valuesPerItem, numberOfItems);
+        }
+    }
+
+    return file;
+}
+
+
+std::shared_ptr<const SidecarFile> SidecarFile::write(const double *values, unsigned valuesPerItem, size_t numberOfItems, uint8_t valueUnit)
+{
+    std::string directory = sidecarDirectory();
+
+    if (directory.empty()) { return nullptr; }
+
+    size_t valuesSize = numberOfItems * valuesPerItem * sizeof(double);
+
+    ContentHash hash;
+    hash.updateValue(valuesPerItem);
+    hash.updateValue((uint64_t) numberOfItems);
+    hash.update(values, valuesSize);
+
+    // Files without a unit keep the names they had before units were recorded.
+    if (valueUnit != 0) { hash.updateValue(valueUnit); }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.xfa", (unsigned long long) hash.digest());
+
+    std::string path = joinPath(directory, name);
+    std::shared_ptr<const SidecarFile> file = map(path, valuesPerItem, numberOfItems);
+
+    // The file of this name is only reused if it still holds these values, as it may have been cut short or edited.
+    if (
+        file &&
+        file->valueUnit() == valueUnit &&
+        file->valuesHash == hash.digest() &&
+        (valuesSize == 0 || memcmp(file->values(), values, valuesSize) == 0)
+    ) {
+        return file;
+    }
+
+    file.reset();
+
+    SidecarHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC));
+    header.version = SIDECAR_VERSION;
+    header.valuesPerItem = valuesPerItem;
+    header.numberOfItems = (uint64_t) numberOfItems;
+    header.hash = hash.digest();
+    header.valueUnit = valueUnit;
+
+    // Written under a temporary name, so that a reader never maps a partly written file.
+    std::string temporaryPath = path + ".tmp" + std::to_string(nextTemporaryId++);
+
+    {
+        std::ofstream out(temporaryPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write((const char*) &header, sizeof(header));
+        out.write((const char*) values, valuesSize);
+        out.close();
+
+        if (out.fail())
+        {
+            remove(temporaryPath.c_str());
+            return nullptr;
+        }
+    }
+
+#if defined(_WIN32)
+    remove(path.c_str());
+#endif
+
+    if (rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        remove(temporaryPath.c_str());
+    }
+
+    return map(path, valuesPerItem, numberOfItems);
+}
@@ -0,0 +1,104 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+sidecarFile
+    Large arrays stored outside the scene file. These have no Maya
+    dependency.
+
+    While a sidecar directory is set, the array data types write arrays of
+    at least sidecarThreshold() items to a sidecar file in that directory,
+    and write only the path of the file to the scene. A sidecar file holds
+    one array of doubles after a SIDECAR_HEADER_SIZE byte header, so the
+    values are 64-byte aligned when the file is mapped. The header can
+    also record the unit of the values, as a code chosen by the caller, so
+    that reading them does not depend on settings that may have changed 
+    since they were written. Files are named by the hash of their values
+    and unit: saving an unchanged array again writes nothing, and identical
+    arrays share a file.
+
+    Reading a scene maps each sidecar file without reading its values, and
+    the operating system pages them in when the array is first used, so
+    scene open time does not depend on the size of the arrays.
+
+    The directory and threshold can be set with the XFORM_ARRAY_SIDECAR_DIR
+    and XFORM_ARRAY_SIDECAR_THRESHOLD environment variables or the
+    xformArrayOptions command. No directory is set by default. The plugin
+    never deletes sidecar files, as any saved scene may refer to them.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+const size_t    SIDECAR_HEADER_SIZE       = 64;
+const size_t    SIDECAR_DEFAULT_THRESHOLD = 100000;
+
+std::string     sidecarDirectory();
+size_t          sidecarThreshold();
+
+void            setSidecarDirectory(const std::string &directory);
+void            setSidecarThreshold(size_t numberOfItems);
+
+/** Returns true if an array of numberOfItems items should be written to a sidecar file. */
+bool            useSidecar(size_t numberOfItems);
+
+/** A read-only mapping of the values in one sidecar file. */
+class SidecarFile
+{
+public:
+                        ~SidecarFile();
+
+    /**
+        Maps the file at path. If there is no file at path, the file of the
+        same name in sidecarDirectory() is tried, so that sidecar files can
+        be moved along with their scenes. Returns null if neither can be
+        mapped, or the file does not hold numberOfItems items of
+        valuesPerItem values.
+    */
+    static std::shared_ptr<const SidecarFile> open(const std::string &path, unsigned valuesPerItem, size_t numberOfItems);
+
+    /**
+        Writes values to a file in sidecarDirectory(), unless the file for
+        these values is already there and still holds them, and maps it.
+        valueUnit is recorded in the header; 0 means no unit. Returns null
+        on failure.
+    */
+    static std::shared_ptr<const SidecarFile> write(const double *values, unsigned valuesPerItem, size_t numberOfItems, uint8_t valueUnit=0);
+
+    const std::string&  path() const            { return this->filePath; }
+    const double*       values() const          { return this->mappedValues; }
+    size_t              numberOfItems() const   { return this->itemCount; }
+    unsigned            valuesPerItem() const   { return this->itemValues; }
+
+    /** Returns the unit recorded when the file was written, or 0 if there is none. */
+    uint8_t             valueUnit() const       { return this->unit; }
+
+    /** Returns the bytes mapped, which are paged in on use rather than allocated. */
+    size_t              mappedBytes() const     { return this->mappingSize; }
+
+private:
+                        SidecarFile();
+                        SidecarFile(const SidecarFile&);
+    SidecarFile&        operator=(const SidecarFile&);
+
+    static std::shared_ptr<const SidecarFile> map(const std::string &path, unsigned valuesPerItem, size_t numberOfItems);
+
+private:
+    std::string         filePath;
+    const double       *mappedValues;
+    size_t              itemCount;
+    unsigned            itemValues;
+    uint8_t             unit;
+    uint64_t            valuesHash;
+
+    void               *mapping;
+    size_t              mappingSize;
+    void               *mappingHandle;
+};
@@ -0,0 +1,71 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if XFORM_ARRAY_X86 && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+static bool cpuSupportsAVX2()
+{
+#if XFORM_ARRAY_X86 && defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7) { return false; }
+
+    __cpuid(info, 1);
+    bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+    bool cpuHasAVX   = (info[2] & (1 << 28)) != 0;
+    if (!osUsesXSave || !cpuHasAVX) { return false; }
+
+    bool osSavesYMM = (_xgetbv(0) & 0x6) == 0x6;
+    if (!osSavesYMM) { return false; }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif XFORM_ARRAY_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+
+static SimdISA detectSimdISA()
+{
+    SimdISA isa = SIMD_SCALAR;
+
+#if XFORM_ARRAY_X86
+    isa = cpuSupportsAVX2() ? SIMD_AVX2 : SIMD_SSE2;
+#endif
+
+    const char *requested = getenv("XFORM_ARRAY_SIMD");
+
+    if (requested != NULL)
+    {
+        if (strcmp(requested, "scalar") == 0) 
+        { 
+            isa = SIMD_SCALAR; 
+        } else if (strcmp(requested, "sse2") == 0 && isa > SIMD_SSE2) {
+            isa = SIMD_SSE2;
+        }
+    }
+
+    return isa;
+}
+
+
+SimdISA simdISA()
+{
+    static const SimdISA isa = detectSimdISA();
+    return isa;
+}
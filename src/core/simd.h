@@ -0,0 +1,29 @@
+/**
+    Copyright (c) 2017 Ryan Porter    
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+simd
+    Runtime instruction set detection shared by the array kernels. The 
+    widest instruction set supported by the CPU is detected once. The 
+    XFORM_ARRAY_SIMD environment variable ("scalar", "sse2" or "avx2") can 
+    be used to cap it.
+*/
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define XFORM_ARRAY_X86 1
+#else
+#define XFORM_ARRAY_X86 0
+#endif
+
+enum SimdISA
+{
+    SIMD_SCALAR = 0,
+    SIMD_SSE2   = 1,
+    SIMD_AVX2   = 2
+};
+
+SimdISA simdISA();
@@ -0,0 +1,276 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+#include "vectorKernels.h"
+#include "arrayView.h"
+#include "matrixCompose.h"
+#include "parallel.h"
+#include "xformTypes.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+static inline Vector3 add(const Vector3 &a, const Vector3 &b)
+{
+    Vector3 r = { a.x + b.x, a.y + b.y, a.z + b.z };
+    return r;
+}
+
+
+static inline Vector3 subtract(const Vector3 &a, const Vector3 &b)
+{
+    Vector3 r = { a.x - b.x, a.y - b.y, a.z - b.z };
+    return r;
+}
+
+
+static inline Vector3 scale(const Vector3 &a, double s)
+{
+    Vector3 r = { a.x * s, a.y * s, a.z * s };
+    return r;
+}
+
+
+/** a times the 3x3 rotation r, with a as a row vector. */
+static inline Vector3 rotate(const Vector3 &a, const double r[3][3])
+{
+    Vector3 result = {
+        (a.x * r[0][0]) + (a.y * r[1][0]) + (a.z * r[2][0]),
+        (a.x * r[0][1]) + (a.y * r[1][1]) + (a.z * r[2][1]),
+        (a.x * r[0][2]) + (a.y * r[1][2]) + (a.z * r[2][2])
+    };
+    return result;
+}
+
+
+static inline double dot(const Vector3 &a, const Vector3 &b)
+{
+    return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+}
+
+
+void vectorArrayAdd(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        out[i] = add(v1[i], v2[i]);
+    });
+}
+
+
+void vectorArraySubtract(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        out[i] = subtract(v1[i], v2[i]);
+    });
+}
+
+
+void vectorArrayCross(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        const Vector3 &a = v1[i];
+        const Vector3 &b = v2[i];
+
+        Vector3 r = {
+            (a.y * b.z) - (a.z * b.y),
+            (a.z * b.x) - (a.x * b.z),
+            (a.x * b.y) - (a.y * b.x)
+        };
+
+        out[i] = r;
+    });
+}
+
+
+void vectorArrayDistance(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        Vector3 d = subtract(v1[i], v2[i]);
+        out[i] = sqrt(dot(d, d));
+    });
+}
+
+
+void vectorArrayDot(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        out[i] = dot(v1[i], v2[i]);
+    });
+}
+
+
+void vectorArrayLength(BroadcastView<Vector3> v, double *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        out[i] = sqrt(dot(v[i], v[i]));
+    });
+}
+
+
+void vectorArrayNormalize(ArrayView<Vector3> v, Vector3 *out)
+{
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        double length = sqrt(dot(v[i], v[i]));
+        out[i] = length > 0.0 ? scale(v[i], 1.0 / length) : v[i];
+    });
+}
+
+
+void vectorArrayNegate(ArrayView<Vector3> v, Vector3 *out)
+{
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        out[i] = scale(v[i], -1.0);
+    });
+}
+
+
+void vectorArrayMultiply(ArrayView<Vector3> v, BroadcastView<double> s, Vector3 *out)
+{
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        out[i] = scale(v[i], s[i]);
+    });
+}
+
+
+void vectorArrayDivide(ArrayView<Vector3> v, BroadcastView<double> s, Vector3 *out)
+{
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        const Vector3 &a = v[i];
+        double d = s[i];
+
+        Vector3 r = { a.x / d, a.y / d, a.z / d };
+        out[i] = r;
+    });
+}
+
+
+void vectorArrayMatrixProduct(BroadcastView<Vector3> v, BroadcastView<Matrix4> m, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        const Vector3 &a = v[i];
+        const double (*b)[4] = m[i].m;
+
+        Vector3 r = {
+            (a.x * b[0][0]) + (a.y * b[1][0]) + (a.z * b[2][0]),
+            (a.x * b[0][1]) + (a.y * b[1][1]) + (a.z * b[2][1]),
+            (a.x * b[0][2]) + (a.y * b[1][2]) + (a.z * b[2][2])
+        };
+
+        out[i] = r;
+    });
+}
+
+
+void pointArrayMatrixProduct(BroadcastView<Vector3> v, BroadcastView<Matrix4> m, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        const Vector3 &a = v[i];
+        const double (*b)[4] = m[i].m;
+
+        Vector3 r = {
+            (a.x * b[0][0]) + (a.y * b[1][0]) + (a.z * b[2][0]) + b[3][0],
+            (a.x * b[0][1]) + (a.y * b[1][1]) + (a.z * b[2][1]) + b[3][1],
+            (a.x * b[0][2]) + (a.y * b[1][2]) + (a.z * b[2][2]) + b[3][2]
+        };
+
+        out[i] = r;
+    });
+}
+
+
+void vectorArrayRotateByQuat(ArrayView<Vector3> v, ArrayView<Quaternion> q, Vector3 *out)
+{
+    size_t numberOfRotations = std::min(v.size(), q.size());
+
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        if (i < numberOfRotations)
+        {
+            double r[3][3];
+            quatToRotation(q[i].x, q[i].y, q[i].z, q[i].w, r);
+            out[i] = rotate(v[i], r);
+        } else {
+            out[i] = v[i];
+        }
+    });
+}
+
+
+void vectorArrayRotateByEuler(ArrayView<Vector3> v, ArrayView<EulerRotation> e, Vector3 *out)
+{
+    size_t numberOfRotations = std::min(v.size(), e.size());
+
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        if (i < numberOfRotations)
+        {
+            double r[3][3];
+            eulerToRotation(e[i].x, e[i].y, e[i].z, e[i].order, r);
+            out[i] = rotate(v[i], r);
+        } else {
+            out[i] = v[i];
+        }
+    });
+}
+
+
+void pointArrayToVector(ArrayView<Point4> p, Vector3 *out)
+{
+    parallelFor(0, p.size(), [&](size_t i)
+    {
+        Vector3 r = {p[i].x, p[i].y, p[i].z};
+        out[i] = r;
+    });
+}
+
+
+void vectorArrayToPoint(ArrayView<Vector3> v, Point4 *out)
+{
+    parallelFor(0, v.size(), [&](size_t i)
+    {
+        Point4 r = {v[i].x, v[i].y, v[i].z, 1.0};
+        out[i] = r;
+    });
+}
+
+
+void vectorArrayLerp(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double tween, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        const Vector3 &start = v1[i];
+        out[i] = add(start, scale(subtract(v2[i], start), tween));
+    });
+}
+
+
+void vectorArraySlerp(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double tween, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        const Vector3 &start = v1[i];
+        const Vector3 &end   = v2[i];
+
+        double d = std::min(1.0, std::max(0.0, dot(start, end)));
+        double theta = acos(d) * tween;
+
+        Vector3 v = subtract(end, scale(start, d));
+
+        out[i] = add(scale(start, cos(theta)), scale(v, sin(theta)));
+    });
+}
@@ -0,0 +1,64 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+vectorKernels
+    Elementwise vector operations behind the vector array nodes. These have
+    no Maya dependency, and follow the results of the matching MVector and
+    MPoint operators.
+
+    Each kernel writes n elements to out, which must not overlap the 
+    inputs. Inputs taken as a BroadcastView are read at every index, so a 
+    single value is used with every element of the other input.
+*/
+
+#pragma once
+
+#include "arrayView.h"
+#include "xformTypes.h"
+
+#include <stddef.h>
+
+void            vectorArrayAdd(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n);
+void            vectorArraySubtract(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n);
+void            vectorArrayCross(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n);
+
+void            vectorArrayDistance(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double *out, size_t n);
+void            vectorArrayDot(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double *out, size_t n);
+void            vectorArrayLength(BroadcastView<Vector3> v, double *out, size_t n);
+
+/** Zero length vectors are left as they are. */
+void            vectorArrayNormalize(ArrayView<Vector3> v, Vector3 *out);
+void            vectorArrayNegate(ArrayView<Vector3> v, Vector3 *out);
+
+void            vectorArrayMultiply(ArrayView<Vector3> v, BroadcastView<double> s, Vector3 *out);
+void            vectorArrayDivide(ArrayView<Vector3> v, BroadcastView<double> s, Vector3 *out);
+
+/** Transforms directions, ignoring the translation of the matrices. */
+void            vectorArrayMatrixProduct(BroadcastView<Vector3> v, BroadcastView<Matrix4> m, Vector3 *out, size_t n);
+
+/** Transforms positions. Like MVector(MPoint), the resulting w is ignored. */
+void            pointArrayMatrixProduct(BroadcastView<Vector3> v, BroadcastView<Matrix4> m, Vector3 *out, size_t n);
+
+/** 
+    Rotates each vector by the rotation at the same index, as MVector::rotateBy
+    does. Vectors past the end of the rotations are copied unchanged.
+*/
+void            vectorArrayRotateByQuat(ArrayView<Vector3> v, ArrayView<Quaternion> q, Vector3 *out);
+void            vectorArrayRotateByEuler(ArrayView<Vector3> v, ArrayView<EulerRotation> e, Vector3 *out);
+
+/** Like MVector(MPoint), w is ignored. */
+void            pointArrayToVector(ArrayView<Point4> p, Vector3 *out);
+
+/** Like MPoint(MVector), w is 1. */
+void            vectorArrayToPoint(ArrayView<Vector3> v, Point4 *out);
+
+void            vectorArrayLerp(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double tween, Vector3 *out, size_t n);
+
+/**
+    Rotates each start vector towards its end vector, assuming both are
+    normalized. The dot product is clamped to [0, 1].
+*/
+void            vectorArraySlerp(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, double tween, Vector3 *out, size_t n);
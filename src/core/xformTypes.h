@@ -0,0 +1,45 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+xformTypes
+    Plain element types used by the core kernels. These have no Maya
+    dependency. Each matches the memory layout of the Maya class it stands
+    in for, so arrays of MVector, MPoint, MQuaternion, MEulerRotation and 
+    MMatrix can be passed to the kernels without copying.
+*/
+
+#pragma once
+
+/** Laid out like MVector. */
+struct Vector3
+{
+    double x, y, z;
+};
+
+/** Laid out like MPoint. */
+struct Point4
+{
+    double x, y, z, w;
+};
+
+/** Laid out like MQuaternion. */
+struct Quaternion
+{
+    double x, y, z, w;
+};
+
+/** Laid out like MEulerRotation. Angles are in radians, and order is a RotateOrder. */
+struct EulerRotation
+{
+    double x, y, z;
+    int    order;
+};
+
+/** Laid out like MMatrix; rows are indexed first. */
+struct Matrix4
+{
+    double m[4][4];
+};
@@ -11,10 +11,16 @@ angleArray data
 
 #include "angleArrayData.h"
 #include "arrayData.h"
+#include "../core/sidecarFile.h"
 
 #include <algorithm>
+#include <atomic>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <maya/MAngle.h>
@@ -25,7 +31,15 @@ angleArray data
 #include <maya/MString.h>
 #include <maya/MStatus.h>
 
-AngleArrayData::AngleArrayData() {}
+std::atomic<uint64_t> AngleArrayData::nextId(1);
+
+AngleArrayData::AngleArrayData() : 
+    isLoaded(true), 
+    sidecarUnit(MAngle::kInvalid), 
+    id(nextId++), 
+    base(0), 
+    dirty(DirtyRange::all()) 
+{}
 
 AngleArrayData::~AngleArrayData() {}
 
@@ -37,7 +51,14 @@ void* AngleArrayData::creator()
 
 unsigned int AngleArrayData::length()
 {
-    return (unsigned int) this->data.size();
+    // Loading is the only change made from other threads, so loaded values are read without the lock.
+    if (!this->isLoaded.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(this->loadMutex);
+        if (!this->isLoaded) { return (unsigned int) this->sidecar->numberOfItems(); }
+    }
+
+    return (unsigned int) this->data.get().size();
 }
 
 
@@ -45,6 +66,14 @@ MStatus AngleArrayData::readASCII(const MArgList& args, unsigned int &end)
 {
     MStatus status;
 
+    unsigned numberOfItems = 0;
+    std::string path;
+
+    if (readASCIISidecar(args, end, numberOfItems, path))
+    {
+        return this->readSidecar(numberOfItems, path);
+    }
+
     std::vector<double> values = readASCIIData(1, args, end, &status);
     if (status) { this->setValues(values); }
 
@@ -56,8 +85,13 @@ MStatus AngleArrayData::writeASCII(std::ostream &out)
 {
     MStatus status;
 
+    if (this->writeSidecar())
+    {
+        return writeASCIISidecar(this->length(), this->sidecar->path(), out);
+    }
+
     std::vector<double> values = this->getValues();
-    status = writeASCIIData(values, this->length(), out);
+    status = writeASCIIData(values.data(), values.size(), this->length(), out);
 
     return status; 
 }
@@ -67,8 +101,43 @@ MStatus AngleArrayData::readBinary(std::istream &in, unsigned int length)
 {
     MStatus status; 
 
-    std::vector<double> values = readBinaryData(1, in, length, &status);
-    if (status) { this->setValues(values); }
+    unsigned numberOfItems = 0;
+    unsigned marker = 0;
+    status = readBinaryItemCount(1, in, length, numberOfItems, marker);
+
+    if (status && marker == SIDECAR_ITEM_COUNT)
+    {
+        std::string path;
+        status = readBinarySidecar(in, length, numberOfItems, path);
+
+        if (status) 
+        { 
+            status = this->readSidecar(numberOfItems, path); 
+        }
+    } else if (status && marker != 0) {
+        status = MStatus::kFailure;
+    } else if (status) {
+        MAngle::Unit unit = MAngle::uiUnit();
+        std::vector<MAngle> values(numberOfItems);
+        double buffer[BINARY_BLOCK_SIZE];
+
+        for (size_t i = 0; i < numberOfItems && status; i += BINARY_BLOCK_SIZE)
+        {
+            size_t numberOfBlockItems = std::min(BINARY_BLOCK_SIZE, numberOfItems - i);
+            status = readBinaryValues(buffer, numberOfBlockItems, in);
+
+            for (size_t j = 0; j < numberOfBlockItems && status; j++)
+            {
+                values[i+j] = MAngle(buffer[j], unit);
+            }
+        }
+
+        if (status) 
+        { 
+            this->data.set(std::move(values)); 
+            this->setChanged();
+        }
+    }
 
     return status; 
 }
@@ -78,27 +147,77 @@ MStatus AngleArrayData::writeBinary(std::ostream &out)
 {
     MStatus status;
 
-    std::vector<double> values = this->getValues();
-    status = writeBinaryData(values, this->length(), out);
+    if (this->writeSidecar())
+    {
+        return writeBinarySidecar(this->length(), this->sidecar->path(), out);
+    }
+
+    const std::vector<MAngle> &array = this->array();
+    status = writeBinaryItemCount((unsigned) array.size(), out);
+
+    size_t numberOfItems = array.size();
+    double buffer[BINARY_BLOCK_SIZE];
+
+    for (size_t i = 0; i < numberOfItems && status; i += BINARY_BLOCK_SIZE)
+    {
+        size_t numberOfBlockItems = std::min(BINARY_BLOCK_SIZE, numberOfItems - i);
+
+        for (size_t j = 0; j < numberOfBlockItems; j++)
+        {
+            buffer[j] = array[i+j].value();
+        }
+
+        status = writeBinaryValues(buffer, numberOfBlockItems, out);
+    }
 
     return status; 
 }
 
 
+const std::vector<MAngle>& AngleArrayData::array() const
+{
+    this->load();
+    return this->data.get();
+}
+
+
 std::vector<MAngle> AngleArrayData::getArray()
 {
-    return std::vector<MAngle>(this->data);
+    return std::vector<MAngle>(this->array());
+}
+
+
+std::vector<MAngle> AngleArrayData::takeArray()
+{
+    this->array();
+
+    std::vector<MAngle> array;
+
+    if (this->data.useCount() == 1)
+    {
+        array = std::move(this->data.edit());
+    } else {
+        array = this->data.get();
+    }
+
+    this->data.reset();
+    this->setChanged();
+
+    return array;
 }
 
 
 void AngleArrayData::setArray(std::vector<MAngle> &array)
 {
-    this->data.resize(array.size());
-    std::copy(
-        array.begin(), 
-        array.end(),
-        this->data.begin()
-    );
+    this->data.assign(array);
+    this->setChanged();
+}
+
+
+void AngleArrayData::setArray(std::vector<MAngle> &&array)
+{
+    this->data.set(std::move(array));
+    this->setChanged();
 }
 
 
@@ -106,24 +225,29 @@ void AngleArrayData::setValues(std::vector<double> &values)
 {
     MAngle::Unit u = MAngle::uiUnit();
     size_t numberOfItems = values.size();
-    this->data.resize(numberOfItems);
+    std::vector<MAngle> array(numberOfItems);
 
     for (size_t i = 0; i < numberOfItems; i++)
     {
-        this->data[i] = MAngle(values[i], u);
+        array[i] = MAngle(values[i], u);
     }
+
+    this->data.set(std::move(array));
+    this->setChanged();
 }
 
 
 std::vector<double> AngleArrayData::getValues()
 {
+    const std::vector<MAngle> &array = this->array();
+
     std::vector<double> values;
-    size_t numberOfItems = data.size();
+    size_t numberOfItems = array.size();
     values.resize(numberOfItems);
 
     for (size_t i = 0; i < numberOfItems; i++)
     {
-        values[i] = data[i].value();
+        values[i] = array[i].value();
     }
 
     return values;
@@ -132,18 +256,138 @@ std::vector<double> AngleArrayData::getValues()
 
 void AngleArrayData::copy(const MPxData& other)
 {
-    if (this->typeId() == other.typeId())
+    if (this->typeId() == other.typeId() && this != &other)
     {
         const AngleArrayData &otherData = (const AngleArrayData &) other;
-        this->data.resize(otherData.data.size());
-        std::copy(
-            otherData.data.begin(), 
-            otherData.data.end(),
-            this->data.begin()
-        );
+        std::unique_lock<std::mutex> otherLock(otherData.loadMutex, std::defer_lock);
+        std::unique_lock<std::mutex> lock(this->loadMutex, std::defer_lock);
+        std::lock(otherLock, lock);
+
+        this->data = otherData.data;
+        this->isLoaded = otherData.isLoaded.load();
+        this->sidecar = otherData.sidecar;
+        this->sidecarUnit = otherData.sidecarUnit;
+
+        this->id = otherData.id;
+        this->base = otherData.base;
+        this->dirty = otherData.dirty;
+    }
+}
+
+
+uint64_t AngleArrayData::contentId() const
+{
+    return this->id;
+}
+
+
+uint64_t AngleArrayData::baseId() const
+{
+    return this->base;
+}
+
+
+DirtyRange AngleArrayData::dirtyRange() const
+{
+    return this->dirty;
+}
+
+
+void AngleArrayData::setDirtyRange(uint64_t baseId, const DirtyRange &range)
+{
+    this->base = baseId;
+    this->dirty = range;
+}
+
+
+size_t AngleArrayData::footprint() const
+{
+    return sizeof(*this) + this->data.share(this->data.get().capacity() * sizeof(MAngle));
+}
+
+
+void AngleArrayData::setChanged()
+{
+    std::lock_guard<std::mutex> lock(this->loadMutex);
+
+    this->sidecar.reset();
+    this->isLoaded = true;
+    this->id = nextId++;
+    this->base = 0;
+    this->dirty = DirtyRange::all();
+}
+
+
+void AngleArrayData::load() const
+{
+    if (this->isLoaded.load(std::memory_order_acquire)) { return; }
+
+    std::lock_guard<std::mutex> lock(this->loadMutex);
+
+    if (!this->isLoaded)
+    {
+        const double *values = this->sidecar->values();
+        size_t numberOfItems = this->sidecar->numberOfItems();
+        std::vector<MAngle> array(numberOfItems);
+
+        for (size_t i = 0; i < numberOfItems; i++)
+        {
+            array[i] = MAngle(values[i], this->sidecarUnit);
+        }
+
+        this->data.set(std::move(array));
+        this->isLoaded.store(true, std::memory_order_release);
     }
 }
 
+
+MStatus AngleArrayData::readSidecar(unsigned numberOfItems, const std::string &path)
+{
+    MStatus status;
+
+    std::shared_ptr<const SidecarFile> file = openSidecar(path, 1, numberOfItems, &status);
+
+    if (status)
+    {
+        this->data.reset();
+        this->setChanged();
+
+        std::lock_guard<std::mutex> lock(this->loadMutex);
+        this->sidecar = file;
+        this->sidecarUnit = sidecarAngleUnit(*file);
+        this->isLoaded = false;
+    }
+
+    return status;
+}
+
+
+bool AngleArrayData::writeSidecar()
+{
+    if (!useSidecar(this->length())) { return false; }
+
+    {
+        std::lock_guard<std::mutex> lock(this->loadMutex);
+        if (this->sidecar) { return true; }
+    }
+
+    const std::vector<MAngle> &array = this->array();
+    std::vector<double> values(array.size());
+
+    for (size_t i = 0; i < array.size(); i++)
+    {
+        values[i] = array[i].asRadians();
+    }
+
+    std::shared_ptr<const SidecarFile> file = SidecarFile::write(values.data(), 1, values.size(), (uint8_t) MAngle::kRadians);
+
+    std::lock_guard<std::mutex> lock(this->loadMutex);
+    this->sidecar = file;
+
+    return file != nullptr;
+}
+
+
 MTypeId AngleArrayData::typeId() const
 {
     return AngleArrayData::TYPE_ID;
@@ -5,8 +5,19 @@
 
 #pragma once
 
+#include "../core/dirtyRange.h"
+#include "../core/sharedBuffer.h"
+#include "../core/sidecarFile.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
 #include <vector>
 
 #include <maya/MAngle.h>
@@ -16,6 +27,13 @@
 #include <maya/MStatus.h>
 #include <maya/MSyntax.h>
 
+/**
+    The values are held in a shared buffer, and contentId, baseId, 
+    dirtyRange and footprint work as they do for QuatArrayData. Values read
+    from a sidecar file are copied out of the mapped file when the array is
+    first requested. Sidecar files hold the angles in radians, and record 
+    that in their header.
+*/
 class AngleArrayData : public MPxData
 {
 public:
@@ -31,9 +49,25 @@ public:
 
     virtual void    copy(const MPxData &src);
 
-    virtual unsigned int        length();
-    virtual std::vector<MAngle> getArray();
-    virtual void                setArray(std::vector<MAngle> &array);                   
+    virtual unsigned int               length();
+    virtual const std::vector<MAngle>& array() const;
+    virtual std::vector<MAngle>        getArray();
+
+    /** 
+        Moves the array out and leaves this data empty, with a new contentId.
+        The array is only copied if other data shares it.
+    */
+    virtual std::vector<MAngle>        takeArray();
+
+    virtual void                       setArray(std::vector<MAngle> &array);
+    virtual void                       setArray(std::vector<MAngle> &&array);                   
+
+    virtual uint64_t                   contentId() const;
+    virtual uint64_t                   baseId() const;
+    virtual DirtyRange                 dirtyRange() const;
+    virtual void                       setDirtyRange(uint64_t baseId, const DirtyRange &range);
+
+    virtual size_t                     footprint() const;
 
     virtual MTypeId typeId() const;
     virtual MString name()   const;
@@ -45,7 +79,27 @@ public:
 private:
     virtual void                setValues(std::vector<double> &values);
     virtual std::vector<double> getValues();
+
+    void                        setChanged();
+
+    /** Copies the values out of the sidecar file, unless they already have been. */
+    void                        load() const;
+
+    MStatus                     readSidecar(unsigned numberOfItems, const std::string &path);
+
+    /** Returns true if the values are, or have now been, written to a sidecar file. */
+    bool                        writeSidecar();
     
 private:
-    std::vector<MAngle> data;
+    mutable SharedBuffer<std::vector<MAngle>> data;
+    mutable std::mutex                        loadMutex;
+    mutable std::atomic<bool>                 isLoaded;
+    std::shared_ptr<const SidecarFile>        sidecar;
+    MAngle::Unit                              sidecarUnit;
+
+    uint64_t                                  id;
+    uint64_t                                  base;
+    DirtyRange                                dirty;
+
+    static std::atomic<uint64_t> nextId;
 };
\ No newline at end of file
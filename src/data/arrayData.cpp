@@ -1,15 +1,26 @@
 #include "arrayData.h"
+#include "../core/doubleText.h"
+#include "../core/sidecarFile.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <istream>
+#include <memory>
 #include <ostream>
+#include <string>
 #include <vector>
 
+#include <maya/MAngle.h>
 #include <maya/MArgList.h>
 #include <maya/MGlobal.h>
 #include <maya/MStatus.h>
-#include <maya/MStatus.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+
+const size_t ASCII_FLUSH_SIZE = 65536;
+
 
 std::vector<double> readASCIIData(unsigned numberOfElementsPerItem, const MArgList &args, unsigned int &end, MStatus *ReturnStatus)
 {
@@ -32,8 +43,7 @@ std::vector<double> readASCIIData(unsigned numberOfElementsPerItem, const MArgLi
 
     if (status)
     {
-        int valuesParsed = 0;
-
+        unsigned valuesParsed = 0;
         result.resize(numberOfItems * numberOfElementsPerItem);
 
         bool argumentsAreInTuples = numberOfElementsPerItem > 1 && (numberOfItems == numberOfArguments);
@@ -51,9 +61,8 @@ std::vector<double> readASCIIData(unsigned numberOfElementsPerItem, const MArgLi
                 {
                     for (unsigned j = 0; j < n; j++)
                     {
-                        if (argStr[j].isDouble())
+                        if (parseDouble(argStr[j].asChar(), result[(i*n)+j]))
                         {
-                            result[(i*n)+j] = argStr[j].asDouble();
                             valuesParsed++;
                         }
                     }
@@ -64,9 +73,8 @@ std::vector<double> readASCIIData(unsigned numberOfElementsPerItem, const MArgLi
             {
                 MString arg = args.asString(end++, &status);
 
-                if (status && arg.isDouble())
+                if (status && parseDouble(arg.asChar(), result[i]))
                 {
-                    result[i] = arg.asDouble();
                     valuesParsed++;
                 }
             }
@@ -82,92 +90,210 @@ std::vector<double> readASCIIData(unsigned numberOfElementsPerItem, const MArgLi
 }
 
 
-std::vector<double> readBinaryData(unsigned numberOfElementsPerItem, std::istream &in, unsigned int length, MStatus *ReturnStatus)
+MStatus readBinaryItemCount(unsigned numberOfElementsPerItem, std::istream &in, unsigned int length, unsigned &numberOfItems)
 {
-    bool readFailed = false;
+    unsigned marker = 0;
+    MStatus status = readBinaryItemCount(numberOfElementsPerItem, in, length, numberOfItems, marker);
 
-    std::vector<double> result;
+    return marker != 0 ? MStatus::kFailure : status;
+}
 
-    if (length > 0)
-    {
-        unsigned numberOfItems;
-        in.read((char*) &numberOfItems, sizeof(numberOfItems));
 
-        if (in.fail())
-        {
-            readFailed = true;
-        } else {
-            result.resize(numberOfItems * numberOfElementsPerItem);
+MStatus readBinaryItemCount(unsigned numberOfElementsPerItem, std::istream &in, unsigned int length, unsigned &numberOfItems, unsigned &marker)
+{
+    numberOfItems = 0;
+    marker = 0;
 
-            for (unsigned i = 0; i < numberOfItems * numberOfElementsPerItem; i++)
-            {
-                in.read((char*) &result[i], sizeof(result[i]));
-                readFailed = in.fail();
+    if (length == 0) { return MStatus::kSuccess; }
 
-                if (readFailed) { break; }
-            }
-        }
-    }
+    in.read((char*) &numberOfItems, sizeof(numberOfItems));
 
-    if (ReturnStatus) 
+    if (in.fail()) 
     { 
-        *ReturnStatus = readFailed ? MStatus::kFailure : MStatus::kSuccess; 
+        numberOfItems = 0;
+        return MStatus::kFailure; 
     }
 
-    return result;
+    if (numberOfItems == ENCODED_ITEM_COUNT || numberOfItems == SIDECAR_ITEM_COUNT || numberOfItems == ORDERED_ITEM_COUNT)
+    {
+        marker = numberOfItems;
+        numberOfItems = 0;
+        return MStatus::kSuccess;
+    }
+
+    size_t numberOfBytes = sizeof(numberOfItems) + ((size_t) numberOfItems * numberOfElementsPerItem * sizeof(double));
+
+    if (numberOfBytes > length)
+    {
+        numberOfItems = 0;
+        return MStatus::kFailure;
+    }
+
+    return MStatus::kSuccess;
 }
 
 
-MStatus writeASCIIData(std::vector<double> values, unsigned numberOfItems, std::ostream &out)
+MStatus readBinaryValues(double *values, size_t numberOfValues, std::istream &in)
 {
-    MStatus status;
+    if (numberOfValues == 0) { return MStatus::kSuccess; }
+
+    in.read((char*) values, numberOfValues * sizeof(double));
+
+    return in.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+
+MStatus writeASCIIData(const double *values, size_t numberOfValues, unsigned numberOfItems, std::ostream &out)
+{
+    char buffer[DOUBLE_TEXT_BUFFER_SIZE];
 
-    size_t numberOfValues = values.size();
+    std::string text;
+    text.reserve(ASCII_FLUSH_SIZE + DOUBLE_TEXT_BUFFER_SIZE);
 
-    out << numberOfItems << " ";
+    snprintf(buffer, DOUBLE_TEXT_BUFFER_SIZE, "%u ", numberOfItems);
+    text.append(buffer);
 
-    if (out.fail())
+    for (size_t i = 0; i < numberOfValues; i++)
     {
-        status =  MStatus::kFailure;
-    } else {
-        for (size_t i = 0; i < numberOfValues; i++)
+        int length = formatDouble(values[i], buffer);
+        text.append(buffer, length);
+        text.push_back(' ');
+
+        if (text.size() >= ASCII_FLUSH_SIZE)
         {
-            out << values[i] << " ";
+            out.write(text.data(), text.size());
+            text.clear();
 
-            if (out.fail())
-            {
-                status = MStatus::kFailure;
-                break;
-            }
+            if (out.fail()) { return MStatus::kFailure; }
         }
     }
 
-    return status;
+    out.write(text.data(), text.size());
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
 }
 
 
-MStatus writeBinaryData(std::vector<double> values, unsigned numberOfItems, std::ostream &out)
+MStatus writeBinaryItemCount(unsigned numberOfItems, std::ostream &out)
 {
-    MStatus status;
-    
-    size_t numberOfValues = values.size();
     out.write((char*) &numberOfItems, sizeof(numberOfItems));
 
-    if (out.fail())
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+
+MStatus writeBinaryValues(const double *values, size_t numberOfValues, std::ostream &out)
+{
+    if (numberOfValues == 0) { return MStatus::kSuccess; }
+
+    out.write((const char*) values, numberOfValues * sizeof(double));
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+
+bool readASCIISidecar(const MArgList &args, unsigned int &end, unsigned &numberOfItems, std::string &path)
+{
+    MStatus status;
+
+    if (args.length() < end + 3 || args.asInt(end, &status) != SIDECAR_ASCII_ITEM_COUNT || !status)
     {
-        status = MStatus::kFailure;
-    } else {
-        for (size_t i = 0; i < numberOfValues; i++)
-        {
-            out.write((char*) &values[i], sizeof(values[i]));
+        return false;
+    }
 
-            if (out.fail())
-            {
-                status = MStatus::kFailure;
-                break;
-            }
-        }
+    int count = args.asInt(end + 1, &status);
+    if (!status || count < 0) { return false; }
+
+    MString pathArg = args.asString(end + 2, &status);
+    if (!status) { return false; }
+
+    numberOfItems = (unsigned) count;
+    path = pathArg.asChar();
+    end += 3;
+
+    return true;
+}
+
+
+MStatus writeASCIISidecar(unsigned numberOfItems, const std::string &path, std::ostream &out)
+{
+    std::string text = std::to_string(SIDECAR_ASCII_ITEM_COUNT) + " " + std::to_string(numberOfItems) + " \"";
+
+    for (char c : path)
+    {
+        if (c == '\\' || c == '"') { text.push_back('\\'); }
+        text.push_back(c);
+    }
+
+    text.append("\" ");
+    out.write(text.data(), text.size());
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+
+MStatus readBinarySidecar(std::istream &in, unsigned int length, unsigned &numberOfItems, std::string &path)
+{
+    unsigned header[2] = {0, 0};
+    in.read((char*) header, sizeof(header));
+
+    if (in.fail()) { return MStatus::kFailure; }
+
+    unsigned pathLength = header[1];
+
+    if (sizeof(unsigned) + sizeof(header) + (size_t) pathLength > length)
+    {
+        return MStatus::kFailure;
+    }
+
+    path.resize(pathLength);
+
+    if (pathLength > 0)
+    {
+        in.read(&path[0], pathLength);
+        if (in.fail()) { return MStatus::kFailure; }
+    }
+
+    numberOfItems = header[0];
+
+    return MStatus::kSuccess;
+}
+
+
+MStatus writeBinarySidecar(unsigned numberOfItems, const std::string &path, std::ostream &out)
+{
+    unsigned header[3] = {SIDECAR_ITEM_COUNT, numberOfItems, (unsigned) path.size()};
+
+    out.write((const char*) header, sizeof(header));
+    out.write(path.data(), path.size());
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+
+std::shared_ptr<const SidecarFile> openSidecar(const std::string &path, unsigned numberOfElementsPerItem, unsigned numberOfItems, MStatus *ReturnStatus)
+{
+    std::shared_ptr<const SidecarFile> file = SidecarFile::open(path, numberOfElementsPerItem, numberOfItems);
+
+    if (!file)
+    {
+        MGlobal::displayError(MString("Could not map the array sidecar file \"") + path.c_str() + "\".");
+    }
+
+    if (ReturnStatus) { *ReturnStatus = file ? MStatus::kSuccess : MStatus::kFailure; }
+
+    return file;
+}
+
+
+MAngle::Unit sidecarAngleUnit(const SidecarFile &file)
+{
+    uint8_t unit = file.valueUnit();
+
+    if (unit > (uint8_t) MAngle::kInvalid && unit < (uint8_t) MAngle::kLast)
+    {
+        return (MAngle::Unit) unit;
     }
 
-    return status; 
+    return MAngle::uiUnit();
 }
@@ -1,14 +1,67 @@
 #pragma once 
 
+#include "../core/sidecarFile.h"
+
 #include <istream>
+#include <memory>
 #include <ostream>
+#include <string>
 #include <vector>
 
+#include <maya/MAngle.h>
 #include <maya/MArgList.h>
 #include <maya/MStatus.h>
 
+/** Number of doubles staged per block when converting typed storage to/from the binary stream. */
+const size_t BINARY_BLOCK_SIZE = 4096;
+
 std::vector<double> readASCIIData(unsigned numberOfElementsPerItem, const MArgList &args, unsigned int &end, MStatus *ReturnStatus=NULL);  
-std::vector<double> readBinaryData(unsigned numberOfElementsPerItem, std::istream &in, unsigned int length, MStatus *ReturnStatus=NULL);
 
-MStatus writeASCIIData(std::vector<double> values, unsigned numberOfItems, std::ostream &out);
-MStatus writeBinaryData(std::vector<double> values, unsigned numberOfItems, std::ostream &out);
+/** 
+    Written in place of the binary item count when the items that follow are
+    encoded, or are in a sidecar file, or when rotation orders come before
+    the item count. None can pass the length check of an array written 
+    inline.
+*/
+const unsigned ENCODED_ITEM_COUNT = 0xFFFFFFFF;
+const unsigned SIDECAR_ITEM_COUNT = 0xFFFFFFFE;
+const unsigned ORDERED_ITEM_COUNT = 0xFFFFFFFD;
+
+/** Written in place of the ASCII item count when the items are in a sidecar file. */
+const int SIDECAR_ASCII_ITEM_COUNT = -1;
+
+/** Written before the ASCII item count when rotation orders come first. */
+const int ORDERED_ASCII_ITEM_COUNT = -2;
+
+/** Reads the item count, failing on a marker. */
+MStatus readBinaryItemCount(unsigned numberOfElementsPerItem, std::istream &in, unsigned int length, unsigned &numberOfItems);
+
+/** Reads the item count, or sets marker to the marker read in its place. marker is 0 otherwise. */
+MStatus readBinaryItemCount(unsigned numberOfElementsPerItem, std::istream &in, unsigned int length, unsigned &numberOfItems, unsigned &marker);
+
+/** 
+    Reads the item count and path written by writeASCIISidecar, if the 
+    arguments at end start with SIDECAR_ASCII_ITEM_COUNT. Returns false, 
+    without moving end, otherwise.
+*/
+bool    readASCIISidecar(const MArgList &args, unsigned int &end, unsigned &numberOfItems, std::string &path);
+MStatus writeASCIISidecar(unsigned numberOfItems, const std::string &path, std::ostream &out);
+
+/** Reads the item count and path that follow SIDECAR_ITEM_COUNT. */
+MStatus readBinarySidecar(std::istream &in, unsigned int length, unsigned &numberOfItems, std::string &path);
+MStatus writeBinarySidecar(unsigned numberOfItems, const std::string &path, std::ostream &out);
+
+/** Maps the sidecar file at path, displaying an error if it cannot be. */
+std::shared_ptr<const SidecarFile> openSidecar(const std::string &path, unsigned numberOfElementsPerItem, unsigned numberOfItems, MStatus *ReturnStatus);
+
+/** 
+    Returns the unit of the angles in a sidecar file. Files written before 
+    units were recorded hold angles in the UI unit, as inline values are.
+*/
+MAngle::Unit sidecarAngleUnit(const SidecarFile &file);
+MStatus readBinaryValues(double *values, size_t numberOfValues, std::istream &in);
+
+MStatus writeASCIIData(const double *values, size_t numberOfValues, unsigned numberOfItems, std::ostream &out);
+
+MStatus writeBinaryItemCount(unsigned numberOfItems, std::ostream &out);
+MStatus writeBinaryValues(const double *values, size_t numberOfValues, std::ostream &out);
@@ -7,17 +7,30 @@
 eulerArray data
     Custom data type for a variable length array of euler rotations. 
     This array is contiguous, unlike a multi-attribute, which may be sparse.
+
+    Arrays that are all in XYZ order are written as x, y, z values only. 
+    Other arrays write their rotation orders first: ORDERED_ASCII_ITEM_COUNT
+    or ORDERED_ITEM_COUNT, the number of orders, and the orders, followed
+    by the values as usual. There is one order when every rotation shares
+    it, and one per rotation otherwise. ASCII orders are ints, and binary
+    orders are a uint32 count and one byte each.
 */
 
 #include "eulerArrayData.h"
 #include "arrayData.h"
+#include "../core/sidecarFile.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
 #include <algorithm>
+#include <atomic>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <maya/MAngle.h>
@@ -32,7 +45,163 @@ eulerArray data
 #include <maya/MStatus.h>
 #include <maya/MVector.h>
 
-EulerArrayData::EulerArrayData() {}
+std::atomic<uint64_t> EulerArrayData::nextId(1);
+
+static const std::vector<uint8_t> XYZ_ORDER(1, (uint8_t) MEulerRotation::kXYZ);
+
+static inline bool isValidOrder(int order)
+{
+    return order >= MEulerRotation::kXYZ && order <= MEulerRotation::kZYX;
+}
+
+
+/** Returns the rotation of three angles in unit, stored as they are written. */
+static inline MEulerRotation toRotation(const double *values, MAngle::Unit unit, uint8_t order)
+{
+    return MEulerRotation(
+        MAngle(values[0], unit).asRadians(),
+        MAngle(values[1], unit).asRadians(),
+        MAngle(values[2], unit).asRadians(),
+        (MEulerRotation::RotationOrder) order
+    );
+}
+
+
+/** Returns the order of item i, from orders read with an array of numberOfItems items. */
+static inline uint8_t itemOrder(const std::vector<uint8_t> &orders, size_t i)
+{
+    return orders.size() == 1 ? orders[0] : orders[i];
+}
+
+
+/** Returns the one order every rotation shares, or one order per rotation if they differ. */
+static std::vector<uint8_t> arrayOrders(const std::vector<MEulerRotation> &array)
+{
+    size_t numberOfItems = array.size();
+    size_t i = 1;
+
+    while (i < numberOfItems && array[i].order == array[0].order) { i++; }
+
+    if (i >= numberOfItems)
+    {
+        return numberOfItems == 0 ? XYZ_ORDER : std::vector<uint8_t>(1, (uint8_t) array[0].order);
+    }
+
+    std::vector<uint8_t> orders(numberOfItems);
+
+    for (i = 0; i < numberOfItems; i++)
+    {
+        orders[i] = (uint8_t) array[i].order;
+    }
+
+    return orders;
+}
+
+
+/** 
+    Reads the orders written by writeASCIIOrders, if the arguments at end 
+    start with ORDERED_ASCII_ITEM_COUNT. orders is XYZ_ORDER otherwise.
+*/
+static MStatus readASCIIOrders(const MArgList &args, unsigned int &end, std::vector<uint8_t> &orders)
+{
+    MStatus status;
+
+    orders = XYZ_ORDER;
+
+    if (args.length() < end + 2 || args.asInt(end, &status) != ORDERED_ASCII_ITEM_COUNT || !status)
+    {
+        return MStatus::kSuccess;
+    }
+
+    int numberOfOrders = args.asInt(end + 1, &status);
+
+    if (!status || numberOfOrders < 1 || args.length() < end + 2 + (unsigned) numberOfOrders)
+    {
+        return MStatus::kFailure;
+    }
+
+    orders.resize((size_t) numberOfOrders);
+
+    for (int i = 0; i < numberOfOrders; i++)
+    {
+        int order = args.asInt(end + 2 + i, &status);
+        if (!status || !isValidOrder(order)) { return MStatus::kFailure; }
+
+        orders[i] = (uint8_t) order;
+    }
+
+    end += 2 + numberOfOrders;
+
+    return MStatus::kSuccess;
+}
+
+
+static MStatus writeASCIIOrders(const std::vector<uint8_t> &orders, std::ostream &out)
+{
+    if (orders == XYZ_ORDER) { return MStatus::kSuccess; }
+
+    std::string text = std::to_string(ORDERED_ASCII_ITEM_COUNT) + " " + std::to_string(orders.size()) + " ";
+
+    for (uint8_t order : orders)
+    {
+        text.append(std::to_string(order));
+        text.push_back(' ');
+    }
+
+    out.write(text.data(), text.size());
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+
+/** Reads the orders that follow ORDERED_ITEM_COUNT, and takes them from length. */
+static MStatus readBinaryOrders(std::istream &in, unsigned int &length, std::vector<uint8_t> &orders)
+{
+    unsigned numberOfOrders = 0;
+    in.read((char*) &numberOfOrders, sizeof(numberOfOrders));
+
+    size_t numberOfBytes = sizeof(ORDERED_ITEM_COUNT) + sizeof(numberOfOrders) + (size_t) numberOfOrders;
+
+    if (in.fail() || numberOfOrders == 0 || numberOfBytes > length) 
+    { 
+        return MStatus::kFailure; 
+    }
+
+    orders.resize(numberOfOrders);
+    in.read((char*) orders.data(), numberOfOrders);
+
+    if (in.fail()) { return MStatus::kFailure; }
+
+    for (uint8_t order : orders)
+    {
+        if (!isValidOrder(order)) { return MStatus::kFailure; }
+    }
+
+    length -= (unsigned int) numberOfBytes;
+
+    return MStatus::kSuccess;
+}
+
+
+static MStatus writeBinaryOrders(const std::vector<uint8_t> &orders, std::ostream &out)
+{
+    if (orders == XYZ_ORDER) { return MStatus::kSuccess; }
+
+    unsigned header[2] = {ORDERED_ITEM_COUNT, (unsigned) orders.size()};
+    out.write((const char*) header, sizeof(header));
+    out.write((const char*) orders.data(), orders.size());
+
+    return out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+}
+
+
+EulerArrayData::EulerArrayData() : 
+    isLoaded(true), 
+    sidecarUnit(MAngle::kInvalid), 
+    id(nextId++), 
+    base(0), 
+    dirty(DirtyRange::all()) 
+{}
 EulerArrayData::~EulerArrayData() {}
 
 void* EulerArrayData::creator()
@@ -43,7 +212,14 @@ void* EulerArrayData::creator()
 
 unsigned int EulerArrayData::length()
 {
-    return (unsigned int) this->data.size();
+    // Loading is the only change made from other threads, so loaded values are read without the lock.
+    if (!this->isLoaded.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(this->loadMutex);
+        if (!this->isLoaded) { return (unsigned int) this->sidecar->numberOfItems(); }
+    }
+
+    return (unsigned int) this->data.get().size();
 }
 
 
@@ -51,8 +227,26 @@ MStatus EulerArrayData::readASCII(const MArgList& args, unsigned int &end)
 {
     MStatus status;
 
+    std::vector<uint8_t> orders;
+    status = readASCIIOrders(args, end, orders);
+    if (!status) { return status; }
+
+    unsigned numberOfItems = 0;
+    std::string path;
+
+    if (readASCIISidecar(args, end, numberOfItems, path))
+    {
+        return this->readSidecar(numberOfItems, path, orders);
+    }
+
     std::vector<double> values = readASCIIData(3, args, end, &status);
-    if (status) { this->setValues(values); }
+
+    if (status && orders.size() != 1 && orders.size() != values.size() / 3)
+    {
+        status = MStatus::kFailure;
+    }
+
+    if (status) { this->setValues(values, orders); }
 
     return status;   
 }
@@ -62,8 +256,16 @@ MStatus EulerArrayData::writeASCII(std::ostream &out)
 {
     MStatus status;
 
+    status = writeASCIIOrders(this->orders(), out);
+    if (!status) { return status; }
+
+    if (this->writeSidecar())
+    {
+        return writeASCIISidecar(this->length(), this->sidecar->path(), out);
+    }
+
     std::vector<double> values = this->getValues();
-    status = writeASCIIData(values, this->length(), out);
+    status = writeASCIIData(values.data(), values.size(), this->length(), out);
 
     return status; 
 }
@@ -73,8 +275,64 @@ MStatus EulerArrayData::readBinary(std::istream &in, unsigned int length)
 {
     MStatus status; 
 
-    std::vector<double> values = readBinaryData(3, in, length, &status);
-    if (status) { this->setValues(values); }
+    unsigned numberOfItems = 0;
+    unsigned marker = 0;
+    status = readBinaryItemCount(3, in, length, numberOfItems, marker);
+
+    std::vector<uint8_t> orders = XYZ_ORDER;
+
+    if (status && marker == ORDERED_ITEM_COUNT)
+    {
+        status = readBinaryOrders(in, length, orders);
+
+        if (status)
+        {
+            status = readBinaryItemCount(3, in, length, numberOfItems, marker);
+        }
+
+        if (status && marker == ORDERED_ITEM_COUNT)
+        {
+            status = MStatus::kFailure;
+        }
+    }
+
+    if (status && marker == SIDECAR_ITEM_COUNT)
+    {
+        std::string path;
+        status = readBinarySidecar(in, length, numberOfItems, path);
+
+        if (status) 
+        { 
+            status = this->readSidecar(numberOfItems, path, orders); 
+        }
+    } else if (status && orders.size() != 1 && orders.size() != numberOfItems) {
+        status = MStatus::kFailure;
+    } else if (status && marker != 0) {
+        status = MStatus::kFailure;
+    } else if (status) {
+        MAngle::Unit unit = MAngle::uiUnit();
+        std::vector<MEulerRotation> values(numberOfItems);
+        double buffer[BINARY_BLOCK_SIZE];
+
+        const size_t blockSize = BINARY_BLOCK_SIZE / 3;
+
+        for (size_t i = 0; i < numberOfItems && status; i += blockSize)
+        {
+            size_t numberOfBlockItems = std::min(blockSize, numberOfItems - i);
+            status = readBinaryValues(buffer, numberOfBlockItems * 3, in);
+
+            for (size_t j = 0; j < numberOfBlockItems && status; j++)
+            {
+                values[i+j] = toRotation(&buffer[j*3], unit, itemOrder(orders, i+j));
+            }
+        }
+
+        if (status) 
+        { 
+            this->data.set(std::move(values)); 
+            this->setChanged();
+        }
+    }
 
     return status; 
 }
@@ -84,59 +342,117 @@ MStatus EulerArrayData::writeBinary(std::ostream &out)
 {
     MStatus status;
 
-    std::vector<double> values = this->getValues();
-    status = writeBinaryData(values, this->length(), out);
+    status = writeBinaryOrders(this->orders(), out);
+    if (!status) { return status; }
+
+    if (this->writeSidecar())
+    {
+        return writeBinarySidecar(this->length(), this->sidecar->path(), out);
+    }
+
+    const std::vector<MEulerRotation> &array = this->array();
+    status = writeBinaryItemCount((unsigned) array.size(), out);
+
+    size_t numberOfItems = array.size();
+    double buffer[BINARY_BLOCK_SIZE];
+
+    const size_t blockSize = BINARY_BLOCK_SIZE / 3;
+
+    for (size_t i = 0; i < numberOfItems && status; i += blockSize)
+    {
+        size_t numberOfBlockItems = std::min(blockSize, numberOfItems - i);
+
+        for (size_t j = 0; j < numberOfBlockItems; j++)
+        {
+            const MEulerRotation &rot = array[i+j];
+            buffer[(j*3)+0] = rot.x;
+            buffer[(j*3)+1] = rot.y;
+            buffer[(j*3)+2] = rot.z;
+        }
+
+        status = writeBinaryValues(buffer, numberOfBlockItems * 3, out);
+    }
 
     return status; 
 }
 
 
+const std::vector<MEulerRotation>& EulerArrayData::array() const
+{
+    this->load();
+    return this->data.get();
+}
+
+
 std::vector<MEulerRotation> EulerArrayData::getArray()
 {
-    return std::vector<MEulerRotation>(this->data);
+    return std::vector<MEulerRotation>(this->array());
+}
+
+
+std::vector<MEulerRotation> EulerArrayData::takeArray()
+{
+    this->array();
+
+    std::vector<MEulerRotation> array;
+
+    if (this->data.useCount() == 1)
+    {
+        array = std::move(this->data.edit());
+    } else {
+        array = this->data.get();
+    }
+
+    this->data.reset();
+    this->setChanged();
+
+    return array;
 }
 
 
 void EulerArrayData::setArray(std::vector<MEulerRotation> &array)
 {
-    this->data.resize(array.size());
-    std::copy(
-        array.begin(), 
-        array.end(),
-        this->data.begin()
-    );
+    this->data.assign(array);
+    this->setChanged();
 }
 
 
-void EulerArrayData::setValues(std::vector<double> &values)
+void EulerArrayData::setArray(std::vector<MEulerRotation> &&array)
+{
+    this->data.set(std::move(array));
+    this->setChanged();
+}
+
+
+void EulerArrayData::setValues(std::vector<double> &values, const std::vector<uint8_t> &orders)
 {
     size_t numberOfValues = values.size();
     size_t numberOfItems = numberOfValues / 3;
-    this->data.resize(numberOfItems);
+    std::vector<MEulerRotation> array(numberOfItems);
 
     MAngle::Unit unit = MAngle::uiUnit();
 
     for (size_t i = 0; i < numberOfItems; i++)
     {
-        this->data[i] = MEulerRotation(
-            MAngle(values[(i*3)+0], unit).asRadians(),
-            MAngle(values[(i*3)+1], unit).asRadians(),
-            MAngle(values[(i*3)+2], unit).asRadians(),
-            MEulerRotation::RotationOrder::kXYZ
-        );
+        array[i] = toRotation(&values[i*3], unit, itemOrder(orders, i));
     }
+
+    this->data.set(std::move(array));
+    this->setChanged();
 }
 
 
 std::vector<double> EulerArrayData::getValues()
 {
+    const std::vector<MEulerRotation> &array = this->array();
+
     std::vector<double> values;
-    size_t numberOfItems = this->data.size();
+    size_t numberOfItems = array.size();
     values.resize(numberOfItems * 3);
 
     for (size_t i = 0; i < numberOfItems; i++)
     {
-        MEulerRotation &rot = this->data[i];
+        const MEulerRotation &rot = array[i];
         values[(i*3)+0] = rot.x;
         values[(i*3)+1] = rot.y;
         values[(i*3)+2] = rot.z;
@@ -147,18 +463,179 @@ std::vector<double> EulerArrayData::getValues()
 
 void EulerArrayData::copy(const MPxData& other)
 {
-    if (this->typeId() == other.typeId())
+    if (this->typeId() == other.typeId() && this != &other)
     {
         const EulerArrayData &otherData = (const EulerArrayData &) other;
-        this->data.resize(otherData.data.size());
-        std::copy(
-            otherData.data.begin(), 
-            otherData.data.end(),
-            this->data.begin()
-        );
+        std::unique_lock<std::mutex> otherLock(otherData.loadMutex, std::defer_lock);
+        std::unique_lock<std::mutex> lock(this->loadMutex, std::defer_lock);
+        std::lock(otherLock, lock);
+
+        this->data = otherData.data;
+        this->isLoaded = otherData.isLoaded.load();
+        this->sidecar = otherData.sidecar;
+        this->sidecarUnit = otherData.sidecarUnit;
+        this->sidecarOrders = otherData.sidecarOrders;
+
+        this->id = otherData.id;
+        this->base = otherData.base;
+        this->dirty = otherData.dirty;
     }
 }
 
+
+uint64_t EulerArrayData::contentId() const
+{
+    return this->id;
+}
+
+
+uint64_t EulerArrayData::baseId() const
+{
+    return this->base;
+}
+
+
+DirtyRange EulerArrayData::dirtyRange() const
+{
+    return this->dirty;
+}
+
+
+void EulerArrayData::setDirtyRange(uint64_t baseId, const DirtyRange &range)
+{
+    this->base = baseId;
+    this->dirty = range;
+}
+
+
+size_t EulerArrayData::footprint() const
+{
+    return sizeof(*this) + this->data.share(this->data.get().capacity() * sizeof(MEulerRotation));
+}
+
+
+void EulerArrayData::setChanged()
+{
+    std::lock_guard<std::mutex> lock(this->loadMutex);
+
+    this->sidecar.reset();
+    this->isLoaded = true;
+    this->id = nextId++;
+    this->base = 0;
+    this->dirty = DirtyRange::all();
+}
+
+
+void EulerArrayData::load() const
+{
+    if (this->isLoaded.load(std::memory_order_acquire)) { return; }
+
+    std::lock_guard<std::mutex> lock(this->loadMutex);
+
+    if (!this->isLoaded)
+    {
+        const double *values = this->sidecar->values();
+        size_t numberOfItems = this->sidecar->numberOfItems();
+        std::vector<MEulerRotation> array(numberOfItems);
+
+        for (size_t i = 0; i < numberOfItems; i++)
+        {
+            array[i] = toRotation(&values[i*3], this->sidecarUnit, itemOrder(this->sidecarOrders, i));
+        }
+
+        this->data.set(std::move(array));
+        this->isLoaded.store(true, std::memory_order_release);
+    }
+}
+
+
+MStatus EulerArrayData::readSidecar(unsigned numberOfItems, const std::string &path, const std::vector<uint8_t> &orders)
+{
+    MStatus status;
+
+    if (orders.size() != 1 && orders.size() != numberOfItems)
+    {
+        return MStatus::kFailure;
+    }
+
+    std::shared_ptr<const SidecarFile> file = openSidecar(path, 3, numberOfItems, &status);
+
+    if (status)
+    {
+        this->data.reset();
+        this->setChanged();
+
+        std::lock_guard<std::mutex> lock(this->loadMutex);
+        this->sidecar = file;
+        this->sidecarUnit = sidecarAngleUnit(*file);
+        this->sidecarOrders = orders;
+        this->isLoaded = false;
+    }
+
+    return status;
+}
+
+
+bool EulerArrayData::writeSidecar()
+{
+    if (!useSidecar(this->length())) { return false; }
+
+    {
+        std::lock_guard<std::mutex> lock(this->loadMutex);
+        if (this->sidecar) { return true; }
+    }
+
+    std::vector<double> values = this->getValues();
+    std::shared_ptr<const SidecarFile> file = SidecarFile::write(values.data(), 3, values.size() / 3, (uint8_t) MAngle::kRadians);
+
+    std::lock_guard<std::mutex> lock(this->loadMutex);
+    this->sidecar = file;
+
+    return file != nullptr;
+}
+
+
+std::vector<uint8_t> EulerArrayData::orders() const
+{
+    if (!this->isLoaded.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(this->loadMutex);
+        if (!this->isLoaded) { return this->sidecarOrders; }
+    }
+
+    return arrayOrders(this->data.get());
+}
+
+
+MEulerRotation::RotationOrder EulerArrayData::rotationOrder() const
+{
+    return (MEulerRotation::RotationOrder) this->orders()[0];
+}
+
+
+bool EulerArrayData::hasMixedOrders() const
+{
+    return this->orders().size() > 1;
+}
+
+
+void EulerArrayData::setRotationOrder(MEulerRotation::RotationOrder order)
+{
+    std::vector<uint8_t> orders = this->orders();
+    if (orders.size() == 1 && orders[0] == (uint8_t) order) { return; }
+
+    this->load();
+    std::vector<MEulerRotation> &array = this->data.edit();
+
+    for (MEulerRotation &rotation : array)
+    {
+        if (rotation.order != order) { rotation.reorderIt(order); }
+    }
+
+    this->setChanged();
+}
+
+
 MTypeId EulerArrayData::typeId() const
 {
     return EulerArrayData::TYPE_ID;
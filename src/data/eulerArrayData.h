@@ -5,10 +5,22 @@
 
 #pragma once
 
+#include "../core/dirtyRange.h"
+#include "../core/sharedBuffer.h"
+#include "../core/sidecarFile.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
 #include <vector>
 
+#include <maya/MAngle.h>
 #include <maya/MArgList.h>
 #include <maya/MEulerRotation.h>
 #include <maya/MPxData.h>
@@ -16,6 +28,18 @@
 #include <maya/MStatus.h>
 #include <maya/MSyntax.h>
 
+/**
+    The values are held in a shared buffer, and contentId, baseId, 
+    dirtyRange and footprint work as they do for QuatArrayData. Values read
+    from a sidecar file are copied out of the mapped file when the array is
+    first requested. Sidecar files hold the angles in radians, and record 
+    that in their header.
+
+    Each rotation keeps its own order. Arrays are written with a single 
+    rotation order when every rotation shares it, and with one order per 
+    rotation otherwise, so reading an array gives back the orders it was
+    written with.
+*/
 class EulerArrayData : public MPxData
 {
 public:
@@ -31,9 +55,32 @@ public:
 
     virtual void    copy(const MPxData &src);
 
-    virtual unsigned int                length();
-    virtual std::vector<MEulerRotation> getArray();
-    virtual void                        setArray(std::vector<MEulerRotation> &array);  
+    virtual unsigned int                       length();
+    virtual const std::vector<MEulerRotation>& array() const;
+    virtual std::vector<MEulerRotation>        getArray();
+
+    /** 
+        Moves the array out and leaves this data empty, with a new contentId.
+        The array is only copied if other data shares it.
+    */
+    virtual std::vector<MEulerRotation>        takeArray();
+
+    virtual void                               setArray(std::vector<MEulerRotation> &array);
+    virtual void                               setArray(std::vector<MEulerRotation> &&array);  
+
+    virtual uint64_t                           contentId() const;
+    virtual uint64_t                           baseId() const;
+    virtual DirtyRange                         dirtyRange() const;
+    virtual void                               setDirtyRange(uint64_t baseId, const DirtyRange &range);
+
+    virtual size_t                             footprint() const;
+
+    /** Returns the order every rotation shares, or the order of the first if they differ. */
+    virtual MEulerRotation::RotationOrder      rotationOrder() const;
+    virtual bool                               hasMixedOrders() const;
+
+    /** Reorders every rotation that is not in order to the equivalent rotation that is. */
+    virtual void                               setRotationOrder(MEulerRotation::RotationOrder order);
 
     virtual MTypeId typeId() const;
     virtual MString name()   const;
@@ -42,9 +89,33 @@ public:
     static const MString TYPE_NAME;
 
 private:
-    virtual void                setValues(std::vector<double> &values);
+    virtual void                setValues(std::vector<double> &values, const std::vector<uint8_t> &orders);
     virtual std::vector<double> getValues();
 
+    void                        setChanged();
+
+    /** Copies the values out of the sidecar file, unless they already have been. */
+    void                        load() const;
+
+    MStatus                     readSidecar(unsigned numberOfItems, const std::string &path, const std::vector<uint8_t> &orders);
+
+    /** Returns true if the values are, or have now been, written to a sidecar file. */
+    bool                        writeSidecar();
+
+    /** Returns the one order every rotation shares, or one order per rotation if they differ. */
+    std::vector<uint8_t>        orders() const;
+
 private:
-    std::vector<MEulerRotation> data;
+    mutable SharedBuffer<std::vector<MEulerRotation>> data;
+    mutable std::mutex                                loadMutex;
+    mutable std::atomic<bool>                         isLoaded;
+    std::shared_ptr<const SidecarFile>                sidecar;
+    MAngle::Unit                                      sidecarUnit;
+    std::vector<uint8_t>                              sidecarOrders;
+
+    uint64_t                                          id;
+    uint64_t                                          base;
+    DirtyRange                                        dirty;
+
+    static std::atomic<uint64_t> nextId;
 };
\ No newline at end of file
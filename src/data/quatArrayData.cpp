@@ -7,13 +7,31 @@
 quatArray data
     Custom data type for a variable length array of quaternion rotations. 
     This array is contiguous, unlike a multi-attribute, which may be sparse.
+
+    In binary files, the array is written as its item count and values,
+    unless quatEncoding() is set. The item count is then ENCODED_ITEM_COUNT, 
+    followed by the encoding, its bits per component, the item count, the
+    number of encoded bytes, and the bytes from encodeQuaternions. Either 
+    form can be read regardless of the option.
+
+    Arrays that useSidecar() picks are written to a sidecar file instead, 
+    which takes precedence over the encoding.
 */
 
 #include "quatArrayData.h"
 #include "arrayData.h"
+#include "../core/quatCodec.h"
+#include "../core/sidecarFile.h"
+#include "../core/xformTypes.h"
+
+#include <stdint.h>
 
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <maya/MArgList.h>
@@ -24,7 +42,21 @@ quatArray data
 #include <maya/MString.h>
 #include <maya/MStatus.h>
 
-QuatArrayData::QuatArrayData() {}
+static_assert(
+    sizeof(MQuaternion) == 4 * sizeof(double), 
+    "QuatArrayData serialization requires MQuaternion to be four packed doubles."
+);
+
+std::atomic<uint64_t> QuatArrayData::nextId(1);
+
+QuatArrayData::QuatArrayData() : 
+    hasArray(true), 
+    hasLanes(true), 
+    hasLanesF(true), 
+    id(nextId++), 
+    base(0), 
+    dirty(DirtyRange::all()) 
+{}
 QuatArrayData::~QuatArrayData() {}
 
 void* QuatArrayData::creator()
@@ -33,9 +65,55 @@ void* QuatArrayData::creator()
 }
 
 
+template <typename REAL>
+static std::vector<MQuaternion> lanesToArray(const BasicQuatLanes<REAL> &lanes)
+{
+    size_t numberOfItems = lanes.size();
+    std::vector<MQuaternion> array(numberOfItems);
+
+    for (size_t i = 0; i < numberOfItems; i++)
+    {
+        MQuaternion &q = array[i];
+        q.x = lanes.x[i];
+        q.y = lanes.y[i];
+        q.z = lanes.z[i];
+        q.w = lanes.w[i];
+    }
+
+    return array;
+}
+
+
+template <typename REAL>
+static BasicQuatLanes<REAL> arrayToLanes(const MQuaternion *array, size_t numberOfItems)
+{
+    BasicQuatLanes<REAL> lanes;
+    lanes.x.resize(numberOfItems);
+    lanes.y.resize(numberOfItems);
+    lanes.z.resize(numberOfItems);
+    lanes.w.resize(numberOfItems);
+
+    for (size_t i = 0; i < numberOfItems; i++)
+    {
+        const MQuaternion &q = array[i];
+        lanes.x[i] = (REAL) q.x;
+        lanes.y[i] = (REAL) q.y;
+        lanes.z[i] = (REAL) q.z;
+        lanes.w[i] = (REAL) q.w;
+    }
+
+    return lanes;
+}
+
+
 unsigned int QuatArrayData::length()
 {
-    return (unsigned int) this->data.size();
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    if (this->hasArray) { return (unsigned int) this->data.get().size(); }
+    if (this->hasLanes) { return (unsigned int) this->lanesData.get().size(); }
+    if (this->hasLanesF) { return (unsigned int) this->lanesFData.get().size(); }
+
+    return (unsigned int) this->sidecar->numberOfItems();
 }
 
 
@@ -43,6 +121,14 @@ MStatus QuatArrayData::readASCII(const MArgList& args, unsigned int &end)
 {
     MStatus status;
 
+    unsigned numberOfItems = 0;
+    std::string path;
+
+    if (readASCIISidecar(args, end, numberOfItems, path))
+    {
+        return this->readSidecar(numberOfItems, path);
+    }
+
     std::vector<double> values = readASCIIData(4, args, end, &status);
     if (status) { this->setValues(values); }
 
@@ -54,19 +140,120 @@ MStatus QuatArrayData::writeASCII(std::ostream &out)
 {
     MStatus status;
 
-    std::vector<double> values = this->getValues();
-    status = writeASCIIData(values, this->length(), out);
+    if (this->writeSidecar())
+    {
+        return writeASCIISidecar(this->length(), this->sidecar->path(), out);
+    }
+
+    const std::vector<MQuaternion> &array = this->array();
+    const double *values = array.empty() ? NULL : &array[0].x;
+    status = writeASCIIData(values, array.size() * 4, (unsigned) array.size(), out);
 
     return status; 
 }
 
 
+/** Reads the QuatEncodingHeader and encoded bytes that follow ENCODED_ITEM_COUNT. */
+static MStatus readEncodedValues(std::istream &in, unsigned int length, std::vector<MQuaternion> &values)
+{
+    QuatEncodingHeader header;
+    in.read((char*) &header, sizeof(header));
+
+    if (in.fail()) { return MStatus::kFailure; }
+
+    size_t numberOfHeaderBytes = sizeof(uint32_t) + sizeof(header);
+    size_t numberOfBytesAvailable = length > numberOfHeaderBytes ? length - numberOfHeaderBytes : 0;
+
+    if (!isValidQuatEncodingHeader(header, numberOfBytesAvailable))
+    {
+        return MStatus::kFailure;
+    }
+
+    std::vector<uint8_t> bytes(header.numberOfBytes);
+
+    if (header.numberOfBytes > 0)
+    {
+        in.read((char*) bytes.data(), header.numberOfBytes);
+        if (in.fail()) { return MStatus::kFailure; }
+    }
+
+    values.resize(header.numberOfItems);
+
+    bool isDecoded = decodeQuaternions(
+        bytes.data(), bytes.size(), 
+        (QuatEncoding) header.encoding, header.bits, 
+        reinterpret_cast<Quaternion*>(values.data()), values.size()
+    );
+
+    return isDecoded ? MStatus::kSuccess : MStatus::kFailure;
+}
+
+
+static MStatus writeEncodedValues(const std::vector<uint8_t> &bytes, QuatEncoding encoding, unsigned bits, size_t numberOfItems, std::ostream &out)
+{
+    MStatus status = writeBinaryItemCount(ENCODED_ITEM_COUNT, out);
+
+    if (status)
+    {
+        QuatEncodingHeader header = {
+            (uint32_t) encoding, 
+            (uint32_t) bits, 
+            (uint32_t) numberOfItems, 
+            (uint32_t) bytes.size()
+        };
+
+        out.write((const char*) &header, sizeof(header));
+        out.write((const char*) bytes.data(), bytes.size());
+
+        status = out.fail() ? MStatus::kFailure : MStatus::kSuccess;
+    }
+
+    return status;
+}
+
+
 MStatus QuatArrayData::readBinary(std::istream &in, unsigned int length)
 {
     MStatus status; 
 
-    std::vector<double> values = readBinaryData(4, in, length, &status);
-    if (status) { this->setValues(values); }
+    unsigned numberOfItems = 0;
+    unsigned marker = 0;
+    status = readBinaryItemCount(4, in, length, numberOfItems, marker);
+
+    if (status && marker == SIDECAR_ITEM_COUNT)
+    {
+        std::string path;
+        status = readBinarySidecar(in, length, numberOfItems, path);
+
+        if (status) 
+        { 
+            status = this->readSidecar(numberOfItems, path); 
+        }
+    } else if (status && marker == ENCODED_ITEM_COUNT) {
+        std::vector<MQuaternion> values;
+        status = readEncodedValues(in, length, values);
+
+        if (status) 
+        { 
+            this->data.set(std::move(values)); 
+            this->useArray();
+        }
+    } else if (status && marker != 0) {
+        status = MStatus::kFailure;
+    } else if (status) {
+        std::vector<MQuaternion> values(numberOfItems);
+
+        if (numberOfItems > 0)
+        {
+            status = readBinaryValues(&values[0].x, values.size() * 4, in);
+        }
+
+        if (status) 
+        { 
+            this->data.set(std::move(values)); 
+            this->useArray();
+        }
+    }
 
     return status; 
 }
@@ -76,27 +263,306 @@ MStatus QuatArrayData::writeBinary(std::ostream &out)
 {
     MStatus status;
 
-    std::vector<double> values = this->getValues();
-    status = writeBinaryData(values, this->length(), out);
+    if (this->writeSidecar())
+    {
+        return writeBinarySidecar(this->length(), this->sidecar->path(), out);
+    }
+
+    const std::vector<MQuaternion> &array = this->array();
+    QuatEncoding encoding = quatEncoding();
+
+    if (encoding != QUAT_ENCODING_RAW && !array.empty())
+    {
+        std::vector<uint8_t> bytes;
+        unsigned bits = quatEncodingBits();
+
+        encoding = encodeQuaternions(reinterpret_cast<const Quaternion*>(array.data()), array.size(), encoding, bits, bytes);
+
+        // Values that did not compress are written unencoded, which older versions of the plugin can also read.
+        if (encoding != QUAT_ENCODING_RAW)
+        {
+            return writeEncodedValues(bytes, encoding, bits, array.size(), out);
+        }
+    }
+
+    status = writeBinaryItemCount((unsigned) array.size(), out);
+
+    if (status && !array.empty())
+    {
+        status = writeBinaryValues(&array[0].x, array.size() * 4, out);
+    }
 
     return status; 
 }
 
 
+const std::vector<MQuaternion>& QuatArrayData::array() const
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    if (!this->hasArray)
+    {
+        if (this->hasLanes)
+        {
+            this->data.set(lanesToArray(this->lanesData.get()));
+        } else if (this->hasLanesF) {
+            this->data.set(lanesToArray(this->lanesFData.get()));
+        } else {
+            const MQuaternion *values = this->sidecarArray();
+            this->data.set(std::vector<MQuaternion>(values, values + this->sidecar->numberOfItems()));
+        }
+
+        this->hasArray = true;
+    }
+
+    return this->data.get();
+}
+
+
 std::vector<MQuaternion> QuatArrayData::getArray()
 {
-    return std::vector<MQuaternion>(this->data);
+    return std::vector<MQuaternion>(this->array());
+}
+
+
+std::vector<MQuaternion> QuatArrayData::takeArray()
+{
+    this->array();
+
+    std::vector<MQuaternion> array;
+
+    if (this->data.useCount() == 1)
+    {
+        array = std::move(this->data.edit());
+    } else {
+        array = this->data.get();
+    }
+
+    this->data.reset();
+    this->useArray();
+
+    return array;
 }
 
 
 void QuatArrayData::setArray(std::vector<MQuaternion> &array)
 {
-    this->data.resize(array.size());
-    std::copy(
-        array.begin(), 
-        array.end(),
-        this->data.begin()
-    );
+    this->data.assign(array);
+    this->useArray();
+}
+
+
+void QuatArrayData::setArray(std::vector<MQuaternion> &&array)
+{
+    this->data.set(std::move(array));
+    this->useArray();
+}
+
+
+const QuatLanes& QuatArrayData::lanes() const
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    if (!this->hasLanes)
+    {
+        QuatLanes lanes;
+
+        if (this->hasArray)
+        {
+            lanes = arrayToLanes<double>(this->data.get().data(), this->data.get().size());
+        } else if (this->hasLanesF) {
+            convertQuatLanes(this->lanesFData.get(), lanes);
+        } else {
+            lanes = arrayToLanes<double>(this->sidecarArray(), this->sidecar->numberOfItems());
+        }
+
+        this->lanesData.set(std::move(lanes));
+        this->hasLanes = true;
+    }
+
+    return this->lanesData.get();
+}
+
+
+void QuatArrayData::setLanes(QuatLanes &&lanes)
+{
+    this->lanesData.set(std::move(lanes));
+    this->useLanes();
+}
+
+
+const QuatLanesF& QuatArrayData::lanesF() const
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    if (!this->hasLanesF)
+    {
+        QuatLanesF lanes;
+
+        if (this->hasLanes)
+        {
+            convertQuatLanes(this->lanesData.get(), lanes);
+        } else if (this->hasArray) {
+            lanes = arrayToLanes<float>(this->data.get().data(), this->data.get().size());
+        } else {
+            lanes = arrayToLanes<float>(this->sidecarArray(), this->sidecar->numberOfItems());
+        }
+
+        this->lanesFData.set(std::move(lanes));
+        this->hasLanesF = true;
+    }
+
+    return this->lanesFData.get();
+}
+
+
+void QuatArrayData::setLanesF(QuatLanesF &&lanes)
+{
+    this->lanesFData.set(std::move(lanes));
+    this->useLanesF();
+}
+
+
+uint64_t QuatArrayData::contentId() const
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    return this->id;
+}
+
+
+uint64_t QuatArrayData::baseId() const
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    return this->base;
+}
+
+
+DirtyRange QuatArrayData::dirtyRange() const
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    return this->dirty;
+}
+
+
+void QuatArrayData::setDirtyRange(uint64_t baseId, const DirtyRange &range)
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    this->base = baseId;
+    this->dirty = range;
+}
+
+
+size_t QuatArrayData::footprint() const
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    size_t arrayBytes = this->hasArray ? this->data.share(this->data.get().capacity() * sizeof(MQuaternion)) : 0;
+    size_t lanesBytes = this->hasLanes ? this->lanesData.share(this->lanesData.get().w.capacity() * 4 * sizeof(double)) : 0;
+    size_t lanesFBytes = this->hasLanesF ? this->lanesFData.share(this->lanesFData.get().w.capacity() * 4 * sizeof(float)) : 0;
+
+    return sizeof(*this) + arrayBytes + lanesBytes + lanesFBytes;
+}
+
+
+void QuatArrayData::useArray()
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    this->id = nextId++;
+    this->base = 0;
+    this->dirty = DirtyRange::all();
+    this->lanesData.reset();
+    this->lanesFData.reset();
+    this->sidecar.reset();
+    this->hasArray = true;
+    this->hasLanes = false;
+    this->hasLanesF = false;
+}
+
+
+void QuatArrayData::useLanes()
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    this->id = nextId++;
+    this->base = 0;
+    this->dirty = DirtyRange::all();
+    this->data.reset();
+    this->lanesFData.reset();
+    this->sidecar.reset();
+    this->hasArray = false;
+    this->hasLanes = true;
+    this->hasLanesF = false;
+}
+
+
+void QuatArrayData::useLanesF()
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    this->id = nextId++;
+    this->base = 0;
+    this->dirty = DirtyRange::all();
+    this->data.reset();
+    this->lanesData.reset();
+    this->sidecar.reset();
+    this->hasArray = false;
+    this->hasLanes = false;
+    this->hasLanesF = true;
+}
+
+
+void QuatArrayData::useSidecarFile(const std::shared_ptr<const SidecarFile> &file)
+{
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+
+    this->id = nextId++;
+    this->base = 0;
+    this->dirty = DirtyRange::all();
+    this->data.reset();
+    this->lanesData.reset();
+    this->lanesFData.reset();
+    this->sidecar = file;
+    this->hasArray = false;
+    this->hasLanes = false;
+    this->hasLanesF = false;
+}
+
+
+const MQuaternion* QuatArrayData::sidecarArray() const
+{
+    return reinterpret_cast<const MQuaternion*>(this->sidecar->values());
+}
+
+
+MStatus QuatArrayData::readSidecar(unsigned numberOfItems, const std::string &path)
+{
+    MStatus status;
+
+    std::shared_ptr<const SidecarFile> file = openSidecar(path, 4, numberOfItems, &status);
+    if (status) { this->useSidecarFile(file); }
+
+    return status;
+}
+
+
+bool QuatArrayData::writeSidecar()
+{
+    if (!useSidecar(this->length())) { return false; }
+
+    {
+        std::lock_guard<std::mutex> lock(this->layoutMutex);
+        if (this->sidecar) { return true; }
+    }
+
+    const std::vector<MQuaternion> &array = this->array();
+    std::shared_ptr<const SidecarFile> file = SidecarFile::write(&array[0].x, 4, array.size());
+
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    this->sidecar = file;
+
+    return file != nullptr;
 }
 
 
@@ -104,29 +570,34 @@ void QuatArrayData::setValues(std::vector<double> &values)
 {
     size_t numberOfValues = values.size();
     size_t numberOfItems = numberOfValues / 4;
-    this->data.resize(numberOfItems);
+    std::vector<MQuaternion> array(numberOfItems);
 
     for (size_t i = 0; i < numberOfItems; i++)
     {
-        this->data[i] = MQuaternion(
+        array[i] = MQuaternion(
             values[(i*4)+0], 
             values[(i*4)+1], 
             values[(i*4)+2],
             values[(i*4)+3]
         );
     }
+
+    this->data.set(std::move(array));
+    this->useArray();
 }
 
 
 std::vector<double> QuatArrayData::getValues()
 {
+    const std::vector<MQuaternion> &array = this->array();
+
     std::vector<double> values;
-    size_t numberOfItems = this->data.size();
+    size_t numberOfItems = array.size();
     values.resize(numberOfItems * 4);
 
     for (size_t i = 0; i < numberOfItems; i++)
     {
-        MQuaternion &q = this->data[i];
+        const MQuaternion &q = array[i];
         values[(i*4)+0] = q.x;
         values[(i*4)+1] = q.y;
         values[(i*4)+2] = q.z;
@@ -139,15 +610,25 @@ std::vector<double> QuatArrayData::getValues()
 
 void QuatArrayData::copy(const MPxData& other)
 {
-    if (this->typeId() == other.typeId())
+    if (this->typeId() == other.typeId() && this != &other)
     {
         const QuatArrayData &otherData = (const QuatArrayData &) other;
-        this->data.resize(otherData.data.size());
-        std::copy(
-            otherData.data.begin(), 
-            otherData.data.end(),
-            this->data.begin()
-        );
+        std::unique_lock<std::mutex> otherLock(otherData.layoutMutex, std::defer_lock);
+        std::unique_lock<std::mutex> lock(this->layoutMutex, std::defer_lock);
+        std::lock(otherLock, lock);
+
+        // All layouts are shared, including any the source built on request.
+        this->data = otherData.data;
+        this->lanesData = otherData.lanesData;
+        this->lanesFData = otherData.lanesFData;
+        this->sidecar = otherData.sidecar;
+        this->hasArray = otherData.hasArray;
+        this->hasLanes = otherData.hasLanes;
+        this->hasLanesF = otherData.hasLanesF;
+
+        this->id = otherData.id;
+        this->base = otherData.base;
+        this->dirty = otherData.dirty;
     }
 }
 
@@ -5,8 +5,20 @@
 
 #pragma once
 
+#include "../core/dirtyRange.h"
+#include "../core/quatLanes.h"
+#include "../core/sharedBuffer.h"
+#include "../core/sidecarFile.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
 #include <vector>
 
 #include <maya/MArgList.h>
@@ -16,6 +28,33 @@
 #include <maya/MStatus.h>
 #include <maya/MSyntax.h>
 
+/**
+    The array is stored as MQuaternion structs (AoS), as four component 
+    lanes (SoA) of doubles, as four lanes of floats, or any of these. 
+    Whichever layout is requested is built from another on first access and
+    kept until the data changes. Values set as floats are widened exactly,
+    but values set as doubles are rounded when read as floats.
+
+    contentId identifies the values held. It changes whenever they are set,
+    and a copy takes the id of its source, so nodes can tell that an input
+    holds the same values as on their last compute without comparing them.
+    Ids are unique across all instances and are never 0.
+
+    Data can also record that it differs from the data with contentId 
+    baseId only inside dirtyRange. Setting the values clears this, until
+    setDirtyRange is called again.
+
+    All layouts are held in shared, copy-on-write buffers, so copy() costs
+    the same for any number of elements, and setting the values of one copy
+    never changes another. footprint() returns the bytes this data holds. 
+    A buffer shared by several copies is divided among them, so the 
+    footprints of every copy add up to the memory the buffers take.
+
+    Values read from a sidecar file stay in the mapped file until a layout
+    is requested, so reading a scene does not depend on the size of the
+    array. Mapped values are not counted by footprint(). While the values 
+    are unchanged, writing the scene again refers to the same file.
+*/
 class QuatArrayData : public MPxData
 {
 public:
@@ -31,9 +70,31 @@ public:
 
     virtual void    copy(const MPxData &src);
 
-    virtual unsigned int             length();
-    virtual std::vector<MQuaternion> getArray();
-    virtual void                     setArray(std::vector<MQuaternion> &array);  
+    virtual unsigned int                    length();
+    virtual const std::vector<MQuaternion>& array() const;
+    virtual std::vector<MQuaternion>        getArray();
+
+    /** 
+        Moves the array out and leaves this data empty, with a new contentId.
+        The array is only copied if other data shares it.
+    */
+    virtual std::vector<MQuaternion>        takeArray();
+
+    virtual void                            setArray(std::vector<MQuaternion> &array);
+    virtual void                            setArray(std::vector<MQuaternion> &&array);  
+
+    virtual const QuatLanes&                lanes() const;
+    virtual void                            setLanes(QuatLanes &&lanes);
+
+    virtual const QuatLanesF&               lanesF() const;
+    virtual void                            setLanesF(QuatLanesF &&lanes);
+
+    virtual uint64_t                        contentId() const;
+    virtual uint64_t                        baseId() const;
+    virtual DirtyRange                      dirtyRange() const;
+    virtual void                            setDirtyRange(uint64_t baseId, const DirtyRange &range);
+
+    virtual size_t                          footprint() const;
 
     virtual MTypeId typeId() const;
     virtual MString name()   const;
@@ -45,6 +106,32 @@ private:
     virtual void                setValues(std::vector<double> &values);
     virtual std::vector<double> getValues();
 
+    void                        useArray();
+    void                        useLanes();
+    void                        useLanesF();
+    void                        useSidecarFile(const std::shared_ptr<const SidecarFile> &file);
+
+    const MQuaternion*          sidecarArray() const;
+
+    MStatus                     readSidecar(unsigned numberOfItems, const std::string &path);
+
+    /** Returns true if the values are, or have now been, written to a sidecar file. */
+    bool                        writeSidecar();
+
 private:
-    std::vector<MQuaternion> data;
-};
\ No newline at end of file
+    mutable SharedBuffer<std::vector<MQuaternion>> data;
+    mutable SharedBuffer<QuatLanes>                lanesData;
+    mutable SharedBuffer<QuatLanesF>               lanesFData;
+    std::shared_ptr<const SidecarFile>             sidecar;
+
+    mutable bool                                   hasArray;
+    mutable bool                                   hasLanes;
+    mutable bool                                   hasLanesF;
+    mutable std::mutex                             layoutMutex;
+
+    uint64_t                                       id;
+    uint64_t                                       base;
+    DirtyRange                                     dirty;
+
+    static std::atomic<uint64_t>     nextId;
+};
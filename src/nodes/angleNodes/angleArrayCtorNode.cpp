@@ -20,8 +20,10 @@ This node outputs a contiguous array of doubleAngle values.
         An array of doubleAngle values.
 */
 
+#include <utility>
 #include <vector>
 
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "../../data/angleArrayData.h"
 #include "angleArrayCtorNode.h"
@@ -51,6 +53,12 @@ void* AngleArrayCtorNode::creator()
 }
 
 
+MPxNode::SchedulingType AngleArrayCtorNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus AngleArrayCtorNode::initialize()
 {
     MStatus status;
@@ -97,6 +105,8 @@ MStatus AngleArrayCtorNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MArrayDataHandle inputArrayHandle = data.inputArrayValue(inputAttr);
     MAngle fillValue = data.inputValue(fillValueAttr).asAngle();
     unsigned size = (unsigned) data.inputValue(sizeAttr).asInt();
@@ -110,7 +120,7 @@ MStatus AngleArrayCtorNode::compute(const MPlug& plug, MDataBlock& data)
 
     MDataHandle outputHandle = data.outputValue(outputAttr);
 
-    setUserArray<MAngle, AngleArrayData>(outputHandle, values);
+    setUserArray<MAngle, AngleArrayData>(outputHandle, std::move(values));
 
     return MStatus::kSuccess;   
 }
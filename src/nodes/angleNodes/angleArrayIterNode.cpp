@@ -16,6 +16,7 @@ This node outputs the elements of a contiguous doubleAngle array.
 */
 
 #include "../../data/angleArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "angleArrayIterNode.h"
 
@@ -46,6 +47,12 @@ void* AngleArrayIterNode::creator()
 }
 
 
+MPxNode::SchedulingType AngleArrayIterNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus AngleArrayIterNode::initialize()
 {
     MStatus status;
@@ -79,8 +86,10 @@ MStatus AngleArrayIterNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputAttr);
-    std::vector<MAngle> values = getUserArray<MAngle, AngleArrayData>(inputHandle);
+    const std::vector<MAngle> &values = getUserArray<MAngle, AngleArrayData>(inputHandle);
 
     MArrayDataHandle outputArrayHandle = data.outputArrayValue(outputAttr, &status);
     status = setArrayElements<MAngle>(outputArrayHandle, values, &AngleArrayIterNode::setElement);
@@ -15,6 +15,7 @@ class AngleArrayIterNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
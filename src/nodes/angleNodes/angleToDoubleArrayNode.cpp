@@ -15,7 +15,9 @@ This node converts an array of doubleAngle values to an array of double values.
 
 */
 
+#include "../../core/parallel.h"
 #include "../../data/angleArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "angleToDoubleArrayNode.h"
 
@@ -44,6 +46,12 @@ void* AngleToDoubleArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType AngleToDoubleArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus AngleToDoubleArrayNode::initialize()
 {
     MStatus status;
@@ -74,20 +82,40 @@ MStatus AngleToDoubleArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputAttr);
-    std::vector<MAngle> input = getUserArray<MAngle, AngleArrayData>(inputHandle);
+    const std::vector<MAngle> &input = getUserArray<MAngle, AngleArrayData>(inputHandle);
+
+    ContentHash inputHash;
 
-    std::vector<double> output(input.size());
+    if (useComputeCache(data))
+    {
+        hashInput(inputHash, input);
+        inputHash.updateValue(MAngle::uiUnit());
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
+    }
+
+    MDataHandle outputHandle = data.outputValue(outputAttr);
+
+    double *output = nullptr;
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputHandle, (unsigned) input.size(), output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
     MAngle::Unit unit = MAngle::uiUnit();
 
-    for (size_t i = 0; i < input.size(); i++)
+    parallelFor(0, input.size(), [&](size_t i)
     {
         output[i] = input[i].as(unit);
-    }
+    });
 
-    MDataHandle outputHandle = data.outputValue(outputAttr);
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputHandle, output);
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
@@ -15,10 +15,13 @@ This node converts an array of double values to an array of doubleAngle values.
 
 */
 
+#include "../../core/parallel.h"
 #include "../../data/angleArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "doubleToAngleArrayNode.h"
 
+#include <utility>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -43,6 +46,12 @@ void* DoubleToAngleArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType DoubleToAngleArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus DoubleToAngleArrayNode::initialize()
 {
     MStatus status;
@@ -73,20 +82,37 @@ MStatus DoubleToAngleArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputAttr);
-    std::vector<double> input = getMayaArray<double, MFnDoubleArrayData>(inputHandle);
+    ArrayView<double> input = getMayaArrayView<double, MFnDoubleArrayData>(inputHandle);
+
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
+    {
+        hashInput(inputHash, input);
+        inputHash.updateValue(MAngle::uiUnit());
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
+    }
 
     std::vector<MAngle> output(input.size());
 
     MAngle::Unit unit = MAngle::uiUnit();
 
-    for (size_t i = 0; i < input.size(); i++)
+    parallelFor(0, input.size(), [&](size_t i)
     {
         output[i] = MAngle(input[i], unit);
-    }
+    });
 
     MDataHandle outputHandle = data.outputValue(outputAttr);
-    setUserArray<MAngle, AngleArrayData>(outputHandle, output);
+    setUserArray<MAngle, AngleArrayData>(outputHandle, std::move(output));
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
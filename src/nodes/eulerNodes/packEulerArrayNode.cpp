@@ -37,12 +37,15 @@ This node outputs an array of euler rotation values.
 
 */
 
+#include "../../core/parallel.h"
 #include "../../data/angleArrayData.h"
 #include "../../data/eulerArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "packEulerArrayNode.h"
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 #include <maya/MAngle.h>
@@ -84,6 +87,12 @@ void* PackEulerArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType PackEulerArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus PackEulerArrayNode::initialize()
 {
     MStatus status;
@@ -162,6 +171,8 @@ MStatus PackEulerArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short inputMethod = data.inputValue(inputMethodAttr).asShort();
     unsigned size     = (unsigned) data.inputValue(sizeAttr).asInt();
     std::vector<MEulerRotation> outputRotate;
@@ -209,18 +220,18 @@ MStatus PackEulerArrayNode::compute(const MPlug& plug, MDataBlock& data)
 
         unsigned numberOfOutputs = std::min(size, numberOfInputs);
 
-        for (unsigned i = 0; i < numberOfOutputs; i++)
+        parallelFor(0, numberOfOutputs, [&](size_t i)
         {
             outputRotate[i] = MEulerRotation(
                 inputRotateX[i].asRadians(),
                 inputRotateY[i].asRadians(),
                 inputRotateZ[i].asRadians()
             );
-        }    
+        });
     }       
     
     MDataHandle outputHandle = data.outputValue(outputRotateAttr);
-    setUserArray<MEulerRotation, EulerArrayData>(outputHandle, outputRotate);
+    setUserArray<MEulerRotation, EulerArrayData>(outputHandle, std::move(outputRotate));
 
     return MStatus::kSuccess;   
 }
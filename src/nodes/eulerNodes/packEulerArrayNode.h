@@ -17,6 +17,7 @@ class PackEulerArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
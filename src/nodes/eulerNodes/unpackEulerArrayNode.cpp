@@ -22,13 +22,20 @@ This node outputs arrays of the angles that make up euler rotation values.
     outputAngleZ (oaz) angleArray
         Angles that describe the Z component of a euler rotation.
 
+    When the input records which of its elements changed since the last 
+    compute, only those angles are recomputed.
+
 */
 
+#include "../../core/parallel.h"
 #include "../../data/angleArrayData.h"
 #include "../../data/eulerArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "unpackEulerArrayNode.h"
 
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <maya/MAngle.h>
@@ -63,6 +70,12 @@ void* UnpackEulerArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType UnpackEulerArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus UnpackEulerArrayNode::initialize()
 {
     MStatus status;
@@ -119,8 +132,10 @@ MStatus UnpackEulerArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputRotateAttr);
-    std::vector<MEulerRotation> inputRotate = getUserArray<MEulerRotation, EulerArrayData>(inputHandle);
+    const std::vector<MEulerRotation> &inputRotate = getUserArray<MEulerRotation, EulerArrayData>(inputHandle);
     unsigned numberOfInputs = (unsigned) inputRotate.size();
 
     MArrayDataHandle outputRotateArrayHandle = data.outputArrayValue(outputRotateAttr);
@@ -131,28 +146,45 @@ MStatus UnpackEulerArrayNode::compute(const MPlug& plug, MDataBlock& data)
         &UnpackEulerArrayNode::setElement
     );
 
+    // The ids below are shared by every compute of this node.
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+
+    DirtyRange changes = getUserArrayChanges<EulerArrayData>(inputHandle, this->inputId);
+
+    MDataHandle outputAngleHandles[3] = {
+        data.outputValue(outputAngleXAttr),
+        data.outputValue(outputAngleYAttr),
+        data.outputValue(outputAngleZAttr)
+    };
+
+    std::vector<MAngle> outputAngles[3];
+    PreviousOutput<MAngle> previousAngles[3];
+    DirtyRange outputChanges[3];
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        outputChanges[axis] = getUserArrayOutput<MAngle, AngleArrayData>(outputAngleHandles[axis], this->outputAngleIds[axis], changes, numberOfInputs, outputAngles[axis], previousAngles[axis]);
+    }
+
+    // Recomputing an element an output did not need gives it the value it already holds.
+    DirtyRange range = outputChanges[0].merge(outputChanges[1]).merge(outputChanges[2]);
+
+    parallelFor(range.begin, range.end, [&](size_t i)
+    {
+        const MEulerRotation &r = inputRotate[i];
+        outputAngles[0][i] = MAngle(r.x);
+        outputAngles[1][i] = MAngle(r.y);
+        outputAngles[2][i] = MAngle(r.z);
+    });
+
+    for (int axis = 0; axis < 3; axis++)
     {
-        std::vector<MAngle> outputX(numberOfInputs);
-        std::vector<MAngle> outputY(numberOfInputs);
-        std::vector<MAngle> outputZ(numberOfInputs);
-
-        for (unsigned i = 0; i < numberOfInputs; i++)
-        {
-            MEulerRotation &r = inputRotate[i];
-            outputX[i] = MAngle(r.x);
-            outputY[i] = MAngle(r.y);
-            outputZ[i] = MAngle(r.z);
-        }
-
-        MDataHandle outputXHandle = data.outputValue(outputAngleXAttr);
-        MDataHandle outputYHandle = data.outputValue(outputAngleYAttr);
-        MDataHandle outputZHandle = data.outputValue(outputAngleZAttr);
-
-        setUserArray<MAngle, AngleArrayData>(outputXHandle, outputX);
-        setUserArray<MAngle, AngleArrayData>(outputYHandle, outputY);
-        setUserArray<MAngle, AngleArrayData>(outputZHandle, outputZ);
+        setUserArray<MAngle, AngleArrayData>(outputAngleHandles[axis], std::move(outputAngles[axis]), outputChanges[axis], previousAngles[axis]);
+        this->outputAngleIds[axis] = getUserArrayId<AngleArrayData>(outputAngleHandles[axis]);
     }
 
+    this->inputId = getUserArrayId<EulerArrayData>(inputHandle);
+
     return MStatus::kSuccess;   
 }
 
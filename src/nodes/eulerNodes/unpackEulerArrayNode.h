@@ -5,6 +5,10 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include <mutex>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,6 +19,7 @@ class UnpackEulerArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
@@ -33,4 +38,9 @@ public:
     static MObject          outputAngleXAttr;
     static MObject          outputAngleYAttr;
     static MObject          outputAngleZAttr;
+
+private:
+    uint64_t                inputId = 0;
+    uint64_t                outputAngleIds[3] = {0, 0, 0};
+    std::mutex              stateMutex;
 };
\ No newline at end of file
@@ -32,10 +32,16 @@ This node constructs matrices from transform components.
     outputMatrix (om) matrixArray
         The matrices composed from transform components.
 
+    Each matrix is composed in one pass, directly into the output array. 
+    Components missing from shorter inputs use the default transform values.
+
 */
 
 #include "composeMatrixArrayNode.h"
 
+#include "../../core/matrixCompose.h"
+#include "../../core/parallel.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "../../data/angleArrayData.h"
 #include "../../data/eulerArrayData.h"
@@ -60,7 +66,6 @@ This node constructs matrices from transform components.
 #include <maya/MPxNode.h>
 #include <maya/MQuaternion.h>
 #include <maya/MString.h>
-#include <maya/MTransformationMatrix.h>
 #include <maya/MTypeId.h>
 #include <maya/MVector.h>
 #include <maya/MVectorArray.h>
@@ -83,6 +88,12 @@ void* ComposeMatrixArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType ComposeMatrixArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus ComposeMatrixArrayNode::initialize()
 {
     MStatus status;
@@ -145,26 +156,50 @@ MStatus ComposeMatrixArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputTranslateHandle = data.inputValue(inputTranslateAttr);
     MDataHandle inputRotateHandle    = data.inputValue(inputRotateAttr);
     MDataHandle inputQuatHandle      = data.inputValue(inputQuatAttr);
     MDataHandle inputScaleHandle     = data.inputValue(inputScaleAttr);
     MDataHandle inputShearHandle     = data.inputValue(inputShearAttr);
 
-    std::vector<MVector>        translate   = getMayaArray<MVector, MFnVectorArrayData>(inputTranslateHandle);
-    std::vector<MVector>        scale       = getMayaArray<MVector, MFnVectorArrayData>(inputScaleHandle);
-    std::vector<MVector>        shear       = getMayaArray<MVector, MFnVectorArrayData>(inputShearHandle);
+    ArrayView<MVector>        inputTranslate = getMayaArrayView<MVector, MFnVectorArrayData>(inputTranslateHandle);
+    ArrayView<MVector>        inputScale     = getMayaArrayView<MVector, MFnVectorArrayData>(inputScaleHandle);
+    ArrayView<MVector>        inputShear     = getMayaArrayView<MVector, MFnVectorArrayData>(inputShearHandle);
 
-    std::vector<MEulerRotation> eulerRotate = getUserArray<MEulerRotation, EulerArrayData>(inputRotateHandle);
-    std::vector<MQuaternion>    quatRotate  = getUserArray<MQuaternion, QuatArrayData>(inputQuatHandle);
+    const std::vector<MEulerRotation> &eulerRotate = getUserArray<MEulerRotation, EulerArrayData>(inputRotateHandle);
+    const std::vector<MQuaternion>    &quatRotate  = getUserArray<MQuaternion, QuatArrayData>(inputQuatHandle);
 
     bool useEulerRotation = data.inputValue(useEulerRotationAttr).asBool();
 
-    size_t numberOfTranslates = translate.size();
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
+    {
+        hashInput(inputHash, inputTranslate);
+        hashInput(inputHash, inputScale);
+        hashInput(inputHash, inputShear);
+        inputHash.updateValue(useEulerRotation);
+
+        if (useEulerRotation)
+        {
+            hashInput(inputHash, eulerRotate);
+        } else {
+            hashInput(inputHash, quatRotate);
+        }
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
+    }
+
+    size_t numberOfTranslates = inputTranslate.size();
     size_t numberOfEulerRotates = eulerRotate.size();
     size_t numberOfQuatRotates = quatRotate.size();
-    size_t numberOfScales = scale.size();
-    size_t numberOfShears = shear.size();
+    size_t numberOfScales = inputScale.size();
+    size_t numberOfShears = inputShear.size();
 
     size_t numberOfOutputs = 0;
     numberOfOutputs = std::max(numberOfOutputs, numberOfTranslates);
@@ -172,59 +207,59 @@ MStatus ComposeMatrixArrayNode::compute(const MPlug& plug, MDataBlock& data)
     numberOfOutputs = std::max(numberOfOutputs, numberOfScales);
     numberOfOutputs = std::max(numberOfOutputs, numberOfShears);
 
-    double values[3] {0.0, 0.0, 0.0};
-    std::vector<MTransformationMatrix> matrix(numberOfOutputs);
-    
-    for (size_t i = 0; i < numberOfTranslates; i++)
-    {
-        matrix[i].setTranslation(translate[i], MSpace::Space::kWorld);
-    }
+    MDataHandle outputHandle = data.outputValue(outputMatrixAttr);
 
-    if (useEulerRotation)
-    {
-        short rotateOrderIdx  = data.inputValue(inputRotateOrderAttr).asShort();
-        MTransformationMatrix::RotationOrder rotateOrder = (MTransformationMatrix::RotationOrder) rotateOrderIdx;
+    MMatrix *output = nullptr;
+    status = getMayaArrayOutput<MMatrix, MMatrixArray, MFnMatrixArrayData>(outputHandle, (unsigned) numberOfOutputs, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
-        for (size_t i = 0; i < numberOfEulerRotates; i++)
+    parallelFor(0, numberOfOutputs, [&](size_t i)
+    {
+        double translate[3] {0.0, 0.0, 0.0};
+        double scale[3]     {1.0, 1.0, 1.0};
+        double shear[3]     {0.0, 0.0, 0.0};
+        double rotate[3][3] {
+            {1.0, 0.0, 0.0},
+            {0.0, 1.0, 0.0},
+            {0.0, 0.0, 1.0}
+        };
+
+        if (i < numberOfTranslates)
         {
-            MEulerRotation &e = eulerRotate[i];
-            matrix[i].rotateTo(e);
+            const MVector &t = inputTranslate[i];
+            translate[0] = t.x; translate[1] = t.y; translate[2] = t.z;
         }
-    } else {
-        for (size_t i = 0; i < numberOfQuatRotates; i++)
+
+        if (useEulerRotation)
         {
-            MQuaternion &q = quatRotate[i];
-            matrix[i].rotateTo(q);
+            if (i < numberOfEulerRotates)
+            {
+                const MEulerRotation &e = eulerRotate[i];
+                eulerToRotation(e.x, e.y, e.z, (int) e.order, rotate);
+            }
+        } else if (i < numberOfQuatRotates) {
+            const MQuaternion &q = quatRotate[i];
+            quatToRotation(q.x, q.y, q.z, q.w, rotate);
         }
-    }
 
-    for (size_t i = 0; i < numberOfScales; i++)
-    {
-        MVector &s = scale[i];
-        values[0] = s.x;
-        values[1] = s.y;
-        values[2] = s.z;
-        matrix[i].setScale(values, MSpace::Space::kWorld);
-    }
+        if (i < numberOfScales)
+        {
+            const MVector &s = inputScale[i];
+            scale[0] = s.x; scale[1] = s.y; scale[2] = s.z;
+        }
 
-    for (size_t i = 0; i < numberOfShears; i++)
-    {
-        MVector &sh = shear[i];
-        values[0] = sh.x;
-        values[1] = sh.y;
-        values[2] = sh.z;
-        matrix[i].setShear(values, MSpace::Space::kWorld);
-    }
+        if (i < numberOfShears)
+        {
+            const MVector &sh = inputShear[i];
+            shear[0] = sh.x; shear[1] = sh.y; shear[2] = sh.z;
+        }
 
-    std::vector<MMatrix> output(numberOfOutputs);
+        composeMatrix(translate, rotate, scale, shear, &output[i].matrix[0][0]);
+    });
 
-    for (size_t i = 0; i < numberOfOutputs; i++)
-    {
-        output[i] = matrix[i].asMatrix();
-    }
+    outputHandle.setClean();
 
-    MDataHandle outputHandle = data.outputValue(outputMatrixAttr);
-    setMayaArray<MMatrix, MMatrixArray, MFnMatrixArrayData>(outputHandle, output);
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,6 +17,7 @@ class ComposeMatrixArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
@@ -31,4 +34,7 @@ public:
     static MObject          useEulerRotationAttr;
 
     static MObject          outputMatrixAttr;   
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
@@ -28,15 +28,26 @@ This node decomposes matrices into their transform components.
     outputShear (osh) vectorArray
         Shear component of the matrices.
 
+    Only the outputs that are being requested or are connected are computed.
+    Connections are counted as they are made and broken, so compute does 
+    not query plugs. Quat, scale and shear come from a single decomposition
+    of each matrix; mirrored or degenerate matrices fall back to 
+    MTransformationMatrix. Rotate is found from the whole matrix with
+    MEulerRotation::decompose, as before.
+
 */
 
 #include "decomposeMatrixArrayNode.h"
 
+#include "../../core/matrixDecompose.h"
+#include "../../core/parallel.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "../../data/angleArrayData.h"
 #include "../../data/eulerArrayData.h"
 #include "../../data/quatArrayData.h"
 
+#include <utility>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -51,6 +62,7 @@ This node decomposes matrices into their transform components.
 #include <maya/MMatrixArray.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
+#include <maya/MQuaternion.h>
 #include <maya/MString.h>
 #include <maya/MTransformationMatrix.h>
 #include <maya/MTypeId.h>
@@ -69,12 +81,27 @@ MObject DecomposeMatrixArrayNode::outputScaleAttr;
 MObject DecomposeMatrixArrayNode::outputShearAttr;
 
 
+DecomposeMatrixArrayNode::DecomposeMatrixArrayNode()
+{
+    for (std::atomic<int> &connections : this->outputConnections)
+    {
+        connections = 0;
+    }
+}
+
+
 void* DecomposeMatrixArrayNode::creator()
 {
     return new DecomposeMatrixArrayNode();
 }
 
 
+MPxNode::SchedulingType DecomposeMatrixArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus DecomposeMatrixArrayNode::initialize()
 {
     MStatus status;
@@ -139,50 +166,187 @@ MStatus DecomposeMatrixArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
+    bool computeTranslate = this->isOutputRequired(plug, outputTranslateAttr);
+    bool computeRotate    = this->isOutputRequired(plug, outputRotateAttr);
+    bool computeQuat      = this->isOutputRequired(plug, outputQuatAttr);
+    bool computeScale     = this->isOutputRequired(plug, outputScaleAttr);
+    bool computeShear     = this->isOutputRequired(plug, outputShearAttr);
+
+    bool computeComponents = computeRotate || computeQuat || computeScale || computeShear;
+
     short rotateOrderIdx  = data.inputValue(inputRotateOrderAttr).asShort();
     MEulerRotation::RotationOrder rotateOrder = (MEulerRotation::RotationOrder) rotateOrderIdx;
 
     MDataHandle inputMatrixHandle = data.inputValue(inputMatrixAttr);
 
-    std::vector<MMatrix> inputMatrix = getMayaArray<MMatrix, MFnMatrixArrayData>(inputMatrixHandle);
+    ArrayView<MMatrix> inputMatrix = getMayaArrayView<MMatrix, MFnMatrixArrayData>(inputMatrixHandle);
 
     size_t numberOfOutputs = inputMatrix.size();
 
-    std::vector<MVector>        outputTranslate(numberOfOutputs);
-    std::vector<MEulerRotation> outputRotate(numberOfOutputs);
-    std::vector<MQuaternion>    outputQuat(numberOfOutputs);
-    std::vector<MVector>        outputScale(numberOfOutputs);
-    std::vector<MVector>        outputShear(numberOfOutputs);
+    std::vector<MEulerRotation> outputRotate(computeRotate ? numberOfOutputs : 0);
+    std::vector<MQuaternion>    outputQuat(computeQuat ? numberOfOutputs : 0);
+
+    MDataHandle outputTranslateHandle = data.outputValue(outputTranslateAttr);
+    MDataHandle outputScaleHandle     = data.outputValue(outputScaleAttr);
+    MDataHandle outputShearHandle     = data.outputValue(outputShearAttr);
 
-    double values[3] {0.0, 0.0, 0.0};
+    MVector *outputTranslate = nullptr;
+    MVector *outputScale     = nullptr;
+    MVector *outputShear     = nullptr;
 
-    for (size_t i = 0; i < numberOfOutputs; i++)
+    if (computeTranslate)
     {
-        MTransformationMatrix matrix(inputMatrix[i]);
+        status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputTranslateHandle, (unsigned) numberOfOutputs, outputTranslate);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
 
-        outputTranslate[i] = matrix.getTranslation(MSpace::Space::kWorld);
-        outputRotate[i]    = MEulerRotation::decompose(inputMatrix[i], rotateOrder);
-        outputQuat[i]      = matrix.rotation();
+    if (computeScale)
+    {
+        status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputScaleHandle, (unsigned) numberOfOutputs, outputScale);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
 
-        matrix.getScale(values, MSpace::Space::kWorld);
-        outputScale[i] = MVector(values);
+    if (computeShear)
+    {
+        status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputShearHandle, (unsigned) numberOfOutputs, outputShear);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
 
-        matrix.getShear(values, MSpace::Space::kWorld);
-        outputShear[i] = MVector(values);
+    parallelFor(0, numberOfOutputs, [&](size_t i)
+    {
+        const MMatrix &m = inputMatrix[i];
+
+        if (computeTranslate)
+        {
+            outputTranslate[i] = MVector(m(3, 0), m(3, 1), m(3, 2));
+        }
+
+        if (!computeComponents) 
+        { 
+            return; 
+        }
+
+        MatrixComponents components;
+
+        if (decomposeMatrix(&m.matrix[0][0], components))
+        {
+            // The euler rotation is found from the whole matrix, as it always
+            // has been, so that sheared matrices keep their previous angles.
+            if (computeRotate) { outputRotate[i] = MEulerRotation::decompose(m, rotateOrder); }
+            if (computeQuat)   { outputQuat[i]   = MMatrix(components.rotate); }
+            if (computeScale)  { outputScale[i]  = MVector(components.scale); }
+            if (computeShear)  { outputShear[i]  = MVector(components.shear); }
+        } else {
+            double values[3] {0.0, 0.0, 0.0};
+
+            MTransformationMatrix matrix(m);
+
+            if (computeRotate) { outputRotate[i] = MEulerRotation::decompose(m, rotateOrder); }
+            if (computeQuat)   { outputQuat[i]   = matrix.rotation(); }
+
+            if (computeScale)
+            {
+                matrix.getScale(values, MSpace::Space::kWorld);
+                outputScale[i] = MVector(values);
+            }
+
+            if (computeShear)
+            {
+                matrix.getShear(values, MSpace::Space::kWorld);
+                outputShear[i] = MVector(values);
+            }
+        }
+    });
+
+    if (computeTranslate)
+    {
+        outputTranslateHandle.setClean();
     }
 
-    MDataHandle outputTranslateHandle = data.outputValue(outputTranslateAttr);
-    MDataHandle outputRotateHandle    = data.outputValue(outputRotateAttr);
-    MDataHandle outputQuatHandle      = data.outputValue(outputQuatAttr);
-    MDataHandle outputScaleHandle     = data.outputValue(outputScaleAttr);
-    MDataHandle outputShearHandle     = data.outputValue(outputShearAttr);
+    if (computeRotate)
+    {
+        MDataHandle outputRotateHandle = data.outputValue(outputRotateAttr);
+        setUserArray<MEulerRotation, EulerArrayData>(outputRotateHandle, std::move(outputRotate));
+        outputRotateHandle.setClean();
+    }
 
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputTranslateHandle, outputTranslate);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputScaleHandle, outputScale);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputShearHandle, outputShear);
+    if (computeQuat)
+    {
+        MDataHandle outputQuatHandle = data.outputValue(outputQuatAttr);
+        setUserArray<MQuaternion, QuatArrayData>(outputQuatHandle, std::move(outputQuat));
+        outputQuatHandle.setClean();
+    }
 
-    setUserArray<MEulerRotation, EulerArrayData>(outputRotateHandle, outputRotate);
-    setUserArray<MQuaternion, QuatArrayData>(outputQuatHandle, outputQuat);
+    if (computeScale)
+    {
+        outputScaleHandle.setClean();
+    }
+
+    if (computeShear)
+    {
+        outputShearHandle.setClean();
+    }
 
     return MStatus::kSuccess;   
-}
\ No newline at end of file
+}
+
+
+bool DecomposeMatrixArrayNode::isOutputRequired(const MPlug &plug, const MObject &attribute) const
+{
+    if (plug == outputAttr || plug == attribute)
+    {
+        return true;
+    }
+
+    return this->outputConnections[0] > 0 || this->outputConnections[this->outputIndex(attribute)] > 0;
+}
+
+
+/** Returns the index of attribute in outputConnections, or -1 if it is not an output. */
+int DecomposeMatrixArrayNode::outputIndex(const MObject &attribute) const
+{
+    const MObject* outputs[6] = {
+        &outputAttr, 
+        &outputTranslateAttr, 
+        &outputRotateAttr, 
+        &outputQuatAttr, 
+        &outputScaleAttr, 
+        &outputShearAttr
+    };
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (attribute == *outputs[i]) { return i; }
+    }
+
+    return -1;
+}
+
+
+void DecomposeMatrixArrayNode::updateConnections(const MPlug &plug, bool asSrc, int change)
+{
+    int index = asSrc ? this->outputIndex(plug.attribute()) : -1;
+
+    if (index >= 0)
+    {
+        this->outputConnections[index] += change;
+    }
+}
+
+
+MStatus DecomposeMatrixArrayNode::connectionMade(const MPlug &plug, const MPlug &otherPlug, bool asSrc)
+{
+    this->updateConnections(plug, asSrc, 1);
+
+    return MPxNode::connectionMade(plug, otherPlug, asSrc);
+}
+
+
+MStatus DecomposeMatrixArrayNode::connectionBroken(const MPlug &plug, const MPlug &otherPlug, bool asSrc)
+{
+    this->updateConnections(plug, asSrc, -1);
+
+    return MPxNode::connectionBroken(plug, otherPlug, asSrc);
+}
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -14,10 +16,27 @@
 class DecomposeMatrixArrayNode : public MPxNode
 {
 public:
+                            DecomposeMatrixArrayNode();
+
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual MStatus         connectionMade(const MPlug &plug, const MPlug &otherPlug, bool asSrc);
+    virtual MStatus         connectionBroken(const MPlug &plug, const MPlug &otherPlug, bool asSrc);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
+private:
+            bool            isOutputRequired(const MPlug &plug, const MObject &attribute) const;
+            int             outputIndex(const MObject &attribute) const;
+            void            updateConnections(const MPlug &plug, bool asSrc, int change);
+
+    /** 
+        Number of connections from output, then from each of its children. 
+        These are kept up to date by connectionMade and connectionBroken,
+        so that compute does not query plugs.
+    */
+    std::atomic<int>        outputConnections[6];
+
 public:
     static MTypeId          NODE_ID;
     static MString          NODE_NAME;
@@ -25,13 +25,34 @@ This node computes the result of a matrix operation.
         As Rotate    (5) outputs the matrices as a rotation matrix.
         As Scale     (6) outputs the matrices as a scale matrix.
 
+    inverseMode (ivm) enum
+        Method used to invert matrices, for the "Invert" and "As Rotate 
+        Matrix" operations.
+
+        Exact (0) inverts each matrix with MMatrix::inverse.
+        Fast  (1) inverts all of the matrices in one batch. Affine matrices
+                  only invert their upper 3x3. Singular matrices still use
+                  MMatrix::inverse.
+
     outputMatrix (om) matrixArray
         List of output matrices.
 
+    When multiplying, a single matrix is multiplied with every matrix of the
+    other input. Otherwise the shorter input is padded with identity 
+    matrices.
+
+    "As Rotate" and "As Scale" split each matrix with a single decomposition;
+    mirrored or degenerate matrices fall back to MTransformationMatrix.
+
 */
 
 #include "matrixArrayOpNode.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
+#include "../../core/matrixCompose.h"
+#include "../../core/matrixDecompose.h"
+#include "../../core/matrixKernels.h"
+#include "../../core/parallel.h"
 
 #include <algorithm>
 #include <vector>
@@ -53,6 +74,7 @@ This node computes the result of a matrix operation.
 MObject MatrixArrayOpNode::inputMatrix1Attr;
 MObject MatrixArrayOpNode::inputMatrix2Attr;
 MObject MatrixArrayOpNode::operationAttr;
+MObject MatrixArrayOpNode::inverseModeAttr;
 
 MObject MatrixArrayOpNode::outputMatrixAttr;
 
@@ -65,6 +87,77 @@ const short AS_TRANSLATE = 4;
 const short AS_ROTATE    = 5;
 const short AS_SCALE     = 6;
 
+const short EXACT_INVERSE = 0;
+const short FAST_INVERSE  = 1;
+
+static_assert(sizeof(MMatrix) == MATRIX_SIZE * sizeof(double), "MMatrix must be a bare 4x4 array of doubles.");
+
+
+static const double* matrixData(ArrayView<MMatrix> matrices)
+{
+    return matrices.empty() ? nullptr : &matrices[0].matrix[0][0];
+}
+
+
+static double* matrixData(std::vector<MMatrix> &matrices)
+{
+    return matrices.empty() ? nullptr : &matrices[0].matrix[0][0];
+}
+
+
+static double* matrixData(MMatrix *matrices)
+{
+    return matrices == nullptr ? nullptr : &matrices[0].matrix[0][0];
+}
+
+
+/**
+    Finds the scale matrix of m, which includes shear, and its rotate matrix
+    if rotateMatrix is not null, as MTransformationMatrix::asScaleMatrix and
+    asRotateMatrix do. Mirrored or degenerate matrices, which decomposeMatrix
+    does not handle, fall back to MTransformationMatrix.
+*/
+static void decomposeScaleMatrix(const MMatrix &m, MMatrix &scaleMatrix, MMatrix *rotateMatrix)
+{
+    MatrixComponents components;
+
+    if (decomposeMatrix(&m.matrix[0][0], components))
+    {
+        static const double ORIGIN[3] = {0.0, 0.0, 0.0};
+        static const double NO_ROTATION[3][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+
+        composeMatrix(ORIGIN, NO_ROTATION, components.scale, components.shear, &scaleMatrix.matrix[0][0]);
+
+        if (rotateMatrix != nullptr) { *rotateMatrix = MMatrix(components.rotate); }
+    } else {
+        MTransformationMatrix xformMatrix(m);
+
+        scaleMatrix = xformMatrix.asScaleMatrix();
+
+        if (rotateMatrix != nullptr) { *rotateMatrix = xformMatrix.asRotateMatrix(); }
+    }
+}
+
+
+static void invertMatrices(ArrayView<MMatrix> matrices, short inverseMode, MMatrix *output)
+{
+    if (inverseMode == FAST_INVERSE)
+    {
+        std::vector<size_t> singular;
+        matrixArrayFastInverse(matrixData(matrices), matrixData(output), matrices.size(), singular);
+
+        for (size_t i : singular)
+        {
+            output[i] = matrices[i].inverse();
+        }
+    } else {
+        parallelFor(0, matrices.size(), [&](size_t i)
+        {
+            output[i] = matrices[i].inverse();
+        });
+    }
+}
+
 
 void* MatrixArrayOpNode::creator()
 {
@@ -72,6 +165,12 @@ void* MatrixArrayOpNode::creator()
 }
 
 
+MPxNode::SchedulingType MatrixArrayOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus MatrixArrayOpNode::initialize()
 {
     MStatus status;
@@ -93,9 +192,15 @@ MStatus MatrixArrayOpNode::initialize()
     E.addField("As Rotate Matrix",    AS_ROTATE);
     E.addField("As Scale Matrix",     AS_SCALE);
 
+    inverseModeAttr = E.create("inverseMode", "ivm", EXACT_INVERSE, &status);
+    E.setChannelBox(true);
+    E.addField("Exact", EXACT_INVERSE);
+    E.addField("Fast",  FAST_INVERSE);
+
     addAttribute(inputMatrix1Attr);
     addAttribute(inputMatrix2Attr);
     addAttribute(operationAttr);
+    addAttribute(inverseModeAttr);
 
     outputMatrixAttr = T.create("outputMatrix", "om", MFnData::kMatrixArray, MObject::kNullObj, &status);
     T.setStorable(false);
@@ -105,6 +210,7 @@ MStatus MatrixArrayOpNode::initialize()
     attributeAffects(inputMatrix1Attr, outputMatrixAttr);
     attributeAffects(inputMatrix2Attr, outputMatrixAttr);
     attributeAffects(operationAttr, outputMatrixAttr);
+    attributeAffects(inverseModeAttr, outputMatrixAttr);
 
     return MStatus::kSuccess;
 }
@@ -119,74 +225,108 @@ MStatus MatrixArrayOpNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short operation = data.inputValue(operationAttr).asShort();
+    short inverseMode = data.inputValue(inverseModeAttr).asShort();
 
     MDataHandle inputMatrix1Handle = data.inputValue(inputMatrix1Attr);
-    std::vector<MMatrix> inputMatrix1 = getMayaArray<MMatrix, MFnMatrixArrayData>(inputMatrix1Handle);
+    ArrayView<MMatrix> inputMatrix1 = getMayaArrayView<MMatrix, MFnMatrixArrayData>(inputMatrix1Handle);
 
     unsigned numberOfInputs = (unsigned) inputMatrix1.size();
 
-    std::vector<MMatrix> outputMatrix(numberOfInputs);
+    ArrayView<MMatrix> inputMatrix2;
+
+    std::vector<MMatrix> paddedMatrix1;
+    std::vector<MMatrix> paddedMatrix2;
 
     if (operation == MULTIPY)
     {
         MDataHandle inputMatrix2Handle = data.inputValue(inputMatrix2Attr);
-        std::vector<MMatrix> inputMatrix2 = getMayaArray<MMatrix, MFnMatrixArrayData>(inputMatrix2Handle);
+        inputMatrix2 = getMayaArrayView<MMatrix, MFnMatrixArrayData>(inputMatrix2Handle);
 
         numberOfInputs = std::max(numberOfInputs, (unsigned) inputMatrix2.size());
 
-        inputMatrix1.resize(numberOfInputs);
-        inputMatrix2.resize(numberOfInputs);
-        outputMatrix.resize(numberOfInputs);
-
-        for (unsigned i = 0; i < numberOfInputs; i++)
+        // The matrix kernels need contiguous inputs, so only a shorter input
+        // is copied, broadcast or padded with identity matrices.
+        if (inputMatrix1.size() != numberOfInputs)
         {
-            outputMatrix[i] = inputMatrix1[i] * inputMatrix2[i];
+            paddedMatrix1 = BroadcastView<MMatrix>(inputMatrix1, MMatrix::identity).copy(numberOfInputs);
+            inputMatrix1 = paddedMatrix1;
         }
-    } else if (operation == INVERT) { 
-        for (unsigned i = 0; i < numberOfInputs; i++)
+
+        if (inputMatrix2.size() != numberOfInputs)
         {
-            outputMatrix[i] = inputMatrix1[i].inverse();
+            paddedMatrix2 = BroadcastView<MMatrix>(inputMatrix2, MMatrix::identity).copy(numberOfInputs);
+            inputMatrix2 = paddedMatrix2;
         }
-    } else if (operation == TRANSPOSE) {
-        for (unsigned i = 0; i < numberOfInputs; i++)
-        {
-            outputMatrix[i] = inputMatrix1[i].transpose();
+    }
+
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
+    {
+        hashInput(inputHash, inputMatrix1);
+        hashInput(inputHash, inputMatrix2);
+        inputHash.updateValue(operation);
+        inputHash.updateValue(inverseMode);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
         }
+    }
+
+    MDataHandle outputMatrixHandle = data.outputValue(outputMatrixAttr);
+
+    MMatrix *outputMatrix = nullptr;
+    status = getMayaArrayOutput<MMatrix, MMatrixArray, MFnMatrixArrayData>(outputMatrixHandle, numberOfInputs, outputMatrix);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    if (operation == MULTIPY)
+    {
+        matrixArrayMultiply(matrixData(inputMatrix1), matrixData(inputMatrix2), matrixData(outputMatrix), numberOfInputs);
+    } else if (operation == INVERT) { 
+        invertMatrices(inputMatrix1, inverseMode, outputMatrix);
+    } else if (operation == TRANSPOSE) {
+        matrixArrayTranspose(matrixData(inputMatrix1), matrixData(outputMatrix), numberOfInputs);
     } else if (operation == AS_TRANSLATE) {
-        MTransformationMatrix xformMatrix;
-        
-        for (unsigned i = 0; i < numberOfInputs; i++)
+        parallelFor(0, numberOfInputs, [&](size_t i)
         {
-            MMatrix &m = inputMatrix1[i];
-            MVector t(m(3, 0), m(3, 1), m(3, 2));
-            xformMatrix.setTranslation(t, MSpace::Space::kWorld);
-            outputMatrix[i] = xformMatrix.asMatrix();
-        }
+            const MMatrix &m = inputMatrix1[i];
+            MMatrix &t = outputMatrix[i];
+            t = MMatrix::identity;
+            t(3, 0) = m(3, 0);
+            t(3, 1) = m(3, 1);
+            t(3, 2) = m(3, 2);
+        });
     } else if (operation == AS_ROTATE) {
-        for (unsigned i = 0; i < numberOfInputs; i++)
+        std::vector<MMatrix> rotateMatrix(numberOfInputs);
+        std::vector<MMatrix> scaleMatrix(numberOfInputs);
+
+        parallelFor(0, numberOfInputs, [&](size_t i)
         {
-            MTransformationMatrix xformMatrix(inputMatrix1[i]);
-            MMatrix rotateMatrix = xformMatrix.asRotateMatrix();
-            MMatrix scaleMatrix  = xformMatrix.asScaleMatrix();
-            outputMatrix[i] = rotateMatrix * scaleMatrix.inverse();
-        }
+            decomposeScaleMatrix(inputMatrix1[i], scaleMatrix[i], &rotateMatrix[i]);
+        });
+
+        invertMatrices(scaleMatrix, inverseMode, scaleMatrix.data());
+        matrixArrayMultiply(matrixData(rotateMatrix), matrixData(scaleMatrix), matrixData(outputMatrix), numberOfInputs);
     } else if (operation == AS_SCALE) {
-        for (unsigned i = 0; i < numberOfInputs; i++)
+        parallelFor(0, numberOfInputs, [&](size_t i)
         {
-            MTransformationMatrix xformMatrix(inputMatrix1[i]);
-            outputMatrix[i] = xformMatrix.asScaleMatrix();
-        }
+            decomposeScaleMatrix(inputMatrix1[i], outputMatrix[i], nullptr);
+        });
     } else {
         std::copy(
             inputMatrix1.begin(),
             inputMatrix1.end(),
-            outputMatrix.begin()
+            outputMatrix
         );
     }
 
-    MDataHandle outputMatrixHandle = data.outputValue(outputMatrixAttr);
-    setMayaArray<MMatrix, MMatrixArray, MFnMatrixArrayData>(outputMatrixHandle, outputMatrix);
+    outputMatrixHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,6 +17,7 @@ class MatrixArrayOpNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
@@ -25,6 +28,10 @@ public:
     static MObject          inputMatrix1Attr;
     static MObject          inputMatrix2Attr;
     static MObject          operationAttr;
+    static MObject          inverseModeAttr;
 
     static MObject          outputMatrixAttr;
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
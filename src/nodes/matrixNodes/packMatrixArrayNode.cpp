@@ -43,9 +43,10 @@ This node outputs an array of 4x4 matrices based on the input values.
 */
 
 #include "packMatrixArrayNode.h"
+#include "../../core/packKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 
-#include <algorithm>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -89,6 +90,12 @@ void* PackMatrixArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType PackMatrixArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus PackMatrixArrayNode::initialize()
 {
     MStatus status;
@@ -153,6 +160,8 @@ MStatus PackMatrixArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MFnMatrixData fnMatrixData;
 
     MMatrix fillValue = data.inputValue(fillValueAttr).asMatrix();
@@ -177,47 +186,22 @@ MStatus PackMatrixArrayNode::compute(const MPlug& plug, MDataBlock& data)
         MDataHandle inputRow2Handle = data.inputValue(inputRow2Attr);
         MDataHandle inputRow3Handle = data.inputValue(inputRow3Attr);
 
-        std::vector<MVector> inputRow0 = getMayaArray<MVector, MFnVectorArrayData>(inputRow0Handle);
-        std::vector<MVector> inputRow1 = getMayaArray<MVector, MFnVectorArrayData>(inputRow1Handle);
-        std::vector<MVector> inputRow2 = getMayaArray<MVector, MFnVectorArrayData>(inputRow2Handle);
-        std::vector<MVector> inputRow3 = getMayaArray<MVector, MFnVectorArrayData>(inputRow3Handle);
-
-        unsigned numberOfInputs = 0;
-
-        numberOfInputs = std::max(numberOfInputs, (unsigned) inputRow0.size());
-        numberOfInputs = std::max(numberOfInputs, (unsigned) inputRow1.size());
-        numberOfInputs = std::max(numberOfInputs, (unsigned) inputRow2.size());
-        numberOfInputs = std::max(numberOfInputs, (unsigned) inputRow3.size());
-
-        inputRow0.resize(numberOfInputs, MVector::xAxis);
-        inputRow1.resize(numberOfInputs, MVector::yAxis);
-        inputRow2.resize(numberOfInputs, MVector::zAxis);
-        inputRow3.resize(numberOfInputs, MVector::zero);
-        outputMatrix.resize(size, fillValue);
-
-        double m[4][4] = {
-            {1.0, 0.0, 0.0, 0.0},
-            {0.0, 1.0, 0.0, 0.0},
-            {0.0, 0.0, 1.0, 0.0},
-            {1.0, 0.0, 0.0, 1.0}
-        };
-
-        unsigned numberOfOutputs = std::min(size, numberOfInputs);
-
-        for (unsigned i = 0; i < numberOfOutputs; i++)
-        {
-            MVector &row0 = inputRow0[i];
-            MVector &row1 = inputRow1[i];
-            MVector &row2 = inputRow2[i];
-            MVector &row3 = inputRow3[i];
-
-            m[0][0] = row0.x; m[0][1] = row0.y; m[0][2] = row0.z;
-            m[1][0] = row1.x; m[1][1] = row1.y; m[1][2] = row1.z;
-            m[2][0] = row2.x; m[2][1] = row2.y; m[2][2] = row2.z;
-            m[3][0] = row3.x; m[3][1] = row3.y; m[3][2] = row3.z;
-
-            outputMatrix[i] = MMatrix(m);
-        }
+        ArrayView<MVector> inputRow0 = getMayaArrayView<MVector, MFnVectorArrayData>(inputRow0Handle);
+        ArrayView<MVector> inputRow1 = getMayaArrayView<MVector, MFnVectorArrayData>(inputRow1Handle);
+        ArrayView<MVector> inputRow2 = getMayaArrayView<MVector, MFnVectorArrayData>(inputRow2Handle);
+        ArrayView<MVector> inputRow3 = getMayaArrayView<MVector, MFnVectorArrayData>(inputRow3Handle);
+
+        outputMatrix.resize(size);
+
+        packMatrixArray(
+            coreView(inputRow0), 
+            coreView(inputRow1), 
+            coreView(inputRow2), 
+            coreView(inputRow3), 
+            coreValue(fillValue), 
+            coreArray(outputMatrix.data()), 
+            size
+        );
     }
 
     MDataHandle outputMatrixHandle = data.outputValue(outputMatrixAttr);
@@ -31,6 +31,8 @@ This node outputs the rows of 4x4 matrices.
 
 #include <vector>
 
+#include "../../core/packKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "unpackMatrixArrayNode.h"
 
@@ -69,6 +71,12 @@ void* UnpackMatrixArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType UnpackMatrixArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus UnpackMatrixArrayNode::initialize()
 {
     MStatus status;
@@ -129,8 +137,10 @@ MStatus UnpackMatrixArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputMatrixHandle = data.inputValue(inputMatrixAttr);
-    std::vector<MMatrix> inputMatrix = getMayaArray<MMatrix, MFnMatrixArrayData>(inputMatrixHandle);
+    ArrayView<MMatrix> inputMatrix = getMayaArrayView<MMatrix, MFnMatrixArrayData>(inputMatrixHandle);
 
     unsigned numberOfValues = (unsigned) inputMatrix.size();
 
@@ -142,30 +152,31 @@ MStatus UnpackMatrixArrayNode::compute(const MPlug& plug, MDataBlock& data)
         &UnpackMatrixArrayNode::setElement
     );
 
-    std::vector<MVector> row0(numberOfValues);
-    std::vector<MVector> row1(numberOfValues);
-    std::vector<MVector> row2(numberOfValues);
-    std::vector<MVector> row3(numberOfValues);
-
-    for (unsigned i = 0; i < numberOfValues; i++)
-    {
-        MMatrix &m = inputMatrix[i];
-
-        row0[i] = MVector(m(0, 0), m(0, 1), m(0, 2));
-        row1[i] = MVector(m(1, 0), m(1, 1), m(1, 2));
-        row2[i] = MVector(m(2, 0), m(2, 1), m(2, 2));
-        row3[i] = MVector(m(3, 0), m(3, 1), m(3, 2));
-    }
-
     MDataHandle outputRow0Handle = data.outputValue(outputRow0Attr);
     MDataHandle outputRow1Handle = data.outputValue(outputRow1Attr);
     MDataHandle outputRow2Handle = data.outputValue(outputRow2Attr);
     MDataHandle outputRow3Handle = data.outputValue(outputRow3Attr);
 
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputRow0Handle, row0);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputRow1Handle, row1);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputRow2Handle, row2);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputRow3Handle, row3);
+    MVector *row0 = nullptr;
+    MVector *row1 = nullptr;
+    MVector *row2 = nullptr;
+    MVector *row3 = nullptr;
+
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputRow0Handle, numberOfValues, row0);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputRow1Handle, numberOfValues, row1);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputRow2Handle, numberOfValues, row2);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputRow3Handle, numberOfValues, row3);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    unpackMatrixArray(coreView(inputMatrix), coreArray(row0), coreArray(row1), coreArray(row2), coreArray(row3));
+
+    outputRow0Handle.setClean();
+    outputRow1Handle.setClean();
+    outputRow2Handle.setClean();
+    outputRow3Handle.setClean();
 
     return MStatus::kSuccess;   
 }
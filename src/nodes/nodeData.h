@@ -1,17 +1,29 @@
 #pragma once 
 
+#include <stdint.h>
+
+#include <algorithm>
 #include <functional>
+#include <utility>
 #include <vector>
 
 #include "../data/angleArrayData.h"
 #include "../data/eulerArrayData.h"
 #include "../data/quatArrayData.h"
+#include "../core/arrayView.h"
+#include "../core/computeCache.h"
+#include "../core/contentHash.h"
+#include "../core/dirtyRange.h"
+#include "../core/nodeProfiler.h"
+#include "../core/quatLanes.h"
+#include "../core/xformTypes.h"
 
 #include <maya/MAngle.h>
 #include <maya/MArrayDataBuilder.h>
 #include <maya/MArrayDataHandle.h>
 #include <maya/MDataHandle.h>
 #include <maya/MDataBlock.h>
+#include <maya/MDGContext.h>
 #include <maya/MDoubleArray.h>
 #include <maya/MEulerRotation.h>
 #include <maya/MFnCompoundAttribute.h>
@@ -25,31 +37,80 @@
 #include <maya/MMatrix.h>
 #include <maya/MMatrixArray.h>
 #include <maya/MObject.h>
+#include <maya/MPlug.h>
 #include <maya/MPoint.h>
 #include <maya/MPointArray.h>
 #include <maya/MQuaternion.h>
 #include <maya/MVector.h>
 #include <maya/MVectorArray.h>
 
+static_assert(sizeof(MVector)        == sizeof(Vector3),       "MVector must be laid out like Vector3.");
+static_assert(sizeof(MPoint)         == sizeof(Point4),        "MPoint must be laid out like Point4.");
+static_assert(sizeof(MQuaternion)    == sizeof(Quaternion),    "MQuaternion must be laid out like Quaternion.");
+static_assert(sizeof(MEulerRotation) == sizeof(EulerRotation), "MEulerRotation must be laid out like EulerRotation.");
+static_assert(sizeof(MMatrix)        == sizeof(Matrix4),       "MMatrix must be laid out like Matrix4.");
+
+/** Views Maya arrays as the core type with the same layout, for the core kernels. */
+inline ArrayView<Vector3>       coreView(ArrayView<MVector> values)        { return ArrayView<Vector3>(reinterpret_cast<const Vector3*>(values.data()), values.size()); }
+inline ArrayView<Point4>        coreView(ArrayView<MPoint> values)         { return ArrayView<Point4>(reinterpret_cast<const Point4*>(values.data()), values.size()); }
+inline ArrayView<Quaternion>    coreView(ArrayView<MQuaternion> values)    { return ArrayView<Quaternion>(reinterpret_cast<const Quaternion*>(values.data()), values.size()); }
+inline ArrayView<EulerRotation> coreView(ArrayView<MEulerRotation> values) { return ArrayView<EulerRotation>(reinterpret_cast<const EulerRotation*>(values.data()), values.size()); }
+inline ArrayView<Matrix4>       coreView(ArrayView<MMatrix> values)        { return ArrayView<Matrix4>(reinterpret_cast<const Matrix4*>(values.data()), values.size()); }
+
+inline Vector3*                 coreArray(MVector *values)                 { return reinterpret_cast<Vector3*>(values); }
+inline Point4*                  coreArray(MPoint *values)                  { return reinterpret_cast<Point4*>(values); }
+inline Quaternion*              coreArray(MQuaternion *values)             { return reinterpret_cast<Quaternion*>(values); }
+inline EulerRotation*           coreArray(MEulerRotation *values)          { return reinterpret_cast<EulerRotation*>(values); }
+inline Matrix4*                 coreArray(MMatrix *values)                 { return reinterpret_cast<Matrix4*>(values); }
+
+inline const Vector3&           coreValue(const MVector &value)            { return reinterpret_cast<const Vector3&>(value); }
+inline const Quaternion&        coreValue(const MQuaternion &value)        { return reinterpret_cast<const Quaternion&>(value); }
+inline const Matrix4&           coreValue(const MMatrix &value)            { return reinterpret_cast<const Matrix4&>(value); }
+
+/**
+    Returns a read-only view of the array data on an input handle, without 
+    copying it. Maya arrays store their elements contiguously, so the view
+    points straight at that storage. It stays valid for the rest of the 
+    compute, as long as the input is not set again.
+*/
 template<class T, class FN>
-std::vector<T> getMayaArray(MDataHandle &arrayHandle)
+ArrayView<T> getMayaArrayView(MDataHandle &arrayHandle)
 {
-    std::vector<T> result;
-
     MObject dataObj = arrayHandle.data();
 
-    if (!dataObj.isNull())
+    if (dataObj.isNull())
     {
-        FN arrayData(dataObj);
-        result.resize(arrayData.length());
+        return ArrayView<T>();
+    }
 
-        for (unsigned i = 0; i < arrayData.length(); i++)
-        {
-            result[i] = T(arrayData[i]);
-        }
+    FN arrayData;
+
+    if (!arrayData.setObject(dataObj))
+    {
+        return ArrayView<T>();
     }
 
-    return result;
+    unsigned length = arrayData.length();
+
+    profileInputElements(length);
+
+    return length == 0 ? ArrayView<T>() : ArrayView<T>(&arrayData[0], length);
+}
+
+template ArrayView<double>  getMayaArrayView<double,  MFnDoubleArrayData> (MDataHandle &arrayHandle);
+template ArrayView<MMatrix> getMayaArrayView<MMatrix, MFnMatrixArrayData> (MDataHandle &arrayHandle);
+template ArrayView<MPoint>  getMayaArrayView<MPoint,  MFnPointArrayData>  (MDataHandle &arrayHandle);
+template ArrayView<MVector> getMayaArrayView<MVector, MFnVectorArrayData> (MDataHandle &arrayHandle);
+
+/** Returns a copy of the array data on an input handle, for nodes that must modify or resize it. */
+template<class T, class FN>
+std::vector<T> getMayaArray(MDataHandle &arrayHandle)
+{
+    ArrayView<T> values = getMayaArrayView<T, FN>(arrayHandle);
+
+    profileAllocation(values.size() * sizeof(T));
+
+    return std::vector<T>(values.begin(), values.end());
 }
 
 template std::vector<double>  getMayaArray<double,  MFnDoubleArrayData> (MDataHandle &arrayHandle);
@@ -57,67 +118,425 @@ template std::vector<MMatrix> getMayaArray<MMatrix, MFnMatrixArrayData> (MDataHa
 template std::vector<MPoint>  getMayaArray<MPoint,  MFnPointArrayData>  (MDataHandle &arrayHandle);
 template std::vector<MVector> getMayaArray<MVector, MFnVectorArrayData> (MDataHandle &arrayHandle);
 
+/**
+    Points values at the elements of the array data on an output handle, 
+    resized to numberOfValues. The data object already on the handle is 
+    reused, so nothing is allocated while the length stays the same. Maya 
+    arrays store their elements contiguously, so values can be written as a
+    plain array. values is nullptr when numberOfValues is 0.
+*/
 template<class T, class MA, class FN>
-MStatus setMayaArray(MDataHandle &arrayHandle, std::vector<T> &values)
+MStatus getMayaArrayOutput(MDataHandle &arrayHandle, unsigned numberOfValues, T* &values)
 {
     MStatus status;
-    
-    unsigned numberOfValues = (unsigned) values.size();
-    MA output(numberOfValues);
 
-    for (unsigned i = 0; i < numberOfValues; i++)
+    FN fnData;
+    MObject dataObj = arrayHandle.data();
+
+    bool isReusable = !dataObj.isNull() && fnData.setObject(dataObj);
+
+    profileOutputElements(numberOfValues);
+
+    if (!isReusable)
     {
-        output[i] = values[i];
+        profileAllocation(numberOfValues * sizeof(T));
+
+        dataObj = fnData.create(MA(numberOfValues), &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        status = arrayHandle.setMObject(dataObj);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+
+        dataObj = arrayHandle.data();
+        status = fnData.setObject(dataObj);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    } else if (fnData.length() != numberOfValues) {
+        profileAllocation(numberOfValues * sizeof(T));
+
+        status = fnData.set(MA(numberOfValues));
+        CHECK_MSTATUS_AND_RETURN_IT(status);
     }
 
-    FN fnData;
-    MObject dataObj = fnData.create(output, &status);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    values = numberOfValues == 0 ? nullptr : &fnData[0];
 
-    status = arrayHandle.setMObject(dataObj);
+    return MStatus::kSuccess;
+}
+
+template MStatus getMayaArrayOutput<double,  MDoubleArray, MFnDoubleArrayData>(MDataHandle &arrayHandle, unsigned numberOfValues, double* &values);
+template MStatus getMayaArrayOutput<MMatrix, MMatrixArray, MFnMatrixArrayData>(MDataHandle &arrayHandle, unsigned numberOfValues, MMatrix* &values);
+template MStatus getMayaArrayOutput<MPoint,  MPointArray,  MFnPointArrayData>(MDataHandle &arrayHandle, unsigned numberOfValues, MPoint* &values);
+template MStatus getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(MDataHandle &arrayHandle, unsigned numberOfValues, MVector* &values);
+
+template<class T, class MA, class FN>
+MStatus setMayaArray(MDataHandle &arrayHandle, const std::vector<T> &values)
+{
+    MStatus status;
+    
+    T *output = nullptr;
+    status = getMayaArrayOutput<T, MA, FN>(arrayHandle, (unsigned) values.size(), output);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    std::copy(values.begin(), values.end(), output);
+
     arrayHandle.setClean();
     
     return MStatus::kSuccess;
 }
 
-template MStatus setMayaArray<double,  MDoubleArray, MFnDoubleArrayData>(MDataHandle &arrayHandle, std::vector<double> &values);
-template MStatus setMayaArray<MMatrix, MMatrixArray, MFnMatrixArrayData>(MDataHandle &arrayHandle, std::vector<MMatrix> &values);
-template MStatus setMayaArray<MPoint,  MPointArray,  MFnPointArrayData>(MDataHandle &arrayHandle, std::vector<MPoint> &values);
-template MStatus setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(MDataHandle &arrayHandle, std::vector<MVector> &values);
+template MStatus setMayaArray<double,  MDoubleArray, MFnDoubleArrayData>(MDataHandle &arrayHandle, const std::vector<double> &values);
+template MStatus setMayaArray<MMatrix, MMatrixArray, MFnMatrixArrayData>(MDataHandle &arrayHandle, const std::vector<MMatrix> &values);
+template MStatus setMayaArray<MPoint,  MPointArray,  MFnPointArrayData>(MDataHandle &arrayHandle, const std::vector<MPoint> &values);
+template MStatus setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(MDataHandle &arrayHandle, const std::vector<MVector> &values);
 
 template<class T, class DATA>
-std::vector<T> getUserArray(MDataHandle& arrayHandle)
+const std::vector<T>& getUserArray(MDataHandle& arrayHandle)
 {
-    std::vector<T> result;
+    static const std::vector<T> emptyArray;
 
     MObject dataObj = arrayHandle.data();
 
-    if (!dataObj.isNull())
+    if (dataObj.isNull())
     {
-        MFnPluginData fnData(dataObj);
-        DATA* userData = (DATA*) fnData.data();
-        result = userData->getArray();
+        return emptyArray;
     }
 
-    return result;
+    MFnPluginData fnData(dataObj);
+    DATA* userData = (DATA*) fnData.data();
+
+    profileInputElements(userData->array().size());
+
+    return userData->array();
+}
+
+template const std::vector<MAngle>&         getUserArray<MAngle, AngleArrayData>(MDataHandle& arrayHandle);
+template const std::vector<MEulerRotation>& getUserArray<MEulerRotation, EulerArrayData>(MDataHandle& arrayHandle);
+template const std::vector<MQuaternion>&    getUserArray<MQuaternion, QuatArrayData>(MDataHandle& arrayHandle);
+
+/** Returns the user data on a handle, or nullptr if it has none. */
+template<class DATA>
+DATA* getUserData(MDataHandle& arrayHandle)
+{
+    MObject dataObj = arrayHandle.data();
+
+    if (dataObj.isNull())
+    {
+        return nullptr;
+    }
+
+    MFnPluginData fnData(dataObj);
+    return (DATA*) fnData.data();
+}
+
+/** Returns the contentId of the user data on a handle, or 0 if it has none. */
+template<class DATA>
+uint64_t getUserArrayId(MDataHandle& arrayHandle)
+{
+    DATA* userData = getUserData<DATA>(arrayHandle);
+    return userData == nullptr ? 0 : userData->contentId();
+}
+
+/**
+    Returns the elements of the user data on an input handle that changed
+    since the handle held the data with contentId sinceId. That is every
+    element, unless the data is that data or records its changes from it.
+*/
+template<class DATA>
+DirtyRange getUserArrayChanges(MDataHandle& arrayHandle, uint64_t sinceId)
+{
+    DATA* userData = getUserData<DATA>(arrayHandle);
+
+    if (sinceId == 0 || userData == nullptr)
+    {
+        return DirtyRange::all();
+    }
+
+    if (userData->contentId() == sinceId)
+    {
+        return DirtyRange::none();
+    }
+
+    return userData->baseId() == sinceId ? userData->dirtyRange() : DirtyRange::all();
 }
 
-template std::vector<MAngle>         getUserArray<MAngle, AngleArrayData>(MDataHandle& arrayHandle);
-template std::vector<MEulerRotation> getUserArray<MEulerRotation, EulerArrayData>(MDataHandle& arrayHandle);
-template std::vector<MQuaternion>    getUserArray<MQuaternion, QuatArrayData>(MDataHandle& arrayHandle);
+inline bool isSameValue(const MAngle &a, const MAngle &b)                 { return a.value() == b.value() && a.unit() == b.unit(); }
+inline bool isSameValue(const MEulerRotation &a, const MEulerRotation &b) { return a.x == b.x && a.y == b.y && a.z == b.z && a.order == b.order; }
+inline bool isSameValue(const MQuaternion &a, const MQuaternion &b)       { return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w; }
+
+/**
+    What getUserArrayOutput took over from the previous output: its 
+    contentId, and a copy of its elements in range, which are about to be 
+    recomputed. id is 0 if nothing was taken over.
+*/
+template<class T>
+struct PreviousOutput
+{
+    uint64_t        id = 0;
+    DirtyRange      range = DirtyRange::none();
+    std::vector<T>  values;
+};
+
+/**
+    Starts the output of an elementwise compute that only has to recompute 
+    the elements in changes. If the output handle still holds the data with
+    contentId outputId, and it has numberOfValues elements, values takes 
+    over its array and changes is returned. The array is moved rather than
+    copied unless other data shares it, and the data on the handle is left
+    empty, so previous keeps what setUserArray needs from it. Otherwise, or
+    when every element changed, values is resized to numberOfValues, and 
+    the whole array is returned as changed.
+*/
+template<class T, class DATA>
+DirtyRange getUserArrayOutput(MDataHandle& arrayHandle, uint64_t outputId, const DirtyRange &changes, size_t numberOfValues, std::vector<T> &values, PreviousOutput<T> &previous)
+{
+    DATA* userData = getUserData<DATA>(arrayHandle);
+
+    bool isReusable = (
+        changes.clamp(numberOfValues).size() < numberOfValues &&
+        outputId != 0 &&
+        userData != nullptr && 
+        userData->contentId() == outputId &&
+        userData->array().size() == numberOfValues
+    );
+
+    if (isReusable)
+    {
+        DirtyRange reused = changes.clamp(numberOfValues);
+
+        profileAllocation(reused.size() * sizeof(T));
+
+        values = userData->takeArray();
+
+        previous.id = outputId;
+        previous.range = reused;
+        previous.values.assign(values.begin() + reused.begin, values.begin() + reused.end);
+
+        return reused;
+    }
+
+    profileAllocation(numberOfValues * sizeof(T));
+
+    previous = PreviousOutput<T>();
+    values.resize(numberOfValues);
+
+    DirtyRange everything = {0, numberOfValues};
+    return everything.clamp(numberOfValues);
+}
 
+/** Sets the user data on an output handle to new data, which differs from the data with contentId baseId only inside dirty. */
 template<class T, class DATA>
-MStatus setUserArray(MDataHandle& arrayHandle, std::vector<T> &data)
+MStatus setUserArrayData(MDataHandle& arrayHandle, std::vector<T> &&data, uint64_t baseId, const DirtyRange &dirty)
 {
     MStatus status;
 
+    profileOutputElements(data.size());
+    profileAllocation(data.size() * sizeof(T));
+
     MFnPluginData fnData;
     MObject dataObj = fnData.create(DATA::TYPE_ID, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
     DATA* userData = (DATA*) fnData.data(&status);
-    userData->setArray(data);
+    userData->setArray(std::move(data));
+    userData->setDirtyRange(baseId, dirty);
+
+    status = arrayHandle.setMPxData(userData);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    arrayHandle.setClean();
+
+    return status;
+}
+
+/**
+    Sets the user data on an output handle to data. The caller guarantees
+    that data holds the same values as the data already on the handle 
+    outside changed. The new data records which elements inside changed 
+    really differ, so downstream nodes can skip the rest.
+*/
+template<class T, class DATA>
+MStatus setUserArray(MDataHandle& arrayHandle, std::vector<T> &&data, const DirtyRange &changed)
+{
+    uint64_t baseId = 0;
+    DirtyRange dirty = DirtyRange::all();
+
+    DATA* previousData = getUserData<DATA>(arrayHandle);
+
+    if (previousData != nullptr && previousData->array().size() == data.size())
+    {
+        const std::vector<T> &previous = previousData->array();
+        DirtyRange searchRange = changed.clamp(data.size());
+
+        baseId = previousData->contentId();
+        dirty = findChangedRange(searchRange.begin, searchRange.end, [&](size_t i) { return isSameValue(previous[i], data[i]); });
+    }
+
+    return setUserArrayData<T, DATA>(arrayHandle, std::move(data), baseId, dirty);
+}
+
+template MStatus setUserArray<MAngle, AngleArrayData>(MDataHandle& arrayHandle, std::vector<MAngle> &&data, const DirtyRange &changed);
+template MStatus setUserArray<MEulerRotation, EulerArrayData>(MDataHandle& arrayHandle, std::vector<MEulerRotation> &&data, const DirtyRange &changed);
+template MStatus setUserArray<MQuaternion, QuatArrayData> (MDataHandle& arrayHandle, std::vector<MQuaternion> &&data, const DirtyRange &changed);
+
+/**
+    As above, for an output started by getUserArrayOutput, which has taken 
+    the values over from the data on the handle. The values in changed are
+    compared with the ones previous kept instead.
+*/
+template<class T, class DATA>
+MStatus setUserArray(MDataHandle& arrayHandle, std::vector<T> &&data, const DirtyRange &changed, const PreviousOutput<T> &previous)
+{
+    if (previous.id == 0)
+    {
+        return setUserArray<T, DATA>(arrayHandle, std::move(data), changed);
+    }
+
+    DirtyRange searchRange = changed.clamp(data.size());
+    DirtyRange dirty = searchRange;
+
+    // Elements outside the range that was kept cannot be compared, so they count as changed.
+    if (searchRange.begin >= previous.range.begin && searchRange.end <= previous.range.end)
+    {
+        dirty = findChangedRange(searchRange.begin, searchRange.end, [&](size_t i) { return isSameValue(previous.values[i - previous.range.begin], data[i]); });
+    }
+
+    return setUserArrayData<T, DATA>(arrayHandle, std::move(data), previous.id, dirty);
+}
+
+template MStatus setUserArray<MAngle, AngleArrayData>(MDataHandle& arrayHandle, std::vector<MAngle> &&data, const DirtyRange &changed, const PreviousOutput<MAngle> &previous);
+template MStatus setUserArray<MEulerRotation, EulerArrayData>(MDataHandle& arrayHandle, std::vector<MEulerRotation> &&data, const DirtyRange &changed, const PreviousOutput<MEulerRotation> &previous);
+template MStatus setUserArray<MQuaternion, QuatArrayData> (MDataHandle& arrayHandle, std::vector<MQuaternion> &&data, const DirtyRange &changed, const PreviousOutput<MQuaternion> &previous);
+
+template<class T, class DATA>
+MStatus setUserArray(MDataHandle& arrayHandle, std::vector<T> &&data)
+{
+    return setUserArray<T, DATA>(arrayHandle, std::move(data), DirtyRange::all());
+}
+
+template MStatus setUserArray<MAngle, AngleArrayData>(MDataHandle& arrayHandle, std::vector<MAngle> &&data);
+template MStatus setUserArray<MEulerRotation, EulerArrayData>(MDataHandle& arrayHandle, std::vector<MEulerRotation> &&data);
+template MStatus setUserArray<MQuaternion, QuatArrayData> (MDataHandle& arrayHandle, std::vector<MQuaternion> &&data);
+
+template<class T, class DATA>
+MStatus setUserArray(MDataHandle& arrayHandle, const std::vector<T> &data)
+{
+    return setUserArray<T, DATA>(arrayHandle, std::vector<T>(data));
+}
+
+template MStatus setUserArray<MAngle, AngleArrayData>(MDataHandle& arrayHandle, const std::vector<MAngle> &data);
+template MStatus setUserArray<MEulerRotation, EulerArrayData>(MDataHandle& arrayHandle, const std::vector<MEulerRotation> &data);
+template MStatus setUserArray<MQuaternion, QuatArrayData> (MDataHandle& arrayHandle, const std::vector<MQuaternion> &data);
+
+/** Returns the lanes of a QuatArrayData in either precision. */
+template <typename REAL> const BasicQuatLanes<REAL>& quatDataLanes(const QuatArrayData *data);
+
+template <> inline const QuatLanes&  quatDataLanes<double>(const QuatArrayData *data) { return data->lanes(); }
+template <> inline const QuatLanesF& quatDataLanes<float>(const QuatArrayData *data)  { return data->lanesF(); }
+
+inline void setQuatDataLanes(QuatArrayData *data, QuatLanes &&lanes)  { data->setLanes(std::move(lanes)); }
+inline void setQuatDataLanes(QuatArrayData *data, QuatLanesF &&lanes) { data->setLanesF(std::move(lanes)); }
+
+template <typename REAL>
+const BasicQuatLanes<REAL>& getBasicQuatLanes(MDataHandle& arrayHandle)
+{
+    static const BasicQuatLanes<REAL> emptyLanes;
+
+    MObject dataObj = arrayHandle.data();
+
+    if (dataObj.isNull())
+    {
+        return emptyLanes;
+    }
+
+    MFnPluginData fnData(dataObj);
+    QuatArrayData* userData = (QuatArrayData*) fnData.data();
+
+    const BasicQuatLanes<REAL> &lanes = quatDataLanes<REAL>(userData);
+
+    profileInputElements(lanes.size());
+
+    return lanes;
+}
+
+inline const QuatLanes& getQuatLanes(MDataHandle& arrayHandle)
+{
+    return getBasicQuatLanes<double>(arrayHandle);
+}
+
+inline const QuatLanesF& getQuatLanesF(MDataHandle& arrayHandle)
+{
+    return getBasicQuatLanes<float>(arrayHandle);
+}
+
+/**
+    As getUserArrayOutput, for lanes in either precision. The previous lanes
+    are only reused if they were also computed in this precision, which the
+    caller checks.
+*/
+template <typename REAL>
+DirtyRange getQuatLanesOutput(MDataHandle& arrayHandle, uint64_t outputId, const DirtyRange &changes, size_t numberOfValues, BasicQuatLanes<REAL> &lanes)
+{
+    QuatArrayData* userData = getUserData<QuatArrayData>(arrayHandle);
+
+    profileAllocation(numberOfValues * 4 * sizeof(REAL));
+
+    bool isReusable = (
+        changes.clamp(numberOfValues).size() < numberOfValues &&
+        outputId != 0 &&
+        userData != nullptr && 
+        userData->contentId() == outputId &&
+        userData->length() == numberOfValues
+    );
+
+    if (isReusable)
+    {
+        lanes = quatDataLanes<REAL>(userData);
+        return changes.clamp(numberOfValues);
+    }
+
+    lanes.resize(numberOfValues);
+
+    DirtyRange everything = {0, numberOfValues};
+    return everything.clamp(numberOfValues);
+}
+
+/** As setUserArray, for lanes in either precision. */
+template <typename REAL>
+MStatus setQuatLanes(MDataHandle& arrayHandle, BasicQuatLanes<REAL> &&lanes, const DirtyRange &changed)
+{
+    MStatus status;
+
+    profileOutputElements(lanes.size());
+    profileAllocation(lanes.size() * 4 * sizeof(REAL));
+
+    uint64_t baseId = 0;
+    DirtyRange dirty = DirtyRange::all();
+
+    QuatArrayData* previousData = getUserData<QuatArrayData>(arrayHandle);
+
+    if (previousData != nullptr && previousData->length() == lanes.size())
+    {
+        const BasicQuatLanes<REAL> &previous = quatDataLanes<REAL>(previousData);
+        DirtyRange searchRange = changed.clamp(lanes.size());
+
+        baseId = previousData->contentId();
+        dirty = findChangedRange(searchRange.begin, searchRange.end, [&](size_t i) 
+        { 
+            return (
+                previous.x[i] == lanes.x[i] && 
+                previous.y[i] == lanes.y[i] && 
+                previous.z[i] == lanes.z[i] && 
+                previous.w[i] == lanes.w[i]
+            );
+        });
+    }
+
+    MFnPluginData fnData;
+    MObject dataObj = fnData.create(QuatArrayData::TYPE_ID, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    QuatArrayData* userData = (QuatArrayData*) fnData.data(&status);
+    setQuatDataLanes(userData, std::move(lanes));
+    userData->setDirtyRange(baseId, dirty);
 
     status = arrayHandle.setMPxData(userData);
     CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -127,17 +546,109 @@ MStatus setUserArray(MDataHandle& arrayHandle, std::vector<T> &data)
     return status;
 }
 
-template MStatus setUserArray<MAngle, AngleArrayData>(MDataHandle& arrayHandle, std::vector<MAngle> &data);
-template MStatus setUserArray<MEulerRotation, EulerArrayData>(MDataHandle& arrayHandle, std::vector<MEulerRotation> &data);
-template MStatus setUserArray<MQuaternion, QuatArrayData> (MDataHandle& arrayHandle, std::vector<MQuaternion> &data);
+template <typename REAL>
+MStatus setQuatLanes(MDataHandle& arrayHandle, BasicQuatLanes<REAL> &&lanes)
+{
+    return setQuatLanes(arrayHandle, std::move(lanes), DirtyRange::all());
+}
+
+/** Adds an input array to the hash of a compute's inputs. T must not contain padding. */
+template<class T>
+void hashInput(ContentHash &inputHash, ArrayView<T> values)
+{
+    inputHash.updateValue((uint64_t) values.size());
+    inputHash.update(values.data(), values.size() * sizeof(T));
+}
+
+template<class T>
+void hashInput(ContentHash &inputHash, const std::vector<T> &values)
+{
+    hashInput(inputHash, ArrayView<T>(values));
+}
+
+/** MAngle and MEulerRotation are padded, so only their fields are hashed. */
+inline void hashInput(ContentHash &inputHash, const std::vector<MAngle> &values)
+{
+    inputHash.updateValue((uint64_t) values.size());
+
+    for (const MAngle &a : values)
+    {
+        inputHash.updateValue(a.value());
+        inputHash.updateValue(a.unit());
+    }
+}
+
+inline void hashInput(ContentHash &inputHash, const std::vector<MEulerRotation> &values)
+{
+    inputHash.updateValue((uint64_t) values.size());
+
+    for (const MEulerRotation &r : values)
+    {
+        double xyz[3] = {r.x, r.y, r.z};
+        inputHash.update(xyz, sizeof(xyz));
+        inputHash.updateValue(r.order);
+    }
+}
+
+template <typename REAL>
+void hashInput(ContentHash &inputHash, const BasicQuatLanes<REAL> &values)
+{
+    size_t numberOfValues = values.size();
+
+    inputHash.updateValue((uint64_t) numberOfValues);
+    inputHash.update(values.x.data(), numberOfValues * sizeof(REAL));
+    inputHash.update(values.y.data(), numberOfValues * sizeof(REAL));
+    inputHash.update(values.z.data(), numberOfValues * sizeof(REAL));
+    inputHash.update(values.w.data(), numberOfValues * sizeof(REAL));
+}
+
+/**
+    Returns true if this compute may use the node's compute cache. A compute
+    outside the normal context (for example, getAttr -time) writes to a
+    different data block, so it neither reuses nor stores an output.
+*/
+inline bool useComputeCache(MDataBlock &data)
+{
+    return computeCacheEnabled() && data.context().isNormal();
+}
+
+/**
+    Returns true if the inputs hashed into inputHash are the inputs of the 
+    node's last compute. The output already on plug is then kept, and set 
+    clean.
+*/
+inline bool reuseOutput(ComputeCache &cache, const ContentHash &inputHash, const MPlug &plug, MDataBlock &data)
+{
+    if (!cache.reuse(inputHash.digest()))
+    {
+        return false;
+    }
+
+    data.setClean(plug);
+
+    return true;
+}
+
+/** Stores the hash of the inputs of a finished compute. */
+inline void storeOutput(ComputeCache &cache, const ContentHash &inputHash, MDataBlock &data)
+{
+    if (data.context().isNormal())
+    {
+        cache.store(inputHash.digest());
+    }
+}
 
 template<class T>
 std::vector<T> getArrayElements(MArrayDataHandle& arrayHandle, T (*getElement)(MDataHandle&), unsigned size, T fillValue)
 {
     std::vector<T> result(size, fillValue);
 
+    profileAllocation(size * sizeof(T));
+
     unsigned numberOfInputs = (unsigned) arrayHandle.elementCount();
 
+    profileInputElements(numberOfInputs);
+
     std::vector<T> values(numberOfInputs);
     std::vector<unsigned> indices(numberOfInputs);
 
@@ -169,7 +680,7 @@ template std::vector<MQuaternion>    getArrayElements(MArrayDataHandle& arrayHan
 template std::vector<MVector>        getArrayElements(MArrayDataHandle& arrayHandle, MVector (*getElement)(MDataHandle&),        unsigned size, MVector fillValue);
 
 template<class T>
-MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<T> &values, MStatus (*setElement)(MDataHandle&, T))
+MStatus setArrayElements(MArrayDataHandle& arrayHandle, ArrayView<T> values, MStatus (*setElement)(MDataHandle&, T))
 { 
     MStatus status;
     MArrayDataBuilder outputArray = arrayHandle.builder(&status);
@@ -177,6 +688,8 @@ MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<T> &values,
 
     unsigned numberOfValues = (unsigned) values.size();
 
+    profileOutputElements(numberOfValues);
+
     for (unsigned i = 0; i < numberOfValues; i++)
     {
         MDataHandle outputHandle = outputArray.addElement(i, &status);
@@ -195,8 +708,17 @@ MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<T> &values,
     return status;
 }
 
-template MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<MAngle> &values,         MStatus (*setElement)(MDataHandle&, MAngle));
-template MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<MEulerRotation> &values, MStatus (*setElement)(MDataHandle&, MEulerRotation));
-template MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<MMatrix> &values ,       MStatus (*setElement)(MDataHandle&, MMatrix));
-template MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<MQuaternion> &values,    MStatus (*setElement)(MDataHandle&, MQuaternion));
-template MStatus setArrayElements(MArrayDataHandle& arrayHandle, std::vector<MVector> &values,        MStatus (*setElement)(MDataHandle&, MVector));
+template MStatus setArrayElements(MArrayDataHandle& arrayHandle, ArrayView<MMatrix> values, MStatus (*setElement)(MDataHandle&, MMatrix));
+template MStatus setArrayElements(MArrayDataHandle& arrayHandle, ArrayView<MVector> values, MStatus (*setElement)(MDataHandle&, MVector));
+
+template<class T>
+MStatus setArrayElements(MArrayDataHandle& arrayHandle, const std::vector<T> &values, MStatus (*setElement)(MDataHandle&, T))
+{
+    return setArrayElements(arrayHandle, ArrayView<T>(values), setElement);
+}
+
+template MStatus setArrayElements(MArrayDataHandle& arrayHandle, const std::vector<MAngle> &values,         MStatus (*setElement)(MDataHandle&, MAngle));
+template MStatus setArrayElements(MArrayDataHandle& arrayHandle, const std::vector<MEulerRotation> &values, MStatus (*setElement)(MDataHandle&, MEulerRotation));
+template MStatus setArrayElements(MArrayDataHandle& arrayHandle, const std::vector<MMatrix> &values ,       MStatus (*setElement)(MDataHandle&, MMatrix));
+template MStatus setArrayElements(MArrayDataHandle& arrayHandle, const std::vector<MQuaternion> &values,    MStatus (*setElement)(MDataHandle&, MQuaternion));
+template MStatus setArrayElements(MArrayDataHandle& arrayHandle, const std::vector<MVector> &values,        MStatus (*setElement)(MDataHandle&, MVector));
@@ -16,13 +16,21 @@ This node converts euler rotations to quaternion rotations.
     outputQuat (oq) quatArray
         Array of quaternion rotations.
 
+    If the input records which of its rotations changed since the last 
+    compute, only those are converted.
+
 */
 
+#include "../../core/dirtyRange.h"
+#include "../../core/eulerKernels.h"
 #include "../../data/eulerArrayData.h"
 #include "../../data/quatArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "eulerToQuatArrayNode.h"
 
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -49,6 +57,12 @@ void* EulerToQuatArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType EulerToQuatArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus EulerToQuatArrayNode::initialize()
 {
     MStatus status;
@@ -92,18 +106,46 @@ MStatus EulerToQuatArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputRotateAttr);
-    std::vector<MEulerRotation> input = getUserArray<MEulerRotation, EulerArrayData>(inputHandle);
+    const std::vector<MEulerRotation> &input = getUserArray<MEulerRotation, EulerArrayData>(inputHandle);
 
-    std::vector<MQuaternion> output(input.size());
+    ContentHash inputHash;
 
-    for (size_t i = 0; i < input.size(); i++)
+    if (useComputeCache(data))
     {
-        output[i] = input[i].asQuaternion();
+        hashInput(inputHash, input);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
+    // The ids and cached values below are shared by every compute of this node.
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+
+    DirtyRange changes = getUserArrayChanges<EulerArrayData>(inputHandle, this->inputId);
+
     MDataHandle outputHandle = data.outputValue(outputQuatAttr);
-    setUserArray<MQuaternion, QuatArrayData>(outputHandle, output);
+
+    std::vector<MQuaternion> output;
+    PreviousOutput<MQuaternion> previous;
+    changes = getUserArrayOutput<MQuaternion, QuatArrayData>(outputHandle, this->outputId, changes, input.size(), output, previous);
+
+    eulerArrayToQuat(
+        coreView(ArrayView<MEulerRotation>(input)).data() + changes.begin, 
+        changes.size(), 
+        coreArray(output.data()) + changes.begin
+    );
+
+    setUserArray<MQuaternion, QuatArrayData>(outputHandle, std::move(output), changes, previous);
+
+    this->inputId = getUserArrayId<EulerArrayData>(inputHandle);
+    this->outputId = getUserArrayId<QuatArrayData>(outputHandle);
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
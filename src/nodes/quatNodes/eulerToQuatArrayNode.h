@@ -5,6 +5,12 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+
+#include <stdint.h>
+
+#include <mutex>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,6 +21,7 @@ class EulerToQuatArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
@@ -26,4 +33,11 @@ public:
     static MObject          inputRotateOrderAttr;
 
     static MObject          outputQuatAttr;
+
+private:
+    uint64_t                inputId = 0;
+    uint64_t                outputId = 0;
+    std::mutex              stateMutex;
+
+    ComputeCache            computeCache;
 };
\ No newline at end of file
@@ -67,11 +67,15 @@ This node packs quaternion rotation components into an array.
 */
 
 #include "packQuatArrayNode.h"
+#include "../../core/parallel.h"
+#include "../../core/packKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "../../data/angleArrayData.h"
 #include "../../data/quatArrayData.h"
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 #include <maya/MAngle.h>
@@ -132,6 +136,12 @@ void* PackQuatArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType PackQuatArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus PackQuatArrayNode::initialize()
 {
     MStatus status;
@@ -235,6 +245,8 @@ MStatus PackQuatArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short inputMethod = data.inputValue(inputMethodAttr).asShort();
     size_t size = (size_t) data.inputValue(sizeAttr).asInt();
 
@@ -267,7 +279,7 @@ MStatus PackQuatArrayNode::compute(const MPlug& plug, MDataBlock& data)
 
     MDataHandle outputHandle = data.outputValue(outputQuatAttr);
 
-    setUserArray<MQuaternion, QuatArrayData>(outputHandle, output);
+    setUserArray<MQuaternion, QuatArrayData>(outputHandle, std::move(output));
 
     return MStatus::kSuccess;   
 }
@@ -293,29 +305,14 @@ MStatus PackQuatArrayNode::fromComponents(MDataBlock& data, size_t size, MQuater
     MDataHandle inputZHandle = data.inputValue(inputZAttr);        
     MDataHandle inputWHandle = data.inputValue(inputWAttr);        
 
-    std::vector<double> inputX = getMayaArray<double, MFnDoubleArrayData>(inputXHandle);
-    std::vector<double> inputY = getMayaArray<double, MFnDoubleArrayData>(inputYHandle);
-    std::vector<double> inputZ = getMayaArray<double, MFnDoubleArrayData>(inputZHandle);
-    std::vector<double> inputW = getMayaArray<double, MFnDoubleArrayData>(inputWHandle);
-
-    size_t numberOfInputs = 0;
-    numberOfInputs = std::max(numberOfInputs, inputX.size());
-    numberOfInputs = std::max(numberOfInputs, inputY.size());
-    numberOfInputs = std::max(numberOfInputs, inputZ.size());
-    numberOfInputs = std::max(numberOfInputs, inputW.size());
-
-    inputX.resize(numberOfInputs, fillValue.x);
-    inputY.resize(numberOfInputs, fillValue.y);
-    inputZ.resize(numberOfInputs, fillValue.z);
-    inputW.resize(numberOfInputs, fillValue.w);
-    output.resize(size, fillValue);
+    ArrayView<double> inputX = getMayaArrayView<double, MFnDoubleArrayData>(inputXHandle);
+    ArrayView<double> inputY = getMayaArrayView<double, MFnDoubleArrayData>(inputYHandle);
+    ArrayView<double> inputZ = getMayaArrayView<double, MFnDoubleArrayData>(inputZHandle);
+    ArrayView<double> inputW = getMayaArrayView<double, MFnDoubleArrayData>(inputWHandle);
 
-    size_t numberOfOutputs = std::min(size, numberOfInputs);
+    output.resize(size);
 
-    for (size_t i = 0; i < numberOfOutputs; i++)
-    {
-        output[i] = MQuaternion(inputX[i], inputY[i], inputZ[i], inputW[i]);
-    }   
+    packQuatArray(inputX, inputY, inputZ, inputW, coreValue(fillValue), coreArray(output.data()), size);
 
     return MStatus::kSuccess;
 }
@@ -339,10 +336,10 @@ MStatus PackQuatArrayNode::fromAxisAngle(MDataBlock& data, size_t size, MQuatern
 
     size_t numberOfOutputs = std::min(size, numberOfInputs);
 
-    for (size_t i = 0; i < numberOfOutputs; i++)
+    parallelFor(0, numberOfOutputs, [&](size_t i)
     {
         output[i] = MQuaternion(inputAngle[i].asRadians(), inputAxis[i]);
-    }   
+    });
 
     return MStatus::kSuccess;
 }
@@ -365,10 +362,10 @@ MStatus PackQuatArrayNode::fromVectors(MDataBlock& data, size_t size, MQuaternio
     inputVector2.resize(numberOfInputs);
     output.resize(size, fillValue);
 
-    for (size_t i = 0; i < numberOfOutputs; i++)
+    parallelFor(0, numberOfOutputs, [&](size_t i)
     {
         output[i] = MQuaternion(inputVector1[i], inputVector2[i]);
-    }  
+    });
 
     return MStatus::kSuccess;
 }
@@ -21,16 +21,36 @@ This node performs a binary operation on pairs of quaternions.
         Subtract     (3) calculates the difference between pairs of quaternions.
         Product      (4) calculates the product of pairs of quaternions.
 
+    precision (prc) enum
+        Specifies the precision of the computation.
+
+        Double (0) computes with 64-bit floats.
+        Single (1) computes with 32-bit floats, which is faster on large 
+                   arrays but keeps only about seven significant digits.
+
     outputQuat (oq) quatArray
         Results of the binary operations.
 
+    If one input holds a single quaternion, it is used with every quaternion
+    of the other input. Otherwise the shorter input is padded with identity
+    quaternions.
+
+    When the inputs record which of their elements changed since the last 
+    compute, and operation and precision are unchanged, only those elements
+    are recomputed.
+
 */
 
+#include "../../core/quatKernels.h"
+#include "../../core/quatLanes.h"
 #include "../../data/quatArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "quatArrayBinaryOpNode.h"
 
 #include <algorithm>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -45,9 +65,13 @@ const short ADD      = 1;
 const short SUBTRACT = 2;
 const short PRODUCT  = 3;
 
+const short DOUBLE_PRECISION = 0;
+const short SINGLE_PRECISION = 1;
+
 MObject QuatArrayBinaryOpNode::inputQuat1Attr;
 MObject QuatArrayBinaryOpNode::inputQuat2Attr;
 MObject QuatArrayBinaryOpNode::operationAttr;
+MObject QuatArrayBinaryOpNode::precisionAttr;
 
 MObject QuatArrayBinaryOpNode::outputQuatAttr;
 
@@ -58,6 +82,12 @@ void* QuatArrayBinaryOpNode::creator()
 }
 
 
+MPxNode::SchedulingType QuatArrayBinaryOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus QuatArrayBinaryOpNode::initialize()
 {
     MStatus status;
@@ -76,9 +106,15 @@ MStatus QuatArrayBinaryOpNode::initialize()
     E.addField("Subtract", SUBTRACT);
     E.addField("Product", PRODUCT);
 
+    precisionAttr = E.create("precision", "prc", DOUBLE_PRECISION, &status);
+    E.setChannelBox(true);
+    E.addField("Double", DOUBLE_PRECISION);
+    E.addField("Single", SINGLE_PRECISION);
+
     addAttribute(inputQuat1Attr);
     addAttribute(inputQuat2Attr);
     addAttribute(operationAttr);
+    addAttribute(precisionAttr);
 
     outputQuatAttr = T.create("outputQuat", "oq", QuatArrayData::TYPE_ID, MObject::kNullObj, &status);
     T.setStorable(false);
@@ -88,6 +124,7 @@ MStatus QuatArrayBinaryOpNode::initialize()
     attributeAffects(inputQuat1Attr, outputQuatAttr);
     attributeAffects(inputQuat2Attr, outputQuatAttr);
     attributeAffects(operationAttr, outputQuatAttr);
+    attributeAffects(precisionAttr, outputQuatAttr);
 
     return MStatus::kSuccess;
 }
@@ -95,48 +132,111 @@ MStatus QuatArrayBinaryOpNode::initialize()
 
 MStatus QuatArrayBinaryOpNode::compute(const MPlug& plug, MDataBlock& data)
 {
-    MStatus status;
-    
     if (plug != outputQuatAttr)
     {
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
+    short precision = data.inputValue(precisionAttr).asShort();
+
+    if (precision == SINGLE_PRECISION)
+    {
+        return this->computeLanes<float>(plug, data);
+    }
+
+    return this->computeLanes<double>(plug, data);
+}
+
+
+template <typename REAL>
+MStatus QuatArrayBinaryOpNode::computeLanes(const MPlug& plug, MDataBlock& data)
+{
     MDataHandle input1Handle = data.inputValue(inputQuat1Attr);
     MDataHandle input2Handle = data.inputValue(inputQuat2Attr);
     short operation = data.inputValue(operationAttr).asShort();
 
-    std::vector<MQuaternion> input1 = getUserArray<MQuaternion, QuatArrayData>(input1Handle);
-    std::vector<MQuaternion> input2 = getUserArray<MQuaternion, QuatArrayData>(input2Handle);
+    const BasicQuatLanes<REAL> &input1 = getBasicQuatLanes<REAL>(input1Handle);
+    const BasicQuatLanes<REAL> &input2 = getBasicQuatLanes<REAL>(input2Handle);
 
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
+    {
+        hashInput(inputHash, input1);
+        hashInput(inputHash, input2);
+        inputHash.updateValue(operation);
+        inputHash.updateValue((uint32_t) sizeof(REAL));
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
+    }
+
+    // The ids below are shared by every compute of this node.
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+
+    short precision = (short) (sizeof(REAL) == sizeof(float) ? SINGLE_PRECISION : DOUBLE_PRECISION);
     size_t numberOfValues = std::max(input1.size(), input2.size());
 
-    input1.resize(numberOfValues);
-    input2.resize(numberOfValues);
+    DirtyRange changes1 = getUserArrayChanges<QuatArrayData>(input1Handle, this->inputId1);
+    DirtyRange changes2 = getUserArrayChanges<QuatArrayData>(input2Handle, this->inputId2);
 
-    std::vector<MQuaternion> output(numberOfValues);
+    // A single quaternion is used with every element.
+    if (input1.size() == 1 && !changes1.empty()) { changes1 = DirtyRange::all(); }
+    if (input2.size() == 1 && !changes2.empty()) { changes2 = DirtyRange::all(); }
 
-    MQuaternion (*F)(MQuaternion, MQuaternion) = &QuatArrayBinaryOpNode::quatNop;
+    DirtyRange changes = changes1.merge(changes2);
 
-    switch (operation)
+    if (operation != this->outputOperation || precision != this->outputPrecision)
     {
-        case ADD:      F = &QuatArrayBinaryOpNode::quatAdd; break;
-        case SUBTRACT: F = &QuatArrayBinaryOpNode::quatSub; break;
-        case PRODUCT:  F = &QuatArrayBinaryOpNode::quatProd; break;
+        changes = DirtyRange::all();
     }
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    MDataHandle outputHandle = data.outputValue(outputQuatAttr);
+
+    BasicQuatLanes<REAL> output;
+    changes = getQuatLanesOutput(outputHandle, this->outputId, changes, numberOfValues, output);
+
+    void (*F)(const BasicQuatLanes<REAL>&, const BasicQuatLanes<REAL>&, BasicQuatLanes<REAL>&, const DirtyRange&) = &QuatArrayBinaryOpNode::quatNop<REAL>;
+
+    switch (operation)
     {
-        output[i] = F(input1[i], input2[i]);
+        case ADD:      F = &quatArrayAdd;      break;
+        case SUBTRACT: F = &quatArraySubtract; break;
+        case PRODUCT:  F = &quatArrayProduct;  break;
     }
 
-    MDataHandle outputHandle = data.outputValue(outputQuatAttr);
-    setUserArray<MQuaternion, QuatArrayData>(outputHandle, output);
+    F(input1, input2, output, changes);
+
+    setQuatLanes(outputHandle, std::move(output), changes);
+
+    this->inputId1 = getUserArrayId<QuatArrayData>(input1Handle);
+    this->inputId2 = getUserArrayId<QuatArrayData>(input2Handle);
+    this->outputId = getUserArrayId<QuatArrayData>(outputHandle);
+    this->outputOperation = operation;
+    this->outputPrecision = precision;
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
 
-MQuaternion QuatArrayBinaryOpNode::quatAdd(MQuaternion q1, MQuaternion q2)  { return q1 + q2; }
-MQuaternion QuatArrayBinaryOpNode::quatSub(MQuaternion q1, MQuaternion q2)  { return q1 - q2; }
-MQuaternion QuatArrayBinaryOpNode::quatProd(MQuaternion q1, MQuaternion q2) { return q1 * q2; }
-MQuaternion QuatArrayBinaryOpNode::quatNop(MQuaternion q1, MQuaternion q2)  { return MQuaternion(q1); }
\ No newline at end of file
+template <typename REAL>
+void QuatArrayBinaryOpNode::quatNop(const BasicQuatLanes<REAL> &q1, const BasicQuatLanes<REAL> &q2, BasicQuatLanes<REAL> &out, const DirtyRange &changed)
+{
+    DirtyRange range = changed.clamp(std::max(q1.size(), q2.size()));
+
+    // Elements past the end of q1 are the identity, as in resize().
+    for (size_t i = range.begin; i < range.end; i++)
+    {
+        bool isPadding = i >= q1.size();
+
+        out.x[i] = isPadding ? REAL(0) : q1.x[i];
+        out.y[i] = isPadding ? REAL(0) : q1.y[i];
+        out.z[i] = isPadding ? REAL(0) : q1.z[i];
+        out.w[i] = isPadding ? REAL(1) : q1.w[i];
+    }
+}
\ No newline at end of file
@@ -5,6 +5,14 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+#include "../../core/dirtyRange.h"
+#include "../../core/quatLanes.h"
+
+#include <stdint.h>
+
+#include <mutex>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -16,14 +24,16 @@ class QuatArrayBinaryOpNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
 private:
-    static inline MQuaternion quatNop(MQuaternion q1,  MQuaternion q2);
-    static inline MQuaternion quatAdd(MQuaternion q1,  MQuaternion q2);
-    static inline MQuaternion quatSub(MQuaternion q1,  MQuaternion q2);
-    static inline MQuaternion quatProd(MQuaternion q1, MQuaternion q2);
+    template <typename REAL>
+    MStatus                 computeLanes(const MPlug& plug, MDataBlock& data);
+
+    template <typename REAL>
+    static void             quatNop(const BasicQuatLanes<REAL> &q1, const BasicQuatLanes<REAL> &q2, BasicQuatLanes<REAL> &out, const DirtyRange &changed);
 
 public:
     static MTypeId          NODE_ID;
@@ -32,6 +42,17 @@ public:
     static MObject          inputQuat1Attr;
     static MObject          inputQuat2Attr;
     static MObject          operationAttr;
+    static MObject          precisionAttr;
 
     static MObject          outputQuatAttr;
+
+private:
+    uint64_t                inputId1 = 0;
+    uint64_t                inputId2 = 0;
+    uint64_t                outputId = 0;
+    short                   outputOperation = -1;
+    short                   outputPrecision = -1;
+    std::mutex              stateMutex;
+
+    ComputeCache            computeCache;
 };
\ No newline at end of file
@@ -19,15 +19,32 @@ This node performs unary operations on quaternions.
         Negate       (3) calculates the negative of each input.
         Normalize    (4) calculates the normal of each input.
 
+    precision (prc) enum
+        Specifies the precision of the computation.
+
+        Double (0) computes with 64-bit floats.
+        Single (1) computes with 32-bit floats, which is faster on large 
+                   arrays but keeps only about seven significant digits.
+
     outputQuat (oq)
         Results of the unary operations.
 
+    When the input records which of its elements changed since the last 
+    compute, and operation and precision are unchanged, only those elements
+    are recomputed.
+
 */
 
+#include "../../core/quatKernels.h"
+#include "../../core/quatLanes.h"
 #include "../../data/quatArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "quatArrayUnaryOpNode.h"
 
+#include <algorithm>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -45,8 +62,12 @@ const short INVERSE   = 2;
 const short NEGATE    = 3;
 const short NORMALIZE = 4;
 
+const short DOUBLE_PRECISION = 0;
+const short SINGLE_PRECISION = 1;
+
 MObject QuatArrayUnaryOpNode::inputQuatAttr;
 MObject QuatArrayUnaryOpNode::operationAttr;
+MObject QuatArrayUnaryOpNode::precisionAttr;
 
 MObject QuatArrayUnaryOpNode::outputQuatAttr;
 
@@ -57,6 +78,12 @@ void* QuatArrayUnaryOpNode::creator()
 }
 
 
+MPxNode::SchedulingType QuatArrayUnaryOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus QuatArrayUnaryOpNode::initialize()
 {
     MStatus status;
@@ -75,8 +102,14 @@ MStatus QuatArrayUnaryOpNode::initialize()
     E.addField("Negate",       NEGATE);
     E.addField("Normalize",    NORMALIZE);
 
+    precisionAttr = E.create("precision", "prc", DOUBLE_PRECISION, &status);
+    E.setChannelBox(true);
+    E.addField("Double", DOUBLE_PRECISION);
+    E.addField("Single", SINGLE_PRECISION);
+
     addAttribute(inputQuatAttr);
     addAttribute(operationAttr);
+    addAttribute(precisionAttr);
 
     outputQuatAttr = T.create("outputQuat", "oq", QuatArrayData::TYPE_ID, MObject::kNullObj, &status);
     T.setStorable(false);
@@ -85,6 +118,7 @@ MStatus QuatArrayUnaryOpNode::initialize()
 
     attributeAffects(inputQuatAttr, outputQuatAttr);
     attributeAffects(operationAttr, outputQuatAttr);
+    attributeAffects(precisionAttr, outputQuatAttr);
 
     return MStatus::kSuccess;
 }
@@ -92,41 +126,93 @@ MStatus QuatArrayUnaryOpNode::initialize()
 
 MStatus QuatArrayUnaryOpNode::compute(const MPlug& plug, MDataBlock& data)
 {
-    MStatus status;
-    
     if (plug != outputQuatAttr)
     {
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
+    short precision = data.inputValue(precisionAttr).asShort();
+
+    if (precision == SINGLE_PRECISION)
+    {
+        return this->computeLanes<float>(plug, data);
+    }
+
+    return this->computeLanes<double>(plug, data);
+}
+
+
+template <typename REAL>
+MStatus QuatArrayUnaryOpNode::computeLanes(const MPlug& plug, MDataBlock& data)
+{
     MDataHandle inputHandle = data.inputValue(inputQuatAttr);
     short operation = data.inputValue(operationAttr).asShort();
 
-    std::vector<MQuaternion> values = getUserArray<MQuaternion, QuatArrayData>(inputHandle);
-
-    void (*F)(MQuaternion&) = &QuatArrayUnaryOpNode::quatNop;
+    const BasicQuatLanes<REAL> &input = getBasicQuatLanes<REAL>(inputHandle);
+    ContentHash inputHash;
 
-    switch (operation)
+    if (useComputeCache(data))
     {
-        case CONJUGATE: F = &QuatArrayUnaryOpNode::quatConjugate; break;
-        case INVERSE:   F = &QuatArrayUnaryOpNode::quatInverse;   break;
-        case NEGATE:    F = &QuatArrayUnaryOpNode::quatNegate;    break;
-        case NORMALIZE: F = &QuatArrayUnaryOpNode::quatNormalize; break;
+        hashInput(inputHash, input);
+        inputHash.updateValue(operation);
+        inputHash.updateValue((uint32_t) sizeof(REAL));
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
-    for (size_t i = 0; i < values.size(); i++)
+    // The ids below are shared by every compute of this node.
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+
+    short precision = (short) (sizeof(REAL) == sizeof(float) ? SINGLE_PRECISION : DOUBLE_PRECISION);
+
+    DirtyRange changes = getUserArrayChanges<QuatArrayData>(inputHandle, this->inputId);
+
+    if (operation != this->outputOperation || precision != this->outputPrecision)
     {
-        F(values[i]);
+        changes = DirtyRange::all();
     }
 
     MDataHandle outputHandle = data.outputValue(outputQuatAttr);
-    setUserArray<MQuaternion, QuatArrayData>(outputHandle, values);
+
+    BasicQuatLanes<REAL> output;
+    changes = getQuatLanesOutput(outputHandle, this->outputId, changes, input.size(), output);
+
+    void (*F)(const BasicQuatLanes<REAL>&, BasicQuatLanes<REAL>&, const DirtyRange&) = &QuatArrayUnaryOpNode::quatNop<REAL>;
+
+    switch (operation)
+    {
+        case CONJUGATE: F = &quatArrayConjugate; break;
+        case INVERSE:   F = &quatArrayInverse;   break;
+        case NEGATE:    F = &quatArrayNegate;    break;
+        case NORMALIZE: F = &quatArrayNormalize; break;
+    }
+
+    F(input, output, changes);
+
+    setQuatLanes(outputHandle, std::move(output), changes);
+
+    this->inputId = getUserArrayId<QuatArrayData>(inputHandle);
+    this->outputId = getUserArrayId<QuatArrayData>(outputHandle);
+    this->outputOperation = operation;
+    this->outputPrecision = precision;
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;  
 }
 
-void QuatArrayUnaryOpNode::quatNop(MQuaternion &q)       {}
-void QuatArrayUnaryOpNode::quatConjugate(MQuaternion &q) {q.conjugateIt(); }
-void QuatArrayUnaryOpNode::quatInverse(MQuaternion &q)   {q.invertIt(); }
-void QuatArrayUnaryOpNode::quatNegate(MQuaternion &q)    {q.negateIt(); }
-void QuatArrayUnaryOpNode::quatNormalize(MQuaternion &q) {q.normalizeIt(); }
\ No newline at end of file
+template <typename REAL>
+void QuatArrayUnaryOpNode::quatNop(const BasicQuatLanes<REAL> &q, BasicQuatLanes<REAL> &out, const DirtyRange &changed) 
+{
+    DirtyRange range = changed.clamp(q.size());
+
+    std::copy(q.x.begin() + range.begin, q.x.begin() + range.end, out.x.begin() + range.begin);
+    std::copy(q.y.begin() + range.begin, q.y.begin() + range.end, out.y.begin() + range.begin);
+    std::copy(q.z.begin() + range.begin, q.z.begin() + range.end, out.z.begin() + range.begin);
+    std::copy(q.w.begin() + range.begin, q.w.begin() + range.end, out.w.begin() + range.begin);
+}
\ No newline at end of file
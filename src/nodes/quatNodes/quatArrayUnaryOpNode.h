@@ -5,6 +5,14 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+#include "../../core/dirtyRange.h"
+#include "../../core/quatLanes.h"
+
+#include <stdint.h>
+
+#include <mutex>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -16,15 +24,16 @@ class QuatArrayUnaryOpNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
 private:
-    static inline void      quatNop(MQuaternion &q);
-    static inline void      quatConjugate(MQuaternion &q);
-    static inline void      quatInverse(MQuaternion &q);
-    static inline void      quatNegate(MQuaternion &q);
-    static inline void      quatNormalize(MQuaternion &q);
+    template <typename REAL>
+    MStatus                 computeLanes(const MPlug& plug, MDataBlock& data);
+
+    template <typename REAL>
+    static void             quatNop(const BasicQuatLanes<REAL> &q, BasicQuatLanes<REAL> &out, const DirtyRange &changed);
 
 public:
     static MTypeId          NODE_ID;
@@ -32,6 +41,16 @@ public:
 
     static MObject          inputQuatAttr;
     static MObject          operationAttr;
+    static MObject          precisionAttr;
 
     static MObject          outputQuatAttr;
+
+private:
+    uint64_t                inputId = 0;
+    uint64_t                outputId = 0;
+    short                   outputOperation = -1;
+    short                   outputPrecision = -1;
+    std::mutex              stateMutex;
+
+    ComputeCache            computeCache;
 };
\ No newline at end of file
@@ -13,19 +13,42 @@ This node converts quaternion rotations to euler rotations.
     inputRotateOrder (iro) enum
         Rotation order of the euler rotations.
 
+    conversion (cnv) enum
+        Specifies how the angles are found. Both give the same rotations,
+        but may choose different angles for them.
+
+        Maya      (0) converts to XYZ angles with asEulerRotation(), then
+                      reorders them with reorderIt(), as earlier versions
+                      of this node did.
+        Per Order (1) computes the angles in the output order directly, 
+                      which is faster. The middle angle is in [-pi/2, pi/2]
+                      and the others in [-pi, pi]; at the poles, the last
+                      angle is 0.
+
     outputRotate (or) eulerArray
         Array of euler rotations.
 
+    If the input records which of its rotations changed since the last 
+    compute, and the rotation order and conversion are unchanged, only 
+    those are converted.
+
 */
 
+#include "../../core/dirtyRange.h"
+#include "../../core/eulerKernels.h"
+#include "../../core/parallel.h"
 #include "../../data/eulerArrayData.h"
 #include "../../data/quatArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "quatToEulerArrayNode.h"
 
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <maya/MDataBlock.h>
+#include <maya/MEulerRotation.h>
 #include <maya/MFnEnumAttribute.h>
 #include <maya/MFnTypedAttribute.h>
 #include <maya/MPlug.h>
@@ -36,16 +59,27 @@ This node converts quaternion rotations to euler rotations.
 
 MObject QuatToEulerArrayNode::inputQuatAttr;
 MObject QuatToEulerArrayNode::inputRotateOrderAttr;
+MObject QuatToEulerArrayNode::conversionAttr;
 
 MObject QuatToEulerArrayNode::outputRotateAttr;
 
 
+const short MAYA_CONVERSION      = 0;
+const short PER_ORDER_CONVERSION = 1;
+
+
 void* QuatToEulerArrayNode::creator()
 {
     return new QuatToEulerArrayNode();
 }
 
 
+MPxNode::SchedulingType QuatToEulerArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus QuatToEulerArrayNode::initialize()
 {
     MStatus status;
@@ -65,8 +99,14 @@ MStatus QuatToEulerArrayNode::initialize()
     E.addField("yxz", 4);
     E.addField("zyx", 5);
 
+    conversionAttr = E.create("conversion", "cnv", MAYA_CONVERSION, &status);
+    E.setChannelBox(true);
+    E.addField("Maya",      MAYA_CONVERSION);
+    E.addField("Per Order", PER_ORDER_CONVERSION);
+
     addAttribute(inputQuatAttr);
     addAttribute(inputRotateOrderAttr);
+    addAttribute(conversionAttr);
 
     outputRotateAttr = T.create("outputRotate", "or", EulerArrayData::TYPE_ID, MObject::kNullObj, &status);
     T.setStorable(false);
@@ -75,6 +115,7 @@ MStatus QuatToEulerArrayNode::initialize()
 
     attributeAffects(inputQuatAttr, outputRotateAttr);
     attributeAffects(inputRotateOrderAttr, outputRotateAttr);
+    attributeAffects(conversionAttr, outputRotateAttr);
 
     return MStatus::kSuccess;
 }
@@ -89,22 +130,70 @@ MStatus QuatToEulerArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputQuatAttr);
-    std::vector<MQuaternion> input = getUserArray<MQuaternion, QuatArrayData>(inputHandle);
+    const std::vector<MQuaternion> &input = getUserArray<MQuaternion, QuatArrayData>(inputHandle);
 
     short rotateOrderIndex = data.inputValue(inputRotateOrderAttr).asShort();
-    MEulerRotation::RotationOrder rotateOrder = (MEulerRotation::RotationOrder) rotateOrderIndex;
+    short conversion = data.inputValue(conversionAttr).asShort();
 
-    std::vector<MEulerRotation> output(input.size());
+    ContentHash inputHash;
 
-    for (size_t i = 0; i < input.size(); i++)
+    if (useComputeCache(data))
     {
-        output[i] = input[i].asEulerRotation();
-        output[i].reorderIt(rotateOrder);
+        hashInput(inputHash, input);
+        inputHash.updateValue(rotateOrderIndex);
+        inputHash.updateValue(conversion);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
+    }
+
+    // The ids and cached values below are shared by every compute of this node.
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+
+    DirtyRange changes = DirtyRange::all();
+
+    if (rotateOrderIndex == this->outputRotateOrder && conversion == this->outputConversion)
+    {
+        changes = getUserArrayChanges<QuatArrayData>(inputHandle, this->inputId);
     }
 
     MDataHandle outputHandle = data.outputValue(outputRotateAttr);
-    setUserArray<MEulerRotation, EulerArrayData>(outputHandle, output);
+
+    std::vector<MEulerRotation> output;
+    PreviousOutput<MEulerRotation> previous;
+    changes = getUserArrayOutput<MEulerRotation, EulerArrayData>(outputHandle, this->outputId, changes, input.size(), output, previous);
+
+    if (conversion == PER_ORDER_CONVERSION)
+    {
+        quatArrayToEuler(
+            coreView(ArrayView<MQuaternion>(input)).data() + changes.begin, 
+            changes.size(), 
+            rotateOrderIndex, 
+            coreArray(output.data()) + changes.begin
+        );
+    } else {
+        MEulerRotation::RotationOrder rotateOrder = (MEulerRotation::RotationOrder) rotateOrderIndex;
+
+        parallelFor(changes.begin, changes.end, [&](size_t i)
+        {
+            output[i] = input[i].asEulerRotation();
+            output[i].reorderIt(rotateOrder);
+        });
+    }
+
+    setUserArray<MEulerRotation, EulerArrayData>(outputHandle, std::move(output), changes, previous);
+
+    this->inputId = getUserArrayId<QuatArrayData>(inputHandle);
+    this->outputId = getUserArrayId<EulerArrayData>(outputHandle);
+    this->outputRotateOrder = rotateOrderIndex;
+    this->outputConversion = conversion;
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
@@ -22,13 +22,29 @@ This node computes the slerp (Spherical linear interpolation) of pairs of quater
     outputQuat (oq)  quatArray
         Array of iterpolated quaternions.
 
+    If one input holds a single quaternion, it is used with every quaternion
+    of the other input. Otherwise the shorter input is padded with identity
+    quaternions.
+
+    The part of each slerp that does not depend on tween is kept between 
+    computes, for as long as the inputs hold the same data and spin is 
+    unchanged, so scrubbing tween only recomputes the weighted sums. When 
+    the inputs record which of their elements changed, only those pairs 
+    are recomputed.
+
 */
 
+#include "../../core/dirtyRange.h"
+#include "../../core/quatSlerp.h"
+#include "../../core/xformTypes.h"
 #include "../../data/quatArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "slerpQuatArrayNode.h"
 
 #include <algorithm>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -55,6 +71,12 @@ void* SlerpQuatArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType SlerpQuatArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus SlerpQuatArrayNode::initialize()
 {
     MStatus status;
@@ -100,6 +122,8 @@ MStatus SlerpQuatArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle input1Handle = data.inputValue(inputQuat1Attr);
     MDataHandle input2Handle = data.inputValue(inputQuat2Attr);
     
@@ -108,23 +132,87 @@ MStatus SlerpQuatArrayNode::compute(const MPlug& plug, MDataBlock& data)
 
     if (spin == 0) { spin = 1; }
     
-    std::vector<MQuaternion> input1 = getUserArray<MQuaternion, QuatArrayData>(input1Handle);
-    std::vector<MQuaternion> input2 = getUserArray<MQuaternion, QuatArrayData>(input2Handle);
+    const std::vector<MQuaternion> &values1 = getUserArray<MQuaternion, QuatArrayData>(input1Handle);
+    const std::vector<MQuaternion> &values2 = getUserArray<MQuaternion, QuatArrayData>(input2Handle);
+
+    size_t numberOfValues = std::max(values1.size(), values2.size());
+
+    BroadcastView<Quaternion> input1(coreView(values1), coreValue(MQuaternion::identity));
+    BroadcastView<Quaternion> input2(coreView(values2), coreValue(MQuaternion::identity));
+
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
+    {
+        hashInput(inputHash, values1);
+        hashInput(inputHash, values2);
+        inputHash.updateValue(tween);
+        inputHash.updateValue(spin);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
+    }
+
+    // The ids and cached values below are shared by every compute of this node.
+    std::lock_guard<std::mutex> lock(this->stateMutex);
 
-    size_t numberOfValues = std::max(input1.size(), input2.size());
+    DirtyRange changes1 = getUserArrayChanges<QuatArrayData>(input1Handle, this->pairsId1);
+    DirtyRange changes2 = getUserArrayChanges<QuatArrayData>(input2Handle, this->pairsId2);
 
-    input1.resize(numberOfValues);
-    input2.resize(numberOfValues);
+    // A single quaternion is used with every pair.
+    if (values1.size() == 1 && !changes1.empty()) { changes1 = DirtyRange::all(); }
+    if (values2.size() == 1 && !changes2.empty()) { changes2 = DirtyRange::all(); }
 
-    std::vector<MQuaternion> output(numberOfValues);
+    DirtyRange pairChanges = changes1.merge(changes2);
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    if (spin != this->pairsSpin || numberOfValues != this->pairs.size())
     {
-        output[i] = slerp(input1[i], input2[i], tween, spin);
+        pairChanges = DirtyRange::all();
     }
 
+    pairChanges = pairChanges.clamp(numberOfValues);
+
+    if (!pairChanges.empty())
+    {
+        size_t first = pairChanges.begin;
+
+        profileAllocation(numberOfValues * sizeof(QuatSlerpPair));
+
+        this->pairs.resize(numberOfValues);
+        quatArraySlerpPrepare(input1.from(first), input2.from(first), spin, this->pairs.data() + first, pairChanges.size());
+    }
+
+    this->pairsId1 = getUserArrayId<QuatArrayData>(input1Handle);
+    this->pairsId2 = getUserArrayId<QuatArrayData>(input2Handle);
+    this->pairsSpin = spin;
+
+    DirtyRange outputChanges = tween == this->outputTween ? pairChanges : DirtyRange::all();
+
     MDataHandle outputHandle = data.outputValue(outputQuatAttr);
-    setUserArray<MQuaternion, QuatArrayData>(outputHandle, output);
+
+    std::vector<MQuaternion> output;
+    PreviousOutput<MQuaternion> previous;
+    outputChanges = getUserArrayOutput<MQuaternion, QuatArrayData>(outputHandle, this->outputId, outputChanges, numberOfValues, output, previous);
+
+    size_t first = outputChanges.begin;
+
+    quatArraySlerpPrepared(
+        input1.from(first), 
+        input2.from(first), 
+        this->pairs.data() + first, 
+        tween, 
+        coreArray(output.data()) + first, 
+        outputChanges.size()
+    );
+
+    setUserArray<MQuaternion, QuatArrayData>(outputHandle, std::move(output), outputChanges, previous);
+
+    this->outputId = getUserArrayId<QuatArrayData>(outputHandle);
+    this->outputTween = tween;
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
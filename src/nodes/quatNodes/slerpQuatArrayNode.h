@@ -5,6 +5,14 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+#include "../../core/quatSlerp.h"
+
+#include <stdint.h>
+
+#include <mutex>
+#include <vector>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,6 +23,7 @@ class SlerpQuatArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
@@ -28,4 +37,16 @@ public:
     static MObject          spinAttr;
 
     static MObject          outputQuatAttr;
+
+private:
+    uint64_t                    pairsId1 = 0;
+    uint64_t                    pairsId2 = 0;
+    int                         pairsSpin = 0;
+    std::vector<QuatSlerpPair>  pairs;
+
+    uint64_t                    outputId = 0;
+    double                      outputTween = 0.0;
+    std::mutex                  stateMutex;
+
+    ComputeCache                computeCache;
 };
\ No newline at end of file
@@ -46,10 +46,15 @@ This node unpacks quaternion rotation components from an array.
 */
 
 #include "unpackQuatArrayNode.h"
+#include "../../core/packKernels.h"
+#include "../../core/parallel.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "../../data/angleArrayData.h"
 #include "../../data/quatArrayData.h"
 
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <maya/MAngle.h>
@@ -94,6 +99,12 @@ void* UnpackQuatArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType UnpackQuatArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus UnpackQuatArrayNode::initialize()
 {
     MStatus status;
@@ -169,34 +180,23 @@ MStatus UnpackQuatArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputQuatAttr);
 
-    std::vector<MQuaternion> input = getUserArray<MQuaternion, QuatArrayData>(inputHandle);
+    const std::vector<MQuaternion> &input = getUserArray<MQuaternion, QuatArrayData>(inputHandle);
 
     size_t numberOfValues = input.size();
 
-    std::vector<double> outputX(numberOfValues);
-    std::vector<double> outputY(numberOfValues);
-    std::vector<double> outputZ(numberOfValues);
-    std::vector<double> outputW(numberOfValues);
-
     std::vector<MVector> outputAxis(numberOfValues);
     std::vector<MAngle>  outputAngle(numberOfValues);
 
-    double theta = 0.0;
-
-    for (size_t i = 0; i < numberOfValues; i++)
+    parallelFor(0, numberOfValues, [&](size_t i)
     {
-        MQuaternion &q = input[i];
-
-        q.getAxisAngle(outputAxis[i], theta);
+        double theta = 0.0;
+        input[i].getAxisAngle(outputAxis[i], theta);
         outputAngle[i] = MAngle(theta);
-
-        outputX[i] = q.x;
-        outputY[i] = q.y;
-        outputZ[i] = q.z;
-        outputW[i] = q.w;
-    }
+    });
 
     MArrayDataHandle outputArrayHandle = data.outputArrayValue(outputQuatAttr);
     setArrayElements<MQuaternion>(outputArrayHandle, input, &UnpackQuatArrayNode::setElement);
@@ -206,16 +206,49 @@ MStatus UnpackQuatArrayNode::compute(const MPlug& plug, MDataBlock& data)
     MDataHandle outputZHandle = data.outputValue(outputZAttr);
     MDataHandle outputWHandle = data.outputValue(outputWAttr);
 
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputXHandle, outputX);
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputYHandle, outputY);
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputZHandle, outputZ);
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputWHandle, outputW);
+    double *outputX = nullptr;
+    double *outputY = nullptr;
+    double *outputZ = nullptr;
+    double *outputW = nullptr;
+
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputXHandle, (unsigned) numberOfValues, outputX);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputYHandle, (unsigned) numberOfValues, outputY);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputZHandle, (unsigned) numberOfValues, outputZ);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputWHandle, (unsigned) numberOfValues, outputW);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    unpackQuatArray(coreView(input), outputX, outputY, outputZ, outputW);
+
+    outputXHandle.setClean();
+    outputYHandle.setClean();
+    outputZHandle.setClean();
+    outputWHandle.setClean();
 
     MDataHandle outputAxisHandle = data.outputValue(outputAxisAttr);
     MDataHandle outputAngleHandle = data.outputValue(outputAngleAttr);
 
     setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputAxisHandle, outputAxis);
-    setUserArray<MAngle, AngleArrayData>(outputAngleHandle, outputAngle);
+
+    {
+        // The ids below are shared by every compute of this node.
+        std::lock_guard<std::mutex> lock(this->stateMutex);
+
+        // Every angle is recomputed with the axes, but only those the input changed need comparing.
+        DirtyRange angleChanges = getUserArrayChanges<QuatArrayData>(inputHandle, this->inputId);
+
+        if (getUserArrayId<AngleArrayData>(outputAngleHandle) != this->outputAngleId)
+        {
+            angleChanges = DirtyRange::all();
+        }
+
+        setUserArray<MAngle, AngleArrayData>(outputAngleHandle, std::move(outputAngle), angleChanges);
+
+        this->inputId = getUserArrayId<QuatArrayData>(inputHandle);
+        this->outputAngleId = getUserArrayId<AngleArrayData>(outputAngleHandle);
+    }
 
     return MStatus::kSuccess;   
 }
@@ -5,6 +5,10 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include <mutex>
+
 #include <maya/MDataBlock.h>
 #include <maya/MDataHandle.h>
 #include <maya/MPlug.h>
@@ -17,6 +21,7 @@ class UnpackQuatArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
@@ -40,4 +45,9 @@ public:
     static MObject          outputWAttr;
     static MObject          outputAxisAttr;
     static MObject          outputAngleAttr;
+
+private:
+    uint64_t                inputId = 0;
+    uint64_t                outputAngleId = 0;
+    std::mutex              stateMutex;
 };
\ No newline at end of file
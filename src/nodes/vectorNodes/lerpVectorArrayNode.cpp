@@ -23,13 +23,18 @@ This node interpolates vectors using either linear or spherical interpolation.
     outputVector (ov) vectorArray
         Array of vectors calculated by this node.
 
+    If one input holds a single vector, it is used with every vector of the
+    other input. Otherwise the shorter input is padded with zero vectors.
+
 */
 
+#include "../../core/vectorKernels.h"
+#include "../../core/xformTypes.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "lerpVectorArrayNode.h"
 
 #include <algorithm>
-#include <math.h>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -61,6 +66,12 @@ void* LerpVectorArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType LerpVectorArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus LerpVectorArrayNode::initialize()
 {
     MStatus status;
@@ -109,6 +120,8 @@ MStatus LerpVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle input1Handle = data.inputValue(inputVector1Attr);
     MDataHandle input2Handle = data.inputValue(inputVector2Attr);
     double tween = data.inputValue(tweenAttr).asDouble();
@@ -116,43 +129,42 @@ MStatus LerpVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
 
     bool useSlerp = data.inputValue(slerpAttr).asBool();
 
-    std::vector<MVector> input1 = getMayaArray<MVector, MFnVectorArrayData>(input1Handle);
-    std::vector<MVector> input2 = getMayaArray<MVector, MFnVectorArrayData>(input2Handle);
-
-    size_t numberOfValues = std::max(input1.size(), input2.size());
-
-    std::vector<MVector> output(numberOfValues);
+    ArrayView<MVector> values1 = getMayaArrayView<MVector, MFnVectorArrayData>(input1Handle);
+    ArrayView<MVector> values2 = getMayaArrayView<MVector, MFnVectorArrayData>(input2Handle);
 
-    input1.resize(numberOfValues);
-    input2.resize(numberOfValues);
+    size_t numberOfValues = std::max(values1.size(), values2.size());
 
-    MVector (*INTERP)(MVector, MVector, double) = useSlerp ? &LerpVectorArrayNode::vectorSlerp : &LerpVectorArrayNode::lerp;
+    ContentHash inputHash;
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    if (useComputeCache(data))
     {
-        output[i] = INTERP(input1[i], input2[i], tween);
+        hashInput(inputHash, values1);
+        hashInput(inputHash, values2);
+        inputHash.updateValue(tween);
+        inputHash.updateValue(useSlerp);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
     MDataHandle outputHandle = data.outputValue(outputVectorAttr);
 
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, output);
+    MVector *output = nullptr;
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
-    return MStatus::kSuccess;   
-}
+    BroadcastView<Vector3> input1(coreView(values1), Vector3());
+    BroadcastView<Vector3> input2(coreView(values2), Vector3());
 
+    void (*INTERP)(BroadcastView<Vector3>, BroadcastView<Vector3>, double, Vector3*, size_t) = useSlerp ? &vectorArraySlerp : &vectorArrayLerp;
 
-MVector LerpVectorArrayNode::lerp(MVector start, MVector end, double tween)
-{
-    return start + ((end - start) * tween);
-}
+    INTERP(input1, input2, tween, coreArray(output), numberOfValues);
 
+    outputHandle.setClean();
 
-MVector LerpVectorArrayNode::vectorSlerp(MVector start, MVector end, double tween)
-{
-    double dot = std::min(1.0, std::max(0.0, start * end));
-    double theta = std::acos(dot) * tween;
-
-    MVector v = (end - start * dot);
+    storeOutput(this->computeCache, inputHash, data);
 
-    return (start * std::cos(theta)) + (v * std::sin(theta));
+    return MStatus::kSuccess;   
 }
\ No newline at end of file
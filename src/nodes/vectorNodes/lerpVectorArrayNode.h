@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,13 +17,10 @@ class LerpVectorArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
-private:
-    static MVector          lerp(MVector start, MVector end, double tween);
-    static MVector          vectorSlerp(MVector start, MVector end, double tween);
-
 public:
     static MTypeId          NODE_ID;
     static MString          NODE_NAME;
@@ -32,4 +31,7 @@ public:
     static MObject          slerpAttr;
 
     static MObject          outputVectorAttr;
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
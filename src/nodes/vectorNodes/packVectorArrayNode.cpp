@@ -55,10 +55,11 @@ This node constructs vectors from trios of values.
 
 */
 
+#include "../../core/packKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "packVectorArrayNode.h"
 
-#include <algorithm>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -102,6 +103,12 @@ void* PackVectorArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType PackVectorArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus PackVectorArrayNode::initialize()
 {
     MStatus status;
@@ -179,6 +186,8 @@ MStatus PackVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short inputMethod = data.inputValue(inputMethodAttr).asShort();
     unsigned size     = (unsigned) data.inputValue(sizeAttr).asInt();
 
@@ -206,30 +215,13 @@ MStatus PackVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
         MDataHandle inputYHandle = data.inputValue(inputYAttr);
         MDataHandle inputZHandle = data.inputValue(inputZAttr);
 
-        std::vector<double> inputX = getMayaArray<double, MFnDoubleArrayData>(inputXHandle);
-        std::vector<double> inputY = getMayaArray<double, MFnDoubleArrayData>(inputYHandle);
-        std::vector<double> inputZ = getMayaArray<double, MFnDoubleArrayData>(inputZHandle);
-
-        unsigned numberOfInputs = 0;
-        numberOfInputs = std::max(numberOfInputs, (unsigned) inputX.size());
-        numberOfInputs = std::max(numberOfInputs, (unsigned) inputY.size());
-        numberOfInputs = std::max(numberOfInputs, (unsigned) inputZ.size());
-
-        inputX.resize(numberOfInputs, fillValue.x);
-        inputY.resize(numberOfInputs, fillValue.y);
-        inputZ.resize(numberOfInputs, fillValue.z);
-        output.resize(size, fillValue);
-
-        unsigned numberOfOutputs = std::min(size, numberOfInputs);
-
-        for (unsigned i = 0; i < numberOfOutputs; i++)
-        {
-            output[i] = MVector(
-                inputX[i],
-                inputY[i],
-                inputZ[i]
-            );
-        }    
+        ArrayView<double> inputX = getMayaArrayView<double, MFnDoubleArrayData>(inputXHandle);
+        ArrayView<double> inputY = getMayaArrayView<double, MFnDoubleArrayData>(inputYHandle);
+        ArrayView<double> inputZ = getMayaArrayView<double, MFnDoubleArrayData>(inputZHandle);
+
+        output.resize(size);
+
+        packVectorArray(inputX, inputY, inputZ, coreValue(fillValue), coreArray(output.data()), size);
     }
 
     MDataHandle outputHandle = data.outputValue(outputVectorAttr);
@@ -15,6 +15,8 @@ This node converts points to vectors.
 
 */
 
+#include "../../core/vectorKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "pointToVectorArrayNode.h"
 
@@ -47,6 +49,12 @@ void* PointToVectorArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType PointToVectorArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus PointToVectorArrayNode::initialize()
 {
     MStatus status;
@@ -77,19 +85,35 @@ MStatus PointToVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputPointAttr);
     MDataHandle outputHandle = data.outputValue(outputVectorAttr);
 
-    std::vector<MPoint> input = getMayaArray<MPoint, MFnPointArrayData>(inputHandle);
+    ArrayView<MPoint> input = getMayaArrayView<MPoint, MFnPointArrayData>(inputHandle);
     size_t numberOfValues = input.size();
-    std::vector<MVector> output(numberOfValues);
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
     {
-        output[i] = MVector(input[i]);
+        hashInput(inputHash, input);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, output);
+    MVector *output = nullptr;
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    pointArrayToVector(coreView(input), coreArray(output));
+
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,6 +17,7 @@ class PointToVectorArrayNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
@@ -25,4 +28,7 @@ public:
     static MObject          inputPointAttr;
 
     static MObject          outputVectorAttr;
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
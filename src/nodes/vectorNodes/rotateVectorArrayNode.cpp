@@ -35,9 +35,11 @@ This node computes the result of rotating vectors.
 
 */
 
+#include "../../core/vectorKernels.h"
 #include "../../data/angleArrayData.h"
 #include "../../data/eulerArrayData.h"
 #include "../../data/quatArrayData.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "rotateVectorArrayNode.h"
 
@@ -78,6 +80,12 @@ void* RotateVectorArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType RotateVectorArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus RotateVectorArrayNode::initialize()
 {
     MStatus status;
@@ -131,14 +139,48 @@ MStatus RotateVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short operation = data.inputValue(operationAttr).asShort();
 
     MDataHandle inputHandle = data.inputValue(inputVectorAttr);
-    std::vector<MVector> input = getMayaArray<MVector, MFnVectorArrayData>(inputHandle);
+    ArrayView<MVector> input = getMayaArrayView<MVector, MFnVectorArrayData>(inputHandle);
 
     size_t numberOfValues = input.size();
 
-    std::vector<MVector> output(numberOfValues);
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
+    {
+        hashInput(inputHash, input);
+        inputHash.updateValue(operation);
+
+        if (operation == AXIS_ANGLE)
+        {
+            MDataHandle axisHandle  = data.inputValue(inputAxisAttr);
+            MDataHandle angleHandle = data.inputValue(inputAngleAttr);
+
+            hashInput(inputHash, getMayaArrayView<MVector, MFnVectorArrayData>(axisHandle));
+            hashInput(inputHash, getUserArray<MAngle, AngleArrayData>(angleHandle));
+        } else if (operation == EULER_ROTATE) {
+            MDataHandle rotateHandle = data.inputValue(inputRotateAttr);
+            hashInput(inputHash, getUserArray<MEulerRotation, EulerArrayData>(rotateHandle));
+        } else {
+            MDataHandle rotateHandle = data.inputValue(inputQuatAttr);
+            hashInput(inputHash, getUserArray<MQuaternion, QuatArrayData>(rotateHandle));
+        }
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
+    }
+
+    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
+
+    MVector *output = nullptr;
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
     if (operation == AXIS_ANGLE)
     {
@@ -154,31 +196,25 @@ MStatus RotateVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
         for (size_t i = 0; i < numberOfValues; i++)
         {
             // todo: write equation that does this;
+            output[i] = MVector::zero;
         }        
     } else if (operation == EULER_ROTATE) {
         MDataHandle rotateHandle = data.inputValue(inputRotateAttr);
+        const std::vector<MEulerRotation> &rotate = getUserArray<MEulerRotation, EulerArrayData>(rotateHandle);
 
-        std::vector<MEulerRotation> rotate = getUserArray<MEulerRotation, EulerArrayData>(rotateHandle);
-        rotate.resize(numberOfValues);
-
-        for (size_t i = 0; i < numberOfValues; i++)
-        {
-            output[i] = input[i].rotateBy(rotate[i]);
-        }  
-    } else if (operation == AXIS_ANGLE) {
+        vectorArrayRotateByEuler(coreView(input), coreView(ArrayView<MEulerRotation>(rotate)), coreArray(output));
+    } else if (operation == QUATERNION) {
         MDataHandle rotateHandle = data.inputValue(inputQuatAttr);
+        const std::vector<MQuaternion> &rotate = getUserArray<MQuaternion, QuatArrayData>(rotateHandle);
 
-        std::vector<MQuaternion> rotate = getUserArray<MQuaternion, QuatArrayData>(rotateHandle);
-        rotate.resize(numberOfValues);
-
-        for (size_t i = 0; i < numberOfValues; i++)
-        {
-            output[i] = input[i].rotateBy(rotate[i]);
-        }  
+        vectorArrayRotateByQuat(coreView(input), coreView(ArrayView<MQuaternion>(rotate)), coreArray(output));
+    } else {
+        std::fill(output, output + numberOfValues, MVector::zero);
     }
 
-    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, output);
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
@@ -33,6 +33,8 @@ This node unpacks vectors into their components.
 
 */
 
+#include "../../core/packKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "unpackVectorArrayNode.h"
 
@@ -72,6 +74,12 @@ void* UnpackVectorArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType UnpackVectorArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus UnpackVectorArrayNode::initialize()
 {
     MStatus status;
@@ -131,25 +139,14 @@ MStatus UnpackVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputVectorAttr);
 
-    std::vector<MVector> input = getMayaArray<MVector, MFnVectorArrayData>(inputHandle);
+    ArrayView<MVector> input = getMayaArrayView<MVector, MFnVectorArrayData>(inputHandle);
 
     size_t numberOfValues = input.size();
 
-    std::vector<double> outputX(numberOfValues);
-    std::vector<double> outputY(numberOfValues);
-    std::vector<double> outputZ(numberOfValues);
-
-    for (size_t i = 0; i < numberOfValues; i++)
-    {
-        MVector &v = input[i];
-
-        outputX[i] = v.x;
-        outputY[i] = v.y;
-        outputZ[i] = v.z;
-    }
-
     MArrayDataHandle outputArrayHandle = data.outputArrayValue(outputVectorAttr);
     setArrayElements<MVector>(outputArrayHandle, input, &UnpackVectorArrayNode::setElement);
 
@@ -157,9 +154,22 @@ MStatus UnpackVectorArrayNode::compute(const MPlug& plug, MDataBlock& data)
     MDataHandle outputYHandle = data.outputValue(outputYAttr);
     MDataHandle outputZHandle = data.outputValue(outputZAttr);
 
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputXHandle, outputX);
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputYHandle, outputY);
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputZHandle, outputZ);
+    double *outputX = nullptr;
+    double *outputY = nullptr;
+    double *outputZ = nullptr;
+
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputXHandle, (unsigned) numberOfValues, outputX);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputYHandle, (unsigned) numberOfValues, outputY);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputZHandle, (unsigned) numberOfValues, outputZ);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    unpackVectorArray(coreView(input), outputX, outputY, outputZ);
+
+    outputXHandle.setClean();
+    outputYHandle.setClean();
+    outputZHandle.setClean();
     
     return MStatus::kSuccess;   
 }
@@ -24,8 +24,14 @@ This node performs binary operations of pairs of vectors.
     outputVector (ov) vectorArray
         Array of vectors calculated by this node.
 
+    If one input holds a single vector, it is used with every vector of the
+    other input. Otherwise the shorter input is padded with zero vectors.
+
 */
 
+#include "../../core/parallel.h"
+#include "../../core/vectorKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "vectorArrayBinaryOpNode.h"
 
@@ -64,6 +70,12 @@ void* VectorArrayBinaryOpNode::creator()
 }
 
 
+MPxNode::SchedulingType VectorArrayBinaryOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus VectorArrayBinaryOpNode::initialize()
 {
     MStatus status;
@@ -108,42 +120,63 @@ MStatus VectorArrayBinaryOpNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short operation = data.inputValue(operationAttr).asShort();
 
     MDataHandle input1Handle = data.inputValue(inputVector1Attr);
     MDataHandle input2Handle = data.inputValue(inputVector2Attr);
 
-    std::vector<MVector> input1 = getMayaArray<MVector, MFnVectorArrayData>(input1Handle);
-    std::vector<MVector> input2 = getMayaArray<MVector, MFnVectorArrayData>(input2Handle);
-
-    size_t numberOfValues = std::max(input1.size(), input2.size());
+    ArrayView<MVector> values1 = getMayaArrayView<MVector, MFnVectorArrayData>(input1Handle);
+    ArrayView<MVector> values2 = getMayaArrayView<MVector, MFnVectorArrayData>(input2Handle);
 
-    input1.resize(numberOfValues);
-    input2.resize(numberOfValues);
+    size_t numberOfValues = std::max(values1.size(), values2.size());
 
-    std::vector<MVector> output(numberOfValues);
+    BroadcastView<Vector3> input1(coreView(values1), Vector3());
+    BroadcastView<Vector3> input2(coreView(values2), Vector3());
 
-    MVector (*F)(MVector, MVector) = &VectorArrayBinaryOpNode::nop;
+    ContentHash inputHash;
 
-    switch (operation)
+    if (useComputeCache(data))
     {
-        case ADD:      F = &VectorArrayBinaryOpNode::add; break;
-        case SUBTRACT: F = &VectorArrayBinaryOpNode::subtract; break;
-        case CROSS:    F = &VectorArrayBinaryOpNode::cross; break;
+        hashInput(inputHash, values1);
+        hashInput(inputHash, values2);
+        inputHash.updateValue(operation);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
+
+    MVector *output = nullptr;
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    void (*F)(BroadcastView<Vector3>, BroadcastView<Vector3>, Vector3*, size_t) = &VectorArrayBinaryOpNode::nop;
+
+    switch (operation)
     {
-        output[i] = F(input1[i], input2[i]);
+        case ADD:      F = &vectorArrayAdd;      break;
+        case SUBTRACT: F = &vectorArraySubtract; break;
+        case CROSS:    F = &vectorArrayCross;    break;
     }
 
-    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, output);
+    F(input1, input2, coreArray(output), numberOfValues);
+
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
 
-MVector VectorArrayBinaryOpNode::nop(MVector v1, MVector v2)      { return v1; }
-MVector VectorArrayBinaryOpNode::add(MVector v1, MVector v2)      { return v1 + v2; }
-MVector VectorArrayBinaryOpNode::subtract(MVector v1, MVector v2) { return v1 - v2; }
-MVector VectorArrayBinaryOpNode::cross(MVector v1, MVector v2)    { return v1 ^ v2; }
\ No newline at end of file
+void VectorArrayBinaryOpNode::nop(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        out[i] = v1[i];
+    });
+}
\ No newline at end of file
@@ -5,6 +5,12 @@
 
 #pragma once
 
+#include "../../core/arrayView.h"
+#include "../../core/computeCache.h"
+#include "../../core/xformTypes.h"
+
+#include <stddef.h>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,14 +21,12 @@ class VectorArrayBinaryOpNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
 private:
-    static inline MVector   nop(MVector v1, MVector v2);
-    static inline MVector   add(MVector v1, MVector v2);
-    static inline MVector   subtract(MVector v1, MVector v2);
-    static inline MVector   cross(MVector v1, MVector v2);
+    static void             nop(BroadcastView<Vector3> v1, BroadcastView<Vector3> v2, Vector3 *out, size_t n);
 
 public:
     static MTypeId          NODE_ID;
@@ -33,4 +37,7 @@ public:
     static MObject          operationAttr;
 
     static MObject          outputVectorAttr;
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
@@ -23,8 +23,15 @@ This node performs binary operations on vector/matrix pairs.
     outputVector (ov) vectorArray        
         Array of vectors calculated by this node.
 
+    A single matrix is applied to every vector, and a single vector is 
+    transformed by every matrix. Otherwise the shorter input is padded with
+    zero vectors or identity matrices.
+
 */
 
+#include "../../core/parallel.h"
+#include "../../core/vectorKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "vectorArrayMatrixOpNode.h"
 
@@ -41,7 +48,6 @@ This node performs binary operations on vector/matrix pairs.
 #include <maya/MMatrix.h>
 #include <maya/MMatrixArray.h>
 #include <maya/MPlug.h>
-#include <maya/MPoint.h>
 #include <maya/MPxNode.h>
 #include <maya/MString.h>
 #include <maya/MTypeId.h>
@@ -64,6 +70,12 @@ void* VectorArrayMatrixOpNode::creator()
 }
 
 
+MPxNode::SchedulingType VectorArrayMatrixOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus VectorArrayMatrixOpNode::initialize()
 {
     MStatus status;
@@ -107,40 +119,63 @@ MStatus VectorArrayMatrixOpNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short operation = data.inputValue(operationAttr).asShort();
 
     MDataHandle inputVectorHandle = data.inputValue(inputVectorAttr);
     MDataHandle inputMatrixHandle = data.inputValue(inputMatrixAttr);
 
-    std::vector<MVector> vector_ = getMayaArray<MVector, MFnVectorArrayData>(inputVectorHandle);
-    std::vector<MMatrix> matrix = getMayaArray<MMatrix, MFnMatrixArrayData>(inputMatrixHandle);
-
-    size_t numberOfValues = std::max(vector_.size(), matrix.size());
+    ArrayView<MVector> vectorValues = getMayaArrayView<MVector, MFnVectorArrayData>(inputVectorHandle);
+    ArrayView<MMatrix> matrixValues = getMayaArrayView<MMatrix, MFnMatrixArrayData>(inputMatrixHandle);
 
-    vector_.resize(numberOfValues);
-    matrix.resize(numberOfValues);
+    size_t numberOfValues = std::max(vectorValues.size(), matrixValues.size());
 
-    std::vector<MVector> output(numberOfValues);
+    BroadcastView<Vector3> vector_(coreView(vectorValues), Vector3());
+    BroadcastView<Matrix4> matrix(coreView(matrixValues), coreValue(MMatrix::identity));
 
-    MVector (*F)(MVector, MMatrix) = &VectorArrayMatrixOpNode::nop;
+    ContentHash inputHash;
 
-    switch (operation)
+    if (useComputeCache(data))
     {
-        case VECTOR_MATRIX_PRODUCT: F = &VectorArrayMatrixOpNode::vectorMatrixProduct; break;
-        case POINT_MATRIX_PRODUCT:  F = &VectorArrayMatrixOpNode::pointMatrixProduct;  break;
+        hashInput(inputHash, vectorValues);
+        hashInput(inputHash, matrixValues);
+        inputHash.updateValue(operation);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
+
+    MVector *output = nullptr;
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    void (*F)(BroadcastView<Vector3>, BroadcastView<Matrix4>, Vector3*, size_t) = &VectorArrayMatrixOpNode::nop;
+
+    switch (operation)
     {
-        output[i] = F(vector_[i], matrix[i]);
+        case VECTOR_MATRIX_PRODUCT: F = &vectorArrayMatrixProduct; break;
+        case POINT_MATRIX_PRODUCT:  F = &pointArrayMatrixProduct;  break;
     }
 
-    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, output);
+    F(vector_, matrix, coreArray(output), numberOfValues);
+
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
 
-MVector VectorArrayMatrixOpNode::nop(MVector v, MMatrix m)                 { return v; }
-MVector VectorArrayMatrixOpNode::vectorMatrixProduct(MVector v, MMatrix m) { return v * m; }
-MVector VectorArrayMatrixOpNode::pointMatrixProduct(MVector v, MMatrix m)  { return MVector(MPoint(v) * m); }
\ No newline at end of file
+
+void VectorArrayMatrixOpNode::nop(BroadcastView<Vector3> v, BroadcastView<Matrix4> m, Vector3 *out, size_t n)
+{
+    parallelFor(0, n, [&](size_t i)
+    {
+        out[i] = v[i];
+    });
+}
\ No newline at end of file
@@ -5,6 +5,12 @@
 
 #pragma once
 
+#include "../../core/arrayView.h"
+#include "../../core/computeCache.h"
+#include "../../core/xformTypes.h"
+
+#include <stddef.h>
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,13 +21,12 @@ class VectorArrayMatrixOpNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
 private:
-    static inline MVector   nop(MVector v, MMatrix m);
-    static inline MVector   vectorMatrixProduct(MVector v, MMatrix m);    
-    static inline MVector   pointMatrixProduct(MVector v, MMatrix m);
+    static void             nop(BroadcastView<Vector3> v, BroadcastView<Matrix4> m, Vector3 *out, size_t n);
 
 public:
     static MTypeId          NODE_ID;
@@ -32,4 +37,7 @@ public:
     static MObject          operationAttr;
 
     static MObject          outputVectorAttr;
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
@@ -22,11 +22,17 @@ This node performs scalar operations on vectors.
 
     outputVector (ov) vectorArray 
         Array of vectors calculated by this node.
+
+    A single scalar is applied to every vector. Otherwise vectors without a
+    scalar use 1.
 */
 
+#include "../../core/vectorKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "vectorArrayScalarOpNode.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -60,6 +66,12 @@ void* VectorArrayScalarOpNode::creator()
 }
 
 
+MPxNode::SchedulingType VectorArrayScalarOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus VectorArrayScalarOpNode::initialize()
 {
     MStatus status;
@@ -105,39 +117,49 @@ MStatus VectorArrayScalarOpNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short operation = data.inputValue(operationAttr).asShort();
 
     MDataHandle inputVectorHandle = data.inputValue(inputVectorAttr);
     MDataHandle inputScalarHandle = data.inputValue(scalarAttr);
 
-    std::vector<MVector> vector_ = getMayaArray<MVector, MFnVectorArrayData>(inputVectorHandle);
-    std::vector<double>  scalar  = getMayaArray<double, MFnDoubleArrayData>(inputScalarHandle);
+    ArrayView<MVector>     vector_ = getMayaArrayView<MVector, MFnVectorArrayData>(inputVectorHandle);
+    ArrayView<double>      scalarValues = getMayaArrayView<double, MFnDoubleArrayData>(inputScalarHandle);
+    BroadcastView<double>  scalar(scalarValues, 1.0);
 
     size_t numberOfValues = vector_.size();
-    scalar.resize(numberOfValues, 1);
-
-    std::vector<MVector> output(numberOfValues);
 
-    MVector (*F)(MVector, double) = &VectorArrayScalarOpNode::nop;
+    ContentHash inputHash;
 
-    switch (operation)
+    if (useComputeCache(data))
     {
-        case MULTIPLY: F = &VectorArrayScalarOpNode::multiply; break;
-        case DIVIDE:   F = &VectorArrayScalarOpNode::divide;  break;
+        hashInput(inputHash, vector_);
+        hashInput(inputHash, scalarValues);
+        inputHash.updateValue(operation);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
+
+    MVector *output = nullptr;
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    switch (operation)
     {
-        output[i] = F(vector_[i], scalar[i]);
+        case MULTIPLY: vectorArrayMultiply(coreView(vector_), scalar, coreArray(output)); break;
+        case DIVIDE:   vectorArrayDivide(coreView(vector_), scalar, coreArray(output));   break;
+        default:       std::copy(vector_.begin(), vector_.end(), output);                 break;
     }
 
-    MDataHandle outputHandle = data.outputValue(outputVectorAttr);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, output);
-
-    return MStatus::kSuccess;   
-}
+    outputHandle.setClean();
 
+    storeOutput(this->computeCache, inputHash, data);
 
-MVector VectorArrayScalarOpNode::nop(MVector v, double s)      { return v; }
-MVector VectorArrayScalarOpNode::multiply(MVector v, double s) { return v * s; }
-MVector VectorArrayScalarOpNode::divide(MVector v, double s)   { return v / s; }
\ No newline at end of file
+    return MStatus::kSuccess;   
+}
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -15,14 +17,10 @@ class VectorArrayScalarOpNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
-private:
-    static inline MVector   nop(MVector v, double s);
-    static inline MVector   multiply(MVector v, double s);
-    static inline MVector   divide(MVector v, double s);
-
 public:
     static MTypeId          NODE_ID;
     static MString          NODE_NAME;
@@ -32,4 +30,7 @@ public:
     static MObject          scalarAttr;
 
     static MObject          outputVectorAttr;
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
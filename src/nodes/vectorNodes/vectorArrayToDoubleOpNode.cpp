@@ -24,8 +24,14 @@ This node performs calculates using pairs of vectors and returning a scalar.
     output (o) doubleArray
         Array of values calculated by this node.
 
+    If one input holds a single vector, it is used with every vector of the
+    other input. Otherwise the shorter input is padded with zero vectors.
+
 */
 
+#include "../../core/vectorKernels.h"
+#include "../../core/xformTypes.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "vectorArrayToDoubleOpNode.h"
 
@@ -65,6 +71,12 @@ void* VectorArrayToDoubleOpNode::creator()
 }
 
 
+MPxNode::SchedulingType VectorArrayToDoubleOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus VectorArrayToDoubleOpNode::initialize()
 {
     MStatus status;
@@ -109,43 +121,52 @@ MStatus VectorArrayToDoubleOpNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short operation = data.inputValue(operationAttr).asShort();
 
     MDataHandle input1Handle = data.inputValue(inputVector1Attr);
     MDataHandle input2Handle = data.inputValue(inputVector2Attr);
 
-    std::vector<MVector> input1 = getMayaArray<MVector, MFnVectorArrayData>(input1Handle);
-    std::vector<MVector> input2 = getMayaArray<MVector, MFnVectorArrayData>(input2Handle);
+    ArrayView<MVector> values1 = getMayaArrayView<MVector, MFnVectorArrayData>(input1Handle);
+    ArrayView<MVector> values2 = getMayaArrayView<MVector, MFnVectorArrayData>(input2Handle);
 
-    size_t numberOfValues = std::max(input1.size(), input2.size());
+    size_t numberOfValues = std::max(values1.size(), values2.size());
 
-    input1.resize(numberOfValues);
-    input2.resize(numberOfValues);
+    BroadcastView<Vector3> input1(coreView(values1), Vector3());
+    BroadcastView<Vector3> input2(coreView(values2), Vector3());
 
-    std::vector<double> output(numberOfValues);
+    ContentHash inputHash;
 
-    double (*F)(MVector, MVector) = &VectorArrayToDoubleOpNode::nop;
-
-    switch (operation)
+    if (useComputeCache(data))
     {
-        case DISTANCE_BETWEEN: F = &VectorArrayToDoubleOpNode::distanceBetween; break;
-        case DOT_PRODUCT:      F = &VectorArrayToDoubleOpNode::dotProduct;      break;
-        case LENGTH:           F = &VectorArrayToDoubleOpNode::length;          break;
+        hashInput(inputHash, values1);
+        hashInput(inputHash, values2);
+        inputHash.updateValue(operation);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    MDataHandle outputHandle = data.outputValue(outputAttr);
+
+    double *output = nullptr;
+    status = getMayaArrayOutput<double, MDoubleArray, MFnDoubleArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    switch (operation)
     {
-        output[i] = F(input1[i], input2[i]);
+        case DISTANCE_BETWEEN: vectorArrayDistance(input1, input2, output, numberOfValues); break;
+        case DOT_PRODUCT:      vectorArrayDot(input1, input2, output, numberOfValues);      break;
+        case LENGTH:           vectorArrayLength(input1, output, numberOfValues);           break;
+        default:               std::fill(output, output + numberOfValues, 0.0);             break;
     }
 
-    MDataHandle outputHandle = data.outputValue(outputAttr);
-    setMayaArray<double, MDoubleArray, MFnDoubleArrayData>(outputHandle, output);
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
-
-
-double VectorArrayToDoubleOpNode::nop(MVector v1, MVector v2)             { return 0.0;}
-double VectorArrayToDoubleOpNode::distanceBetween(MVector v1, MVector v2) { return MPoint(v1).distanceTo(MPoint(v2)); }
-double VectorArrayToDoubleOpNode::dotProduct(MVector v1, MVector v2)      { return v1 * v2; }
-double VectorArrayToDoubleOpNode::length(MVector v1, MVector v2)          { return v1.length(); }
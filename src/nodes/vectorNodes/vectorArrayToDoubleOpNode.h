@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "../../core/computeCache.h"
+
 #include <maya/MDataBlock.h>
 #include <maya/MPlug.h>
 #include <maya/MPxNode.h>
@@ -16,15 +18,11 @@ class VectorArrayToDoubleOpNode : public MPxNode
 {
 public:
     virtual MStatus         compute(const MPlug& plug, MDataBlock& data);
+    virtual SchedulingType  schedulingType() const;
     static  void*           creator();
     static  MStatus         initialize();
 
 private:
-    static inline double    nop(MVector v1, MVector v2);
-    static inline double    distanceBetween(MVector v1, MVector v2);
-    static inline double    dotProduct(MVector v1, MVector v2);
-    static inline double    length(MVector v1, MVector v2);
-
 public:
     static MTypeId          NODE_ID;
     static MString          NODE_NAME;
@@ -34,4 +32,7 @@ public:
     static MObject          operationAttr;
 
     static MObject          outputAttr;
+
+private:
+    ComputeCache            computeCache;
 };
\ No newline at end of file
@@ -21,9 +21,12 @@ This node performs unary operations on an array of vectors.
         Array of vectors calculated by this node.
 */
 
+#include "../../core/vectorKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "vectorArrayUnaryOpNode.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <maya/MDataBlock.h>
@@ -56,6 +59,12 @@ void* VectorArrayUnaryOpNode::creator()
 }
 
 
+MPxNode::SchedulingType VectorArrayUnaryOpNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus VectorArrayUnaryOpNode::initialize()
 {
     MStatus status;
@@ -96,27 +105,45 @@ MStatus VectorArrayUnaryOpNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     short operation = data.inputValue(operationAttr).asShort();
 
     MDataHandle inputHandle = data.inputValue(inputVectorAttr);
 
-    std::vector<MVector> values = getMayaArray<MVector, MFnVectorArrayData>(inputHandle);
+    ArrayView<MVector> input = getMayaArrayView<MVector, MFnVectorArrayData>(inputHandle);
 
-    if (operation == NORMALIZE)
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
     {
-        for (size_t i = 0; i < values.size(); i++)
-        {
-            values[i].normalize();
-        }
-    } else if (operation == INVERT) {
-        for (size_t i = 0; i < values.size(); i++)
-        {
-            values[i] *= -1.0;
+        hashInput(inputHash, input);
+        inputHash.updateValue(operation);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
         }
     }
 
     MDataHandle outputHandle = data.outputValue(outputVectorAttr);
-    setMayaArray<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, values);
+
+    MVector *output = nullptr;
+    status = getMayaArrayOutput<MVector, MVectorArray, MFnVectorArrayData>(outputHandle, (unsigned) input.size(), output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    if (operation == NORMALIZE)
+    {
+        vectorArrayNormalize(coreView(input), coreArray(output));
+    } else if (operation == INVERT) {
+        vectorArrayNegate(coreView(input), coreArray(output));
+    } else {
+        std::copy(input.begin(), input.end(), output);
+    }
+
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
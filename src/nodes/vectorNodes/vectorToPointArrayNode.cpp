@@ -16,6 +16,8 @@ This node converts vectors to points.
 
 */
 
+#include "../../core/vectorKernels.h"
+#include "../../core/nodeProfiler.h"
 #include "../nodeData.h"
 #include "vectorToPointArrayNode.h"
 
@@ -48,6 +50,12 @@ void* VectorToPointArrayNode::creator()
 }
 
 
+MPxNode::SchedulingType VectorToPointArrayNode::schedulingType() const
+{
+    return MPxNode::kParallel;
+}
+
+
 MStatus VectorToPointArrayNode::initialize()
 {
     MStatus status;
@@ -78,19 +86,35 @@ MStatus VectorToPointArrayNode::compute(const MPlug& plug, MDataBlock& data)
         return MStatus::kInvalidParameter;
     }
 
+    ComputeProfile profile(this);
+
     MDataHandle inputHandle = data.inputValue(inputVectorAttr);
     MDataHandle outputHandle = data.outputValue(outputPointAttr);
 
-    std::vector<MVector> input = getMayaArray<MVector, MFnVectorArrayData>(inputHandle);
+    ArrayView<MVector> input = getMayaArrayView<MVector, MFnVectorArrayData>(inputHandle);
     size_t numberOfValues = input.size();
-    std::vector<MPoint> output(numberOfValues);
 
-    for (size_t i = 0; i < numberOfValues; i++)
+    ContentHash inputHash;
+
+    if (useComputeCache(data))
     {
-        output[i] = MPoint(input[i]);
+        hashInput(inputHash, input);
+
+        if (reuseOutput(this->computeCache, inputHash, plug, data)) 
+        { 
+            return MStatus::kSuccess; 
+        }
     }
 
-    setMayaArray<MPoint, MPointArray, MFnPointArrayData>(outputHandle, output);
+    MPoint *output = nullptr;
+    status = getMayaArrayOutput<MPoint, MPointArray, MFnPointArrayData>(outputHandle, (unsigned) numberOfValues, output);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    vectorArrayToPoint(coreView(input), coreArray(output));
+
+    outputHandle.setClean();
+
+    storeOutput(this->computeCache, inputHash, data);
 
     return MStatus::kSuccess;   
 }
\ No newline at end of file
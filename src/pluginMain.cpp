@@ -31,6 +31,10 @@ Maya plugin with nodes designed to operate on transform components.
 #include "data/quatArrayData.h"
 
 #include "commands/getArrayAttrCmd.h"
+#include "commands/xformArrayOptionsCmd.h"
+#include "commands/xformArrayProfileCmd.h"
+
+#include "core/parallel.h"
 
 #include "nodes/angleNodes/angleArrayCtorNode.h"
 #include "nodes/angleNodes/angleArrayIterNode.h"
@@ -87,6 +91,8 @@ const MTypeId EulerArrayData::TYPE_ID       = 0x00126b3b;
 const MTypeId QuatArrayData::TYPE_ID        = 0x00126b3c;
 
 MString GetArrayAttrCmd::COMMAND_NAME         = "getArrayAttr";
+MString XformArrayOptionsCmd::COMMAND_NAME    = "xformArrayOptions";
+MString XformArrayProfileCmd::COMMAND_NAME    = "xformArrayProfile";
 
 MString AngleArrayCtorNode::NODE_NAME         = "packAngleArray";
 MString AngleArrayIterNode::NODE_NAME         = "unpackAngleArray";
@@ -208,6 +214,22 @@ MStatus initializePlugin(MObject obj)
 
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = fnPlugin.registerCommand(
+        XformArrayOptionsCmd::COMMAND_NAME,
+        XformArrayOptionsCmd::creator,
+        XformArrayOptionsCmd::getSyntax
+    );    
+
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = fnPlugin.registerCommand(
+        XformArrayProfileCmd::COMMAND_NAME,
+        XformArrayProfileCmd::creator,
+        XformArrayProfileCmd::getSyntax
+    );    
+
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     REGISTER_NODE(AngleArrayCtorNode);
     REGISTER_NODE(AngleArrayIterNode);
     REGISTER_NODE(AngleToDoubleArrayNode);
@@ -251,6 +273,9 @@ MStatus uninitializePlugin(MObject obj)
 {
     MStatus status;
     MFnPlugin fnPlugin(obj, AUTHOR, VERSION, REQUIRED_API_VERSION);
+
+    // Worker threads must not outlive the plugin's code.
+    stopParallelWorkers();
     
     DEREGISTER_DATA(AngleArrayData);
     DEREGISTER_DATA(EulerArrayData);
@@ -262,6 +287,18 @@ MStatus uninitializePlugin(MObject obj)
     
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    status = fnPlugin.deregisterCommand(
+        XformArrayOptionsCmd::COMMAND_NAME
+    );    
+    
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = fnPlugin.deregisterCommand(
+        XformArrayProfileCmd::COMMAND_NAME
+    );    
+    
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     DEREGISTER_NODE(AngleArrayCtorNode);
     DEREGISTER_NODE(AngleArrayIterNode);
     DEREGISTER_NODE(AngleToDoubleArrayNode);
@@ -0,0 +1,2765 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+xformArrayCoreTests
+    Checks the Maya-free kernels behind the xformArrayNodes nodes, and the
+    helpers the data types use to read and write files. Maya is not needed 
+    to build or run it.
+
+    Each test prints what it found when it fails, and the executable exits
+    with the number of failed tests, so that it can be run by CTest.
+
+    Usage: xformArrayCoreTests [--filter <text>]
+
+    CTest also runs the parallel tests with XFORM_ARRAY_THREADS=1.
+*/
+
+#include "../src/core/arrayView.h"
+#include "../src/core/contentHash.h"
+#include "../src/core/dirtyRange.h"
+#include "../src/core/doubleText.h"
+#include "../src/core/eulerKernels.h"
+#include "../src/core/matrixCompose.h"
+#include "../src/core/matrixDecompose.h"
+#include "../src/core/matrixKernels.h"
+#include "../src/core/matrixKernelsImpl.h"
+#include "../src/core/parallel.h"
+#include "../src/core/quatCodec.h"
+#include "../src/core/quatKernels.h"
+#include "../src/core/quatKernelsImpl.h"
+#include "../src/core/quatLanes.h"
+#include "../src/core/quatSlerp.h"
+#include "../src/core/sharedBuffer.h"
+#include "../src/core/sidecarFile.h"
+#include "../src/core/simd.h"
+#include "../src/core/vectorKernels.h"
+#include "../src/core/xformTypes.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TestCase
+{
+    std::string            name;
+    std::function<bool()>  run;
+};
+
+
+/** Prints a failure, and returns false, so that tests can `return fail(...)`. */
+static bool fail(const char *test, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    fprintf(stderr, "%s failed: ", test);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+
+    va_end(args);
+    return false;
+}
+
+
+static const double PI_4 = 0.78539816339744830962;
+static const double PI   = 4.0 * PI_4;
+
+static uint64_t randomState = 1;
+
+/** xorshift64*, so that every run sees the same values. */
+static uint64_t randomBits()
+{
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 0x2545F4914F6CDD1DULL;
+}
+
+
+/** A random value in [-1, 1). */
+static double randomValue()
+{
+    return (double) (randomBits() >> 11) / (double) (1ULL << 52) - 1.0;
+}
+
+
+static double doubleFromBits(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+static uint64_t bitsFromDouble(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Quaternion kernels                                                       */
+/* ------------------------------------------------------------------------ */
+
+/** Lengths on either side of the 2-, 4- and 8-wide vector loops. */
+static const size_t QUAT_TEST_LENGTHS[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1001};
+
+struct RefQuat { double x, y, z, w; };
+
+/** q1 * q2, applying q1 first, as MQuaternion does. */
+static RefQuat refProduct(const RefQuat &a, const RefQuat &b)
+{
+    RefQuat r = {
+        b.w * a.x + b.x * a.w + b.y * a.z - b.z * a.y,
+        b.w * a.y - b.x * a.z + b.y * a.w + b.z * a.x,
+        b.w * a.z + b.x * a.y - b.y * a.x + b.z * a.w,
+        b.w * a.w - b.x * a.x - b.y * a.y - b.z * a.z
+    };
+    return r;
+}
+
+
+/** Zero-length quaternions are passed through, as the kernels document. */
+static RefQuat refInverse(const RefQuat &q)
+{
+    double norm = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    double s = norm > 0.0 ? 1.0 / norm : 1.0;
+    RefQuat r = {-q.x * s, -q.y * s, -q.z * s, q.w * s};
+    return r;
+}
+
+
+static RefQuat refNormalize(const RefQuat &q)
+{
+    double norm = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    double s = norm > 0.0 ? 1.0 / sqrt(norm) : 1.0;
+    RefQuat r = {q.x * s, q.y * s, q.z * s, q.w * s};
+    return r;
+}
+
+
+enum QuatOp { OP_ADD, OP_SUBTRACT, OP_PRODUCT, OP_CONJUGATE, OP_INVERSE, OP_NEGATE, OP_NORMALIZE };
+
+static const char* const QUAT_OP_NAMES[] = {"add", "subtract", "product", "conjugate", "inverse", "negate", "normalize"};
+
+static RefQuat refQuatOp(QuatOp op, const RefQuat &a, const RefQuat &b)
+{
+    switch (op)
+    {
+        case OP_ADD:        { RefQuat r = {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w}; return r; }
+        case OP_SUBTRACT:   { RefQuat r = {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w}; return r; }
+        case OP_PRODUCT:    return refProduct(a, b);
+        case OP_CONJUGATE:  { RefQuat r = {-a.x, -a.y, -a.z, a.w}; return r; }
+        case OP_INVERSE:    return refInverse(a);
+        case OP_NEGATE:     { RefQuat r = {-a.x, -a.y, -a.z, -a.w}; return r; }
+        default:            return refNormalize(a);
+    }
+}
+
+
+/** Fills q with random quaternions, with every fifth one zero, and some very small or large. */
+template <typename REAL>
+static void fillTestLanes(BasicQuatLanes<REAL> &q, size_t n)
+{
+    q.resize(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double scale = (i % 7 == 3) ? 1.0e-3 : (i % 7 == 6) ? 1.0e3 : 1.0;
+        bool   zero  = (i % 5 == 2);
+
+        q.x[i] = zero ? REAL(0) : REAL(randomValue() * scale);
+        q.y[i] = zero ? REAL(0) : REAL(randomValue() * scale);
+        q.z[i] = zero ? REAL(0) : REAL(randomValue() * scale);
+        q.w[i] = zero ? REAL(0) : REAL(randomValue() * scale);
+    }
+}
+
+
+template <typename REAL>
+static RefQuat laneQuat(const BasicQuatLanes<REAL> &q, size_t i)
+{
+    RefQuat r = {(double) q.x[i], (double) q.y[i], (double) q.z[i], (double) q.w[i]};
+    return r;
+}
+
+
+/**
+    Runs op from one kernel table over every test length, and compares each
+    element with the reference, relative to the size of the expected value.
+    Canary elements past the end of the output must not be written.
+*/
+template <typename REAL>
+static bool checkQuatTable(const char *test, const BasicQuatKernelTable<REAL> &table, QuatOp op, double tolerance)
+{
+    for (size_t n : QUAT_TEST_LENGTHS)
+    {
+        BasicQuatLanes<REAL> a, b, out;
+        fillTestLanes(a, n);
+        fillTestLanes(b, n);
+
+        const size_t CANARY = 3;
+        out.resize(n + CANARY);
+
+        for (size_t i = n; i < n + CANARY; i++)
+        {
+            out.x[i] = out.y[i] = out.z[i] = out.w[i] = REAL(42);
+        }
+
+        BasicConstQuatLanePtr<REAL> pa   = {a.x.data(), a.y.data(), a.z.data(), a.w.data()};
+        BasicConstQuatLanePtr<REAL> pb   = {b.x.data(), b.y.data(), b.z.data(), b.w.data()};
+        BasicQuatLanePtr<REAL>      pout = {out.x.data(), out.y.data(), out.z.data(), out.w.data()};
+
+        switch (op)
+        {
+            case OP_ADD:        table.add(pa, pb, pout, 0, n);       break;
+            case OP_SUBTRACT:   table.subtract(pa, pb, pout, 0, n);  break;
+            case OP_PRODUCT:    table.product(pa, pb, pout, 0, n);   break;
+            case OP_CONJUGATE:  table.conjugate(pa, pout, 0, n);     break;
+            case OP_INVERSE:    table.inverse(pa, pout, 0, n);       break;
+            case OP_NEGATE:     table.negate(pa, pout, 0, n);        break;
+            case OP_NORMALIZE:  table.normalize(pa, pout, 0, n);     break;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            RefQuat expected = refQuatOp(op, laneQuat(a, i), laneQuat(b, i));
+            RefQuat actual   = laneQuat(out, i);
+
+            double size  = std::max(1.0, sqrt(expected.x * expected.x + expected.y * expected.y + expected.z * expected.z + expected.w * expected.w));
+            double error = std::max(std::max(fabs(actual.x - expected.x), fabs(actual.y - expected.y)),
+                                    std::max(fabs(actual.z - expected.z), fabs(actual.w - expected.w))) / size;
+
+            if (!(error <= tolerance))
+            {
+                return fail(test, "%s, length %zu, element %zu: (%g, %g, %g, %g), expected (%g, %g, %g, %g)",
+                            QUAT_OP_NAMES[op], n, i, actual.x, actual.y, actual.z, actual.w,
+                            expected.x, expected.y, expected.z, expected.w);
+            }
+        }
+
+        for (size_t i = n; i < n + CANARY; i++)
+        {
+            if (out.x[i] != REAL(42) || out.y[i] != REAL(42) || out.z[i] != REAL(42) || out.w[i] != REAL(42))
+            {
+                return fail(test, "%s, length %zu: wrote past the end of the range", QUAT_OP_NAMES[op], n);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+template <typename REAL>
+static bool checkQuatTableOps(const char *test, const BasicQuatKernelTable<REAL> &table, double tolerance)
+{
+    for (int op = OP_ADD; op <= OP_NORMALIZE; op++)
+    {
+        if (!checkQuatTable(test, table, (QuatOp) op, tolerance))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/** The AVX2 tables may only be called on CPUs that have AVX2. */
+static bool hasAVX2()
+{
+    if (simdISA() < SIMD_AVX2)
+    {
+        printf("    AVX2 is not available here, or XFORM_ARRAY_SIMD caps it; skipped\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool testQuatKernelsScalar()
+{
+    return checkQuatTableOps("quatKernels.scalar",       SCALAR_QUAT_KERNELS,   1.0e-15) &&
+           checkQuatTableOps("quatKernels.scalar.float", SCALAR_QUAT_KERNELS_F, 1.0e-6);
+}
+
+
+static bool testQuatKernelsSSE2()
+{
+#if XFORM_ARRAY_X86
+    return checkQuatTableOps("quatKernels.sse2",       SSE2_QUAT_KERNELS,   1.0e-15) &&
+           checkQuatTableOps("quatKernels.sse2.float", SSE2_QUAT_KERNELS_F, 1.0e-6);
+#else
+    return true;
+#endif
+}
+
+
+static bool testQuatKernelsAVX2()
+{
+#if XFORM_ARRAY_X86
+    if (!hasAVX2())
+    {
+        return true;
+    }
+
+    return checkQuatTableOps("quatKernels.avx2",       AVX2_QUAT_KERNELS,   1.0e-15) &&
+           checkQuatTableOps("quatKernels.avx2.float", AVX2_QUAT_KERNELS_F, 1.0e-6);
+#else
+    return true;
+#endif
+}
+
+
+/** The public kernels broadcast a single quaternion, and pad a shorter input with the identity. */
+static bool testQuatKernelsBroadcast()
+{
+    const char *test = "quatKernels.broadcast";
+
+    QuatLanes many, one, shorter, out;
+    fillTestLanes(many, 1001);
+    fillTestLanes(one, 1);
+    fillTestLanes(shorter, 600);
+
+    one.x[0] = 0.1; one.y[0] = 0.2; one.z[0] = 0.3; one.w[0] = 0.9;
+
+    quatArrayProduct(many, one, out);
+
+    if (out.size() != many.size())
+    {
+        return fail(test, "product with one quaternion has %zu elements, expected %zu", out.size(), many.size());
+    }
+
+    for (size_t i = 0; i < many.size(); i++)
+    {
+        RefQuat expected = refProduct(laneQuat(many, i), laneQuat(one, 0));
+
+        if (fabs(out.x[i] - expected.x) > 1.0e-12 || fabs(out.w[i] - expected.w) > 1.0e-12)
+        {
+            return fail(test, "broadcast product differs at element %zu", i);
+        }
+    }
+
+    quatArraySubtract(shorter, many, out);
+
+    for (size_t i = 0; i < many.size(); i++)
+    {
+        RefQuat a = i < shorter.size() ? laneQuat(shorter, i) : RefQuat{0.0, 0.0, 0.0, 1.0};
+        RefQuat expected = refQuatOp(OP_SUBTRACT, a, laneQuat(many, i));
+
+        if (out.x[i] != expected.x || out.y[i] != expected.y || out.z[i] != expected.z || out.w[i] != expected.w)
+        {
+            return fail(test, "padded subtract differs at element %zu", i);
+        }
+    }
+
+    // The output may be one of the inputs.
+    QuatLanes inPlace = many;
+    quatArrayNormalize(inPlace, inPlace);
+
+    for (size_t i = 0; i < many.size(); i++)
+    {
+        RefQuat expected = refNormalize(laneQuat(many, i));
+
+        if (fabs(inPlace.w[i] - expected.w) > 1.0e-15)
+        {
+            return fail(test, "in-place normalize differs at element %zu", i);
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Matrix kernels                                                           */
+/* ------------------------------------------------------------------------ */
+
+/** Lengths on either side of the parallel grain, and of the serial cutoff. */
+static const size_t MATRIX_TEST_LENGTHS[] = {0, 1, 2, 3, 1023, 1024, 1025, 4097};
+
+/** Random matrices, with the diagonal pushed away from zero so that they are well conditioned. */
+static std::vector<double> randomMatrices(size_t n)
+{
+    std::vector<double> m(n * MATRIX_SIZE);
+
+    for (size_t i = 0; i < m.size(); i++)
+    {
+        m[i] = randomValue() + ((i % MATRIX_SIZE) % 5 == 0 ? 4.0 : 0.0);
+    }
+
+    return m;
+}
+
+
+/** The product written out plainly, adding the terms in the order the kernels do. */
+static void refMatrixProduct(const double *a, const double *b, double *r)
+{
+    for (size_t i = 0; i < 4; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            r[i * 4 + j] = ((a[i * 4 + 0] * b[0 * 4 + j] + a[i * 4 + 1] * b[1 * 4 + j]) + a[i * 4 + 2] * b[2 * 4 + j]) + a[i * 4 + 3] * b[3 * 4 + j];
+        }
+    }
+}
+
+
+/** Gauss-Jordan elimination with partial pivoting, in long double. Returns false if m is singular. */
+static bool refMatrixInverse(const double *m, double *r)
+{
+    long double a[4][8];
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            a[i][j]     = m[i * 4 + j];
+            a[i][j + 4] = i == j ? 1.0L : 0.0L;
+        }
+    }
+
+    for (size_t column = 0; column < 4; column++)
+    {
+        size_t pivot = column;
+
+        for (size_t i = column + 1; i < 4; i++)
+        {
+            if (fabsl(a[i][column]) > fabsl(a[pivot][column])) { pivot = i; }
+        }
+
+        if (a[pivot][column] == 0.0L) { return false; }
+
+        for (size_t j = 0; j < 8; j++) { std::swap(a[column][j], a[pivot][j]); }
+
+        long double s = 1.0L / a[column][column];
+        for (size_t j = 0; j < 8; j++) { a[column][j] *= s; }
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            if (i == column) { continue; }
+
+            long double f = a[i][column];
+            for (size_t j = 0; j < 8; j++) { a[i][j] -= f * a[column][j]; }
+        }
+    }
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            r[i * 4 + j] = (double) a[i][j + 4];
+        }
+    }
+
+    return true;
+}
+
+
+/**
+    Runs multiply and transpose from one kernel table over every test 
+    length. They must match the reference exactly, as the kernels add the
+    terms in the same order, and must not write past the end of the range.
+    Each is also run in place, over either input.
+*/
+static bool checkMatrixTable(const char *test, const MatrixKernelTable &table)
+{
+    const double CANARY = 42.0;
+
+    for (size_t n : MATRIX_TEST_LENGTHS)
+    {
+        std::vector<double> a = randomMatrices(n);
+        std::vector<double> b = randomMatrices(n);
+        std::vector<double> product(n * MATRIX_SIZE + MATRIX_SIZE, CANARY);
+        std::vector<double> transposed(n * MATRIX_SIZE + MATRIX_SIZE, CANARY);
+
+        table.multiply(a.data(), b.data(), product.data(), 0, n);
+        table.transpose(a.data(), transposed.data(), 0, n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            double expected[16];
+            refMatrixProduct(&a[i * MATRIX_SIZE], &b[i * MATRIX_SIZE], expected);
+
+            for (size_t k = 0; k < MATRIX_SIZE; k++)
+            {
+                if (bitsFromDouble(product[i * MATRIX_SIZE + k]) != bitsFromDouble(expected[k]))
+                {
+                    return fail(test, "multiply, length %zu, matrix %zu, element %zu: %.17g, expected %.17g", n, i, k, product[i * MATRIX_SIZE + k], expected[k]);
+                }
+
+                if (transposed[i * MATRIX_SIZE + k] != a[i * MATRIX_SIZE + (k % 4) * 4 + k / 4])
+                {
+                    return fail(test, "transpose, length %zu, matrix %zu, element %zu", n, i, k);
+                }
+            }
+        }
+
+        for (size_t k = n * MATRIX_SIZE; k < product.size(); k++)
+        {
+            if (product[k] != CANARY || transposed[k] != CANARY)
+            {
+                return fail(test, "length %zu: wrote past the end of the range", n);
+            }
+        }
+
+        std::vector<double> inPlace = a;
+        table.multiply(inPlace.data(), b.data(), inPlace.data(), 0, n);
+
+        if (!std::equal(inPlace.begin(), inPlace.end(), product.begin()))
+        {
+            return fail(test, "multiply in place over the first input, length %zu, differs", n);
+        }
+
+        inPlace = b;
+        table.multiply(a.data(), inPlace.data(), inPlace.data(), 0, n);
+
+        if (!std::equal(inPlace.begin(), inPlace.end(), product.begin()))
+        {
+            return fail(test, "multiply in place over the second input, length %zu, differs", n);
+        }
+
+        inPlace = a;
+        table.transpose(inPlace.data(), inPlace.data(), 0, n);
+
+        if (!std::equal(inPlace.begin(), inPlace.end(), transposed.begin()))
+        {
+            return fail(test, "transpose in place, length %zu, differs", n);
+        }
+    }
+
+    return true;
+}
+
+
+static bool testMatrixKernelsScalar()
+{
+    return checkMatrixTable("matrixKernels.scalar", SCALAR_MATRIX_KERNELS);
+}
+
+
+static bool testMatrixKernelsSSE2()
+{
+#if XFORM_ARRAY_X86
+    return checkMatrixTable("matrixKernels.sse2", SSE2_MATRIX_KERNELS);
+#else
+    return true;
+#endif
+}
+
+
+static bool testMatrixKernelsAVX2()
+{
+#if XFORM_ARRAY_X86
+    if (!hasAVX2())
+    {
+        return true;
+    }
+
+    return checkMatrixTable("matrixKernels.avx2", AVX2_MATRIX_KERNELS);
+#else
+    return true;
+#endif
+}
+
+
+/** The public kernels run the selected table in parallel, and may also be used in place. */
+static bool testMatrixKernelsPublic()
+{
+    const char *test = "matrixKernels.public";
+    const size_t n = 4097;
+
+    std::vector<double> a = randomMatrices(n);
+    std::vector<double> b = randomMatrices(n);
+    std::vector<double> expected(n * MATRIX_SIZE);
+    std::vector<double> out(n * MATRIX_SIZE);
+
+    SCALAR_MATRIX_KERNELS.multiply(a.data(), b.data(), expected.data(), 0, n);
+    matrixArrayMultiply(a.data(), b.data(), out.data(), n);
+
+    if (out != expected)
+    {
+        return fail(test, "matrixArrayMultiply differs from the scalar kernel");
+    }
+
+    matrixArrayMultiply(a.data(), b.data(), a.data(), n);
+
+    if (a != expected)
+    {
+        return fail(test, "matrixArrayMultiply in place differs from the scalar kernel");
+    }
+
+    SCALAR_MATRIX_KERNELS.transpose(b.data(), expected.data(), 0, n);
+    matrixArrayTranspose(b.data(), b.data(), n);
+
+    if (b != expected)
+    {
+        return fail(test, "matrixArrayTranspose in place differs from the scalar kernel");
+    }
+
+    return true;
+}
+
+
+/**
+    Inverts a mix of affine and general matrices, some of them singular,
+    across several parallel chunks. The inverses are compared with an exact
+    elimination, singular matrices must be reported in order and left 
+    untouched, and inverting in place must give the same result.
+*/
+static bool testMatrixKernelsInverse()
+{
+    const char *test = "matrixKernels.inverse";
+    const size_t n = 5001;
+    const double CANARY = 42.0;
+
+    std::vector<double> m = randomMatrices(n);
+    std::vector<size_t> expectedSingular;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double *a = &m[i * MATRIX_SIZE];
+
+        // Every other matrix is affine, so that both inverses are used.
+        if (i % 2 == 0)
+        {
+            a[3] = a[7] = a[11] = 0.0;
+            a[15] = 1.0;
+        }
+
+        // A zero row, or a zero scale, makes the determinant exactly zero.
+        if (i % 97 == 0)
+        {
+            a[4] = a[5] = a[6] = a[7] = 0.0;
+            expectedSingular.push_back(i);
+        }
+        else if (i % 101 == 0 && i % 2 == 0)
+        {
+            a[0] = a[1] = a[2] = 0.0;
+            expectedSingular.push_back(i);
+        }
+    }
+
+    std::sort(expectedSingular.begin(), expectedSingular.end());
+
+    std::vector<double> out(n * MATRIX_SIZE, CANARY);
+    std::vector<size_t> singular(1, n);
+
+    matrixArrayFastInverse(m.data(), out.data(), n, singular);
+
+    if (singular.size() != expectedSingular.size() + 1 || singular[0] != n || !std::equal(expectedSingular.begin(), expectedSingular.end(), singular.begin() + 1))
+    {
+        return fail(test, "reported %zu singular matrices after the one already listed, expected %zu", singular.size() - 1, expectedSingular.size());
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const double *a = &m[i * MATRIX_SIZE];
+        const double *r = &out[i * MATRIX_SIZE];
+
+        double expected[16];
+        bool isSingular = std::binary_search(expectedSingular.begin(), expectedSingular.end(), i);
+
+        if (isSingular)
+        {
+            for (size_t k = 0; k < MATRIX_SIZE; k++)
+            {
+                if (r[k] != CANARY)
+                {
+                    return fail(test, "the output of singular matrix %zu was written", i);
+                }
+            }
+
+            continue;
+        }
+
+        if (!refMatrixInverse(a, expected))
+        {
+            return fail(test, "matrix %zu has no reference inverse", i);
+        }
+
+        for (size_t k = 0; k < MATRIX_SIZE; k++)
+        {
+            if (!(fabs(r[k] - expected[k]) <= 1.0e-13 * std::max(1.0, fabs(expected[k]))))
+            {
+                return fail(test, "%s matrix %zu, element %zu: %.17g, expected %.17g", i % 2 == 0 ? "affine" : "general", i, k, r[k], expected[k]);
+            }
+        }
+
+        if (i % 2 == 0 && (r[3] != 0.0 || r[7] != 0.0 || r[11] != 0.0 || r[15] != 1.0))
+        {
+            return fail(test, "the inverse of affine matrix %zu is not affine", i);
+        }
+    }
+
+    std::vector<double> inPlace = m;
+    std::vector<size_t> inPlaceSingular;
+
+    matrixArrayFastInverse(inPlace.data(), inPlace.data(), n, inPlaceSingular);
+
+    if (inPlaceSingular != expectedSingular)
+    {
+        return fail(test, "inverting in place reported different singular matrices");
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        bool isSingular = std::binary_search(expectedSingular.begin(), expectedSingular.end(), i);
+        const double *expected = isSingular ? &m[i * MATRIX_SIZE] : &out[i * MATRIX_SIZE];
+
+        if (!std::equal(expected, expected + MATRIX_SIZE, inPlace.begin() + i * MATRIX_SIZE))
+        {
+            return fail(test, "inverting matrix %zu in place differs", i);
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Matrix composition                                                       */
+/* ------------------------------------------------------------------------ */
+
+static void refRotation3x3Product(const double a[3][3], const double b[3][3], double out[3][3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            out[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+        }
+    }
+}
+
+
+/** The largest difference between two runs of doubles. */
+static double maxDifference(const double *a, const double *b, size_t n)
+{
+    double difference = 0.0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        difference = std::max(difference, fabs(a[i] - b[i]));
+    }
+
+    return difference;
+}
+
+
+/**
+    Composes matrices from random components, with shear, in all six 
+    rotation orders, and decomposes them again. The rotation must apply its
+    axes in order, and the components must come back. Two negative scales 
+    are a rotation by 180 degrees, so only the matrix comes back; one or 
+    three mirror the matrix, which decomposeMatrix must refuse so that the
+    node falls back to MTransformationMatrix.
+*/
+static bool testMatrixComposeRoundTrip()
+{
+    const char *test = "matrixCompose.roundTrip";
+    const double TOLERANCE = 1.0e-12;
+
+    // Each negative scale is a bit of the index.
+    const double SIGNS[8][3] = {
+        { 1,  1,  1}, {-1,  1,  1}, { 1, -1,  1}, {-1, -1,  1},
+        { 1,  1, -1}, {-1,  1, -1}, { 1, -1, -1}, {-1, -1, -1}
+    };
+
+    for (int order = ROTATE_ORDER_XYZ; order <= ROTATE_ORDER_ZYX; order++)
+    {
+        for (size_t n = 0; n < 100; n++)
+        {
+            double angles[3]    = {randomValue() * PI, randomValue() * PI, randomValue() * PI};
+            double translate[3] = {randomValue() * 10.0, randomValue() * 10.0, randomValue() * 10.0};
+            double shear[3]     = {randomValue(), randomValue(), randomValue()};
+            double size[3]      = {1.5 + randomValue(), 1.5 + randomValue(), 1.5 + randomValue()};
+
+            double rotate[3][3];
+            eulerToRotation(angles[0], angles[1], angles[2], order, rotate);
+
+            // The first axis of the order is applied first, and rows are vectors, so it is on the left.
+            double axes[3][3][3];
+            eulerToRotation(angles[0], 0.0, 0.0, ROTATE_ORDER_XYZ, axes[0]);
+            eulerToRotation(0.0, angles[1], 0.0, ROTATE_ORDER_XYZ, axes[1]);
+            eulerToRotation(0.0, 0.0, angles[2], ROTATE_ORDER_XYZ, axes[2]);
+
+            const int AXIS_ORDER[6][3] = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {0, 2, 1}, {1, 0, 2}, {2, 1, 0}};
+            const int *axis = AXIS_ORDER[order];
+
+            double firstTwo[3][3], expectedRotate[3][3];
+            refRotation3x3Product(axes[axis[0]], axes[axis[1]], firstTwo);
+            refRotation3x3Product(firstTwo, axes[axis[2]], expectedRotate);
+
+            if (maxDifference(&rotate[0][0], &expectedRotate[0][0], 9) > TOLERANCE)
+            {
+                return fail(test, "order %d does not apply its axes in order", order);
+            }
+
+            for (size_t signs = 0; signs < 8; signs++)
+            {
+                double scale[3] = {size[0] * SIGNS[signs][0], size[1] * SIGNS[signs][1], size[2] * SIGNS[signs][2]};
+                bool isMirrored = scale[0] * scale[1] * scale[2] < 0.0;
+
+                double m[16];
+                composeMatrix(translate, rotate, scale, shear, m);
+
+                MatrixComponents components;
+
+                if (!decomposeMatrix(m, components))
+                {
+                    if (isMirrored) { continue; }
+                    return fail(test, "order %d, scale (%g, %g, %g): could not decompose", order, scale[0], scale[1], scale[2]);
+                }
+
+                if (isMirrored)
+                {
+                    return fail(test, "order %d, scale (%g, %g, %g): decomposed a mirrored matrix", order, scale[0], scale[1], scale[2]);
+                }
+
+                if (maxDifference(components.translate, translate, 3) != 0.0)
+                {
+                    return fail(test, "order %d: translate did not come back", order);
+                }
+
+                double decomposedRotate[3][3];
+
+                for (int i = 0; i < 3; i++)
+                {
+                    for (int j = 0; j < 3; j++)
+                    {
+                        decomposedRotate[i][j] = components.rotate[i][j];
+                    }
+                }
+
+                double recomposed[16];
+                composeMatrix(components.translate, decomposedRotate, components.scale, components.shear, recomposed);
+
+                if (maxDifference(recomposed, m, 16) > TOLERANCE * 10.0)
+                {
+                    return fail(test, "order %d, scale (%g, %g, %g): the components do not compose the matrix", order, scale[0], scale[1], scale[2]);
+                }
+
+                if (signs != 0)
+                {
+                    continue;
+                }
+
+                if (maxDifference(&decomposedRotate[0][0], &rotate[0][0], 9) > TOLERANCE ||
+                    maxDifference(components.scale, scale, 3) > TOLERANCE ||
+                    maxDifference(components.shear, shear, 3) > TOLERANCE)
+                {
+                    return fail(test, "order %d, angles (%g, %g, %g): rotate (%g), scale (%g) or shear (%g) did not come back",
+                                order, angles[0], angles[1], angles[2],
+                                maxDifference(&decomposedRotate[0][0], &rotate[0][0], 9),
+                                maxDifference(components.scale, scale, 3),
+                                maxDifference(components.shear, shear, 3));
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Dirty ranges                                                             */
+/* ------------------------------------------------------------------------ */
+
+static bool isSameLanes(const QuatLanes &a, const QuatLanes &b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+
+/**
+    Edits one element of a 100k array, as a node's input would change, and 
+    checks that the range found holds only that element. Each ranged kernel,
+    run over the previous output, must then give the whole recomputed output
+    while leaving every element outside the range as it was.
+*/
+static bool testDirtyRangeRecompute()
+{
+    const char *test = "dirtyRange.recompute";
+    const size_t n = 100000;
+    const size_t edited = 54321;
+
+    QuatLanes input, other, one;
+    fillTestLanes(input, n);
+    fillTestLanes(other, n);
+    fillTestLanes(one, 1);
+
+    QuatLanes changedInput = input;
+    changedInput.x[edited] += 0.5;
+
+    auto isSame = [&](size_t i) 
+    { 
+        return input.x[i] == changedInput.x[i] && input.y[i] == changedInput.y[i] && input.z[i] == changedInput.z[i] && input.w[i] == changedInput.w[i];
+    };
+
+    DirtyRange changes = findChangedRange(0, n, isSame);
+
+    if (changes.begin != edited || changes.end != edited + 1)
+    {
+        return fail(test, "editing element %zu gave the range [%zu, %zu)", edited, changes.begin, changes.end);
+    }
+
+    if (!findChangedRange(0, n, [](size_t) { return true; }).empty())
+    {
+        return fail(test, "an unchanged array gave a range");
+    }
+
+    DirtyRange ends = findChangedRange(0, n, [&](size_t i) { return i != 0 && i != n - 1; });
+
+    if (ends.begin != 0 || ends.end != n)
+    {
+        return fail(test, "editing the first and last elements gave the range [%zu, %zu)", ends.begin, ends.end);
+    }
+
+    typedef std::function<void(const QuatLanes&, QuatLanes&)>                    FullOp;
+    typedef std::function<void(const QuatLanes&, QuatLanes&, const DirtyRange&)> RangedOp;
+
+    struct RangeCase { const char *name; FullOp full; RangedOp ranged; };
+
+    const RangeCase rangeCases[] = {
+        {
+            "normalize",
+            [](const QuatLanes &q, QuatLanes &out) { quatArrayNormalize(q, out); },
+            [](const QuatLanes &q, QuatLanes &out, const DirtyRange &r) { quatArrayNormalize(q, out, r); }
+        },
+        {
+            "product",
+            [&](const QuatLanes &q, QuatLanes &out) { quatArrayProduct(q, other, out); },
+            [&](const QuatLanes &q, QuatLanes &out, const DirtyRange &r) { quatArrayProduct(q, other, out, r); }
+        },
+        {
+            "broadcast product",
+            [&](const QuatLanes &q, QuatLanes &out) { quatArrayProduct(one, q, out); },
+            [&](const QuatLanes &q, QuatLanes &out, const DirtyRange &r) { quatArrayProduct(one, q, out, r); }
+        }
+    };
+
+    for (const RangeCase &rangeCase : rangeCases)
+    {
+        QuatLanes previous, expected;
+        rangeCase.full(input, previous);
+        rangeCase.full(changedInput, expected);
+
+        QuatLanes reused = previous;
+        rangeCase.ranged(changedInput, reused, changes);
+
+        if (!isSameLanes(reused, expected))
+        {
+            return fail(test, "%s over the changed range differs from recomputing every element", rangeCase.name);
+        }
+
+        // Elements outside the range are not written, even if they are wrong.
+        QuatLanes marked = previous;
+        marked.w[edited - 1] = 42.0;
+        marked.w[edited + 1] = 42.0;
+
+        rangeCase.ranged(changedInput, marked, changes);
+
+        if (marked.w[edited - 1] != 42.0 || marked.w[edited + 1] != 42.0 || marked.w[edited] != expected.w[edited])
+        {
+            return fail(test, "%s wrote elements outside the changed range", rangeCase.name);
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Shared buffers                                                           */
+/* ------------------------------------------------------------------------ */
+
+/** The shares of a buffer's bytes, added over every copy, count the buffer once. */
+static bool testSharedBufferShare()
+{
+    const char *test = "sharedBuffer.share";
+    const size_t bytes = 3000 * sizeof(double);
+
+    typedef SharedBuffer<std::vector<double>> Buffer;
+
+    Buffer original;
+    original.set(std::vector<double>(3000, 1.0));
+
+    Buffer copy1(original);
+    Buffer copy2(original);
+
+    size_t total = original.share(bytes) + copy1.share(bytes) + copy2.share(bytes);
+
+    if (original.share(bytes) != bytes / 3 || total != bytes)
+    {
+        return fail(test, "three copies have shares of %zu bytes, adding up to %zu, expected %zu each", original.share(bytes), total, bytes / 3);
+    }
+
+    copy2.edit()[0] = 2.0;
+
+    if (copy2.share(bytes) != bytes || original.share(bytes) != bytes / 2)
+    {
+        return fail(test, "after an edit, shares are %zu and %zu bytes, expected %zu and %zu", copy2.share(bytes), original.share(bytes), bytes, bytes / 2);
+    }
+
+    return true;
+}
+
+
+static bool isSameContainer(const std::vector<double> &a, const std::vector<double> &b)
+{
+    return a == b;
+}
+
+
+static bool isSameContainer(const std::vector<Quaternion> &a, const std::vector<Quaternion> &b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(Quaternion)) == 0);
+}
+
+
+static bool isSameContainer(const QuatLanes &a, const QuatLanes &b)
+{
+    return isSameLanes(a, b);
+}
+
+
+/**
+    Writes to one copy of a SharedBuffer, through each of set, assign, 
+    edit and reset, must never be seen by another copy, with the element
+    types the array data types use. edit() and assign() must not copy a
+    container only one SharedBuffer holds.
+*/
+template <typename CONTAINER>
+static bool checkCopyOnWrite(const char *test, const char *type, const CONTAINER &values, const CONTAINER &otherValues)
+{
+    typedef SharedBuffer<CONTAINER> Buffer;
+
+    Buffer original;
+    original.set(CONTAINER(values));
+
+    Buffer edited(original);
+    edited.edit() = otherValues;
+
+    Buffer replaced(original);
+    replaced.set(CONTAINER(otherValues));
+
+    Buffer assigned(original);
+    assigned.assign(otherValues);
+
+    Buffer cleared(original);
+    cleared.reset();
+
+    if (!isSameContainer(original.get(), values))
+    {
+        return fail(test, "%s: a write to a copy changed the original", type);
+    }
+
+    if (!isSameContainer(edited.get(), otherValues) || !isSameContainer(replaced.get(), otherValues) || !isSameContainer(assigned.get(), otherValues) || !isSameContainer(cleared.get(), CONTAINER()))
+    {
+        return fail(test, "%s: a write to a copy was lost", type);
+    }
+
+    // A copy must keep its values when the original is written to as well.
+    Buffer copy(original);
+    original.edit() = otherValues;
+
+    if (!isSameContainer(copy.get(), values))
+    {
+        return fail(test, "%s: a write to the original changed a copy", type);
+    }
+
+    // Each buffer is now held once, so writes go to the container in place.
+    const CONTAINER *before = &edited.get();
+    edited.edit();
+    edited.assign(values);
+
+    if (edited.useCount() != 1 || &edited.get() != before || !isSameContainer(edited.get(), values))
+    {
+        return fail(test, "%s: a container held once was replaced by edit() or assign()", type);
+    }
+
+    Buffer empty;
+    Buffer otherEmpty;
+    empty.edit() = values;
+
+    if (!isSameContainer(otherEmpty.get(), CONTAINER()))
+    {
+        return fail(test, "%s: a write to an empty buffer changed another empty buffer", type);
+    }
+
+    return true;
+}
+
+
+static bool testSharedBufferCopyOnWrite()
+{
+    const char *test = "sharedBuffer.copyOnWrite";
+
+    std::vector<double> values(1000, 1.0), otherValues(10, 2.0);
+
+    std::vector<Quaternion> quats(1000), otherQuats(3);
+    for (Quaternion &q : quats)      { q = {randomValue(), randomValue(), randomValue(), randomValue()}; }
+    for (Quaternion &q : otherQuats) { q = {randomValue(), randomValue(), randomValue(), randomValue()}; }
+
+    QuatLanes lanes, otherLanes;
+    fillTestLanes(lanes, 1000);
+    fillTestLanes(otherLanes, 7);
+
+    return checkCopyOnWrite(test, "doubles", values, otherValues)
+        && checkCopyOnWrite(test, "quaternions", quats, otherQuats)
+        && checkCopyOnWrite(test, "quaternion lanes", lanes, otherLanes);
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Slerp                                                                    */
+/* ------------------------------------------------------------------------ */
+
+static RefQuat randomUnitQuat()
+{
+    RefQuat q = {randomValue(), randomValue(), randomValue(), randomValue()};
+    return refNormalize(q);
+}
+
+
+/** A unit quaternion at angle theta from p, in quaternion space. */
+static RefQuat quatAtAngle(const RefQuat &p, double theta)
+{
+    // Any unit quaternion orthogonal to p.
+    RefQuat r = randomUnitQuat();
+    double d = r.x * p.x + r.y * p.y + r.z * p.z + r.w * p.w;
+    RefQuat u = refNormalize({r.x - d * p.x, r.y - d * p.y, r.z - d * p.z, r.w - d * p.w});
+
+    double c = cos(theta), s = sin(theta);
+    RefQuat q = {c * p.x + s * u.x, c * p.y + s * u.y, c * p.z + s * u.z, c * p.w + s * u.w};
+    return q;
+}
+
+
+/**
+    Moves tween * (theta + spin * pi) along the great circle from p towards
+    q, or towards -q if that is nearer, which is what the extra-spin slerp
+    formula works out to. Pairs whose dot product is within 1e-6 of 1 are
+    interpolated linearly, as quatSlerp does.
+*/
+static RefQuat refSlerp(const RefQuat &p, RefQuat q, double tween, int spin)
+{
+    double c = p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w;
+
+    if (c < 0.0)
+    {
+        q = {-q.x, -q.y, -q.z, -q.w};
+        c = -c;
+    }
+
+    if (1.0 - c < 1.0e-6)
+    {
+        RefQuat r = {
+            (1.0 - tween) * p.x + tween * q.x, (1.0 - tween) * p.y + tween * q.y,
+            (1.0 - tween) * p.z + tween * q.z, (1.0 - tween) * p.w + tween * q.w
+        };
+        return r;
+    }
+
+    // The unit quaternion orthogonal to p in the plane of p and q.
+    RefQuat u = refNormalize({q.x - c * p.x, q.y - c * p.y, q.z - c * p.z, q.w - c * p.w});
+    double angle = tween * (acos(c) + spin * PI);
+
+    RefQuat r = {
+        cos(angle) * p.x + sin(angle) * u.x, cos(angle) * p.y + sin(angle) * u.y,
+        cos(angle) * p.z + sin(angle) * u.z, cos(angle) * p.w + sin(angle) * u.w
+    };
+    return r;
+}
+
+
+static double quatDistance(const RefQuat &a, const Quaternion &b)
+{
+    return std::max(std::max(fabs(a.x - b.x), fabs(a.y - b.y)), std::max(fabs(a.z - b.z), fabs(a.w - b.w)));
+}
+
+
+static const double SLERP_TWEENS[] = {0.0, 0.25, 0.5, 0.75, 1.0, -0.5, 1.5};
+
+/**
+    Checks quatArraySlerp against the great-circle reference with spins of
+    -1, 0 and 1, for pairs at angles across (0, pi], nearly equal pairs,
+    which are interpolated linearly, and opposite and nearly opposite 
+    pairs, which are the same rotation and take the shorter path.
+*/
+static bool testSlerpReference()
+{
+    const char *test = "quatSlerp.reference";
+    const double tolerance = 1.0e-10;
+
+    std::vector<Quaternion> q1, q2;
+    std::vector<const char*> kinds;
+
+    auto addPair = [&](const RefQuat &p, const RefQuat &q, const char *kind)
+    {
+        Quaternion a = {p.x, p.y, p.z, p.w}, b = {q.x, q.y, q.z, q.w};
+        q1.push_back(a);
+        q2.push_back(b);
+        kinds.push_back(kind);
+    };
+
+    for (int i = 0; i < 200; i++)
+    {
+        RefQuat p = randomUnitQuat();
+        addPair(p, quatAtAngle(p, 0.01 + (PI - 0.01) * (randomValue() * 0.5 + 0.5)), "apart");
+    }
+
+    for (int i = 0; i < 20; i++)
+    {
+        RefQuat p = randomUnitQuat();
+        RefQuat q = quatAtAngle(p, i % 2 == 0 ? 1.0e-5 : 1.0e-9);
+
+        addPair(p, q, "nearly equal");
+        addPair(p, p, "equal");
+        addPair(p, {-p.x, -p.y, -p.z, -p.w}, "opposite");
+        addPair(p, {-q.x, -q.y, -q.z, -q.w}, "nearly opposite");
+    }
+
+    const Quaternion identity = {0.0, 0.0, 0.0, 1.0};
+    std::vector<Quaternion> out(q1.size());
+
+    BroadcastView<Quaternion> view1(ArrayView<Quaternion>(q1), identity);
+    BroadcastView<Quaternion> view2(ArrayView<Quaternion>(q2), identity);
+
+    for (int spin = -1; spin <= 1; spin++)
+    {
+        for (double tween : SLERP_TWEENS)
+        {
+            quatArraySlerp(view1, view2, tween, spin, out.data(), out.size());
+
+            for (size_t i = 0; i < out.size(); i++)
+            {
+                RefQuat p = {q1[i].x, q1[i].y, q1[i].z, q1[i].w};
+                RefQuat q = {q2[i].x, q2[i].y, q2[i].z, q2[i].w};
+                RefQuat expected = refSlerp(p, q, tween, spin);
+
+                double error = quatDistance(expected, out[i]);
+
+                if (!(error <= tolerance))
+                {
+                    return fail(test, "%s pair %zu, spin %d, tween %g: got (%g, %g, %g, %g), expected (%g, %g, %g, %g)",
+                        kinds[i], i, spin, tween, out[i].x, out[i].y, out[i].z, out[i].w, expected.x, expected.y, expected.z, expected.w);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/**
+    The prepared path must give the same bits as the full one, as the node
+    switches between them when only tween changes, including when one 
+    input is a single broadcast quaternion or the other is shorter.
+*/
+static bool testSlerpPrepared()
+{
+    const char *test = "quatSlerp.prepared";
+    const Quaternion identity = {0.0, 0.0, 0.0, 1.0};
+
+    for (size_t n : QUAT_TEST_LENGTHS)
+    {
+        std::vector<Quaternion> q1(n), q2(n), single(1), shorter(n / 2);
+
+        for (Quaternion &q : q1) { RefQuat r = randomUnitQuat(); q = {r.x, r.y, r.z, r.w}; }
+        for (Quaternion &q : q2) { RefQuat r = randomUnitQuat(); q = {r.x, r.y, r.z, r.w}; }
+        for (Quaternion &q : shorter) { RefQuat r = randomUnitQuat(); q = {r.x, r.y, r.z, r.w}; }
+
+        // Equal and opposite pairs take the linear branch.
+        if (n > 2) { q2[1] = q1[1]; q2[2] = {-q1[2].x, -q1[2].y, -q1[2].z, -q1[2].w}; }
+
+        RefQuat r = randomUnitQuat();
+        single[0] = {r.x, r.y, r.z, r.w};
+
+        const std::vector<Quaternion> *seconds[] = {&q2, &single, &shorter};
+
+        for (const std::vector<Quaternion> *second : seconds)
+        {
+            BroadcastView<Quaternion> view1(ArrayView<Quaternion>(q1), identity);
+            BroadcastView<Quaternion> view2(ArrayView<Quaternion>(*second), identity);
+
+            for (int spin = -1; spin <= 1; spin++)
+            {
+                std::vector<QuatSlerpPair> pairs(n);
+                quatArraySlerpPrepare(view1, view2, spin, pairs.data(), n);
+
+                for (double tween : SLERP_TWEENS)
+                {
+                    std::vector<Quaternion> full(n), prepared(n);
+
+                    quatArraySlerp(view1, view2, tween, spin, full.data(), n);
+                    quatArraySlerpPrepared(view1, view2, pairs.data(), tween, prepared.data(), n);
+
+                    if (n > 0 && memcmp(full.data(), prepared.data(), n * sizeof(Quaternion)) != 0)
+                    {
+                        return fail(test, "n = %zu, second input of %zu, spin %d, tween %g: the prepared and full results differ", 
+                            n, second->size(), spin, tween);
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Sidecar files                                                            */
+/* ------------------------------------------------------------------------ */
+
+static std::string temporaryDirectory()
+{
+#if defined(_WIN32)
+    const char *directory = getenv("TEMP");
+    return directory != NULL ? std::string(directory) : std::string(".");
+#else
+    const char *directory = getenv("TMPDIR");
+    return directory != NULL ? std::string(directory) : std::string("/tmp");
+#endif
+}
+
+
+/** Returns true if file holds the numberOfItems * valuesPerItem values. */
+static bool isSameValues(const SidecarFile &file, const std::vector<double> &values)
+{
+    return file.numberOfItems() * file.valuesPerItem() == values.size() 
+        && memcmp(file.values(), values.data(), values.size() * sizeof(double)) == 0;
+}
+
+
+/**
+    Writes an array with and without a unit, and checks that each file 
+    holds its values and unit, that the unit is part of the file name,
+    that a path whose file is missing falls back to the file of the same
+    name in sidecarDirectory(), and that a file is not opened for an array
+    of a different length.
+*/
+static bool testSidecarRoundTrip()
+{
+    const char *test = "sidecarFile.roundTrip";
+    const unsigned valuesPerItem = 3;
+    const size_t numberOfItems = 1001;
+    const uint8_t unit = 2;
+
+    std::vector<double> values(numberOfItems * valuesPerItem);
+    for (double &value : values) { value = randomValue(); }
+
+    std::string directory = temporaryDirectory();
+    setSidecarDirectory(directory);
+
+    std::shared_ptr<const SidecarFile> plain = SidecarFile::write(values.data(), valuesPerItem, numberOfItems);
+    std::shared_ptr<const SidecarFile> withUnit = SidecarFile::write(values.data(), valuesPerItem, numberOfItems, unit);
+
+    if (!plain || !withUnit)
+    {
+        setSidecarDirectory(std::string());
+        return fail(test, "could not write a sidecar file to %s", directory.c_str());
+    }
+
+    std::string plainPath = plain->path();
+    std::string unitPath = withUnit->path();
+    plain.reset();
+    withUnit.reset();
+
+    bool isValid = true;
+
+    if (plainPath == unitPath)
+    {
+        isValid = fail(test, "the same values with and without a unit were written to the same file, %s", plainPath.c_str());
+    }
+
+    // Files without a unit are named as they were before units were recorded.
+    ContentHash hash;
+    hash.updateValue(valuesPerItem);
+    hash.updateValue((uint64_t) numberOfItems);
+    hash.update(values.data(), values.size() * sizeof(double));
+
+    char legacyName[32];
+    snprintf(legacyName, sizeof(legacyName), "%016llx.xfa", (unsigned long long) hash.digest());
+
+    if (plainPath.substr(plainPath.find_last_of("/\\") + 1) != legacyName)
+    {
+        isValid = fail(test, "%s is not named %s, as it was before units were recorded", plainPath.c_str(), legacyName);
+    }
+
+    std::shared_ptr<const SidecarFile> file = SidecarFile::open(plainPath, valuesPerItem, numberOfItems);
+
+    if (!file || !isSameValues(*file, values) || file->valueUnit() != 0)
+    {
+        isValid = fail(test, "%s did not read back with its values and no unit", plainPath.c_str());
+    }
+
+    file = SidecarFile::open(unitPath, valuesPerItem, numberOfItems);
+
+    if (!file || !isSameValues(*file, values) || file->valueUnit() != unit)
+    {
+        isValid = fail(test, "%s did not read back with its values and unit %d", unitPath.c_str(), (int) unit);
+    }
+
+    file.reset();
+
+    // The directory a scene was saved with, which is not there any more.
+    size_t nameStart = unitPath.find_last_of("/\\") + 1;
+    std::string movedPath = directory + "/xformArrayCoreTests-missing/" + unitPath.substr(nameStart);
+
+    file = SidecarFile::open(movedPath, valuesPerItem, numberOfItems);
+
+    if (!file || file->path() != unitPath || !isSameValues(*file, values) || file->valueUnit() != unit)
+    {
+        isValid = fail(test, "%s did not fall back to %s", movedPath.c_str(), unitPath.c_str());
+    }
+
+    file = SidecarFile::open(unitPath, valuesPerItem, numberOfItems - 1);
+
+    if (file)
+    {
+        isValid = fail(test, "%s was opened for %zu items, but holds %zu", unitPath.c_str(), numberOfItems - 1, numberOfItems);
+    }
+
+    file.reset();
+    remove(plainPath.c_str());
+    remove(unitPath.c_str());
+    setSidecarDirectory(std::string());
+
+    return isValid;
+}
+
+
+static std::string readFileBytes(const std::string &path)
+{
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+
+static void writeFileBytes(const std::string &path, const std::string &bytes)
+{
+    std::ofstream out(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+
+/**
+    Writing an array whose file is already there must reuse the file only
+    if it still holds the array, and rewrite it if it was edited, cut
+    short or lengthened, or its header does not match.
+*/
+static bool testSidecarReuse()
+{
+    const char *test = "sidecarFile.reuse";
+    const unsigned valuesPerItem = 4;
+    const size_t numberOfItems = 1001;
+
+    std::vector<double> values(numberOfItems * valuesPerItem);
+    for (double &value : values) { value = randomValue(); }
+
+    std::string directory = temporaryDirectory();
+    setSidecarDirectory(directory);
+
+    std::shared_ptr<const SidecarFile> file = SidecarFile::write(values.data(), valuesPerItem, numberOfItems);
+
+    if (!file)
+    {
+        setSidecarDirectory(std::string());
+        return fail(test, "could not write a sidecar file to %s", directory.c_str());
+    }
+
+    const std::string path = file->path();
+    const std::string written = readFileBytes(path);
+    file.reset();
+
+    struct Damage
+    {
+        const char                          *name;
+        std::function<void(std::string&)>   apply;
+    };
+
+    const Damage damages[] = {
+        {"unchanged",               [](std::string&) {}},
+        {"a value edited",          [](std::string &bytes) { bytes[SIDECAR_HEADER_SIZE + 8 * 500 + 3] ^= 0x10; }},
+        {"the last value edited",   [](std::string &bytes) { bytes[bytes.size() - 1] ^= 0x01; }},
+        {"cut short",               [](std::string &bytes) { bytes.resize(bytes.size() - sizeof(double)); }},
+        {"lengthened",              [](std::string &bytes) { bytes.append(sizeof(double), '\0'); }},
+        {"the header hash changed", [](std::string &bytes) { bytes[24] ^= 0x01; }},
+        {"another unit",            [](std::string &bytes) { bytes[32] = 3; }}
+    };
+
+    bool isValid = true;
+
+    for (const Damage &damage : damages)
+    {
+        std::string bytes = written;
+        damage.apply(bytes);
+        writeFileBytes(path, bytes);
+
+        file = SidecarFile::write(values.data(), valuesPerItem, numberOfItems);
+
+        bool holdsValues = file && file->path() == path && memcmp(file->values(), values.data(), values.size() * sizeof(double)) == 0;
+        file.reset();
+
+        if (!holdsValues || readFileBytes(path) != written)
+        {
+            isValid = fail(test, "a file with %s was not rewritten with the values", damage.name);
+        }
+    }
+
+    remove(path.c_str());
+    setSidecarDirectory(std::string());
+
+    return isValid;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Vector kernels                                                           */
+/* ------------------------------------------------------------------------ */
+
+/**
+    Checks rotation by quaternions against the axis-angle formula, rotation
+    by euler rotations against rotation by the same rotations converted to 
+    quaternions, and that vectors past the end of the rotations are copied.
+*/
+static bool testVectorRotate()
+{
+    const char *test = "vectorKernels.rotate";
+    const size_t n = 1001;
+    const size_t numberOfRotations = 990;
+
+    std::vector<Vector3> v(n), byQuat(n), byEuler(n), byConverted(n);
+    std::vector<Quaternion> q(numberOfRotations), converted(numberOfRotations);
+    std::vector<EulerRotation> e(numberOfRotations);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        Vector3 r = {randomValue() * 10.0, randomValue() * 10.0, randomValue() * 10.0};
+        v[i] = r;
+    }
+
+    for (size_t i = 0; i < numberOfRotations; i++)
+    {
+        Vector3 axis = {randomValue(), randomValue(), randomValue()};
+        double length = sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+        double angle = randomValue() * 3.0;
+
+        Quaternion r = {
+            axis.x / length * sin(angle / 2.0), 
+            axis.y / length * sin(angle / 2.0), 
+            axis.z / length * sin(angle / 2.0), 
+            cos(angle / 2.0)
+        };
+        q[i] = r;
+
+        EulerRotation euler = {randomValue() * 3.0, randomValue() * 3.0, randomValue() * 3.0, (int) (i % 6)};
+        e[i] = euler;
+    }
+
+    vectorArrayRotateByQuat(v, q, byQuat.data());
+    vectorArrayRotateByEuler(v, e, byEuler.data());
+
+    eulerArrayToQuat(e.data(), numberOfRotations, converted.data());
+    vectorArrayRotateByQuat(v, converted, byConverted.data());
+
+    for (size_t i = 0; i < n; i++)
+    {
+        Vector3 expected = v[i];
+
+        if (i < numberOfRotations)
+        {
+            // Rodrigues' formula; a positive angle turns x towards y about z, as in Maya.
+            double s = sqrt(q[i].x * q[i].x + q[i].y * q[i].y + q[i].z * q[i].z);
+            double angle = 2.0 * atan2(s, q[i].w);
+            Vector3 k = {0.0, 0.0, 0.0};
+            if (s > 0.0) { k.x = q[i].x / s; k.y = q[i].y / s; k.z = q[i].z / s; }
+
+            const Vector3 &a = v[i];
+            double kDotA = k.x * a.x + k.y * a.y + k.z * a.z;
+            Vector3 kCrossA = {k.y * a.z - k.z * a.y, k.z * a.x - k.x * a.z, k.x * a.y - k.y * a.x};
+
+            expected.x = a.x * cos(angle) + kCrossA.x * sin(angle) + k.x * kDotA * (1.0 - cos(angle));
+            expected.y = a.y * cos(angle) + kCrossA.y * sin(angle) + k.y * kDotA * (1.0 - cos(angle));
+            expected.z = a.z * cos(angle) + kCrossA.z * sin(angle) + k.z * kDotA * (1.0 - cos(angle));
+        }
+
+        double quatError  = std::max(std::max(fabs(byQuat[i].x - expected.x), fabs(byQuat[i].y - expected.y)), fabs(byQuat[i].z - expected.z));
+        double eulerError = std::max(std::max(fabs(byEuler[i].x - byConverted[i].x), fabs(byEuler[i].y - byConverted[i].y)), fabs(byEuler[i].z - byConverted[i].z));
+
+        if (!(quatError <= 1.0e-12) || !(eulerError <= 1.0e-12))
+        {
+            return fail(test, "element %zu is off by %g rotated by a quaternion, and %g rotated by an euler rotation", i, quatError, eulerError);
+        }
+    }
+
+    // The quaternion kernel, like MVector::rotateBy, does not need unit quaternions.
+    Vector3 x = {1.0, 0.0, 0.0}, rotated;
+    Quaternion scaledQuarterTurn = {0.0, 0.0, 2.0 * sin(PI_4), 2.0 * cos(PI_4)};
+    vectorArrayRotateByQuat(ArrayView<Vector3>(&x, 1), ArrayView<Quaternion>(&scaledQuarterTurn, 1), &rotated);
+
+    if (fabs(rotated.x) > 1.0e-15 || fabs(rotated.y - 1.0) > 1.0e-15 || fabs(rotated.z) > 1.0e-15)
+    {
+        return fail(test, "x turned a quarter about z is (%g, %g, %g), expected (0, 1, 0)", rotated.x, rotated.y, rotated.z);
+    }
+
+    return true;
+}
+
+
+/**
+    The quaternion path of rotateVectorArray: quarter and half turns about
+    each axis give the vectors Maya does, and vectors without a quaternion,
+    up to every vector when there are none, are copied rather than zeroed.
+    The array is long enough to be split across threads.
+*/
+static bool testVectorRotateByQuat()
+{
+    const char *test = "vectorKernels.rotateByQuat";
+
+    struct Turn
+    {
+        Quaternion  q;
+        Vector3     v;
+        Vector3     expected;
+    };
+
+    const double h = sin(PI_4);
+
+    // A positive turn about z takes x towards y, about x takes y towards z, and about y takes z towards x.
+    const Turn TURNS[] = {
+        {{  h, 0.0, 0.0,   h}, {0.0, 1.0, 0.0}, { 0.0,  0.0,  1.0}},
+        {{0.0,   h, 0.0,   h}, {0.0, 0.0, 1.0}, { 1.0,  0.0,  0.0}},
+        {{0.0, 0.0,   h,   h}, {1.0, 0.0, 0.0}, { 0.0,  1.0,  0.0}},
+        {{0.0, 0.0,  -h,   h}, {1.0, 0.0, 0.0}, { 0.0, -1.0,  0.0}},
+        {{1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 2.0}, { 0.0, -1.0, -2.0}},
+        {{0.0, 0.0, 0.0, 1.0}, {3.0, 4.0, 5.0}, { 3.0,  4.0,  5.0}}
+    };
+
+    const size_t numberOfTurns = sizeof(TURNS) / sizeof(TURNS[0]);
+    const size_t n = 5000;
+    const size_t numberOfRotations = 4500;
+
+    std::vector<Vector3> v(n), out(n);
+    std::vector<Quaternion> q(numberOfRotations);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const Turn &turn = TURNS[i % numberOfTurns];
+        Vector3 scaled = {turn.v.x * (1.0 + i), turn.v.y * (1.0 + i), turn.v.z * (1.0 + i)};
+        v[i] = scaled;
+
+        if (i < numberOfRotations) { q[i] = turn.q; }
+    }
+
+    vectorArrayRotateByQuat(v, q, out.data());
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const Turn &turn = TURNS[i % numberOfTurns];
+        Vector3 expected = v[i];
+
+        if (i < numberOfRotations)
+        {
+            expected.x = turn.expected.x * (1.0 + i);
+            expected.y = turn.expected.y * (1.0 + i);
+            expected.z = turn.expected.z * (1.0 + i);
+        }
+
+        double error = std::max(std::max(fabs(out[i].x - expected.x), fabs(out[i].y - expected.y)), fabs(out[i].z - expected.z));
+
+        if (!(error <= 1.0e-15 * (1.0 + i) * 4.0))
+        {
+            return fail(test, "vector %zu is (%g, %g, %g), expected (%g, %g, %g)", i, out[i].x, out[i].y, out[i].z, expected.x, expected.y, expected.z);
+        }
+    }
+
+    vectorArrayRotateByQuat(v, ArrayView<Quaternion>(), out.data());
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (bitsFromDouble(out[i].x) != bitsFromDouble(v[i].x) ||
+            bitsFromDouble(out[i].y) != bitsFromDouble(v[i].y) ||
+            bitsFromDouble(out[i].z) != bitsFromDouble(v[i].z))
+        {
+            return fail(test, "vector %zu was not copied when there are no quaternions", i);
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Euler kernels                                                            */
+/* ------------------------------------------------------------------------ */
+
+/** Index of the middle and last axes of each rotation order, as in matrixCompose. */
+static const int MIDDLE_AXIS[6] = {1, 2, 0, 2, 0, 1};
+static const int LAST_AXIS[6]   = {2, 0, 1, 1, 2, 0};
+
+static double eulerAngle(const EulerRotation &e, int axis)
+{
+    return axis == 0 ? e.x : axis == 1 ? e.y : e.z;
+}
+
+
+static double rotationDifference(const EulerRotation &a, const EulerRotation &b)
+{
+    double ra[3][3], rb[3][3];
+    eulerToRotation(a.x, a.y, a.z, a.order, ra);
+    eulerToRotation(b.x, b.y, b.z, b.order, rb);
+
+    double difference = 0.0;
+
+    for (int j = 0; j < 3; j++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            difference = std::max(difference, fabs(ra[j][k] - rb[j][k]));
+        }
+    }
+
+    return difference;
+}
+
+
+/**
+    Checks the angles the euler kernels find, not only the rotations they 
+    describe. Angles inside the documented branch, with the middle angle in
+    (-pi/2, pi/2) and the others in (-pi, pi), must come back unchanged from
+    a round trip through quaternions. At the poles the last angle is 0, and
+    the first holds the whole turn about the other two axes.
+*/
+static bool testEulerAngles()
+{
+    const char *test = "eulerKernels.angles";
+    const size_t n = 10000;
+
+    std::vector<EulerRotation> e(n), back(n);
+    std::vector<Quaternion> q(n);
+
+    for (int order = ROTATE_ORDER_XYZ; order <= ROTATE_ORDER_ZYX; order++)
+    {
+        int middle = MIDDLE_AXIS[order];
+        int last = LAST_AXIS[order];
+
+        for (size_t i = 0; i < n; i++)
+        {
+            double angles[3] = {randomValue() * (PI - 1.0e-3), randomValue() * (PI - 1.0e-3), randomValue() * (PI - 1.0e-3)};
+            angles[middle] = randomValue() * (PI / 2.0 - 1.0e-3);
+
+            EulerRotation r = {angles[0], angles[1], angles[2], order};
+            e[i] = r;
+        }
+
+        eulerArrayToQuat(e.data(), n, q.data());
+        quatArrayToEuler(q.data(), n, order, back.data());
+
+        for (size_t i = 0; i < n; i++)
+        {
+            double error = std::max(std::max(fabs(back[i].x - e[i].x), fabs(back[i].y - e[i].y)), fabs(back[i].z - e[i].z));
+
+            if (!(error <= 1.0e-9) || back[i].order != order)
+            {
+                return fail(test, "order %d: (%.17g, %.17g, %.17g) came back off by %g", order, e[i].x, e[i].y, e[i].z, error);
+            }
+        }
+
+        // Any rotation is found inside the branch.
+        for (size_t i = 0; i < n; i++)
+        {
+            Quaternion r = {randomValue(), randomValue(), randomValue(), randomValue()};
+            q[i] = r;
+        }
+
+        quatArrayToEuler(q.data(), n, order, back.data());
+
+        for (size_t i = 0; i < n; i++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                double limit = axis == middle ? PI / 2.0 : PI;
+
+                if (!(fabs(eulerAngle(back[i], axis)) <= limit))
+                {
+                    return fail(test, "order %d: angle %d of element %zu is %.17g, outside [-%g, %g]", order, axis, i, eulerAngle(back[i], axis), limit, limit);
+                }
+            }
+        }
+
+        // At the poles, only the first angle turns.
+        for (size_t i = 0; i < n; i++)
+        {
+            double angles[3] = {randomValue() * (PI - 1.0e-3), randomValue() * (PI - 1.0e-3), randomValue() * (PI - 1.0e-3)};
+            angles[middle] = (i % 2 == 0 ? 1.0 : -1.0) * PI / 2.0;
+
+            EulerRotation r = {angles[0], angles[1], angles[2], order};
+            e[i] = r;
+        }
+
+        eulerArrayToQuat(e.data(), n, q.data());
+        quatArrayToEuler(q.data(), n, order, back.data());
+
+        for (size_t i = 0; i < n; i++)
+        {
+            double difference = rotationDifference(e[i], back[i]);
+
+            if (eulerAngle(back[i], last) != 0.0 || fabs(fabs(eulerAngle(back[i], middle)) - PI / 2.0) > 1.0e-7 || difference > 1.0e-9)
+            {
+                return fail(
+                    test, "order %d: the pole (%.17g, %.17g, %.17g) came back as (%.17g, %.17g, %.17g), off by %g", 
+                    order, e[i].x, e[i].y, e[i].z, back[i].x, back[i].y, back[i].z, difference
+                );
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Quaternion encodings                                                     */
+/* ------------------------------------------------------------------------ */
+
+static const size_t CODEC_TEST_LENGTHS[] = {0, 1, 2, 3, 17, 1001};
+
+static const char* const QUAT_ENCODING_NAMES[] = {"raw", "lossless", "smallestThree"};
+
+/** Random unit quaternions, with runs of repeated values, as animation often has. */
+static std::vector<Quaternion> randomUnitQuaternions(size_t n)
+{
+    std::vector<Quaternion> q(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        RefQuat r = randomUnitQuat();
+        q[i] = i > 0 && randomBits() % 4 == 0 ? q[i - 1] : Quaternion{r.x, r.y, r.z, r.w};
+    }
+
+    return q;
+}
+
+
+/** Encodes q after a prefix, which must be left as it was, and returns the encoded bytes alone. */
+static std::vector<uint8_t> encodeAfterPrefix(const std::vector<Quaternion> &q, QuatEncoding encoding, unsigned bits, QuatEncoding &encodedAs)
+{
+    const uint8_t prefix[3] = {0xAB, 0xCD, 0xEF};
+
+    std::vector<uint8_t> bytes(prefix, prefix + 3);
+    encodedAs = encodeQuaternions(q.data(), q.size(), encoding, bits, bytes);
+
+    if (memcmp(bytes.data(), prefix, 3) != 0) { bytes.clear(); return bytes; }
+
+    return std::vector<uint8_t>(bytes.begin() + 3, bytes.end());
+}
+
+
+/**
+    Lossless encoding must restore every bit, including NaN payloads, 
+    signed zeros, infinities and denormals, and arrays that compress too
+    little and are stored raw.
+*/
+static bool testCodecLossless()
+{
+    const char *test = "quatCodec.lossless";
+
+    const double special[] = {
+        0.0, -0.0, 1.0, -1.0, DBL_MIN, DBL_MAX, -DBL_MAX, 
+        doubleFromBits(0x0000000000000001ULL), doubleFromBits(0x800FFFFFFFFFFFFFULL),
+        doubleFromBits(0x7FF0000000000000ULL), doubleFromBits(0xFFF0000000000000ULL),
+        doubleFromBits(0x7FF8000000000000ULL), doubleFromBits(0x7FF0000000000001ULL), 
+        doubleFromBits(0xFFFFFFFFFFFFFFFFULL), doubleFromBits(0x7FF4000000ABCDEFULL)
+    };
+
+    const size_t numberOfSpecial = sizeof(special) / sizeof(special[0]);
+
+    for (size_t n : CODEC_TEST_LENGTHS)
+    {
+        // Unit quaternions, special values, and random bit patterns, which do not compress.
+        std::vector<Quaternion> inputs[3] = {randomUnitQuaternions(n), std::vector<Quaternion>(n), std::vector<Quaternion>(n)};
+
+        for (size_t i = 0; i < n; i++)
+        {
+            double *c = &inputs[1][i].x;
+            double *r = &inputs[2][i].x;
+
+            for (int j = 0; j < 4; j++) 
+            { 
+                c[j] = special[(i * 4 + j * 7) % numberOfSpecial]; 
+                r[j] = doubleFromBits(randomBits());
+            }
+        }
+
+        for (const std::vector<Quaternion> &q : inputs)
+        {
+            QuatEncoding encodedAs;
+            std::vector<uint8_t> bytes = encodeAfterPrefix(q, QUAT_ENCODING_LOSSLESS, 0, encodedAs);
+
+            if (encodedAs != QUAT_ENCODING_LOSSLESS && encodedAs != QUAT_ENCODING_RAW)
+            {
+                return fail(test, "n = %zu: lossless encoding fell back to %s", n, QUAT_ENCODING_NAMES[encodedAs]);
+            }
+
+            if (n > 0 && bytes.empty())
+            {
+                return fail(test, "n = %zu: the bytes before the encoded values were changed", n);
+            }
+
+            std::vector<Quaternion> decoded(n);
+
+            if (!decodeQuaternions(bytes.data(), bytes.size(), encodedAs, 0, decoded.data(), n))
+            {
+                return fail(test, "n = %zu: %zu %s bytes were not decoded", n, bytes.size(), QUAT_ENCODING_NAMES[encodedAs]);
+            }
+
+            if (n > 0 && memcmp(decoded.data(), q.data(), n * sizeof(Quaternion)) != 0)
+            {
+                return fail(test, "n = %zu: %s decoding did not restore every bit", n, QUAT_ENCODING_NAMES[encodedAs]);
+            }
+        }
+
+        // Repeated values must compress.
+        std::vector<Quaternion> repeated(n, Quaternion{0.0, 0.0, 0.0, 1.0});
+        QuatEncoding encodedAs;
+        std::vector<uint8_t> bytes = encodeAfterPrefix(repeated, QUAT_ENCODING_LOSSLESS, 0, encodedAs);
+
+        if (n > 1 && encodedAs != QUAT_ENCODING_LOSSLESS)
+        {
+            return fail(test, "n = %zu: repeated quaternions were stored as %s", n, QUAT_ENCODING_NAMES[encodedAs]);
+        }
+    }
+
+    return true;
+}
+
+
+/**
+    Smallest-three must restore each of the three smaller components to 
+    within 1 / (sqrt(2) * (2^bits - 1)), and the largest to within a few
+    times that, at every supported bit depth. Arrays with any quaternion 
+    that is not unit length must be stored losslessly instead.
+*/
+static bool testCodecSmallestThree()
+{
+    const char *test = "quatCodec.smallestThree";
+
+    for (unsigned bits = QUAT_ENCODING_MIN_BITS; bits <= QUAT_ENCODING_MAX_BITS; bits++)
+    {
+        const double bound = 1.0 / (sqrt(2.0) * (double) ((1ULL << bits) - 1)) + 1.0e-12;
+
+        for (size_t n : CODEC_TEST_LENGTHS)
+        {
+            std::vector<Quaternion> q = randomUnitQuaternions(n);
+
+            // Axis rotations, where two components tie for largest or the others are 0.
+            const double h = sqrt(0.5);
+            const Quaternion edges[] = {{0, 0, 0, 1}, {0, 0, 0, -1}, {1, 0, 0, 0}, {h, h, 0, 0}, {-h, 0, 0, h}, {0.5, -0.5, 0.5, -0.5}};
+
+            for (size_t i = 0; i < n && i < sizeof(edges) / sizeof(edges[0]); i++) { q[i] = edges[i]; }
+
+            QuatEncoding encodedAs;
+            std::vector<uint8_t> bytes = encodeAfterPrefix(q, QUAT_ENCODING_SMALLEST_THREE, bits, encodedAs);
+
+            if (encodedAs != QUAT_ENCODING_SMALLEST_THREE)
+            {
+                return fail(test, "%u bits, n = %zu: unit quaternions were stored as %s", bits, n, QUAT_ENCODING_NAMES[encodedAs]);
+            }
+
+            if (bytes.size() != (n * (3 + 3 * bits) + 7) / 8)
+            {
+                return fail(test, "%u bits, n = %zu: %zu bytes were written, expected %zu", bits, n, bytes.size(), (n * (3 + 3 * bits) + 7) / 8);
+            }
+
+            std::vector<Quaternion> decoded(n);
+
+            if (!decodeQuaternions(bytes.data(), bytes.size(), encodedAs, bits, decoded.data(), n))
+            {
+                return fail(test, "%u bits, n = %zu: the bytes were not decoded", bits, n);
+            }
+
+            for (size_t i = 0; i < n; i++)
+            {
+                const double *a = &q[i].x;
+                const double *b = &decoded[i].x;
+
+                int largest = 0;
+                for (int j = 1; j < 4; j++) { if (fabs(a[j]) > fabs(a[largest])) { largest = j; } }
+
+                for (int j = 0; j < 4; j++)
+                {
+                    double limit = j == largest ? 5.0 * bound : bound;
+
+                    if (!(fabs(a[j] - b[j]) <= limit))
+                    {
+                        return fail(test, "%u bits, quaternion %zu: component %d was %.17g, restored as %.17g, more than %g away", 
+                            bits, i, j, a[j], b[j], limit);
+                    }
+                }
+            }
+        }
+    }
+
+    // A single quaternion off unit length, or NaN, makes the whole array lossless.
+    const double offUnit[] = {1.0 + 1.0e-3, 0.5, 0.0, doubleFromBits(0x7FF8000000000000ULL)};
+
+    for (double w : offUnit)
+    {
+        std::vector<Quaternion> q = randomUnitQuaternions(100);
+        q[50] = Quaternion{0.0, 0.0, 0.0, w};
+
+        QuatEncoding encodedAs;
+        std::vector<uint8_t> bytes = encodeAfterPrefix(q, QUAT_ENCODING_SMALLEST_THREE, QUAT_ENCODING_DEFAULT_BITS, encodedAs);
+        std::vector<Quaternion> decoded(q.size());
+
+        if (encodedAs == QUAT_ENCODING_SMALLEST_THREE)
+        {
+            return fail(test, "an array with a quaternion of length %g was stored as smallest-three", w);
+        }
+
+        bool isDecoded = decodeQuaternions(bytes.data(), bytes.size(), encodedAs, QUAT_ENCODING_DEFAULT_BITS, decoded.data(), decoded.size());
+
+        if (!isDecoded || memcmp(decoded.data(), q.data(), q.size() * sizeof(Quaternion)) != 0)
+        {
+            return fail(test, "an array with a quaternion of length %g was not restored exactly from %s", w, QUAT_ENCODING_NAMES[encodedAs]);
+        }
+    }
+
+    return true;
+}
+
+
+/**
+    Truncated, extended or corrupt bytes, and headers that do not match 
+    their bytes, must be rejected rather than read past their end or 
+    decoded into other values.
+*/
+static bool testCodecCorrupt()
+{
+    const char *test = "quatCodec.corrupt";
+
+    std::vector<Quaternion> q = randomUnitQuaternions(257);
+    std::vector<Quaternion> decoded(q.size());
+
+    const QuatEncoding encodings[] = {QUAT_ENCODING_RAW, QUAT_ENCODING_LOSSLESS, QUAT_ENCODING_SMALLEST_THREE};
+    const unsigned bits = QUAT_ENCODING_DEFAULT_BITS;
+
+    for (QuatEncoding encoding : encodings)
+    {
+        const char *name = QUAT_ENCODING_NAMES[encoding];
+
+        QuatEncoding encodedAs;
+        std::vector<uint8_t> bytes = encodeAfterPrefix(q, encoding, bits, encodedAs);
+
+        if (encodedAs != encoding)
+        {
+            return fail(test, "%s was stored as %s", name, QUAT_ENCODING_NAMES[encodedAs]);
+        }
+
+        QuatEncodingHeader header = {(uint32_t) encoding, bits, (uint32_t) q.size(), (uint32_t) bytes.size()};
+
+        if (!isValidQuatEncodingHeader(header, bytes.size()))
+        {
+            return fail(test, "the %s header was rejected", name);
+        }
+
+        // The bytes end before the header says.
+        if (isValidQuatEncodingHeader(header, bytes.size() - 1))
+        {
+            return fail(test, "a %s header for %u bytes was accepted with %zu available", name, header.numberOfBytes, bytes.size() - 1);
+        }
+
+        // An item count that the bytes could not hold, which would otherwise be allocated.
+        QuatEncodingHeader tooMany = header;
+        tooMany.numberOfItems = 0xFFFFFFF0u;
+
+        if (isValidQuatEncodingHeader(tooMany, bytes.size()))
+        {
+            return fail(test, "a %s header for %u items in %u bytes was accepted", name, tooMany.numberOfItems, tooMany.numberOfBytes);
+        }
+
+        std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+        std::vector<uint8_t> extended(bytes);
+        extended.push_back(0);
+
+        if (decodeQuaternions(truncated.data(), truncated.size(), encoding, bits, decoded.data(), q.size()))
+        {
+            return fail(test, "%s bytes missing their last byte were decoded", name);
+        }
+
+        if (decodeQuaternions(extended.data(), extended.size(), encoding, bits, decoded.data(), q.size()))
+        {
+            return fail(test, "%s bytes with an extra byte were decoded", name);
+        }
+
+        if (decodeQuaternions(bytes.data(), 0, encoding, bits, decoded.data(), q.size()))
+        {
+            return fail(test, "no %s bytes were decoded as %zu quaternions", name, q.size());
+        }
+
+        // Every single byte changed, which must never read past the end.
+        for (size_t i = 0; i < bytes.size(); i += 7)
+        {
+            std::vector<uint8_t> corrupt(bytes);
+            corrupt[i] ^= (uint8_t) (1 + randomBits() % 255);
+            decodeQuaternions(corrupt.data(), corrupt.size(), encoding, bits, decoded.data(), q.size());
+        }
+    }
+
+    QuatEncodingHeader unknown = {3, 0, 1, 32};
+    QuatEncodingHeader badBits = {QUAT_ENCODING_SMALLEST_THREE, QUAT_ENCODING_MAX_BITS + 1, 1, 10};
+    QuatEncodingHeader badRaw = {QUAT_ENCODING_RAW, 0, 2, 32};
+
+    if (isValidQuatEncodingHeader(unknown, 32) || isValidQuatEncodingHeader(badBits, 10) || isValidQuatEncodingHeader(badRaw, 32))
+    {
+        return fail(test, "a header with an unknown encoding, unsupported bits, or a raw byte count for another length was accepted");
+    }
+
+    // A changed component whose leading zeros and length add up to more than 64 bits.
+    const uint8_t overlong[2] = {0xFF, 0xFF};
+
+    if (decodeQuaternions(overlong, 2, QUAT_ENCODING_LOSSLESS, 0, decoded.data(), 1))
+    {
+        return fail(test, "a lossless component of more than 64 bits was decoded");
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Content hash                                                             */
+/* ------------------------------------------------------------------------ */
+
+static uint64_t hashBytes(const std::vector<unsigned char> &bytes, size_t first, size_t last, uint64_t seed)
+{
+    ContentHash hash(seed);
+    hash.update(bytes.data() + first, last - first);
+    return hash.digest();
+}
+
+
+/** Checks digests published for XXH64 with seed 0. */
+static bool testContentHashKnown()
+{
+    const char *test = "contentHash.known";
+
+    struct KnownDigest { const char *text; uint64_t digest; };
+
+    const KnownDigest known[] = {
+        {"",    0xef46db3751d8e999ULL},
+        {"a",   0xd24ec4f1a98c6e5bULL},
+        {"abc", 0x44bc2cf5ad770999ULL}
+    };
+
+    for (const KnownDigest &k : known)
+    {
+        ContentHash hash;
+        hash.update(k.text, strlen(k.text));
+
+        if (hash.digest() != k.digest)
+        {
+            return fail(test, "\"%s\" hashes to %016llx, expected %016llx", k.text, (unsigned long long) hash.digest(), (unsigned long long) k.digest);
+        }
+    }
+
+    return true;
+}
+
+
+/**
+    Streamed updates must give the digest of hashing the same bytes at once,
+    however they are split. Lengths cover the 32-byte stripes and the 8, 4 
+    and 1-byte tails, and every split point is tried for shorter inputs.
+*/
+static bool testContentHashStreaming()
+{
+    const char *test = "contentHash.streaming";
+
+    std::vector<unsigned char> bytes(1000);
+
+    for (unsigned char &b : bytes)
+    {
+        b = (unsigned char) randomBits();
+    }
+
+    const uint64_t seeds[] = {0, 1, 0x9e3779b97f4a7c15ULL};
+
+    for (uint64_t seed : seeds)
+    {
+        for (size_t n = 0; n <= 200; n++)
+        {
+            uint64_t expected = hashBytes(bytes, 0, n, seed);
+
+            for (size_t split = 0; split <= n; split++)
+            {
+                ContentHash hash(seed);
+                hash.update(bytes.data(), split);
+                hash.update(bytes.data() + split, n - split);
+
+                if (hash.digest() != expected)
+                {
+                    return fail(test, "%zu bytes split at %zu with seed %llx differ from one update", n, split, (unsigned long long) seed);
+                }
+            }
+        }
+
+        // Many uneven updates, some empty, over the whole array.
+        ContentHash hash(seed);
+
+        for (size_t first = 0; first < bytes.size(); )
+        {
+            size_t size = std::min((size_t) (randomBits() % 70), bytes.size() - first);
+            hash.update(bytes.data() + first, size);
+            first += size;
+        }
+
+        if (hash.digest() != hashBytes(bytes, 0, bytes.size(), seed))
+        {
+            return fail(test, "uneven updates with seed %llx differ from one update", (unsigned long long) seed);
+        }
+
+        // The digest can be read without ending the stream.
+        ContentHash partial(seed);
+        partial.update(bytes.data(), 100);
+        partial.digest();
+        partial.update(bytes.data() + 100, 100);
+
+        if (partial.digest() != hashBytes(bytes, 0, 200, seed))
+        {
+            return fail(test, "reading the digest part way changed the final digest with seed %llx", (unsigned long long) seed);
+        }
+    }
+
+    ContentHash seeded(1);
+
+    if (seeded.digest() == ContentHash(0).digest())
+    {
+        return fail(test, "the seed does not change the digest");
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Double text                                                              */
+/* ------------------------------------------------------------------------ */
+
+/** Returns false, after printing why, if value does not format to text that parses back to the same bits. */
+static bool checkDoubleRoundTrip(const char *test, double value)
+{
+    char buffer[DOUBLE_TEXT_BUFFER_SIZE];
+    int length = formatDouble(value, buffer);
+
+    if (length <= 0 || (size_t) length >= DOUBLE_TEXT_BUFFER_SIZE || strlen(buffer) != (size_t) length)
+    {
+        return fail(test, "%.17g formatted to a length of %d", value, length);
+    }
+
+    double parsed = 0.0;
+
+    if (!parseDouble(buffer, parsed))
+    {
+        return fail(test, "%.17g formatted to \"%s\", which did not parse", value, buffer);
+    }
+
+    if (bitsFromDouble(parsed) != bitsFromDouble(value))
+    {
+        return fail(test, "%.17g formatted to \"%s\", which parsed to %.17g", value, buffer, parsed);
+    }
+
+    return true;
+}
+
+
+static bool testDoubleTextRoundTrip()
+{
+    const char *test = "doubleText.roundTrip";
+
+    const double special[] = {
+        0.0, -0.0, 1.0, -1.0, 0.1, 1.0 / 3.0, 1.0e23, 5.0e-324, -5.0e-324,
+        DBL_MIN, -DBL_MIN, DBL_MAX, -DBL_MAX, DBL_EPSILON, 
+        doubleFromBits(0x000FFFFFFFFFFFFFULL), // The largest subnormal.
+        doubleFromBits(0x0000000000000001ULL), // The smallest subnormal.
+        9007199254740993.0, 123456789012345678.0, 3.14159265358979323846
+    };
+
+    for (double value : special)
+    {
+        if (!checkDoubleRoundTrip(test, value)) { return false; }
+    }
+
+    // Random bit patterns cover every exponent; the non-finite ones are skipped.
+    for (int i = 0; i < 200000; i++)
+    {
+        double value = doubleFromBits(randomBits());
+        if (std::isfinite(value) && !checkDoubleRoundTrip(test, value)) { return false; }
+    }
+
+    // Random subnormals, which have fewer significant bits than other doubles.
+    for (int i = 0; i < 20000; i++)
+    {
+        double value = doubleFromBits((randomBits() & 0x800FFFFFFFFFFFFFULL) | 1);
+        if (!checkDoubleRoundTrip(test, value)) { return false; }
+    }
+
+    return true;
+}
+
+
+/** The text must be no longer than the shortest %g that round trips. */
+static bool testDoubleTextShortest()
+{
+    const char *test = "doubleText.shortest";
+
+    for (int i = 0; i < 20000; i++)
+    {
+        double value = i < 10000 ? doubleFromBits(randomBits()) : randomValue() * 1000.0;
+        if (!std::isfinite(value)) { continue; }
+
+        char buffer[DOUBLE_TEXT_BUFFER_SIZE];
+        int length = formatDouble(value, buffer);
+
+        char shortest[64];
+
+        for (int precision = 1; precision <= 17; precision++)
+        {
+            snprintf(shortest, sizeof(shortest), "%.*g", precision, value);
+            if (strtod(shortest, NULL) == value) { break; }
+        }
+
+        if ((size_t) length > strlen(shortest))
+        {
+            return fail(test, "%.17g formatted to \"%s\", but \"%s\" is shorter", value, buffer, shortest);
+        }
+    }
+
+    return true;
+}
+
+
+static bool testDoubleTextParse()
+{
+    const char *test = "doubleText.parse";
+
+    struct Accepted { const char *text; double value; };
+
+    const Accepted accepted[] = {
+        {"0", 0.0}, {"-0", -0.0}, {"1", 1.0}, {"+3", 3.0}, {"-2.5", -2.5}, 
+        {".5", 0.5}, {"5.", 5.0}, {"1e3", 1000.0}, {"1E-3", 0.001}, {"4.9406564584124654e-324", 5.0e-324}
+    };
+
+    for (const Accepted &a : accepted)
+    {
+        double value = 42.0;
+
+        if (!parseDouble(a.text, value) || bitsFromDouble(value) != bitsFromDouble(a.value))
+        {
+            return fail(test, "\"%s\" parsed to %.17g, expected %.17g", a.text, value, a.value);
+        }
+    }
+
+    const char *rejected[] = {
+        "", "+", "-", ".", "e5", "nan", "NaN", "-nan", "inf", "-inf", "Infinity", 
+        "0x1p3", "0X10", "1e400", "-1e400", "1.0abc", " 1", "1 ", "1,5", "--1", "1e"
+    };
+
+    for (const char *text : rejected)
+    {
+        double value = 42.0;
+
+        if (parseDouble(text, value))
+        {
+            return fail(test, "\"%s\" was accepted as %.17g", text, value);
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Parallel for                                                             */
+/* ------------------------------------------------------------------------ */
+
+/** Restores the thread limit and serial cutoff a test changed. */
+struct ParallelSettings
+{
+    unsigned    threadLimit  = parallelThreadLimit();
+    size_t      serialCutoff = parallelSerialCutoff();
+
+    ~ParallelSettings()
+    {
+        setParallelThreadLimit(threadLimit);
+        setParallelSerialCutoff(serialCutoff);
+    }
+};
+
+
+struct ParallelChunk
+{
+    size_t          begin;
+    size_t          end;
+    std::thread::id thread;
+};
+
+
+/** Runs parallelForRange, counting the visits to each index and recording each chunk. */
+static void runParallelRange(size_t begin, size_t end, size_t grainSize, std::vector<std::atomic<int>> &visits, std::vector<ParallelChunk> &chunks)
+{
+    std::mutex chunksMutex;
+
+    for (std::atomic<int> &visit : visits) { visit = 0; }
+    chunks.clear();
+
+    parallelForRange(begin, end, grainSize, [&](size_t chunkBegin, size_t chunkEnd)
+    {
+        for (size_t i = chunkBegin; i < chunkEnd; i++)
+        {
+            visits[i]++;
+        }
+
+        std::lock_guard<std::mutex> lock(chunksMutex);
+        ParallelChunk chunk = {chunkBegin, chunkEnd, std::this_thread::get_id()};
+        chunks.push_back(chunk);
+    });
+
+    std::sort(chunks.begin(), chunks.end(), [](const ParallelChunk &a, const ParallelChunk &b) { return a.begin < b.begin; });
+}
+
+
+/**
+    The thread limit comes from XFORM_ARRAY_THREADS when it is set. With a 
+    limit of 1, which CTest also runs these tests with, every range runs as
+    one call on the calling thread.
+*/
+static bool testParallelThreadLimit()
+{
+    const char *test = "parallel.threadLimit";
+
+    const char *requested = getenv("XFORM_ARRAY_THREADS");
+    unsigned expected = std::max(1u, std::thread::hardware_concurrency());
+
+    if (requested != NULL && atoi(requested) > 0)
+    {
+        expected = (unsigned) atoi(requested);
+    }
+
+    if (parallelThreadLimit() != expected)
+    {
+        return fail(test, "the thread limit is %u, expected %u with XFORM_ARRAY_THREADS=%s", parallelThreadLimit(), expected, requested ? requested : "(unset)");
+    }
+
+    ParallelSettings settings;
+    setParallelThreadLimit(1);
+
+    const size_t n = 100000;
+    std::vector<std::atomic<int>> visits(n);
+    std::vector<ParallelChunk> chunks;
+
+    runParallelRange(0, n, DEFAULT_GRAIN_SIZE, visits, chunks);
+
+    if (chunks.size() != 1 || chunks[0].begin != 0 || chunks[0].end != n || chunks[0].thread != std::this_thread::get_id())
+    {
+        return fail(test, "with a limit of 1, %zu elements ran as %zu calls, expected one on the calling thread", n, chunks.size());
+    }
+
+    setParallelThreadLimit(0);
+
+    if (parallelThreadLimit() != std::max(1u, std::thread::hardware_concurrency()))
+    {
+        return fail(test, "a limit of 0 gave %u threads, expected the number of hardware threads", parallelThreadLimit());
+    }
+
+    return true;
+}
+
+
+/**
+    Every index must be visited exactly once, on either side of the serial
+    cutoff and of the grain size, and with ranges that do not start at 0.
+    Ranges below the cutoff, or no longer than a grain, run as one call; 
+    longer ones are split into whole grains, counted from begin.
+*/
+static bool testParallelCoverage()
+{
+    const char *test = "parallel.coverage";
+
+    ParallelSettings settings;
+    setParallelThreadLimit(4);
+
+    const size_t LENGTHS[] = {
+        0, 1, 1023, 1024, 1025, 2048,
+        DEFAULT_SERIAL_CUTOFF - 1, DEFAULT_SERIAL_CUTOFF, DEFAULT_SERIAL_CUTOFF + 1,
+        6 * DEFAULT_GRAIN_SIZE - 1, 6 * DEFAULT_GRAIN_SIZE, 6 * DEFAULT_GRAIN_SIZE + 1,
+        100003
+    };
+
+    const size_t BEGINS[] = {0, 1, 1000};
+    const size_t GRAIN_SIZES[] = {DEFAULT_GRAIN_SIZE, 1000, 1, 0, 100000};
+
+    std::vector<std::atomic<int>> visits(100003 + 1000);
+    std::vector<ParallelChunk> chunks;
+
+    for (size_t grainSize : GRAIN_SIZES)
+    {
+        for (size_t begin : BEGINS)
+        {
+            for (size_t length : LENGTHS)
+            {
+                // A grain of 1 over the longest range is slow, and covered by the shorter ones.
+                if (grainSize == 1 && length > 10000) { continue; }
+
+                size_t end = begin + length;
+                runParallelRange(begin, end, grainSize, visits, chunks);
+
+                for (size_t i = 0; i < visits.size(); i++)
+                {
+                    int expected = i >= begin && i < end ? 1 : 0;
+
+                    if (visits[i] != expected)
+                    {
+                        return fail(test, "grain %zu, [%zu, %zu): index %zu was visited %d times", grainSize, begin, end, i, (int) visits[i]);
+                    }
+                }
+
+                size_t grain = std::max((size_t) 1, grainSize);
+                bool isSerial = length < DEFAULT_SERIAL_CUTOFF || length <= grain;
+
+                if (length == 0)
+                {
+                    if (!chunks.empty()) { return fail(test, "an empty range called the body"); }
+                    continue;
+                }
+
+                if (isSerial)
+                {
+                    if (chunks.size() != 1 || chunks[0].begin != begin || chunks[0].end != end)
+                    {
+                        return fail(test, "grain %zu, [%zu, %zu) is below the cutoff, but ran as %zu calls", grainSize, begin, end, chunks.size());
+                    }
+
+                    continue;
+                }
+
+                if (chunks.size() != (length + grain - 1) / grain)
+                {
+                    return fail(test, "grain %zu, [%zu, %zu) ran as %zu chunks, expected %zu", grainSize, begin, end, chunks.size(), (length + grain - 1) / grain);
+                }
+
+                for (size_t c = 0; c < chunks.size(); c++)
+                {
+                    size_t expectedBegin = begin + c * grain;
+                    size_t expectedEnd   = std::min(end, expectedBegin + grain);
+
+                    if (chunks[c].begin != expectedBegin || chunks[c].end != expectedEnd)
+                    {
+                        return fail(test, "grain %zu, [%zu, %zu): chunk %zu is [%zu, %zu), expected [%zu, %zu)",
+                                    grainSize, begin, end, c, chunks[c].begin, chunks[c].end, expectedBegin, expectedEnd);
+                    }
+                }
+            }
+        }
+    }
+
+    // parallelFor visits each index of its range once, too.
+    std::vector<std::atomic<int>> forVisits(DEFAULT_SERIAL_CUTOFF * 3);
+    for (std::atomic<int> &visit : forVisits) { visit = 0; }
+
+    parallelFor(5, forVisits.size(), [&](size_t i) { forVisits[i]++; });
+
+    for (size_t i = 0; i < forVisits.size(); i++)
+    {
+        if (forVisits[i] != (i >= 5 ? 1 : 0))
+        {
+            return fail(test, "parallelFor visited index %zu %d times", i, (int) forVisits[i]);
+        }
+    }
+
+    return true;
+}
+
+
+/**
+    Calls nested inside the body of another, and calls made at the same 
+    time from several threads, as Maya's parallel evaluation does, must 
+    finish and visit every index once. Exceptions thrown by the body reach
+    the caller.
+*/
+static bool testParallelNested()
+{
+    const char *test = "parallel.nested";
+
+    ParallelSettings settings;
+    setParallelThreadLimit(4);
+    setParallelSerialCutoff(1);
+
+    const size_t outer = 24;
+    const size_t inner = 5000;
+
+    std::vector<std::atomic<int>> visits(outer * inner);
+    for (std::atomic<int> &visit : visits) { visit = 0; }
+
+    parallelForRange(0, outer, 1, [&](size_t outerBegin, size_t outerEnd)
+    {
+        for (size_t o = outerBegin; o < outerEnd; o++)
+        {
+            parallelFor(0, inner, [&](size_t i) { visits[o * inner + i]++; }, 256);
+        }
+    });
+
+    for (size_t i = 0; i < visits.size(); i++)
+    {
+        if (visits[i] != 1)
+        {
+            return fail(test, "nested calls visited index %zu of inner range %zu %d times", i % inner, i / inner, (int) visits[i]);
+        }
+    }
+
+    for (std::atomic<int> &visit : visits) { visit = 0; }
+
+    std::vector<std::thread> callers;
+
+    for (size_t o = 0; o < outer; o++)
+    {
+        callers.push_back(std::thread([&visits, o, inner]()
+        {
+            parallelFor(0, inner, [&](size_t i) { visits[o * inner + i]++; }, 256);
+        }));
+    }
+
+    for (std::thread &caller : callers) { caller.join(); }
+
+    for (size_t i = 0; i < visits.size(); i++)
+    {
+        if (visits[i] != 1)
+        {
+            return fail(test, "concurrent calls visited index %zu of range %zu %d times", i % inner, i / inner, (int) visits[i]);
+        }
+    }
+
+    bool isThrown = false;
+
+    try
+    {
+        parallelFor(0, inner, [](size_t i) { if (i == 4321) { throw std::runtime_error("thrown by the body"); } }, 256);
+    } catch (const std::runtime_error &) {
+        isThrown = true;
+    }
+
+    if (!isThrown)
+    {
+        return fail(test, "an exception thrown by the body did not reach the caller");
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+
+static std::vector<TestCase> testCases()
+{
+    std::vector<TestCase> cases;
+
+    cases.push_back({"quatKernels.scalar",      testQuatKernelsScalar});
+    cases.push_back({"quatKernels.sse2",        testQuatKernelsSSE2});
+    cases.push_back({"quatKernels.avx2",        testQuatKernelsAVX2});
+    cases.push_back({"quatKernels.broadcast",   testQuatKernelsBroadcast});
+    cases.push_back({"matrixKernels.scalar",    testMatrixKernelsScalar});
+    cases.push_back({"matrixKernels.sse2",      testMatrixKernelsSSE2});
+    cases.push_back({"matrixKernels.avx2",      testMatrixKernelsAVX2});
+    cases.push_back({"matrixKernels.public",    testMatrixKernelsPublic});
+    cases.push_back({"matrixKernels.inverse",   testMatrixKernelsInverse});
+    cases.push_back({"matrixCompose.roundTrip", testMatrixComposeRoundTrip});
+    cases.push_back({"dirtyRange.recompute",    testDirtyRangeRecompute});
+    cases.push_back({"sharedBuffer.share",      testSharedBufferShare});
+    cases.push_back({"sharedBuffer.copyOnWrite", testSharedBufferCopyOnWrite});
+    cases.push_back({"quatSlerp.reference",     testSlerpReference});
+    cases.push_back({"quatSlerp.prepared",      testSlerpPrepared});
+    cases.push_back({"sidecarFile.roundTrip",   testSidecarRoundTrip});
+    cases.push_back({"sidecarFile.reuse",       testSidecarReuse});
+    cases.push_back({"vectorKernels.rotate",    testVectorRotate});
+    cases.push_back({"vectorKernels.rotateByQuat", testVectorRotateByQuat});
+    cases.push_back({"eulerKernels.angles",     testEulerAngles});
+    cases.push_back({"quatCodec.lossless",      testCodecLossless});
+    cases.push_back({"quatCodec.smallestThree", testCodecSmallestThree});
+    cases.push_back({"quatCodec.corrupt",       testCodecCorrupt});
+    cases.push_back({"contentHash.known",       testContentHashKnown});
+    cases.push_back({"contentHash.streaming",   testContentHashStreaming});
+    cases.push_back({"doubleText.roundTrip",    testDoubleTextRoundTrip});
+    cases.push_back({"doubleText.shortest",     testDoubleTextShortest});
+    cases.push_back({"doubleText.parse",        testDoubleTextParse});
+    cases.push_back({"parallel.threadLimit",    testParallelThreadLimit});
+    cases.push_back({"parallel.coverage",       testParallelCoverage});
+    cases.push_back({"parallel.nested",         testParallelNested});
+
+    return cases;
+}
+
+
+int main(int argc, char **argv)
+{
+    std::string filter;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: xformArrayCoreTests [--filter <text>]\n");
+            return 2;
+        }
+    }
+
+    int failures = 0;
+
+    for (const TestCase &testCase : testCases())
+    {
+        if (testCase.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        randomState = 1;
+
+        bool passed = testCase.run();
+        printf("%-40s %s\n", testCase.name.c_str(), passed ? "ok" : "FAILED");
+
+        failures += passed ? 0 : 1;
+    }
+
+    return failures;
+}
@@ -0,0 +1,843 @@
+/**
+    Copyright (c) 2017 Ryan Porter
+    You may use, distribute, or modify this code under the terms of the MIT license.
+*/
+
+/**
+xformArrayDataTests
+    Checks what needs Maya to build and run: that the array data types
+    read back what they write, that copies, which share their values, are
+    not changed by changes to each other, and that core kernels that stand
+    in for Maya functions agree with them. It is only built with the 
+    plug-in; xformArrayCoreTests covers everything that does not need Maya.
+
+    Each test prints what it found when it fails, and the executable exits
+    with the number of failed tests, so that it can be run by CTest.
+
+    Usage: xformArrayDataTests [--filter <text>]
+*/
+
+#include "../src/core/eulerKernels.h"
+#include "../src/core/quatLanes.h"
+#include "../src/core/xformTypes.h"
+#include "../src/core/sidecarFile.h"
+#include "../src/data/angleArrayData.h"
+#include "../src/data/arrayData.h"
+#include "../src/data/eulerArrayData.h"
+#include "../src/data/quatArrayData.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <maya/MAngle.h>
+#include <maya/MArgList.h>
+#include <maya/MEulerRotation.h>
+#include <maya/MLibrary.h>
+#include <maya/MQuaternion.h>
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+
+struct TestCase
+{
+    std::string            name;
+    std::function<bool()>  run;
+};
+
+
+/** Prints a failure, and returns false, so that tests can `return fail(...)`. */
+static bool fail(const char *test, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    fprintf(stderr, "%s failed: ", test);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+
+    va_end(args);
+    return false;
+}
+
+
+static const double PI = 3.14159265358979323846;
+
+static uint64_t randomState = 1;
+
+/** xorshift64*, so that every run sees the same values. */
+static uint64_t randomBits()
+{
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 0x2545F4914F6CDD1DULL;
+}
+
+
+/** A random value in [-1, 1). */
+static double randomValue()
+{
+    return (double) (randomBits() >> 11) / (double) (1ULL << 52) - 1.0;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Arrays                                                                   */
+/* ------------------------------------------------------------------------ */
+
+/** The tests set the sidecar threshold to this, so that their arrays can be written to sidecar files. */
+static const unsigned TEST_ITEMS = 1001;
+
+static std::vector<MAngle> randomAngles()
+{
+    std::vector<MAngle> items(TEST_ITEMS);
+    for (MAngle &item : items) { item = MAngle(randomValue() * PI, MAngle::kRadians); }
+    return items;
+}
+
+
+/** Rotations in every order, so that the orders are written one per rotation. */
+static std::vector<MEulerRotation> randomRotations()
+{
+    std::vector<MEulerRotation> items(TEST_ITEMS);
+
+    for (MEulerRotation &item : items)
+    {
+        MEulerRotation::RotationOrder order = (MEulerRotation::RotationOrder) (randomBits() % 6);
+        item = MEulerRotation(randomValue() * PI, randomValue() * PI, randomValue() * PI, order);
+    }
+
+    return items;
+}
+
+
+static std::vector<MQuaternion> randomQuaternions()
+{
+    std::vector<MQuaternion> items(TEST_ITEMS);
+    for (MQuaternion &item : items) { item = MQuaternion(randomValue(), randomValue(), randomValue(), randomValue()); }
+    return items;
+}
+
+
+/** Values converted to and from the UI unit are compared with a tolerance. */
+static bool isClose(double a, double b)
+{
+    return fabs(a - b) <= 1.0e-12 * std::max(1.0, fabs(a));
+}
+
+
+static bool isSameItem(const MAngle &a, const MAngle &b)
+{
+    return isClose(a.asRadians(), b.asRadians());
+}
+
+
+static bool isSameItem(const MEulerRotation &a, const MEulerRotation &b)
+{
+    return isClose(a.x, b.x) && isClose(a.y, b.y) && isClose(a.z, b.z) && a.order == b.order;
+}
+
+
+static bool isSameItem(const MQuaternion &a, const MQuaternion &b)
+{
+    return isClose(a.x, b.x) && isClose(a.y, b.y) && isClose(a.z, b.z) && isClose(a.w, b.w);
+}
+
+
+/** Returns the index of the first item that differs, or the shorter length if one array is longer. */
+template <typename ITEM>
+static size_t firstDifference(const std::vector<ITEM> &a, const std::vector<ITEM> &b)
+{
+    size_t n = std::min(a.size(), b.size());
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!isSameItem(a[i], b[i])) { return i; }
+    }
+
+    return a.size() == b.size() ? (size_t) -1 : n;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  File formats                                                             */
+/* ------------------------------------------------------------------------ */
+
+static std::string writeBinaryText(MPxData &data)
+{
+    std::ostringstream out(std::ios::out | std::ios::binary);
+    data.writeBinary(out);
+    return out.str();
+}
+
+
+static std::string writeASCIIText(MPxData &data)
+{
+    std::ostringstream out;
+    data.writeASCII(out);
+    return out.str();
+}
+
+
+static bool readBinaryText(MPxData &data, const std::string &bytes)
+{
+    std::istringstream in(bytes, std::ios::in | std::ios::binary);
+    return data.readBinary(in, (unsigned) bytes.size()) == MStatus::kSuccess;
+}
+
+
+/**
+    Splits text into arguments, as Maya does when it reads a scene: each
+    word is an argument, and a quoted string, without its quotes and
+    escapes, is one argument.
+*/
+static MArgList asciiArgs(const std::string &text)
+{
+    MArgList args;
+    size_t i = 0;
+
+    while (i < text.size())
+    {
+        if (text[i] == ' ') { i++; continue; }
+
+        std::string arg;
+
+        if (text[i] == '"')
+        {
+            for (i++; i < text.size() && text[i] != '"'; i++)
+            {
+                if (text[i] == '\\' && i + 1 < text.size()) { i++; }
+                arg.push_back(text[i]);
+            }
+
+            i++;
+        } else {
+            for (; i < text.size() && text[i] != ' '; i++) { arg.push_back(text[i]); }
+        }
+
+        args.addArg(MString(arg.c_str()));
+    }
+
+    return args;
+}
+
+
+/** Returns true if every argument in text was read. */
+static bool readASCIIText(MPxData &data, const std::string &text)
+{
+    MArgList args = asciiArgs(text);
+    unsigned int end = 0;
+
+    MStatus status = data.readASCII(args, end);
+    return status == MStatus::kSuccess && end == args.length();
+}
+
+
+/** Returns the sidecar path in ASCII text, or an empty string if the values were written inline. */
+static std::string sidecarPathIn(const std::string &text)
+{
+    // The path is the only quoted argument.
+    size_t i = text.find('"');
+    if (i == std::string::npos) { return std::string(); }
+
+    return asciiArgs(text.substr(i)).asString(0).asChar();
+}
+
+
+/** The path of the file after its scene and sidecar directory moved somewhere else. */
+static std::string movedPath(const std::string &path)
+{
+    size_t nameStart = path.find_last_of("/\\") + 1;
+    return sidecarDirectory() + "/xformArrayDataTests-missing/" + path.substr(nameStart);
+}
+
+
+/** Replaces the sidecar path in ASCII text, escaping it as writeASCIISidecar does. */
+static std::string replaceASCIIPath(const std::string &text, const std::string &path, const std::string &newPath)
+{
+    auto quoted = [](const std::string &p)
+    {
+        std::string q = "\"";
+
+        for (char c : p)
+        {
+            if (c == '\\' || c == '"') { q.push_back('\\'); }
+            q.push_back(c);
+        }
+
+        return q + "\"";
+    };
+
+    std::string result = text;
+    std::string from = quoted(path);
+    size_t i = result.find(from);
+
+    if (i != std::string::npos) { result.replace(i, from.size(), quoted(newPath)); }
+
+    return result;
+}
+
+
+/** Replaces the sidecar path in binary data, and the length written before it. */
+static std::string replaceBinaryPath(const std::string &bytes, const std::string &path, const std::string &newPath)
+{
+    std::string result = bytes;
+    size_t i = result.find(path);
+
+    if (i == std::string::npos || i < sizeof(unsigned)) { return result; }
+
+    unsigned pathLength = (unsigned) newPath.size();
+    result.replace(i, path.size(), newPath);
+    result.replace(i - sizeof(unsigned), sizeof(unsigned), (const char*) &pathLength, sizeof(unsigned));
+
+    return result;
+}
+
+
+/** The directory tests write sidecar files to. */
+static std::string temporaryDirectory()
+{
+#if defined(_WIN32)
+    const char *directory = getenv("TEMP");
+    return directory != NULL ? std::string(directory) : std::string(".");
+#else
+    const char *directory = getenv("TMPDIR");
+    return directory != NULL ? std::string(directory) : std::string("/tmp");
+#endif
+}
+
+
+/**
+    Writes items inline and to a sidecar file, in the binary and ASCII
+    formats, and checks that each reads back the same items. Sidecar
+    files are written with angles shown in degrees and read with them
+    shown in radians, and are also read from a path whose directory is
+    missing, which falls back to the file of the same name in
+    sidecarDirectory().
+*/
+template <typename DATA, typename ITEM>
+static bool checkRoundTrips(const char *test, const std::vector<ITEM> &items)
+{
+    const std::string directory = temporaryDirectory();
+    const size_t threshold = sidecarThreshold();
+    const MAngle::Unit uiUnit = MAngle::uiUnit();
+
+    bool isValid = true;
+
+    auto check = [&](const char *format, DATA &data, bool wasRead)
+    {
+        size_t i = wasRead ? firstDifference(items, data.array()) : 0;
+
+        if (!wasRead)
+        {
+            isValid = fail(test, "%s could not be read", format);
+        } else if (i != (size_t) -1) {
+            isValid = fail(test, "%s read back %u items, which differ from the %u written at item %zu",
+                format, data.length(), (unsigned) items.size(), i);
+        }
+    };
+
+    setSidecarThreshold(TEST_ITEMS);
+
+    for (int useSidecarFile = 0; useSidecarFile < 2; useSidecarFile++)
+    {
+        setSidecarDirectory(useSidecarFile ? directory : std::string());
+
+        std::string binary, ascii, path;
+
+        {
+            DATA original;
+            std::vector<ITEM> array(items);
+            original.setArray(std::move(array));
+
+            if (useSidecarFile) { MAngle::setUIUnit(MAngle::kDegrees); }
+
+            binary = writeBinaryText(original);
+            ascii = writeASCIIText(original);
+
+            if (useSidecarFile) { MAngle::setUIUnit(MAngle::kRadians); }
+        }
+
+        path = sidecarPathIn(ascii);
+
+        if (path.empty() == (useSidecarFile != 0))
+        {
+            isValid = fail(test, useSidecarFile ? "the items were not written to a sidecar file" : "the items were written to a sidecar file, with no sidecar directory");
+            continue;
+        }
+
+        {
+            DATA fromBinary, fromASCII;
+
+            check(useSidecarFile ? "binary sidecar" : "binary", fromBinary, readBinaryText(fromBinary, binary));
+            check(useSidecarFile ? "ASCII sidecar" : "ASCII", fromASCII, readASCIIText(fromASCII, ascii));
+        }
+
+        if (useSidecarFile)
+        {
+            std::string moved = movedPath(path);
+
+            DATA fromBinary, fromASCII;
+
+            check("moved binary sidecar", fromBinary, readBinaryText(fromBinary, replaceBinaryPath(binary, path, moved)));
+            check("moved ASCII sidecar", fromASCII, readASCIIText(fromASCII, replaceASCIIPath(ascii, path, moved)));
+        }
+
+        remove(path.c_str());
+    }
+
+    MAngle::setUIUnit(uiUnit);
+    setSidecarDirectory(std::string());
+    setSidecarThreshold(threshold);
+
+    return isValid;
+}
+
+
+static bool testAngleRoundTrip()
+{
+    return checkRoundTrips<AngleArrayData>("angleArrayData.roundTrip", randomAngles());
+}
+
+
+static bool testEulerRoundTrip()
+{
+    return checkRoundTrips<EulerArrayData>("eulerArrayData.roundTrip", randomRotations());
+}
+
+
+static bool testQuatRoundTrip()
+{
+    return checkRoundTrips<QuatArrayData>("quatArrayData.roundTrip", randomQuaternions());
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Copies                                                                   */
+/* ------------------------------------------------------------------------ */
+
+/** Returns false, after printing why, if data does not hold items. */
+template <typename DATA, typename ITEM>
+static bool checkArray(const char *test, const char *what, const DATA &data, const std::vector<ITEM> &items)
+{
+    size_t i = firstDifference(items, data.array());
+
+    if (i != (size_t) -1)
+    {
+        return fail(test, "%s holds %zu items, which differ from the %zu expected at item %zu", what, data.array().size(), items.size(), i);
+    }
+
+    return true;
+}
+
+
+/** 
+    Copies data, which shares its values until one copy changes them, and
+    checks that changing one copy with each setter leaves the other as it
+    was, whichever copy is changed.
+*/
+template <typename DATA, typename ITEM>
+static bool checkCopies(const char *test, const std::vector<ITEM> &items, const std::vector<ITEM> &otherItems)
+{
+    DATA original;
+    std::vector<ITEM> array(items);
+    original.setArray(std::move(array));
+
+    DATA copy;
+    copy.copy(original);
+
+    if (!checkArray(test, "a copy", copy, items)) { return false; }
+
+    array = otherItems;
+    copy.setArray(std::move(array));
+
+    if (!checkArray(test, "the original, after setArray on a copy,", original, items)) { return false; }
+    if (!checkArray(test, "a copy, after setArray,", copy, otherItems)) { return false; }
+
+    copy.copy(original);
+    array = otherItems;
+    original.setArray(std::move(array));
+
+    if (!checkArray(test, "a copy, after setArray on the original,", copy, items)) { return false; }
+
+    return true;
+}
+
+
+static bool testAngleCopy()
+{
+    std::vector<MAngle> items = randomAngles();
+    return checkCopies<AngleArrayData>("angleArrayData.copy", items, randomAngles());
+}
+
+
+static bool testEulerCopy()
+{
+    const char *test = "eulerArrayData.copy";
+
+    std::vector<MEulerRotation> items = randomRotations();
+    if (!checkCopies<EulerArrayData>(test, items, randomRotations())) { return false; }
+
+    EulerArrayData original;
+    std::vector<MEulerRotation> array(items);
+    original.setArray(std::move(array));
+
+    EulerArrayData copy;
+    copy.copy(original);
+    copy.setRotationOrder(MEulerRotation::kZYX);
+
+    if (!checkArray(test, "the original, after setRotationOrder on a copy,", original, items)) { return false; }
+
+    if (copy.hasMixedOrders() || copy.rotationOrder() != MEulerRotation::kZYX)
+    {
+        return fail(test, "a copy was not reordered by setRotationOrder");
+    }
+
+    copy.copy(original);
+    original.setRotationOrder(MEulerRotation::kYXZ);
+
+    return checkArray(test, "a copy, after setRotationOrder on the original,", copy, items);
+}
+
+
+/** Returns lanes holding items, or their conjugates. */
+template <typename REAL>
+static BasicQuatLanes<REAL> lanesOf(const std::vector<MQuaternion> &items, bool conjugate)
+{
+    BasicQuatLanes<REAL> lanes;
+    lanes.resize(items.size());
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        double s = conjugate ? -1.0 : 1.0;
+
+        lanes.x[i] = (REAL) (items[i].x * s);
+        lanes.y[i] = (REAL) (items[i].y * s);
+        lanes.z[i] = (REAL) (items[i].z * s);
+        lanes.w[i] = (REAL) items[i].w;
+    }
+
+    return lanes;
+}
+
+
+template <typename REAL>
+static bool isSameLanes(const BasicQuatLanes<REAL> &a, const BasicQuatLanes<REAL> &b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+
+/**
+    Quaternion data can hold an array and double and float lanes at once,
+    and a copy shares all of them, so each setter is checked with every 
+    layout built on the original first.
+*/
+static bool testQuatCopy()
+{
+    const char *test = "quatArrayData.copy";
+
+    std::vector<MQuaternion> items = randomQuaternions();
+    if (!checkCopies<QuatArrayData>(test, items, randomQuaternions())) { return false; }
+
+    const QuatLanes expectedLanes = lanesOf<double>(items, false);
+    const QuatLanesF expectedLanesF = lanesOf<float>(items, false);
+
+    QuatArrayData original;
+    std::vector<MQuaternion> array(items);
+    original.setArray(std::move(array));
+
+    // Builds the other layouts, which copies share.
+    original.lanes();
+    original.lanesF();
+
+    auto isUnchanged = [&](const char *what)
+    {
+        if (!checkArray(test, what, original, items)) { return false; }
+
+        if (!isSameLanes(original.lanes(), expectedLanes) || !isSameLanes(original.lanesF(), expectedLanesF))
+        {
+            return fail(test, "the lanes of %s changed", what);
+        }
+
+        return true;
+    };
+
+    QuatArrayData withLanes;
+    withLanes.copy(original);
+    withLanes.setLanes(lanesOf<double>(items, true));
+
+    if (!isUnchanged("the original, after setLanes on a copy,")) { return false; }
+
+    if (!isSameLanes(withLanes.lanes(), lanesOf<double>(items, true)))
+    {
+        return fail(test, "a copy did not hold the lanes given to setLanes");
+    }
+
+    QuatArrayData withLanesF;
+    withLanesF.copy(original);
+    withLanesF.setLanesF(lanesOf<float>(items, true));
+
+    if (!isUnchanged("the original, after setLanesF on a copy,")) { return false; }
+
+    if (!isSameLanes(withLanesF.lanesF(), lanesOf<float>(items, true)))
+    {
+        return fail(test, "a copy did not hold the lanes given to setLanesF");
+    }
+
+    // Nor may changing the original change a copy.
+    QuatArrayData copy;
+    copy.copy(original);
+    original.setLanes(lanesOf<double>(items, true));
+
+    if (!checkArray(test, "a copy, after setLanes on the original,", copy, items)) { return false; }
+
+    if (!isSameLanes(copy.lanes(), expectedLanes) || !isSameLanes(copy.lanesF(), expectedLanesF))
+    {
+        return fail(test, "the lanes of a copy changed after setLanes on the original");
+    }
+
+    return true;
+}
+
+
+/**
+    Takes the array out of data that is the only holder of it, which must
+    move it, and out of data that shares it with a copy, which must copy it
+    and leave the copy as it was. Either way, the data is left empty, with 
+    a new contentId, as getUserArrayOutput relies on.
+*/
+template <typename DATA, typename ITEM>
+static bool checkTakeArray(const char *test, const std::vector<ITEM> &items)
+{
+    DATA data;
+    std::vector<ITEM> array(items);
+    data.setArray(std::move(array));
+
+    const ITEM *held = data.array().data();
+    uint64_t id = data.contentId();
+
+    std::vector<ITEM> taken = data.takeArray();
+
+    if (taken.data() != held)
+    {
+        return fail(test, "the array was copied, although no other data held it");
+    }
+
+    if (taken.size() != items.size() || firstDifference(taken, items) != items.size())
+    {
+        return fail(test, "the array taken differs from the one set, at item %zu", firstDifference(taken, items));
+    }
+
+    if (data.length() != 0 || data.contentId() == id)
+    {
+        return fail(test, "the data was not left empty, with a new contentId");
+    }
+
+    array = items;
+    data.setArray(std::move(array));
+
+    DATA copy;
+    copy.copy(data);
+
+    held = data.array().data();
+    taken = data.takeArray();
+
+    if (taken.data() == held)
+    {
+        return fail(test, "the array was moved, although a copy shares it");
+    }
+
+    if (taken.size() != items.size() || firstDifference(taken, items) != items.size())
+    {
+        return fail(test, "the array copied out differs from the one set, at item %zu", firstDifference(taken, items));
+    }
+
+    return checkArray(test, "a copy, after takeArray on the original,", copy, items);
+}
+
+
+static bool testAngleTakeArray()
+{
+    return checkTakeArray<AngleArrayData>("angleArrayData.take", randomAngles());
+}
+
+
+static bool testEulerTakeArray()
+{
+    return checkTakeArray<EulerArrayData>("eulerArrayData.take", randomRotations());
+}
+
+
+/** Data that only holds lanes builds the array to take it. */
+static bool testQuatTakeArray()
+{
+    const char *test = "quatArrayData.take";
+
+    std::vector<MQuaternion> items = randomQuaternions();
+    if (!checkTakeArray<QuatArrayData>(test, items)) { return false; }
+
+    QuatArrayData data;
+    data.setLanes(lanesOf<double>(items, false));
+
+    std::vector<MQuaternion> taken = data.takeArray();
+
+    if (taken.size() != items.size() || firstDifference(taken, items) != items.size())
+    {
+        return fail(test, "the array taken from lanes differs from them, at item %zu", firstDifference(taken, items));
+    }
+
+    if (data.length() != 0 || !data.lanes().empty())
+    {
+        return fail(test, "data that held lanes was not left empty");
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Euler conversions                                                        */
+/* ------------------------------------------------------------------------ */
+
+/**
+    Checks, for every rotation order, that the Per Order conversion of 
+    quatToEulerArray gives the same rotations as its default Maya 
+    conversion, asEulerRotation() then reorderIt(), including at the 
+    poles. Only the rotations are compared, as the two may choose 
+    different angles for them.
+*/
+static bool testEulerConversions()
+{
+    const char *test = "eulerKernels.maya";
+    const double tolerance = 1.0e-9;
+
+    std::vector<MQuaternion> items = randomQuaternions();
+
+    // Rotations of +-90 degrees about each axis, which put some order at its pole.
+    const double h = sqrt(0.5);
+    const MQuaternion poles[] = {
+        MQuaternion(h, 0, 0, h), MQuaternion(0, h, 0, h), MQuaternion(0, 0, h, h),
+        MQuaternion(-h, 0, 0, h), MQuaternion(0, -h, 0, h), MQuaternion(0, 0, -h, h),
+        MQuaternion(0.5, 0.5, 0.5, 0.5), MQuaternion(0.5, -0.5, 0.5, 0.5)
+    };
+
+    items.insert(items.end(), poles, poles + sizeof(poles) / sizeof(poles[0]));
+
+    std::vector<Quaternion> q(items.size());
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        double length = sqrt(items[i].x * items[i].x + items[i].y * items[i].y + items[i].z * items[i].z + items[i].w * items[i].w);
+        items[i] = MQuaternion(items[i].x / length, items[i].y / length, items[i].z / length, items[i].w / length);
+
+        Quaternion r = {items[i].x, items[i].y, items[i].z, items[i].w};
+        q[i] = r;
+    }
+
+    std::vector<EulerRotation> e(items.size());
+
+    for (int order = 0; order < 6; order++)
+    {
+        MEulerRotation::RotationOrder rotateOrder = (MEulerRotation::RotationOrder) order;
+        quatArrayToEuler(q.data(), q.size(), order, e.data());
+
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            MEulerRotation expected = items[i].asEulerRotation();
+            expected.reorderIt(rotateOrder);
+
+            MQuaternion a = expected.asQuaternion();
+            MQuaternion b = MEulerRotation(e[i].x, e[i].y, e[i].z, rotateOrder).asQuaternion();
+
+            double dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+
+            if (fabs(fabs(dot) - 1.0) > tolerance)
+            {
+                return fail(test, "order %d, quaternion %zu: Maya found (%.17g, %.17g, %.17g), the kernel (%.17g, %.17g, %.17g), which is another rotation",
+                    order, i, expected.x, expected.y, expected.z, e[i].x, e[i].y, e[i].z);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Test runner                                                              */
+/* ------------------------------------------------------------------------ */
+
+static std::vector<TestCase> testCases()
+{
+    std::vector<TestCase> cases;
+
+    cases.push_back({"angleArrayData.roundTrip",  testAngleRoundTrip});
+    cases.push_back({"eulerArrayData.roundTrip",  testEulerRoundTrip});
+    cases.push_back({"quatArrayData.roundTrip",   testQuatRoundTrip});
+    cases.push_back({"angleArrayData.copy",       testAngleCopy});
+    cases.push_back({"eulerArrayData.copy",       testEulerCopy});
+    cases.push_back({"quatArrayData.copy",        testQuatCopy});
+    cases.push_back({"angleArrayData.take",       testAngleTakeArray});
+    cases.push_back({"eulerArrayData.take",       testEulerTakeArray});
+    cases.push_back({"quatArrayData.take",        testQuatTakeArray});
+    cases.push_back({"eulerKernels.maya",         testEulerConversions});
+
+    return cases;
+}
+
+
+int main(int argc, char **argv)
+{
+    std::string filter;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: xformArrayDataTests [--filter <text>]\n");
+            return 2;
+        }
+    }
+
+    MStatus status = MLibrary::initialize(argv[0], true);
+
+    if (!status)
+    {
+        fprintf(stderr, "Could not initialize Maya.\n");
+        return 1;
+    }
+
+    int failures = 0;
+
+    for (const TestCase &testCase : testCases())
+    {
+        if (testCase.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        randomState = 1;
+
+        bool passed = testCase.run();
+        printf("%-40s %s\n", testCase.name.c_str(), passed ? "ok" : "FAILED");
+
+        failures += passed ? 0 : 1;
+    }
+
+    MLibrary::cleanup(failures, false);
+
+    return failures;
+}